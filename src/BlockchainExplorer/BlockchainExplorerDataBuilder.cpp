@@ -186,7 +186,12 @@ bool BlockchainExplorerDataBuilder::fillBlockDetails(const Block &block, BlockDe
 }
 
 bool BlockchainExplorerDataBuilder::fillTransactionDetails(const Transaction& transaction, TransactionDetails& transactionDetails, uint64_t timestamp) {
-  Crypto::Hash hash = getObjectHash(transaction);
+  Crypto::Hash hash;
+  size_t blobSize;
+  if (!getObjectHash(transaction, hash, blobSize)) {
+    return false;
+  }
+
   transactionDetails.hash = hash;
 
   transactionDetails.timestamp = timestamp;
@@ -210,7 +215,7 @@ bool BlockchainExplorerDataBuilder::fillTransactionDetails(const Transaction& tr
     }
   }
 
-  transactionDetails.size = getObjectBinarySize(transaction);
+  transactionDetails.size = blobSize;
   transactionDetails.unlockTime = transaction.unlockTime;
   transactionDetails.totalOutputsAmount = get_outs_money_amount(transaction);
 
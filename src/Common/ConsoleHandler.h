@@ -14,8 +14,8 @@
 #include <thread>
 #include <vector>
 
-#include "BlockingQueue.h"
 #include "ConsoleTools.h"
+#include "MpmcQueue.h"
 
 #ifndef _WIN32
     #include <sys/select.h>
@@ -44,7 +44,7 @@ private:
 
   std::atomic<bool> m_stop;
   std::thread m_thread;
-  BlockingQueue<std::string> m_queue;
+  MpmcQueue<std::string> m_queue;
 };
 
 
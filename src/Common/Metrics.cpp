@@ -0,0 +1,220 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "Metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+namespace Common {
+
+namespace {
+
+enum class MetricType {
+  COUNTER,
+  GAUGE,
+  HISTOGRAM
+};
+
+const char* const METRIC_TYPE_NAMES[] = { "counter", "gauge", "histogram" };
+
+struct MetricFamily {
+  MetricType type;
+  std::string help;
+  std::vector<double> bounds;
+  std::map<std::string, std::unique_ptr<MetricCounter>> counters;
+  std::map<std::string, std::unique_ptr<MetricGauge>> gauges;
+  std::map<std::string, std::unique_ptr<MetricHistogram>> histograms;
+};
+
+struct Registry {
+  std::mutex mutex;
+  std::map<std::string, MetricFamily> families;
+};
+
+Registry& registry() {
+  static Registry instance;
+  return instance;
+}
+
+MetricFamily& findFamily(Registry& registry, const std::string& name, const std::string& help, MetricType type) {
+  auto it = registry.families.find(name);
+  if (it == registry.families.end()) {
+    it = registry.families.emplace(name, MetricFamily()).first;
+    it->second.type = type;
+    it->second.help = help;
+  } else if (it->second.type != type) {
+    throw std::invalid_argument("Metric " + name + " is already registered as a " + METRIC_TYPE_NAMES[static_cast<size_t>(it->second.type)]);
+  }
+
+  return it->second;
+}
+
+template <typename Metric, typename... Args>
+Metric& findMetric(std::map<std::string, std::unique_ptr<Metric>>& metrics, const std::string& labels, Args&&... args) {
+  auto& metric = metrics[labels];
+  if (!metric) {
+    metric.reset(new Metric(std::forward<Args>(args)...));
+  }
+
+  return *metric;
+}
+
+std::string escape(const std::string& text, bool quotes) {
+  std::string result;
+  result.reserve(text.size());
+  for (char c : text) {
+    if (c == '\\') {
+      result += "\\\\";
+    } else if (c == '\n') {
+      result += "\\n";
+    } else if (c == '"' && quotes) {
+      result += "\\\"";
+    } else {
+      result += c;
+    }
+  }
+
+  return result;
+}
+
+void writeNumber(std::ostream& stream, double value) {
+  if (std::isinf(value)) {
+    stream << (value > 0 ? "+Inf" : "-Inf");
+  } else if (std::isnan(value)) {
+    stream << "NaN";
+  } else {
+    std::ostringstream text;
+    text.imbue(std::locale::classic());
+    text.precision(std::numeric_limits<double>::max_digits10);
+    text << value;
+    stream << text.str();
+  }
+}
+
+void writeSample(std::ostream& stream, const std::string& name, const std::string& labels, const std::string& extraLabel) {
+  stream << name;
+  if (!labels.empty() || !extraLabel.empty()) {
+    stream << '{' << labels << (labels.empty() || extraLabel.empty() ? "" : ",") << extraLabel << '}';
+  }
+
+  stream << ' ';
+}
+
+}
+
+MetricHistogram::MetricHistogram(const std::vector<double>& bounds) : bounds(bounds), buckets(new std::atomic<uint64_t>[bounds.size() + 1]), sum(0) {
+  if (!std::is_sorted(bounds.begin(), bounds.end())) {
+    throw std::invalid_argument("Histogram bounds must be sorted");
+  }
+
+  for (size_t i = 0; i <= bounds.size(); ++i) {
+    buckets[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void MetricHistogram::observe(double value) {
+  size_t index = std::lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin();
+  buckets[index].fetch_add(1, std::memory_order_relaxed);
+
+  double current = sum.load(std::memory_order_relaxed);
+  while (!sum.compare_exchange_weak(current, current + value, std::memory_order_relaxed)) {
+  }
+}
+
+uint64_t MetricHistogram::getBucketCount(size_t index) const {
+  return buckets[index].load(std::memory_order_relaxed);
+}
+
+uint64_t MetricHistogram::getCount() const {
+  uint64_t count = 0;
+  for (size_t i = 0; i <= bounds.size(); ++i) {
+    count += getBucketCount(i);
+  }
+
+  return count;
+}
+
+double MetricHistogram::getSum() const {
+  return sum.load(std::memory_order_relaxed);
+}
+
+const std::vector<double>& Metrics::latencyBuckets() {
+  static const std::vector<double> bounds = { 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10 };
+  return bounds;
+}
+
+MetricCounter& Metrics::counter(const std::string& name, const std::string& help, const std::string& labels) {
+  Registry& metrics = registry();
+  std::lock_guard<std::mutex> lock(metrics.mutex);
+  return findMetric(findFamily(metrics, name, help, MetricType::COUNTER).counters, labels);
+}
+
+MetricGauge& Metrics::gauge(const std::string& name, const std::string& help, const std::string& labels) {
+  Registry& metrics = registry();
+  std::lock_guard<std::mutex> lock(metrics.mutex);
+  return findMetric(findFamily(metrics, name, help, MetricType::GAUGE).gauges, labels);
+}
+
+MetricHistogram& Metrics::histogram(const std::string& name, const std::string& help, const std::vector<double>& bounds, const std::string& labels) {
+  Registry& metrics = registry();
+  std::lock_guard<std::mutex> lock(metrics.mutex);
+  MetricFamily& family = findFamily(metrics, name, help, MetricType::HISTOGRAM);
+  if (family.histograms.empty()) {
+    family.bounds = bounds;
+  }
+
+  return findMetric(family.histograms, labels, family.bounds);
+}
+
+std::string Metrics::label(const std::string& name, const std::string& value) {
+  return name + "=\"" + escape(value, true) + "\"";
+}
+
+void Metrics::writePrometheus(std::ostream& stream) {
+  Registry& metrics = registry();
+  std::lock_guard<std::mutex> lock(metrics.mutex);
+  for (auto& entry : metrics.families) {
+    const std::string& name = entry.first;
+    const MetricFamily& family = entry.second;
+    stream << "# HELP " << name << ' ' << escape(family.help, false) << '\n';
+    stream << "# TYPE " << name << ' ' << METRIC_TYPE_NAMES[static_cast<size_t>(family.type)] << '\n';
+
+    for (auto& counter : family.counters) {
+      writeSample(stream, name, counter.first, "");
+      stream << counter.second->get() << '\n';
+    }
+
+    for (auto& gauge : family.gauges) {
+      writeSample(stream, name, gauge.first, "");
+      stream << gauge.second->get() << '\n';
+    }
+
+    for (auto& histogram : family.histograms) {
+      const MetricHistogram& metric = *histogram.second;
+      uint64_t cumulative = 0;
+      for (size_t i = 0; i <= family.bounds.size(); ++i) {
+        cumulative += metric.getBucketCount(i);
+        std::ostringstream bound;
+        writeNumber(bound, i < family.bounds.size() ? family.bounds[i] : std::numeric_limits<double>::infinity());
+        writeSample(stream, name + "_bucket", histogram.first, label("le", bound.str()));
+        stream << cumulative << '\n';
+      }
+
+      writeSample(stream, name + "_sum", histogram.first, "");
+      writeNumber(stream, metric.getSum());
+      stream << '\n';
+      writeSample(stream, name + "_count", histogram.first, "");
+      stream << cumulative << '\n';
+    }
+  }
+}
+
+}
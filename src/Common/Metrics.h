@@ -0,0 +1,136 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Common {
+
+// Metrics are updated with relaxed atomics and never lock, so they may be touched from any thread.
+// Look them up once (e.g. into a static reference) rather than on every update.
+
+class MetricCounter {
+public:
+  MetricCounter() : value(0) {}
+  MetricCounter(const MetricCounter&) = delete;
+  MetricCounter& operator=(const MetricCounter&) = delete;
+
+  void inc(uint64_t count = 1) {
+    value.fetch_add(count, std::memory_order_relaxed);
+  }
+
+  uint64_t get() const {
+    return value.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<uint64_t> value;
+};
+
+class MetricGauge {
+public:
+  MetricGauge() : value(0) {}
+  MetricGauge(const MetricGauge&) = delete;
+  MetricGauge& operator=(const MetricGauge&) = delete;
+
+  void set(int64_t newValue) {
+    value.store(newValue, std::memory_order_relaxed);
+  }
+
+  void add(int64_t delta) {
+    value.fetch_add(delta, std::memory_order_relaxed);
+  }
+
+  int64_t get() const {
+    return value.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<int64_t> value;
+};
+
+// Counts observations into fixed buckets. Bounds are upper bounds, inclusive, in ascending order;
+// values above the last bound go to an implicit +Inf bucket.
+class MetricHistogram {
+public:
+  explicit MetricHistogram(const std::vector<double>& bounds);
+  MetricHistogram(const MetricHistogram&) = delete;
+  MetricHistogram& operator=(const MetricHistogram&) = delete;
+
+  void observe(double value);
+
+  const std::vector<double>& getBounds() const {
+    return bounds;
+  }
+
+  // Observations in bucket index alone, not cumulative; index bounds.size() is the +Inf bucket.
+  uint64_t getBucketCount(size_t index) const;
+  uint64_t getCount() const;
+  double getSum() const;
+
+private:
+  const std::vector<double> bounds;
+  std::unique_ptr<std::atomic<uint64_t>[]> buckets;
+  std::atomic<double> sum;
+};
+
+// Observes the seconds elapsed between its construction and destruction.
+class MetricTimer {
+public:
+  explicit MetricTimer(MetricHistogram& histogram) : histogram(&histogram), start(std::chrono::steady_clock::now()) {}
+  MetricTimer(const MetricTimer&) = delete;
+  MetricTimer& operator=(const MetricTimer&) = delete;
+
+  ~MetricTimer() {
+    finish();
+  }
+
+  // Observes now instead of on destruction.
+  void finish() {
+    if (histogram != nullptr) {
+      histogram->observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+      histogram = nullptr;
+    }
+  }
+
+  // Drops the measurement, e.g. for an operation that failed early.
+  void cancel() {
+    histogram = nullptr;
+  }
+
+private:
+  MetricHistogram* histogram;
+  std::chrono::steady_clock::time_point start;
+};
+
+// Process wide registry. A metric is identified by its name and its labels, which are given preformatted,
+// e.g. Metrics::label("command", "1001"); repeated lookups return the same object, which lives as long as
+// the process. Registering a name again with another type throws std::invalid_argument.
+class Metrics {
+public:
+  static MetricCounter& counter(const std::string& name, const std::string& help, const std::string& labels = std::string());
+  static MetricGauge& gauge(const std::string& name, const std::string& help, const std::string& labels = std::string());
+  // The bounds of the first registration of a name are used for all of its label sets.
+  static MetricHistogram& histogram(const std::string& name, const std::string& help, const std::vector<double>& bounds,
+    const std::string& labels = std::string());
+
+  // name="value" with the value escaped; join several with ','.
+  static std::string label(const std::string& name, const std::string& value);
+
+  // Prometheus text exposition format, version 0.0.4.
+  static void writePrometheus(std::ostream& stream);
+
+  // Bounds in seconds, from 100 microseconds to 10 seconds.
+  static const std::vector<double>& latencyBuckets();
+};
+
+}
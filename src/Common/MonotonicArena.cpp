@@ -0,0 +1,63 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "MonotonicArena.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace Common {
+
+MonotonicArena::MonotonicArena(size_t initialChunkSize) : m_chunk(0), m_offset(0), m_initialChunkSize(initialChunkSize) {
+}
+
+void* MonotonicArena::allocate(size_t size, size_t alignment) {
+  assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+  for (;;) {
+    if (m_chunk < m_chunks.size()) {
+      Chunk& chunk = m_chunks[m_chunk];
+      uintptr_t base = reinterpret_cast<uintptr_t>(chunk.data.get());
+      size_t offset = static_cast<size_t>(((base + m_offset + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1)) - base);
+      if (offset <= chunk.size && size <= chunk.size - offset) {
+        m_offset = offset + size;
+        return chunk.data.get() + offset;
+      }
+
+      // a chunk kept from an earlier, bigger workload may still fit
+      if (m_chunk + 1 < m_chunks.size()) {
+        ++m_chunk;
+        m_offset = 0;
+        continue;
+      }
+    }
+
+    if (size > std::numeric_limits<size_t>::max() - alignment) {
+      throw std::bad_alloc();
+    }
+
+    size_t chunkSize = std::max(m_chunks.empty() ? m_initialChunkSize : m_chunks.back().size * 2, size + alignment);
+    m_chunks.push_back({ std::unique_ptr<uint8_t[]>(new uint8_t[chunkSize]), chunkSize });
+    m_chunk = m_chunks.size() - 1;
+    m_offset = 0;
+  }
+}
+
+void MonotonicArena::rewind(const Marker& marker) {
+  assert(marker.chunk < m_chunk || (marker.chunk == m_chunk && marker.offset <= m_offset));
+  m_chunk = marker.chunk;
+  m_offset = marker.offset;
+}
+
+size_t MonotonicArena::getCapacity() const {
+  size_t capacity = 0;
+  for (const Chunk& chunk : m_chunks) {
+    capacity += chunk.size;
+  }
+
+  return capacity;
+}
+
+}
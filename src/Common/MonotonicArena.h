@@ -0,0 +1,117 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace Common {
+
+// Bump allocator for short lived scratch data. Deallocation is a no-op; memory is reclaimed all at once by
+// rewinding to a marker (see MonotonicArena::Scope), and the chunks are kept, so an arena that has seen its
+// largest workload hands out memory without touching the heap. Not thread safe.
+class MonotonicArena {
+public:
+  struct Marker {
+    size_t chunk;
+    size_t offset;
+  };
+
+  // Rewinds the arena to where it was on construction; scopes nest.
+  class Scope {
+  public:
+    explicit Scope(MonotonicArena& arena) : m_arena(arena), m_marker(arena.getMarker()) {}
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    ~Scope() {
+      m_arena.rewind(m_marker);
+    }
+
+  private:
+    MonotonicArena& m_arena;
+    Marker m_marker;
+  };
+
+  explicit MonotonicArena(size_t initialChunkSize = 64 * 1024);
+  MonotonicArena(const MonotonicArena&) = delete;
+  MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+  void* allocate(size_t size, size_t alignment);
+
+  Marker getMarker() const {
+    return { m_chunk, m_offset };
+  }
+
+  // Everything allocated after the marker was taken becomes invalid.
+  void rewind(const Marker& marker);
+  void reset() {
+    rewind({ 0, 0 });
+  }
+
+  // Bytes held from the heap, whether in use or not.
+  size_t getCapacity() const;
+
+private:
+  struct Chunk {
+    std::unique_ptr<uint8_t[]> data;
+    size_t size;
+  };
+
+  std::vector<Chunk> m_chunks;
+  size_t m_chunk;
+  size_t m_offset;
+  size_t m_initialChunkSize;
+};
+
+// Standard allocator over a MonotonicArena, for containers of scratch data.
+template<class T>
+class ArenaAllocator {
+public:
+  typedef T value_type;
+
+  explicit ArenaAllocator(MonotonicArena& arena) : m_arena(&arena) {}
+
+  template<class U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : m_arena(other.getArena()) {}
+
+  T* allocate(size_t count) {
+    if (count > std::numeric_limits<size_t>::max() / sizeof(T)) {
+      throw std::bad_alloc();
+    }
+
+    return static_cast<T*>(m_arena->allocate(count * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T*, size_t) {
+  }
+
+  MonotonicArena* getArena() const {
+    return m_arena;
+  }
+
+private:
+  MonotonicArena* m_arena;
+};
+
+template<class T, class U>
+bool operator==(const ArenaAllocator<T>& left, const ArenaAllocator<U>& right) {
+  return left.getArena() == right.getArena();
+}
+
+template<class T, class U>
+bool operator!=(const ArenaAllocator<T>& left, const ArenaAllocator<U>& right) {
+  return !(left == right);
+}
+
+template<class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+}
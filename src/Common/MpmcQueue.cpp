@@ -0,0 +1,43 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "MpmcQueue.h"
+
+#include <climits>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Common {
+
+#ifdef __linux__
+
+void QueueWaiter::sleep(uint32_t epoch) {
+  // returns at once if the epoch moved on after the caller read it
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_epoch), FUTEX_WAIT_PRIVATE, epoch, nullptr, nullptr, 0);
+}
+
+void QueueWaiter::wake() {
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_epoch), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+
+#else
+
+void QueueWaiter::sleep(uint32_t epoch) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_condition.wait(lock, [&] { return m_epoch.load(std::memory_order_acquire) != epoch; });
+}
+
+void QueueWaiter::wake() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_condition.notify_all();
+}
+
+#endif
+
+}
@@ -0,0 +1,270 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace Common {
+
+// Parks threads until notified. Waiters register before re-checking their condition, so a notifier only
+// touches the kernel (a futex on Linux, a condition variable elsewhere) when somebody is actually asleep.
+class QueueWaiter {
+public:
+  QueueWaiter() : m_epoch(0), m_waiters(0) {}
+  QueueWaiter(const QueueWaiter&) = delete;
+  QueueWaiter& operator=(const QueueWaiter&) = delete;
+
+  template <typename Predicate>
+  void wait(Predicate ready) {
+    while (!ready()) {
+      uint32_t epoch = m_epoch.load(std::memory_order_acquire);
+      m_waiters.fetch_add(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!ready()) {
+        sleep(epoch);
+      }
+
+      m_waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+
+  // The caller must have published the change the waiters are looking for before calling this.
+  void notifyAll() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_waiters.load(std::memory_order_relaxed) != 0) {
+      m_epoch.fetch_add(1, std::memory_order_release);
+      wake();
+    }
+  }
+
+private:
+  void sleep(uint32_t epoch);
+  void wake();
+
+  std::atomic<uint32_t> m_epoch;
+  std::atomic<uint32_t> m_waiters;
+#ifndef __linux__
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+#endif
+};
+
+// Bounded multi-producer/multi-consumer ring queue with the push/pop/close semantics of BlockingQueue.
+// Producers and consumers claim cells with a CAS on their own position counter, and each cell's sequence
+// number tells whether it is ready for the next writer or reader, so no lock is taken while the queue is
+// neither full nor empty. Threads spin briefly and then park on a QueueWaiter.
+template <typename T>
+class MpmcQueue {
+public:
+  explicit MpmcQueue(size_t maxSize = 1) :
+    m_capacity(std::max<size_t>(maxSize, 2)), m_cells(new Cell[m_capacity]), m_enqueuePos(0), m_dequeuePos(0), m_state(0) {
+    for (size_t i = 0; i < m_capacity; ++i) {
+      m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpmcQueue(const MpmcQueue&) = delete;
+  MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+  ~MpmcQueue() {
+    for (size_t position = m_dequeuePos.load(); position != m_enqueuePos.load(); ++position) {
+      reinterpret_cast<T*>(&m_cells[position % m_capacity].storage)->~T();
+    }
+  }
+
+  // Blocks while the queue is full. Returns false once the queue is closed.
+  template <typename TT>
+  bool push(TT&& v) {
+    if ((m_state.fetch_add(PRODUCER, std::memory_order_acq_rel) & CLOSED) != 0) {
+      leaveProducer();
+      return false;
+    }
+
+    for (unsigned spin = 0; !pushCell<TT>(v); ++spin) {
+      if (spin < SPIN_COUNT) {
+        std::this_thread::yield();
+        continue;
+      }
+
+      m_haveSpace.wait([this] { return isClosed() || !isFull(); });
+      if (isClosed()) {
+        leaveProducer();
+        return false;
+      }
+    }
+
+    leaveProducer();
+    m_haveData.notifyAll();
+    return true;
+  }
+
+  // Blocks while the queue is empty. Returns false once the queue is closed and drained.
+  bool pop(T& v) {
+    for (unsigned spin = 0;; ++spin) {
+      if (popCell(v)) {
+        m_haveSpace.notifyAll();
+        return true;
+      }
+
+      if (isDrained()) {
+        // a producer admitted before close() may have finished in between
+        if (popCell(v)) {
+          m_haveSpace.notifyAll();
+          return true;
+        }
+
+        return false;
+      }
+
+      if (spin < SPIN_COUNT) {
+        std::this_thread::yield();
+        continue;
+      }
+
+      m_haveData.wait([this] { return !isEmpty() || isDrained(); });
+    }
+  }
+
+  // Never blocks. Returns false if the queue is full or closed.
+  template <typename TT>
+  bool tryPush(TT&& v) {
+    if ((m_state.fetch_add(PRODUCER, std::memory_order_acq_rel) & CLOSED) != 0 || !pushCell<TT>(v)) {
+      leaveProducer();
+      return false;
+    }
+
+    leaveProducer();
+    m_haveData.notifyAll();
+    return true;
+  }
+
+  // Never blocks. Returns false if the queue is empty.
+  bool tryPop(T& v) {
+    if (!popCell(v)) {
+      return false;
+    }
+
+    m_haveSpace.notifyAll();
+    return true;
+  }
+
+  void close(bool wait = false) {
+    m_state.fetch_or(CLOSED, std::memory_order_acq_rel);
+    m_haveData.notifyAll();
+    m_haveSpace.notifyAll();
+
+    if (wait) {
+      m_haveSpace.wait([this] { return isEmpty(); });
+    }
+  }
+
+  size_t size() const {
+    size_t enqueued = m_enqueuePos.load(std::memory_order_acquire);
+    size_t dequeued = m_dequeuePos.load(std::memory_order_acquire);
+    return enqueued > dequeued ? std::min(enqueued - dequeued, m_capacity) : 0;
+  }
+
+  size_t capacity() const {
+    return m_capacity;
+  }
+
+private:
+  // false sharing between the producer and consumer counters costs more than the padding
+  static const size_t CACHE_LINE = 64;
+  static const unsigned SPIN_COUNT = 16;
+  static const size_t CLOSED = 1;
+  static const size_t PRODUCER = 2;
+
+  struct Cell {
+    std::atomic<size_t> sequence;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+  };
+
+  template <typename TT>
+  bool pushCell(TT& v) {
+    size_t position = m_enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell& cell = m_cells[position % m_capacity];
+      size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      if (sequence == position) {
+        if (m_enqueuePos.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          new (&cell.storage) T(std::forward<TT>(v));
+          cell.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (sequence < position) {
+        return false;
+      } else {
+        position = m_enqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool popCell(T& v) {
+    size_t position = m_dequeuePos.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell& cell = m_cells[position % m_capacity];
+      size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      if (sequence == position + 1) {
+        if (m_dequeuePos.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          T* item = reinterpret_cast<T*>(&cell.storage);
+          v = std::move(*item);
+          item->~T();
+          cell.sequence.store(position + m_capacity, std::memory_order_release);
+          return true;
+        }
+      } else if (sequence < position + 1) {
+        return false;
+      } else {
+        position = m_dequeuePos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  void leaveProducer() {
+    if ((m_state.fetch_sub(PRODUCER, std::memory_order_acq_rel) & CLOSED) != 0) {
+      m_haveData.notifyAll();
+    }
+  }
+
+  bool isClosed() const {
+    return (m_state.load(std::memory_order_acquire) & CLOSED) != 0;
+  }
+
+  // closed, and every producer admitted before close() has left
+  bool isDrained() const {
+    return m_state.load(std::memory_order_acquire) == CLOSED;
+  }
+
+  bool isEmpty() const {
+    size_t position = m_dequeuePos.load(std::memory_order_acquire);
+    return m_cells[position % m_capacity].sequence.load(std::memory_order_acquire) != position + 1;
+  }
+
+  bool isFull() const {
+    size_t position = m_enqueuePos.load(std::memory_order_acquire);
+    return m_cells[position % m_capacity].sequence.load(std::memory_order_acquire) != position;
+  }
+
+  const size_t m_capacity;
+  std::unique_ptr<Cell[]> m_cells;
+  alignas(CACHE_LINE) std::atomic<size_t> m_enqueuePos;
+  alignas(CACHE_LINE) std::atomic<size_t> m_dequeuePos;
+  alignas(CACHE_LINE) std::atomic<size_t> m_state;
+  QueueWaiter m_haveData;
+  QueueWaiter m_haveSpace;
+};
+
+}
@@ -0,0 +1,99 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "RollingBloomFilter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+namespace Common {
+
+namespace {
+
+// Seeds differ between filters, and between nodes, so that nobody can pick keys that collide everywhere.
+uint64_t nextSeed() {
+  static const uint64_t base = (static_cast<uint64_t>(std::random_device()()) << 32) | std::random_device()();
+  static std::atomic<uint64_t> counter(0);
+  uint64_t seed = base + 0x9e3779b97f4a7c15 * counter.fetch_add(1, std::memory_order_relaxed);
+  seed ^= seed >> 31;
+  seed *= 0xbf58476d1ce4e5b9;
+  return seed ^ (seed >> 29);
+}
+
+}
+
+RollingBloomFilter::RollingBloomFilter(size_t capacity, double falsePositiveRate) :
+  m_current(0), m_currentCount(0), m_capacity(std::max<size_t>(capacity, 1)), m_seed(nextSeed()) {
+  // a key is looked up in both generations, so each gets half of the false positive rate
+  double ln2 = std::log(2.0);
+  double bitsPerKey = -std::log(falsePositiveRate / 2) / (ln2 * ln2);
+  m_bitCount = std::max<size_t>(static_cast<size_t>(std::ceil(bitsPerKey * m_capacity)), 64);
+  m_hashCount = std::max<size_t>(1, std::min<size_t>(static_cast<size_t>(std::lround(bitsPerKey * ln2)), 32));
+}
+
+void RollingBloomFilter::insert(const Crypto::Hash& key) {
+  if (m_generations[m_current].empty()) {
+    m_generations[m_current].assign((m_bitCount + 63) / 64, 0);
+  }
+
+  if (m_currentCount == m_capacity) {
+    m_current ^= 1;
+    m_generations[m_current].assign((m_bitCount + 63) / 64, 0);
+    m_currentCount = 0;
+  }
+
+  uint64_t h1;
+  uint64_t h2;
+  getHashes(key, h1, h2);
+  std::vector<uint64_t>& generation = m_generations[m_current];
+  for (size_t i = 0; i < m_hashCount; ++i) {
+    size_t bit = static_cast<size_t>((h1 + i * h2) % m_bitCount);
+    generation[bit / 64] |= uint64_t(1) << (bit % 64);
+  }
+
+  ++m_currentCount;
+}
+
+bool RollingBloomFilter::contains(const Crypto::Hash& key) const {
+  return contains(m_generations[m_current], key) || contains(m_generations[m_current ^ 1], key);
+}
+
+bool RollingBloomFilter::contains(const std::vector<uint64_t>& generation, const Crypto::Hash& key) const {
+  if (generation.empty()) {
+    return false;
+  }
+
+  uint64_t h1;
+  uint64_t h2;
+  getHashes(key, h1, h2);
+  for (size_t i = 0; i < m_hashCount; ++i) {
+    size_t bit = static_cast<size_t>((h1 + i * h2) % m_bitCount);
+    if ((generation[bit / 64] & (uint64_t(1) << (bit % 64))) == 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// The i-th bit of a key is (h1 + i * h2) mod m_bitCount: two hashes stand in for all m_hashCount of them.
+void RollingBloomFilter::getHashes(const Crypto::Hash& key, uint64_t& h1, uint64_t& h2) const {
+  uint64_t words[2];
+  std::memcpy(words, key.data, sizeof(words));
+  h1 = words[0] ^ m_seed;
+  h2 = (words[1] ^ (m_seed << 17 | m_seed >> 47)) | 1;
+}
+
+void RollingBloomFilter::clear() {
+  m_generations[0].clear();
+  m_generations[1].clear();
+  m_current = 0;
+  m_currentCount = 0;
+}
+
+}
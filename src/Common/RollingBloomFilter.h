@@ -0,0 +1,42 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <CryptoTypes.h>
+
+namespace Common {
+
+// Approximate set of the most recently inserted hashes: contains() is true for each of the last `capacity` keys
+// inserted, and for older or never inserted keys with a probability of about falsePositiveRate, up to the point
+// where they are forgotten. Keys are hashes already, so their bytes are used as the hash functions' input.
+// Memory is allocated on the first insert.
+class RollingBloomFilter {
+public:
+  RollingBloomFilter(size_t capacity, double falsePositiveRate);
+
+  void insert(const Crypto::Hash& key);
+  bool contains(const Crypto::Hash& key) const;
+  void clear();
+
+private:
+  // Two generations of `capacity` keys each; the older one is dropped when the newer one is full.
+  std::vector<uint64_t> m_generations[2];
+  size_t m_current;
+  size_t m_currentCount;
+  size_t m_capacity;
+  size_t m_bitCount;
+  size_t m_hashCount;
+  uint64_t m_seed;
+
+  bool contains(const std::vector<uint64_t>& generation, const Crypto::Hash& key) const;
+  void getHashes(const Crypto::Hash& key, uint64_t& h1, uint64_t& h2) const;
+};
+
+}
@@ -36,6 +36,19 @@ namespace Tools {
     template<int bits, typename InputIt, typename T>
     typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value && 0 <= bits && bits <= std::numeric_limits<T>::digits, int>::type
     read_varint(InputIt &&first, InputIt &&last, T &i) {
+        if (first == last) {
+            i = 0;
+            return 0;
+        }
+
+        // Most varints are a single byte, which is always canonical and only overflows types narrower than 7 bits.
+        unsigned char head = *first;
+        if (head < 0x80 && (bits >= 7 || head < 1 << (bits < 7 ? bits : 0))) {
+            ++first;
+            i = static_cast<T>(head);
+            return 1;
+        }
+
         int read = 0;
         i = 0;
         for (int shift = 0;; shift += 7) {
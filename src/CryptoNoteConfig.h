@@ -82,6 +82,10 @@ const uint64_t CRYPTONOTE_LOCKED_TX_ALLOWED_DELTA_SECONDS    = DIFFICULTY_TARGET
 const uint64_t CRYPTONOTE_MEMPOOL_TX_LIVETIME                = (60 * 60 * 14); //seconds, 14 hours
 const uint64_t CRYPTONOTE_MEMPOOL_TX_FROM_ALT_BLOCK_LIVETIME = (60 * 60 * 24); //seconds, one day
 const uint64_t CRYPTONOTE_NUMBER_OF_PERIODS_TO_FORGET_TX_DELETED_FROM_POOL = 7;  // CRYPTONOTE_NUMBER_OF_PERIODS_TO_FORGET_TX_DELETED_FROM_POOL * CRYPTONOTE_MEMPOOL_TX_LIVETIME = time to forget tx
+const size_t   CRYPTONOTE_SEEN_TX_CACHE_SIZE                 = 100000;   // relayed transactions recognized without parsing them
+const uint64_t CRYPTONOTE_SEEN_TX_CACHE_LIFETIME             = 60 * 10;  //seconds, 10 minutes
+const size_t   CRYPTONOTE_REJECTED_TX_CACHE_SIZE             = 10000;    // rejected transactions refused again without parsing them
+const uint64_t CRYPTONOTE_REJECTED_TX_CACHE_LIFETIME         = 60 * 2;   //seconds, 2 minutes
 
 const size_t   FUSION_TX_MAX_SIZE                            = CRYPTONOTE_BLOCK_GRANTED_FULL_REWARD_ZONE * 30 / 100;
 const size_t   FUSION_TX_MIN_INPUT_COUNT                     = 12;
@@ -99,6 +103,8 @@ static_assert(UPGRADE_VOTING_WINDOW > 1, "Bad UPGRADE_VOTING_WINDOW");
 const char     CRYPTONOTE_BLOCKS_FILENAME[]                  = "blocks.dat";
 const char     CRYPTONOTE_BLOCKINDEXES_FILENAME[]            = "blockindexes.dat";
 const char     CRYPTONOTE_BLOCKSCACHE_FILENAME[]             = "blockscache.dat";
+const char     CRYPTONOTE_RAWBLOCKS_FILENAME[]               = "rawblocks.dat";
+const char     CRYPTONOTE_RAWBLOCKINDEXES_FILENAME[]         = "rawblockindexes.dat";
 const char     CRYPTONOTE_POOLDATA_FILENAME[]                = "poolstate.bin";
 const char     P2P_NET_DATA_FILENAME[]                       = "p2pstate.bin";
 const char     CRYPTONOTE_BLOCKCHAIN_INDICES_FILENAME[]      = "blockchainindices.dat";
@@ -132,6 +138,7 @@ const uint8_t  BLOCK_MINOR_VERSION_1                         =  1;
 const size_t   BLOCKS_IDS_SYNCHRONIZING_DEFAULT_COUNT        =  10000;  //by default, blocks ids count in synchronizing
 const size_t   BLOCKS_SYNCHRONIZING_DEFAULT_COUNT            =  200;    //by default, blocks count in blocks downloading
 const size_t   COMMAND_RPC_GET_BLOCKS_FAST_MAX_COUNT         =  1000;
+const size_t   RPC_RESPONSE_CACHE_MAX_ENTRIES                =  4096;   //per cached endpoint
 
 const int      P2P_DEFAULT_PORT                              = 32000;
 const int      RPC_DEFAULT_PORT                              = 33000;
@@ -143,6 +150,19 @@ const size_t   P2P_CONNECTION_MAX_WRITE_BUFFER_SIZE          = 64 * 1024 * 1024;
 const uint32_t P2P_DEFAULT_CONNECTIONS_COUNT                 = 8;
 const size_t   P2P_DEFAULT_WHITELIST_CONNECTIONS_PERCENT     = 70;
 const uint32_t P2P_DEFAULT_HANDSHAKE_INTERVAL                = 60;            // seconds
+const uint32_t P2P_DEFAULT_TX_RELAY_INTERVAL                 = 100;           // milliseconds between transaction inventory batches
+const uint32_t P2P_DEFAULT_TX_REQUEST_TIMEOUT                = 2000;          // milliseconds before an announced transaction is asked from the next peer that announced it
+const size_t   P2P_KNOWN_TXS_FILTER_SIZE                     = 10000;         // transaction ids remembered per peer
+const size_t   P2P_MAX_TX_INVENTORY_SIZE                     = 5000;          // transaction ids in a NOTIFY_TX_INVENTORY
+const size_t   P2P_CONNECTION_CANDIDATES_COUNT               = 4;             // peerlist entries compared by score per connection attempt
+const uint32_t P2P_PEER_REFERENCE_HANDSHAKE_RTT              = 200;           // milliseconds; peer metrics at these values score 0, like unmeasured ones
+const uint32_t P2P_PEER_REFERENCE_BLOCK_LATENCY              = 1000;          // milliseconds
+const uint64_t P2P_PEER_REFERENCE_SYNC_SPEED                 = 100 * 1024;    // bytes per second
+const uint32_t P2P_PEER_STRIKE_LIFETIME                      = 60 * 60;       // seconds an invalid data strike counts against a peer
+const uint32_t P2P_PEER_MAX_STRIKES                          = 3;             // strikes after which a peer is not connected to
+const int64_t  P2P_PEER_EVICTION_SCORE                       = -100;          // outgoing peers scoring lower are replaced
+const size_t   P2P_MAX_SYNCHRONIZING_PEERS                   = 3;             // peers downloading blocks at once, unless a better one shows up
+const uint32_t P2P_SYNC_STALL_TIMEOUT                        = 60;            // seconds without blocks after which a synchronizing peer stops counting
 const uint32_t P2P_DEFAULT_PACKET_MAX_SIZE                   = 50000000;      // 50000000 bytes maximum packet size
 const uint32_t P2P_DEFAULT_PEERS_IN_HANDSHAKE                = 250;
 const uint32_t P2P_DEFAULT_CONNECTION_TIMEOUT                = 5000;          // 5 seconds
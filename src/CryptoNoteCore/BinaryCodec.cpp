@@ -0,0 +1,254 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "BinaryCodec.h"
+
+#include "CryptoNoteConfig.h"
+
+namespace CryptoNote {
+
+namespace {
+
+// tags of BinaryVariantTagGetter in CryptoNoteSerialization.cpp
+const uint8_t BASE_INPUT_TAG = 0xff;
+const uint8_t KEY_TAG = 0x2;
+const uint8_t MULTISIGNATURE_TAG = 0x3;
+
+size_t getSignaturesCount(const TransactionInput& input) {
+  switch (input.which()) {
+  case 1:
+    return boost::get<KeyInput>(input).outputIndexes.size();
+  case 2:
+    return boost::get<MultisignatureInput>(input).signatureCount;
+  default:
+    return 0;
+  }
+}
+
+}
+
+void decode(BinaryDecoder& decoder, std::string& value) {
+  size_t size = decoder.readCount();
+  value.resize(size);
+  if (size != 0) {
+    decoder.read(&value[0], size);
+  }
+}
+
+void encode(BinaryEncoder& encoder, const std::string& value) {
+  encoder.writeVarint(value.size());
+  encoder.write(value.data(), value.size());
+}
+
+void decode(BinaryDecoder& decoder, TransactionInput& input) {
+  switch (decoder.readByte()) {
+  case BASE_INPUT_TAG: {
+    BaseInput base;
+    decode(decoder, base.blockIndex);
+    input = base;
+    break;
+  }
+  case KEY_TAG: {
+    input = KeyInput();
+    KeyInput& key = boost::get<KeyInput>(input);
+    decode(decoder, key.amount);
+    decode(decoder, key.outputIndexes);
+    decoder.read(&key.keyImage, sizeof(key.keyImage));
+    break;
+  }
+  case MULTISIGNATURE_TAG: {
+    MultisignatureInput multisignature;
+    decode(decoder, multisignature.amount);
+    decode(decoder, multisignature.signatureCount);
+    decode(decoder, multisignature.outputIndex);
+    decode(decoder, multisignature.term);
+    input = multisignature;
+    break;
+  }
+  default:
+    throw std::runtime_error("Unknown variant tag");
+  }
+}
+
+void encode(BinaryEncoder& encoder, const TransactionInput& input) {
+  switch (input.which()) {
+  case 0: {
+    encoder.writeByte(BASE_INPUT_TAG);
+    encoder.writeVarint(boost::get<BaseInput>(input).blockIndex);
+    break;
+  }
+  case 1: {
+    const KeyInput& key = boost::get<KeyInput>(input);
+    encoder.writeByte(KEY_TAG);
+    encoder.writeVarint(key.amount);
+    encode(encoder, key.outputIndexes);
+    encoder.write(&key.keyImage, sizeof(key.keyImage));
+    break;
+  }
+  default: {
+    const MultisignatureInput& multisignature = boost::get<MultisignatureInput>(input);
+    encoder.writeByte(MULTISIGNATURE_TAG);
+    encoder.writeVarint(multisignature.amount);
+    encoder.writeVarint(multisignature.signatureCount);
+    encoder.writeVarint(multisignature.outputIndex);
+    encoder.writeVarint(multisignature.term);
+    break;
+  }
+  }
+}
+
+void decode(BinaryDecoder& decoder, TransactionOutput& output) {
+  decode(decoder, output.amount);
+  switch (decoder.readByte()) {
+  case KEY_TAG: {
+    KeyOutput key;
+    decode(decoder, key.key);
+    output.target = key;
+    break;
+  }
+  case MULTISIGNATURE_TAG: {
+    output.target = MultisignatureOutput();
+    MultisignatureOutput& multisignature = boost::get<MultisignatureOutput>(output.target);
+    decode(decoder, multisignature.keys);
+    decode(decoder, multisignature.requiredSignatureCount);
+    decode(decoder, multisignature.term);
+    break;
+  }
+  default:
+    throw std::runtime_error("Unknown variant tag");
+  }
+}
+
+void encode(BinaryEncoder& encoder, const TransactionOutput& output) {
+  encoder.writeVarint(output.amount);
+  if (output.target.which() == 0) {
+    encoder.writeByte(KEY_TAG);
+    encode(encoder, boost::get<KeyOutput>(output.target).key);
+  } else {
+    const MultisignatureOutput& multisignature = boost::get<MultisignatureOutput>(output.target);
+    encoder.writeByte(MULTISIGNATURE_TAG);
+    encode(encoder, multisignature.keys);
+    encoder.writeVarint(multisignature.requiredSignatureCount);
+    encoder.writeVarint(multisignature.term);
+  }
+}
+
+void decode(BinaryDecoder& decoder, TransactionPrefix& prefix) {
+  decode(decoder, prefix.version);
+  decode(decoder, prefix.unlockTime);
+  decode(decoder, prefix.inputs);
+  decode(decoder, prefix.outputs);
+
+  prefix.extra.resize(decoder.readCount());
+  if (!prefix.extra.empty()) {
+    decoder.read(prefix.extra.data(), prefix.extra.size());
+  }
+}
+
+void encode(BinaryEncoder& encoder, const TransactionPrefix& prefix) {
+  encoder.writeVarint(prefix.version);
+  encoder.writeVarint(prefix.unlockTime);
+  encode(encoder, prefix.inputs);
+  encode(encoder, prefix.outputs);
+  encoder.writeVarint(prefix.extra.size());
+  encoder.write(prefix.extra.data(), prefix.extra.size());
+}
+
+void decodeSignatures(BinaryDecoder& decoder, Transaction& transaction) {
+  if (TRANSACTION_VERSION_2 < transaction.version) {
+    throw std::runtime_error("Wrong transaction version");
+  }
+
+  transaction.signatures.resize(transaction.inputs.size());
+  for (size_t i = 0; i < transaction.inputs.size(); ++i) {
+    size_t count = getSignaturesCount(transaction.inputs[i]);
+    if (count > decoder.remaining() / sizeof(Crypto::Signature)) {
+      throw std::runtime_error("BinaryDecoder: unexpected end of data");
+    }
+
+    std::vector<Crypto::Signature>& signatures = transaction.signatures[i];
+    signatures.resize(count);
+    if (count != 0) {
+      decoder.read(signatures.data(), count * sizeof(Crypto::Signature));
+    }
+  }
+}
+
+void decode(BinaryDecoder& decoder, Transaction& transaction) {
+  decode(decoder, static_cast<TransactionPrefix&>(transaction));
+  decodeSignatures(decoder, transaction);
+}
+
+void encodeSignatures(BinaryEncoder& encoder, const Transaction& transaction) {
+  if (TRANSACTION_VERSION_2 < transaction.version) {
+    throw std::runtime_error("Wrong transaction version");
+  }
+
+  // a transaction without signatures is written as a prefix only, if none of its inputs needs any
+  bool signaturesNotExpected = transaction.signatures.empty();
+  if (!signaturesNotExpected && transaction.inputs.size() != transaction.signatures.size()) {
+    throw std::runtime_error("Serialization error: unexpected signatures size");
+  }
+
+  for (size_t i = 0; i < transaction.inputs.size(); ++i) {
+    size_t count = getSignaturesCount(transaction.inputs[i]);
+    if (signaturesNotExpected) {
+      if (count != 0) {
+        throw std::runtime_error("Serialization error: signatures are not expected");
+      }
+
+      continue;
+    }
+
+    if (count != transaction.signatures[i].size()) {
+      throw std::runtime_error("Serialization error: unexpected signatures size");
+    }
+
+    encoder.write(transaction.signatures[i].data(), count * sizeof(Crypto::Signature));
+  }
+}
+
+void encode(BinaryEncoder& encoder, const Transaction& transaction) {
+  encode(encoder, static_cast<const TransactionPrefix&>(transaction));
+  encodeSignatures(encoder, transaction);
+}
+
+void decode(BinaryDecoder& decoder, BlockHeader& header) {
+  decode(decoder, header.majorVersion);
+  if (header.majorVersion > BLOCK_MAJOR_VERSION_3) {
+    throw std::runtime_error("Wrong major version");
+  }
+
+  decode(decoder, header.minorVersion);
+  decode(decoder, header.timestamp);
+  decode(decoder, header.previousBlockHash);
+  decoder.read(&header.nonce, sizeof(header.nonce));
+}
+
+void encode(BinaryEncoder& encoder, const BlockHeader& header) {
+  encoder.writeVarint(header.majorVersion);
+  if (header.majorVersion > BLOCK_MAJOR_VERSION_3) {
+    throw std::runtime_error("Wrong major version");
+  }
+
+  encoder.writeVarint(header.minorVersion);
+  encoder.writeVarint(header.timestamp);
+  encode(encoder, header.previousBlockHash);
+  encoder.write(&header.nonce, sizeof(header.nonce));
+}
+
+void decode(BinaryDecoder& decoder, Block& block) {
+  decode(decoder, static_cast<BlockHeader&>(block));
+  decode(decoder, block.baseTransaction);
+  decode(decoder, block.transactionHashes);
+}
+
+void encode(BinaryEncoder& encoder, const Block& block) {
+  encode(encoder, static_cast<const BlockHeader&>(block));
+  encode(encoder, block.baseTransaction);
+  encode(encoder, block.transactionHashes);
+}
+
+}
@@ -0,0 +1,196 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "CryptoNote.h"
+
+namespace CryptoNote {
+
+// Binary format of the consensus types, without the virtual calls of ISerializer and IInputStream.
+// It produces and accepts exactly what BinaryOutputStreamSerializer and BinaryInputStreamSerializer do
+// with the serialize() overloads in CryptoNoteSerialization.cpp; keep the two in sync.
+
+// Reads from a contiguous buffer. Errors throw std::runtime_error.
+class BinaryDecoder {
+public:
+  BinaryDecoder(const uint8_t* data, size_t size) : m_begin(data), m_current(data), m_end(data + size) {}
+
+  size_t position() const {
+    return m_current - m_begin;
+  }
+
+  size_t remaining() const {
+    return m_end - m_current;
+  }
+
+  // Where the next read starts.
+  const uint8_t* current() const {
+    return m_current;
+  }
+
+  uint8_t readByte() {
+    if (m_current == m_end) {
+      throwTruncated();
+    }
+
+    return *m_current++;
+  }
+
+  void read(void* data, size_t size) {
+    memcpy(data, skip(size), size);
+  }
+
+  // Consumes size bytes and returns where they start in the buffer.
+  const uint8_t* skip(size_t size) {
+    if (size > remaining()) {
+      throwTruncated();
+    }
+
+    const uint8_t* data = m_current;
+    m_current += size;
+    return data;
+  }
+
+  // Same rules as Common::readVarint: overlong and overflowing encodings are rejected.
+  template<typename T>
+  T readVarint() {
+    static_assert(std::is_unsigned<T>::value, "readVarint reads unsigned types");
+    uint8_t piece = readByte();
+    if (piece < 0x80) {
+      return piece;
+    }
+
+    uint64_t value = piece & 0x7f;
+    for (unsigned shift = 7;; shift += 7) {
+      piece = readByte();
+      if (shift >= sizeof(T) * 8 - 7 && piece >= 1u << (sizeof(T) * 8 - shift)) {
+        throw std::runtime_error("readVarint, value overflow");
+      }
+
+      value |= static_cast<uint64_t>(piece & 0x7f) << shift;
+      if ((piece & 0x80) == 0) {
+        if (piece == 0) {
+          throw std::runtime_error("readVarint, invalid value representation");
+        }
+
+        return static_cast<T>(value);
+      }
+    }
+  }
+
+  // An element count; every element takes at least a byte, so a count above what is left can't be valid.
+  size_t readCount() {
+    uint64_t count = readVarint<uint64_t>();
+    if (count > remaining()) {
+      throwTruncated();
+    }
+
+    return static_cast<size_t>(count);
+  }
+
+private:
+  [[noreturn]] static void throwTruncated() {
+    throw std::runtime_error("BinaryDecoder: unexpected end of data");
+  }
+
+  const uint8_t* m_begin;
+  const uint8_t* m_current;
+  const uint8_t* m_end;
+};
+
+// Appends to a BinaryArray.
+class BinaryEncoder {
+public:
+  explicit BinaryEncoder(BinaryArray& output) : m_output(output) {}
+
+  void write(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    m_output.insert(m_output.end(), bytes, bytes + size);
+  }
+
+  void writeByte(uint8_t value) {
+    m_output.push_back(value);
+  }
+
+  void writeVarint(uint64_t value) {
+    while (value >= 0x80) {
+      m_output.push_back(static_cast<uint8_t>(value | 0x80));
+      value >>= 7;
+    }
+
+    m_output.push_back(static_cast<uint8_t>(value));
+  }
+
+private:
+  BinaryArray& m_output;
+};
+
+inline void decode(BinaryDecoder& decoder, uint8_t& value) { value = decoder.readVarint<uint8_t>(); }
+inline void decode(BinaryDecoder& decoder, uint32_t& value) { value = decoder.readVarint<uint32_t>(); }
+inline void decode(BinaryDecoder& decoder, uint64_t& value) { value = decoder.readVarint<uint64_t>(); }
+inline void decode(BinaryDecoder& decoder, Crypto::Hash& value) { decoder.read(&value, sizeof(value)); }
+inline void decode(BinaryDecoder& decoder, Crypto::PublicKey& value) { decoder.read(&value, sizeof(value)); }
+void decode(BinaryDecoder& decoder, std::string& value);
+
+inline void encode(BinaryEncoder& encoder, uint8_t value) { encoder.writeVarint(value); }
+inline void encode(BinaryEncoder& encoder, uint32_t value) { encoder.writeVarint(value); }
+inline void encode(BinaryEncoder& encoder, uint64_t value) { encoder.writeVarint(value); }
+inline void encode(BinaryEncoder& encoder, const Crypto::Hash& value) { encoder.write(&value, sizeof(value)); }
+inline void encode(BinaryEncoder& encoder, const Crypto::PublicKey& value) { encoder.write(&value, sizeof(value)); }
+void encode(BinaryEncoder& encoder, const std::string& value);
+
+void decode(BinaryDecoder& decoder, TransactionInput& input);
+void decode(BinaryDecoder& decoder, TransactionOutput& output);
+void decode(BinaryDecoder& decoder, TransactionPrefix& prefix);
+// The part of a transaction that follows its prefix.
+void decodeSignatures(BinaryDecoder& decoder, Transaction& transaction);
+void decode(BinaryDecoder& decoder, Transaction& transaction);
+void decode(BinaryDecoder& decoder, BlockHeader& header);
+void decode(BinaryDecoder& decoder, Block& block);
+
+void encode(BinaryEncoder& encoder, const TransactionInput& input);
+void encode(BinaryEncoder& encoder, const TransactionOutput& output);
+void encode(BinaryEncoder& encoder, const TransactionPrefix& prefix);
+void encodeSignatures(BinaryEncoder& encoder, const Transaction& transaction);
+void encode(BinaryEncoder& encoder, const Transaction& transaction);
+void encode(BinaryEncoder& encoder, const BlockHeader& header);
+void encode(BinaryEncoder& encoder, const Block& block);
+
+// Other types provide decode() and encode() members, like they do serialize() for ISerializer.
+template<typename T>
+void decode(BinaryDecoder& decoder, T& value) {
+  value.decode(decoder);
+}
+
+template<typename T>
+void encode(BinaryEncoder& encoder, const T& value) {
+  value.encode(encoder);
+}
+
+template<typename T>
+void decode(BinaryDecoder& decoder, std::vector<T>& value) {
+  value.resize(decoder.readCount());
+  for (T& item : value) {
+    decode(decoder, item);
+  }
+}
+
+template<typename T>
+void encode(BinaryEncoder& encoder, const std::vector<T>& value) {
+  encoder.writeVarint(value.size());
+  for (const T& item : value) {
+    encode(encoder, item);
+  }
+}
+
+}
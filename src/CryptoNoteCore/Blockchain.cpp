@@ -14,12 +14,14 @@
 #include <boost/foreach.hpp>
 #include "Common/Math.h"
 #include "Common/int-util.h"
+#include "Common/Metrics.h"
 #include "Common/ShuffleGenerator.h"
 #include "Common/StdInputStream.h"
 #include "Common/StdOutputStream.h"
 #include "Rpc/CoreRpcServerCommandsDefinitions.h"
 #include "Serialization/BinarySerializationTools.h"
 #include "CryptoNoteTools.h"
+#include "TraceLog.h"
 #include "TransactionExtra.h"
 
 using namespace Logging;
@@ -334,11 +336,11 @@ bool Blockchain::removeObserver(IBlockchainStorageObserver* observer) {
   return m_observerManager.remove(observer);
 }
 
-bool Blockchain::checkTransactionInputs(const CryptoNote::Transaction& tx, BlockInfo& maxUsedBlock) {
-  return checkTransactionInputs(tx, maxUsedBlock.height, maxUsedBlock.id) && check_tx_outputs(tx);
+bool Blockchain::checkTransactionInputs(const CryptoNote::CachedTransaction& tx, BlockInfo& maxUsedBlock) {
+  return checkTransactionInputs(tx, maxUsedBlock.height, maxUsedBlock.id) && check_tx_outputs(tx.getTransaction());
 }
 
-bool Blockchain::checkTransactionInputs(const CryptoNote::Transaction& tx, BlockInfo& maxUsedBlock, BlockInfo& lastFailed) {
+bool Blockchain::checkTransactionInputs(const CryptoNote::CachedTransaction& tx, BlockInfo& maxUsedBlock, BlockInfo& lastFailed) {
 
   BlockInfo tail;
 
@@ -421,6 +423,13 @@ bool Blockchain::init(const std::string& config_folder, bool load_existing) {
     return false;
   }
 
+  if (!m_rawBlocks.open(appendPath(config_folder, m_currency.rawBlocksFileName()), appendPath(config_folder, m_currency.rawBlockIndexesFileName()), 1024)) {
+    return false;
+  }
+
+  m_blocks.enableMetrics("blocks");
+  m_rawBlocks.enableMetrics("raw_blocks");
+
   if (load_existing && !m_blocks.empty()) {
     logger(INFO, BRIGHT_WHITE) << "Loading blockchain...";
     BlockCacheSerializer loader(*this, get_block_hash(m_blocks.back().bl), logger.getLogger());
@@ -432,8 +441,10 @@ bool Blockchain::init(const std::string& config_folder, bool load_existing) {
     }
 
     loadBlockchainIndices();
+    syncRawBlocks();
   } else {
     m_blocks.clear();
+    m_rawBlocks.clear();
   }
 
   if (m_blocks.empty()) {
@@ -493,13 +504,13 @@ void Blockchain::rebuildCache() {
     m_blockIndex.push(blockHash);
     uint64_t interest = 0;
     for (uint16_t t = 0; t < block.transactions.size(); ++t) {
-      const TransactionEntry& transaction = block.transactions[t];
-      Crypto::Hash transactionHash = getObjectHash(transaction.tx);
+      const CachedTransaction& cachedTransaction = block.transactions[t].tx;
+      const Transaction& transaction = cachedTransaction.getTransaction();
       TransactionIndex transactionIndex = { b, t };
-      m_transactionMap.insert(std::make_pair(transactionHash, transactionIndex));
+      m_transactionMap.insert(std::make_pair(cachedTransaction.getTransactionHash(), transactionIndex));
 
       // process inputs
-      for (auto& i : transaction.tx.inputs) {
+      for (auto& i : transaction.inputs) {
         if (i.type() == typeid(KeyInput)) {
           m_spent_keys.insert(::boost::get<KeyInput>(i).keyImage);
         } else if (i.type() == typeid(MultisignatureInput)) {
@@ -509,8 +520,8 @@ void Blockchain::rebuildCache() {
       }
 
       // process outputs
-      for (uint16_t o = 0; o < transaction.tx.outputs.size(); ++o) {
-        const auto& out = transaction.tx.outputs[o];
+      for (uint16_t o = 0; o < transaction.outputs.size(); ++o) {
+        const auto& out = transaction.outputs[o];
         if (out.target.type() == typeid(KeyOutput)) {
           m_outputs[out.amount].push_back(std::make_pair<>(transactionIndex, o));
         } else if (out.target.type() == typeid(MultisignatureOutput)) {
@@ -519,7 +530,7 @@ void Blockchain::rebuildCache() {
         }
       }
 
-      interest += m_currency.calculateTotalTransactionInterest(transaction.tx, b); //block.height); //block.height shows 0 wrongly sometimes apparently
+      interest += m_currency.calculateTotalTransactionInterest(transaction, b); //block.height); //block.height shows 0 wrongly sometimes apparently
     }
 
     pushToDepositIndex(block, interest);
@@ -529,6 +540,41 @@ void Blockchain::rebuildCache() {
   logger(INFO, BRIGHT_WHITE) << "Rebuilding internal structures took: " << duration.count();
 }
 
+void Blockchain::syncRawBlocks() {
+  while (m_rawBlocks.size() > m_blocks.size()) {
+    m_rawBlocks.pop_back();
+  }
+
+  if (!m_rawBlocks.empty()) {
+    uint32_t tail = static_cast<uint32_t>(m_rawBlocks.size() - 1);
+    if (m_rawBlocks[tail].block != asString(toBinaryArray(m_blocks[tail].bl))) {
+      logger(WARNING, BRIGHT_YELLOW) << "Raw block storage doesn't match blockchain, rebuilding...";
+      m_rawBlocks.clear();
+    }
+  }
+
+  if (m_rawBlocks.size() == m_blocks.size()) {
+    return;
+  }
+
+  logger(INFO, BRIGHT_WHITE) << "Building raw block storage";
+  for (uint32_t b = static_cast<uint32_t>(m_rawBlocks.size()); b < m_blocks.size(); ++b) {
+    if (b % 1000 == 0) {
+      logger(INFO, BRIGHT_WHITE) << "Height " << b << " of " << m_blocks.size();
+    }
+
+    const BlockEntry& block = m_blocks[b];
+    RawBlockEntry rawBlock;
+    rawBlock.block = asString(toBinaryArray(block.bl));
+    rawBlock.transactions.reserve(block.transactions.size() - 1);
+    for (size_t t = 1; t < block.transactions.size(); ++t) {
+      rawBlock.transactions.push_back(asString(toBinaryArray(block.transactions[t].tx.getTransaction())));
+    }
+
+    m_rawBlocks.push_back(rawBlock);
+  }
+}
+
 bool Blockchain::storeCache() {
   std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
 
@@ -552,6 +598,7 @@ bool Blockchain::deinit() {
 bool Blockchain::resetAndSetGenesisBlock(const Block& b) {
   std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   m_blocks.clear();
+  m_rawBlocks.clear();
   m_blockIndex.clear();
   m_transactionMap.clear();
 
@@ -656,6 +703,20 @@ bool Blockchain::getBlockByHash(const Crypto::Hash& blockHash, Block& b) {
   return false;
 }
 
+bool Blockchain::getRawBlock(const Crypto::Hash& blockId, block_complete_entry& entry) {
+  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+
+  uint32_t height = 0;
+  if (!m_blockIndex.getBlockHeight(blockId, height)) {
+    return false;
+  }
+
+  const RawBlockEntry& rawBlock = m_rawBlocks[height];
+  entry.block = rawBlock.block;
+  entry.txs = rawBlock.transactions;
+  return true;
+}
+
 bool Blockchain::getBlockHeight(const Crypto::Hash& blockId, uint32_t& blockHeight) {
   std::lock_guard<decltype(m_blockchain_lock)> lock(m_blockchain_lock);
   return m_blockIndex.getBlockHeight(blockId, blockHeight);
@@ -1268,22 +1329,20 @@ bool Blockchain::getBlocks(uint32_t start_offset, uint32_t count, std::list<Bloc
 bool Blockchain::handleGetObjects(NOTIFY_REQUEST_GET_OBJECTS::request& arg, NOTIFY_RESPONSE_GET_OBJECTS::request& rsp) { //Deprecated. Should be removed with CryptoNoteProtocolHandler.
   std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   rsp.current_blockchain_height = getCurrentBlockchainHeight();
-  std::list<Block> blocks;
-  getBlocks(arg.blocks, blocks, rsp.missed_ids);
-
-  for (const auto& bl : blocks) {
-    std::list<Crypto::Hash> missed_tx_id;
-    std::list<Transaction> txs;
-    getTransactions(bl.transactionHashes, txs, rsp.missed_ids);
-    if (!(!missed_tx_id.size())) { logger(ERROR, BRIGHT_RED) << "Internal error: have missed missed_tx_id.size()=" << missed_tx_id.size() << ENDL << "for block id = " << get_block_hash(bl); return false; } //WTF???
+
+  for (const auto& blockId : arg.blocks) {
+    uint32_t height = 0;
+    if (!m_blockIndex.getBlockHeight(blockId, height)) {
+      rsp.missed_ids.push_back(blockId);
+      continue;
+    }
+
+    //blocks and transactions are served as stored, without reserialization
+    const RawBlockEntry& rawBlock = m_rawBlocks[height];
     rsp.blocks.push_back(block_complete_entry());
     block_complete_entry& e = rsp.blocks.back();
-    //pack block
-    e.block = asString(toBinaryArray(bl));
-    //pack transactions
-    for (Transaction& tx : txs) {
-      e.txs.push_back(asString(toBinaryArray(tx)));
-    }
+    e.block = rawBlock.block;
+    e.txs = rawBlock.transactions;
   }
 
   //get another transactions, if need
@@ -1297,6 +1356,33 @@ bool Blockchain::handleGetObjects(NOTIFY_REQUEST_GET_OBJECTS::request& arg, NOTI
   return true;
 }
 
+bool Blockchain::handleGetBlocksByRange(const NOTIFY_REQUEST_BLOCKS_BY_RANGE::request& arg, NOTIFY_RESPONSE_BLOCKS_BY_RANGE::request& rsp) {
+  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  rsp.start_height = arg.start_height;
+  rsp.current_blockchain_height = getCurrentBlockchainHeight();
+  rsp.blocks.clear();
+
+  rsp.anchor_found = arg.start_height != 0 && arg.start_height <= m_blocks.size() &&
+    m_blockIndex.getBlockId(arg.start_height - 1) == arg.anchor_id;
+  if (!rsp.anchor_found) {
+    return true;
+  }
+
+  uint32_t count = std::min(arg.count, static_cast<uint32_t>(BLOCKS_SYNCHRONIZING_DEFAULT_COUNT));
+  uint32_t end = std::min(arg.start_height + count, static_cast<uint32_t>(m_blocks.size()));
+
+  // same layout as std::vector<block_complete_entry>, straight from the stored blobs
+  BinaryArray packed;
+  BinaryEncoder encoder(packed);
+  encoder.writeVarint(end - arg.start_height);
+  for (uint32_t height = arg.start_height; height < end; ++height) {
+    encode(encoder, m_rawBlocks[height]);
+  }
+
+  rsp.blocks = asString(packed);
+  return true;
+}
+
 bool Blockchain::getAlternativeBlocks(std::list<Block>& blocks) {
   std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   for (auto& alt_bl : m_alternative_chains) {
@@ -1313,10 +1399,11 @@ uint32_t Blockchain::getAlternativeBlocksCount() {
 
 bool Blockchain::add_out_to_get_random_outs(std::vector<std::pair<TransactionIndex, uint16_t>>& amount_outs, COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount& result_outs, uint64_t amount, size_t i) {
   std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
-  const Transaction& tx = transactionByIndex(amount_outs[i].first).tx;
+  const CachedTransaction& transaction = transactionByIndex(amount_outs[i].first).tx;
+  const Transaction& tx = transaction.getTransaction();
   if (!(tx.outputs.size() > amount_outs[i].second)) {
     logger(ERROR, BRIGHT_RED) << "internal error: in global outs index, transaction out index="
-      << amount_outs[i].second << " more than transaction outputs = " << tx.outputs.size() << ", for tx id = " << getObjectHash(tx); return false;
+      << amount_outs[i].second << " more than transaction outputs = " << tx.outputs.size() << ", for tx id = " << transaction.getTransactionHash(); return false;
   }
   if (!(tx.outputs[amount_outs[i].second].target.type() == typeid(KeyOutput))) { logger(ERROR, BRIGHT_RED) << "unknown tx out type"; return false; }
 
@@ -1438,7 +1525,7 @@ void Blockchain::print_blockchain_outs(const std::string& file) {
     if (!vals.empty()) {
       ss << "amount: " << v.first << ENDL;
       for (size_t i = 0; i != vals.size(); i++) {
-        ss << "\t" << getObjectHash(transactionByIndex(vals[i].first).tx) << ": " << vals[i].second << ENDL;
+        ss << "\t" << transactionByIndex(vals[i].first).tx.getTransactionHash() << ": " << vals[i].second << ENDL;
       }
     }
   }
@@ -1511,7 +1598,7 @@ bool Blockchain::get_out_by_msig_gindex(uint64_t amount, uint64_t gindex, Multis
   }
 
   auto msigUsage = it->second[gindex];
-  auto& targetOut = transactionByIndex(msigUsage.transactionIndex).tx.outputs[msigUsage.outputIndex].target;
+  auto& targetOut = transactionByIndex(msigUsage.transactionIndex).tx.getTransaction().outputs[msigUsage.outputIndex].target;
   if (targetOut.type() != typeid(MultisignatureOutput)) {
     return false;
   }
@@ -1522,7 +1609,7 @@ bool Blockchain::get_out_by_msig_gindex(uint64_t amount, uint64_t gindex, Multis
 
 
 
-bool Blockchain::checkTransactionInputs(const Transaction& tx, uint32_t& max_used_block_height, Crypto::Hash& max_used_block_id, BlockInfo* tail) {
+bool Blockchain::checkTransactionInputs(const CachedTransaction& tx, uint32_t& max_used_block_height, Crypto::Hash& max_used_block_id, BlockInfo* tail) {
   std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
 
   if (tail)
@@ -1547,23 +1634,23 @@ bool Blockchain::haveTransactionKeyImagesAsSpent(const Transaction &tx) {
   return false;
 }
 
-bool Blockchain::checkTransactionInputs(const Transaction& tx, uint32_t* pmax_used_block_height) {
-  Crypto::Hash tx_prefix_hash = getObjectHash(*static_cast<const TransactionPrefix*>(&tx));
-  return checkTransactionInputs(tx, tx_prefix_hash, pmax_used_block_height);
-}
+bool Blockchain::checkTransactionInputs(const CachedTransaction& transaction, uint32_t* pmax_used_block_height) {
+  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Common::MonotonicArena::Scope scratchScope(m_scratchArena);
 
-bool Blockchain::checkTransactionInputs(const Transaction& tx, const Crypto::Hash& tx_prefix_hash, uint32_t* pmax_used_block_height) {
   size_t inputIndex = 0;
   if (pmax_used_block_height) {
     *pmax_used_block_height = 0;
   }
 
-  Crypto::Hash transactionHash = getObjectHash(tx);
+  const Transaction& tx = transaction.getTransaction();
+  const Crypto::Hash& tx_prefix_hash = transaction.getTransactionPrefixHash();
+  const Crypto::Hash& transactionHash = transaction.getTransactionHash();
   for (const auto& txin : tx.inputs) {
     assert(inputIndex < tx.signatures.size());
     if (txin.type() == typeid(KeyInput)) {
       const KeyInput& in_to_key = boost::get<KeyInput>(txin);
-      if (!(!in_to_key.outputIndexes.empty())) { logger(ERROR, BRIGHT_RED) << "empty in_to_key.outputIndexes in transaction with id " << getObjectHash(tx); return false; }
+      if (!(!in_to_key.outputIndexes.empty())) { logger(ERROR, BRIGHT_RED) << "empty in_to_key.outputIndexes in transaction with id " << transactionHash; return false; }
 
       if (have_tx_keyimg_as_spent(in_to_key.keyImage)) {
         logger(DEBUGGING) <<
@@ -1617,10 +1704,10 @@ bool Blockchain::check_tx_input(const KeyInput& txin, const Crypto::Hash& tx_pre
   std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
 
   struct outputs_visitor {
-    std::vector<const Crypto::PublicKey *>& m_results_collector;
+    Common::ArenaVector<const Crypto::PublicKey *>& m_results_collector;
     Blockchain& m_bch;
     LoggerRef logger;
-    outputs_visitor(std::vector<const Crypto::PublicKey *>& results_collector, Blockchain& bch, ILogger& logger) :m_results_collector(results_collector), m_bch(bch), logger(logger, "outputs_visitor") {
+    outputs_visitor(Common::ArenaVector<const Crypto::PublicKey *>& results_collector, Blockchain& bch, ILogger& logger) :m_results_collector(results_collector), m_bch(bch), logger(logger, "outputs_visitor") {
     }
 
     bool handle_output(const Transaction& tx, const TransactionOutput& out, size_t transactionOutputIndex) {
@@ -1643,7 +1730,8 @@ bool Blockchain::check_tx_input(const KeyInput& txin, const Crypto::Hash& tx_pre
   };
 
   //check ring signature
-  std::vector<const Crypto::PublicKey *> output_keys;
+  Common::ArenaVector<const Crypto::PublicKey *> output_keys{ Common::ArenaAllocator<const Crypto::PublicKey *>(m_scratchArena) };
+  output_keys.reserve(txin.outputIndexes.size());
   outputs_visitor vi(output_keys, *this, logger.getLogger());
   if (!scanOutputKeysForIndexes(txin, vi, pmax_related_block_height)) {
     logger(INFO, BRIGHT_WHITE) <<
@@ -1669,7 +1757,7 @@ bool Blockchain::check_tx_input(const KeyInput& txin, const Crypto::Hash& tx_pre
     return false;
   }
 
-  return Crypto::check_ring_signature(tx_prefix_hash, txin.keyImage, output_keys, sig.data());
+  return Crypto::check_ring_signature(tx_prefix_hash, txin.keyImage, output_keys.data(), output_keys.size(), sig.data());
 }
 
 uint64_t Blockchain::get_adjusted_time() {
@@ -1678,7 +1766,7 @@ uint64_t Blockchain::get_adjusted_time() {
 }
 
 bool Blockchain::check_tx_outputs(const Transaction& tx) const {
-  for (TransactionOutput out : tx.outputs) {
+  for (const TransactionOutput& out : tx.outputs) {
     if (out.target.type() == typeid(MultisignatureOutput)) {
       if (tx.version < TRANSACTION_VERSION_2) {
         logger(INFO, BRIGHT_WHITE) << getObjectHash(tx) << " contains multisignature output but have verion " << tx.version;
@@ -1842,7 +1930,7 @@ const Blockchain::TransactionEntry& Blockchain::transactionByIndex(TransactionIn
 bool Blockchain::pushBlock(const Block& blockData, block_verification_context& bvc, uint32_t height) {
 
 	
-  std::vector<Transaction> transactions;
+  std::vector<CachedTransaction> transactions;
   if (!loadTransactions(blockData, transactions, height)) {
     bvc.m_verifivation_failed = true;
     return false;
@@ -1856,10 +1944,20 @@ bool Blockchain::pushBlock(const Block& blockData, block_verification_context& b
   return true;
 }
 
-bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction>& transactions, block_verification_context& bvc) {
+bool Blockchain::pushBlock(const Block& blockData, const std::vector<CachedTransaction>& transactions, block_verification_context& bvc) {
+  static Common::MetricHistogram& processingTime = Common::Metrics::histogram("ultranote_block_processing_seconds",
+    "Time to validate and store a block on top of the main chain, rejected blocks included", Common::Metrics::latencyBuckets());
+  static Common::MetricHistogram& powTime = Common::Metrics::histogram("ultranote_block_pow_check_seconds",
+    "Time to check the proof of work of a block", Common::Metrics::latencyBuckets());
+  static Common::MetricHistogram& inputsTime = Common::Metrics::histogram("ultranote_block_inputs_verification_seconds",
+    "Time to verify the transactions of a block", Common::Metrics::latencyBuckets());
+  static Common::MetricCounter& blocksAdded = Common::Metrics::counter("ultranote_blocks_added_total", "Blocks added to the main chain");
+
   std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Common::MonotonicArena::Scope scratchScope(m_scratchArena);
 
   auto blockProcessingStart = std::chrono::steady_clock::now();
+  Common::MetricTimer processingTimer(processingTime);
 
   Crypto::Hash blockHash = get_block_hash(blockData);
 
@@ -1900,6 +1998,8 @@ bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction
 
 
   auto longhashTimeStart = std::chrono::steady_clock::now();
+  TraceSpan powSpan(TraceEvent::BLOCK_POW_CHECKED, blockHash);
+  Common::MetricTimer powTimer(powTime);
   Crypto::Hash proof_of_work = NULL_HASH;
   if (m_checkpoints.is_in_checkpoint_zone(getCurrentBlockchainHeight())) {
     if (!m_checkpoints.check_block(getCurrentBlockchainHeight(), blockHash)) {
@@ -1918,6 +2018,8 @@ bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction
   }
 
   auto longhash_calculating_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - longhashTimeStart).count();
+  powSpan.finish();
+  powTimer.finish();
 
   if (!prevalidate_miner_transaction(blockData, static_cast<uint32_t>(m_blocks.size()))) {
     logger(INFO, BRIGHT_WHITE) <<
@@ -1926,33 +2028,38 @@ bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction
     return false;
   }
 
-  Crypto::Hash minerTransactionHash = getObjectHash(blockData.baseTransaction);
-
   BlockEntry block;
   block.bl = blockData;
   block.height = static_cast<uint32_t>(m_blocks.size());
+  RawBlockEntry rawBlock;
+  rawBlock.block = asString(toBinaryArray(blockData));
+  rawBlock.transactions.reserve(transactions.size());
+  block.transactions.reserve(transactions.size() + 1);
   block.transactions.resize(1);
-  block.transactions[0].tx = blockData.baseTransaction;
+  block.transactions[0].tx = CachedTransaction(blockData.baseTransaction);
   TransactionIndex transactionIndex = { block.height, static_cast<uint16_t>(0) };
-  pushTransaction(block, minerTransactionHash, transactionIndex);
+  pushTransaction(block, transactionIndex);
 
-  size_t coinbase_blob_size = getObjectBinarySize(blockData.baseTransaction);
+  size_t coinbase_blob_size = block.transactions[0].tx.getTransactionBinarySize();
   size_t cumulative_block_size = coinbase_blob_size;
   uint64_t fee_summary = 0;
   uint64_t interestSummary = 0;
+  TraceSpan inputsSpan(TraceEvent::BLOCK_INPUTS_VERIFIED, blockHash);
+  Common::MetricTimer inputsTimer(inputsTime);
   for (size_t i = 0; i < transactions.size(); ++i) {
     const Crypto::Hash& tx_id = blockData.transactionHashes[i];
+    const Transaction& transaction = transactions[i].getTransaction();
     block.transactions.resize(block.transactions.size() + 1);
     block.transactions.back().tx = transactions[i];
-    size_t blob_size = toBinaryArray(transactions[i]).size();
-	uint64_t in_amount = m_currency.getTransactionAllInputsAmount(transactions[i], block.height);
-	uint64_t out_amount = getOutputAmount(transactions[i]);
+    size_t blob_size = transactions[i].getTransactionBinarySize();
+	uint64_t in_amount = m_currency.getTransactionAllInputsAmount(transaction, block.height);
+	uint64_t out_amount = getOutputAmount(transaction);
     uint64_t fee =  in_amount < out_amount ? CryptoNote::parameters::MINIMUM_FEE : in_amount - out_amount;
 
     bool isTransactionValid = true;
-    if (block.bl.majorVersion == BLOCK_MAJOR_VERSION_1 && transactions[i].version > TRANSACTION_VERSION_1) {
+    if (block.bl.majorVersion == BLOCK_MAJOR_VERSION_1 && transaction.version > TRANSACTION_VERSION_1) {
       isTransactionValid = false;
-      logger(INFO, BRIGHT_WHITE) << "Block " << blockHash << " can't contain transaction " << tx_id << " because it has invalid version " << transactions[i].version;
+      logger(INFO, BRIGHT_WHITE) << "Block " << blockHash << " can't contain transaction " << tx_id << " because it has invalid version " << transaction.version;
     }
 
     if (!checkTransactionInputs(transactions[i])) {
@@ -1960,7 +2067,7 @@ bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction
       logger(INFO, BRIGHT_WHITE) << "Block " << blockHash << " has at least one transaction with wrong inputs: " << tx_id;
     }
 
-    if (!check_tx_outputs(transactions[i])) {
+    if (!check_tx_outputs(transaction)) {
       isTransactionValid = false;
       logger(INFO, BRIGHT_WHITE) << "Transaction " << tx_id << " has at least one invalid output";
     }
@@ -1970,18 +2077,26 @@ bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction
       bvc.m_verifivation_failed = true;
 
       block.transactions.pop_back();
-      popTransactions(block, minerTransactionHash);
+      popTransactions(block);
       return false;
     }
 
     ++transactionIndex.transaction;
-    pushTransaction(block, tx_id, transactionIndex);
+    pushTransaction(block, transactionIndex);
+    if (transactions[i].hasTransactionBinaryArray()) {
+      rawBlock.transactions.push_back(asString(transactions[i].getTransactionBinaryArray()));
+    } else {
+      rawBlock.transactions.push_back(asString(toBinaryArray(transaction)));
+    }
 
     cumulative_block_size += blob_size;
     fee_summary += fee;
-    interestSummary += m_currency.calculateTotalTransactionInterest(transactions[i], block.height);
+    interestSummary += m_currency.calculateTotalTransactionInterest(transaction, block.height);
   }
 
+  inputsSpan.finish();
+  inputsTimer.finish();
+
   if (!checkCumulativeBlockSize(blockHash, cumulative_block_size, block.height)) {
     bvc.m_verifivation_failed = true;
     return false;
@@ -1993,7 +2108,7 @@ bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction
   if (!validate_miner_transaction(blockData, block.height, cumulative_block_size, already_generated_coins, fee_summary, reward, emissionChange)) {
     logger(INFO, BRIGHT_WHITE) << "Block " << blockHash << " has invalid miner transaction";
     bvc.m_verifivation_failed = true;
-    popTransactions(block, minerTransactionHash);
+    popTransactions(block);
     return false;
   }
 
@@ -2005,8 +2120,10 @@ bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction
     block.cumulative_difficulty += m_blocks.back().cumulative_difficulty;
   }
 
-  pushBlock(block);
+  TraceSpan commitSpan(TraceEvent::BLOCK_COMMITTED, blockHash);
+  pushBlock(block, rawBlock);
   pushToDepositIndex(block, interestSummary);
+  commitSpan.finish();
 
   auto block_processing_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - blockProcessingStart).count();
 
@@ -2019,6 +2136,7 @@ bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction
     << ", " << block_processing_time << "(" << target_calculating_time << "/" << longhash_calculating_time << ")ms";
 
   bvc.m_added_to_main_chain = true;
+  blocksAdded.inc();
 
   m_upgradeDetectorV2.blockPushed();
   m_upgradeDetectorV3.blockPushed();
@@ -2050,7 +2168,7 @@ uint64_t Blockchain::depositInterestAtHeight(size_t height) const {
 void Blockchain::pushToDepositIndex(const BlockEntry& block, uint64_t interest) {
   int64_t deposit = 0;
   for (const auto& tx : block.transactions) {
-    for (const auto& in : tx.tx.inputs) {
+    for (const auto& in : tx.tx.getTransaction().inputs) {
       if (in.type() == typeid(MultisignatureInput)) {
         auto& multisign = boost::get<MultisignatureInput>(in);
         if (multisign.term > 0) {
@@ -2058,7 +2176,7 @@ void Blockchain::pushToDepositIndex(const BlockEntry& block, uint64_t interest)
         }
       }
     }
-    for (const auto& out : tx.tx.outputs) {
+    for (const auto& out : tx.tx.getTransaction().outputs) {
       if (out.target.type() == typeid(MultisignatureOutput)) {
         auto& multisign = boost::get<MultisignatureOutput>(out.target);
         if (multisign.term > 0) {
@@ -2070,10 +2188,11 @@ void Blockchain::pushToDepositIndex(const BlockEntry& block, uint64_t interest)
   m_depositIndex.pushBlock(deposit, interest);
 }
 
-bool Blockchain::pushBlock(BlockEntry& block) {
+bool Blockchain::pushBlock(BlockEntry& block, const RawBlockEntry& rawBlock) {
   Crypto::Hash blockHash = get_block_hash(block.bl);
 
   m_blocks.push_back(block);
+  m_rawBlocks.push_back(rawBlock);
   m_blockIndex.push(blockHash);
 
   m_timestampIndex.add(block.bl.timestamp, blockHash);
@@ -2091,7 +2210,7 @@ void Blockchain::popBlock(const Crypto::Hash& blockHash) {
     return;
   }
 
-  std::vector<Transaction> transactions(m_blocks.back().transactions.size() - 1);
+  std::vector<CachedTransaction> transactions(m_blocks.back().transactions.size() - 1);
   for (size_t i = 0; i < m_blocks.back().transactions.size() - 1; ++i) {
     transactions[i] = m_blocks.back().transactions[1 + i].tx;
   }
@@ -2099,22 +2218,34 @@ void Blockchain::popBlock(const Crypto::Hash& blockHash) {
   uint32_t height = static_cast<uint32_t>(m_blocks.size()); //height of popped block should be same as number of blocks  
   saveTransactions(transactions, height);
 
-  popTransactions(m_blocks.back(), getObjectHash(m_blocks.back().bl.baseTransaction));
+  std::vector<Crypto::Hash> transactionHashes;
+  transactionHashes.reserve(m_blocks.back().bl.transactionHashes.size() + 1);
+  transactionHashes.push_back(m_blocks.back().transactions[0].tx.getTransactionHash());
+  transactionHashes.insert(transactionHashes.end(), m_blocks.back().bl.transactionHashes.begin(), m_blocks.back().bl.transactionHashes.end());
+
+  popTransactions(m_blocks.back());
 
   m_timestampIndex.remove(m_blocks.back().bl.timestamp, blockHash);
   m_generatedTransactionsIndex.remove(m_blocks.back().bl);
 
   m_depositIndex.popBlock();
   m_blocks.pop_back();
+  m_rawBlocks.pop_back();
   m_blockIndex.pop();
 
   assert(m_blockIndex.size() == m_blocks.size());
 
   m_upgradeDetectorV2.blockPopped();
   m_upgradeDetectorV3.blockPopped();
+
+  m_observerManager.notify(&IBlockchainStorageObserver::blockPopped, blockHash, transactionHashes);
 }
 
-bool Blockchain::pushTransaction(BlockEntry& block, const Crypto::Hash& transactionHash, TransactionIndex transactionIndex) {
+bool Blockchain::pushTransaction(BlockEntry& block, TransactionIndex transactionIndex) {
+  TransactionEntry& transaction = block.transactions[transactionIndex.transaction];
+  const Transaction& tx = transaction.tx.getTransaction();
+  const Crypto::Hash& transactionHash = transaction.tx.getTransactionHash();
+
   auto result = m_transactionMap.insert(std::make_pair(transactionHash, transactionIndex));
   if (!result.second) {
     logger(ERROR, BRIGHT_RED) <<
@@ -2122,23 +2253,21 @@ bool Blockchain::pushTransaction(BlockEntry& block, const Crypto::Hash& transact
     return false;
   }
 
-  TransactionEntry& transaction = block.transactions[transactionIndex.transaction];
-
-  if (!checkMultisignatureInputsDiff(transaction.tx)) {
+  if (!checkMultisignatureInputsDiff(tx)) {
     logger(ERROR, BRIGHT_RED) <<
       "Double spending transaction was pushed to blockchain.";
     m_transactionMap.erase(transactionHash);
     return false;
   }
 
-  for (size_t i = 0; i < transaction.tx.inputs.size(); ++i) {
-    if (transaction.tx.inputs[i].type() == typeid(KeyInput)) {
-      auto result = m_spent_keys.insert(::boost::get<KeyInput>(transaction.tx.inputs[i]).keyImage);
+  for (size_t i = 0; i < tx.inputs.size(); ++i) {
+    if (tx.inputs[i].type() == typeid(KeyInput)) {
+      auto result = m_spent_keys.insert(::boost::get<KeyInput>(tx.inputs[i]).keyImage);
       if (!result.second) {
         logger(ERROR, BRIGHT_RED) <<
           "Double spending transaction was pushed to blockchain.";
         for (size_t j = 0; j < i; ++j) {
-          m_spent_keys.erase(::boost::get<KeyInput>(transaction.tx.inputs[i - 1 - j]).keyImage);
+          m_spent_keys.erase(::boost::get<KeyInput>(tx.inputs[i - 1 - j]).keyImage);
         }
 
         m_transactionMap.erase(transactionHash);
@@ -2147,7 +2276,7 @@ bool Blockchain::pushTransaction(BlockEntry& block, const Crypto::Hash& transact
     }
   }
 
-  for (const auto& inv : transaction.tx.inputs) {
+  for (const auto& inv : tx.inputs) {
     if (inv.type() == typeid(MultisignatureInput)) {
       const MultisignatureInput& in = ::boost::get<MultisignatureInput>(inv);
       auto& amountOutputs = m_multisignatureOutputs[in.amount];
@@ -2155,26 +2284,28 @@ bool Blockchain::pushTransaction(BlockEntry& block, const Crypto::Hash& transact
     }
   }
 
-  transaction.m_global_output_indexes.resize(transaction.tx.outputs.size());
-  for (uint16_t output = 0; output < transaction.tx.outputs.size(); ++output) {
-    if (transaction.tx.outputs[output].target.type() == typeid(KeyOutput)) {
-      auto& amountOutputs = m_outputs[transaction.tx.outputs[output].amount];
+  transaction.m_global_output_indexes.resize(tx.outputs.size());
+  for (uint16_t output = 0; output < tx.outputs.size(); ++output) {
+    if (tx.outputs[output].target.type() == typeid(KeyOutput)) {
+      auto& amountOutputs = m_outputs[tx.outputs[output].amount];
       transaction.m_global_output_indexes[output] = static_cast<uint32_t>(amountOutputs.size());
       amountOutputs.push_back(std::make_pair<>(transactionIndex, output));
-    } else if (transaction.tx.outputs[output].target.type() == typeid(MultisignatureOutput)) {
-      auto& amountOutputs = m_multisignatureOutputs[transaction.tx.outputs[output].amount];
+    } else if (tx.outputs[output].target.type() == typeid(MultisignatureOutput)) {
+      auto& amountOutputs = m_multisignatureOutputs[tx.outputs[output].amount];
       transaction.m_global_output_indexes[output] = static_cast<uint32_t>(amountOutputs.size());
       MultisignatureOutputUsage outputUsage = { transactionIndex, output, false };
       amountOutputs.push_back(outputUsage);
     }
   }
 
-  m_paymentIdIndex.add(transaction.tx);
+  m_paymentIdIndex.add(tx);
 
   return true;
 }
 
-void Blockchain::popTransaction(const Transaction& transaction, const Crypto::Hash& transactionHash) {
+void Blockchain::popTransaction(const CachedTransaction& cachedTransaction) {
+  const Transaction& transaction = cachedTransaction.getTransaction();
+  const Crypto::Hash& transactionHash = cachedTransaction.getTransactionHash();
   TransactionIndex transactionIndex = m_transactionMap.at(transactionHash);
   for (size_t outputIndex = 0; outputIndex < transaction.outputs.size(); ++outputIndex) {
     const TransactionOutput& output = transaction.outputs[transaction.outputs.size() - 1 - outputIndex];
@@ -2275,12 +2406,10 @@ void Blockchain::popTransaction(const Transaction& transaction, const Crypto::Ha
   }
 }
 
-void Blockchain::popTransactions(const BlockEntry& block, const Crypto::Hash& minerTransactionHash) {
-  for (size_t i = 0; i < block.transactions.size() - 1; ++i) {
-    popTransaction(block.transactions[block.transactions.size() - 1 - i].tx, block.bl.transactionHashes[block.transactions.size() - 2 - i]);
+void Blockchain::popTransactions(const BlockEntry& block) {
+  for (size_t i = 0; i < block.transactions.size(); ++i) {
+    popTransaction(block.transactions[block.transactions.size() - 1 - i].tx);
   }
-
-  popTransaction(block.bl.baseTransaction, minerTransactionHash);
 }
 
 bool Blockchain::validateInput(const MultisignatureInput& input, const Crypto::Hash& transactionHash, const Crypto::Hash& transactionPrefixHash, const std::vector<Crypto::Signature>& transactionSignatures) {
@@ -2305,7 +2434,7 @@ bool Blockchain::validateInput(const MultisignatureInput& input, const Crypto::H
     return false;
   }
 
-  const Transaction& outputTransaction = m_blocks[outputIndex.transactionIndex.block].transactions[outputIndex.transactionIndex.transaction].tx;
+  const Transaction& outputTransaction = m_blocks[outputIndex.transactionIndex.block].transactions[outputIndex.transactionIndex.transaction].tx.getTransaction();
   if (!is_tx_spendtime_unlocked(outputTransaction.unlockTime)) {
     logger(DEBUGGING) <<
       "Transaction << " << transactionHash << " contains multisignature input which points to a locked transaction.";
@@ -2441,8 +2570,7 @@ bool Blockchain::getMultisigOutputReference(const MultisignatureInput& txInMulti
     return false;
   }
   const MultisignatureOutputUsage& outputIndex = amountIter->second[txInMultisig.outputIndex];
-  const Transaction& outputTransaction = m_blocks[outputIndex.transactionIndex.block].transactions[outputIndex.transactionIndex.transaction].tx;
-  outputReference.first = getObjectHash(outputTransaction);
+  outputReference.first = m_blocks[outputIndex.transactionIndex.block].transactions[outputIndex.transactionIndex.transaction].tx.getTransactionHash();
   outputReference.second = outputIndex.outputIndex;
   return true;
 }
@@ -2486,7 +2614,7 @@ bool Blockchain::loadBlockchainIndices() {
       m_generatedTransactionsIndex.add(block.bl);
       for (uint16_t t = 0; t < block.transactions.size(); ++t) {
         const TransactionEntry& transaction = block.transactions[t];
-        m_paymentIdIndex.add(transaction.tx);
+        m_paymentIdIndex.add(transaction.tx.getTransaction());
       }
     }
 
@@ -2516,15 +2644,14 @@ bool Blockchain::getTransactionIdsByPaymentId(const Crypto::Hash& paymentId, std
   return m_paymentIdIndex.find(paymentId, transactionHashes);
 }
 
-bool Blockchain::loadTransactions(const Block& block, std::vector<Transaction>& transactions, uint32_t height) {	
+bool Blockchain::loadTransactions(const Block& block, std::vector<CachedTransaction>& transactions, uint32_t height) {	
   transactions.resize(block.transactionHashes.size());
-  size_t transactionSize;
   uint64_t fee;
   for (size_t i = 0; i < block.transactionHashes.size(); ++i) {
-    if (!m_tx_pool.take_tx(block.transactionHashes[i], transactions[i], transactionSize, fee)) {		
+    if (!m_tx_pool.take_tx(block.transactionHashes[i], transactions[i], fee)) {		
       tx_verification_context context;
       for (size_t j = 0; j < i; ++j) {
-        if (!m_tx_pool.add_tx(transactions[i - 1 - j], context, true, height)
+        if (!m_tx_pool.add_tx(std::move(transactions[i - 1 - j]), context, true, height)
 		) {
           throw std::runtime_error("Blockchain::loadTransactions, failed to add transaction to pool");
         }
@@ -2536,10 +2663,10 @@ bool Blockchain::loadTransactions(const Block& block, std::vector<Transaction>&
   return true;
 }
 
-void Blockchain::saveTransactions(const std::vector<Transaction>& transactions, uint32_t height) {
+void Blockchain::saveTransactions(const std::vector<CachedTransaction>& transactions, uint32_t height) {
   tx_verification_context context;
   for (size_t i = 0; i < transactions.size(); ++i) {
-    if (!m_tx_pool.add_tx(transactions[transactions.size() - 1 - i], context, true, height)) {
+    if (!m_tx_pool.add_tx(CachedTransaction(transactions[transactions.size() - 1 - i]), context, true, height)) {
       throw std::runtime_error("Blockchain::saveTransactions, failed to add transaction to pool");
     }
   }
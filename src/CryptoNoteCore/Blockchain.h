@@ -12,9 +12,11 @@
 #include "google/sparse_hash_set"
 #include "google/sparse_hash_map"
 
+#include "Common/MonotonicArena.h"
 #include "Common/ObserverManager.h"
 #include "Common/Util.h"
 #include "CryptoNoteCore/BlockIndex.h"
+#include "CryptoNoteCore/CachedTransaction.h"
 #include "CryptoNoteCore/Checkpoints.h"
 #include "CryptoNoteCore/Currency.h"
 #include "CryptoNoteCore/DepositIndex.h"
@@ -35,8 +37,11 @@
 #undef ERROR
 
 namespace CryptoNote {
+  struct block_complete_entry;
   struct NOTIFY_REQUEST_GET_OBJECTS_request;
   struct NOTIFY_RESPONSE_GET_OBJECTS_request;
+  struct NOTIFY_REQUEST_BLOCKS_BY_RANGE_request;
+  struct NOTIFY_RESPONSE_BLOCKS_BY_RANGE_request;
   struct COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS_request;
   struct COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS_response;
   struct COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS_outs_for_amount;
@@ -51,8 +56,8 @@ namespace CryptoNote {
     bool removeObserver(IBlockchainStorageObserver* observer);
 
     // ITransactionValidator
-    virtual bool checkTransactionInputs(const CryptoNote::Transaction& tx, BlockInfo& maxUsedBlock) override;
-    virtual bool checkTransactionInputs(const CryptoNote::Transaction& tx, BlockInfo& maxUsedBlock, BlockInfo& lastFailed) override;
+    virtual bool checkTransactionInputs(const CryptoNote::CachedTransaction& tx, BlockInfo& maxUsedBlock) override;
+    virtual bool checkTransactionInputs(const CryptoNote::CachedTransaction& tx, BlockInfo& maxUsedBlock, BlockInfo& lastFailed) override;
     virtual bool haveSpentKeyImages(const CryptoNote::Transaction& tx) override;
     virtual bool checkTransactionSize(size_t blobSize) override;
 
@@ -70,6 +75,7 @@ namespace CryptoNote {
     uint32_t getAlternativeBlocksCount();
     Crypto::Hash getBlockIdByHeight(uint32_t height);
     bool getBlockByHash(const Crypto::Hash &h, Block &blk);
+    bool getRawBlock(const Crypto::Hash& blockId, block_complete_entry& entry);
     bool getBlockHeight(const Crypto::Hash& blockId, uint32_t& blockHeight);
 
     template<class archive_t> void serialize(archive_t & ar, const unsigned int version);
@@ -94,11 +100,12 @@ namespace CryptoNote {
     std::vector<Crypto::Hash> findBlockchainSupplement(const std::vector<Crypto::Hash>& remoteBlockIds, size_t maxCount,
       uint32_t& totalBlockCount, uint32_t& startBlockIndex);
     bool handleGetObjects(NOTIFY_REQUEST_GET_OBJECTS_request& arg, NOTIFY_RESPONSE_GET_OBJECTS_request& rsp); //Deprecated. Should be removed with CryptoNoteProtocolHandler.
+    bool handleGetBlocksByRange(const NOTIFY_REQUEST_BLOCKS_BY_RANGE_request& arg, NOTIFY_RESPONSE_BLOCKS_BY_RANGE_request& rsp);
     bool getRandomOutsByAmount(const COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS_request& req, COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS_response& res);
     bool getBackwardBlocksSize(size_t from_height, std::vector<size_t>& sz, size_t count);
     bool getTransactionOutputGlobalIndexes(const Crypto::Hash& tx_id, std::vector<uint32_t>& indexs);
     bool get_out_by_msig_gindex(uint64_t amount, uint64_t gindex, MultisignatureOutput& out);
-    bool checkTransactionInputs(const Transaction& tx, uint32_t& pmax_used_block_height, Crypto::Hash& max_used_block_id, BlockInfo* tail = 0);
+    bool checkTransactionInputs(const CachedTransaction& tx, uint32_t& pmax_used_block_height, Crypto::Hash& max_used_block_id, BlockInfo* tail = 0);
     uint64_t getCurrentCumulativeBlocksizeLimit();
     uint64_t blockDifficulty(size_t i);
     uint64_t getBlockTimestamp(uint32_t height);
@@ -150,7 +157,7 @@ namespace CryptoNote {
         if (it == m_transactionMap.end()) {
           missed_txs.push_back(tx_id);
         } else {
-          txs.push_back(transactionByIndex(it->second).tx);
+          txs.push_back(transactionByIndex(it->second).tx.getTransaction());
         }
       }
     }
@@ -201,13 +208,45 @@ namespace CryptoNote {
     };
 
     struct TransactionEntry {
-      Transaction tx;
+      CachedTransaction tx;
       std::vector<uint32_t> m_global_output_indexes;
 
       void serialize(ISerializer& s) {
         s(tx, "tx");
         s(m_global_output_indexes, "indexes");
       }
+
+      void decode(BinaryDecoder& decoder) {
+        CryptoNote::decode(decoder, tx);
+        CryptoNote::decode(decoder, m_global_output_indexes);
+      }
+
+      void encode(BinaryEncoder& encoder) const {
+        CryptoNote::encode(encoder, tx);
+        CryptoNote::encode(encoder, m_global_output_indexes);
+      }
+    };
+
+    // Canonical blobs of a main chain block and its non-coinbase transactions,
+    // kept alongside m_blocks so that peers and RPC clients can be served without reserialization
+    struct RawBlockEntry {
+      std::string block;
+      std::vector<std::string> transactions;
+
+      void serialize(ISerializer& s) {
+        s(block, "block");
+        s(transactions, "transactions");
+      }
+
+      void decode(BinaryDecoder& decoder) {
+        CryptoNote::decode(decoder, block);
+        CryptoNote::decode(decoder, transactions);
+      }
+
+      void encode(BinaryEncoder& encoder) const {
+        CryptoNote::encode(encoder, block);
+        CryptoNote::encode(encoder, transactions);
+      }
     };
 
     struct BlockEntry {
@@ -226,6 +265,24 @@ namespace CryptoNote {
         s(already_generated_coins, "already_generated_coins");
         s(transactions, "transactions");
       }
+
+      void decode(BinaryDecoder& decoder) {
+        CryptoNote::decode(decoder, bl);
+        CryptoNote::decode(decoder, height);
+        CryptoNote::decode(decoder, block_cumulative_size);
+        CryptoNote::decode(decoder, cumulative_difficulty);
+        CryptoNote::decode(decoder, already_generated_coins);
+        CryptoNote::decode(decoder, transactions);
+      }
+
+      void encode(BinaryEncoder& encoder) const {
+        CryptoNote::encode(encoder, bl);
+        CryptoNote::encode(encoder, height);
+        CryptoNote::encode(encoder, block_cumulative_size);
+        CryptoNote::encode(encoder, cumulative_difficulty);
+        CryptoNote::encode(encoder, already_generated_coins);
+        CryptoNote::encode(encoder, transactions);
+      }
     };
 
     typedef google::sparse_hash_set<Crypto::KeyImage> key_images_container;
@@ -237,6 +294,8 @@ namespace CryptoNote {
     tx_memory_pool& m_tx_pool;
     mutable std::recursive_mutex m_blockchain_lock; // TODO: add here reader/writer lock
     Crypto::cn_context m_cn_context;
+    // scratch memory of input checks, guarded by m_blockchain_lock; rewound after each checked transaction and pushed block
+    Common::MonotonicArena m_scratchArena;
     Tools::ObserverManager<IBlockchainStorageObserver> m_observerManager;
 
     key_images_container m_spent_keys;
@@ -249,6 +308,7 @@ namespace CryptoNote {
     std::atomic<bool> m_is_in_checkpoint_zone;
 
     typedef SwappedVector<BlockEntry> Blocks;
+    typedef SwappedVector<RawBlockEntry> RawBlocks;
     typedef std::unordered_map<Crypto::Hash, uint32_t> BlockMap;
     typedef std::unordered_map<Crypto::Hash, TransactionIndex> TransactionMap;
     typedef BasicUpgradeDetector<Blocks> UpgradeDetector;
@@ -257,6 +317,7 @@ namespace CryptoNote {
     friend class BlockchainIndicesSerializer;
 
     Blocks m_blocks;
+    RawBlocks m_rawBlocks;
     CryptoNote::BlockIndex m_blockIndex;
     CryptoNote::DepositIndex m_depositIndex;
     TransactionMap m_transactionMap;
@@ -274,6 +335,7 @@ namespace CryptoNote {
     Logging::LoggerRef logger;
 
     void rebuildCache();
+    void syncRawBlocks();
     bool storeCache();
     bool switch_to_alternative_blockchain(std::list<blocks_ext_by_hash::iterator>& alt_chain, bool discard_disconnected_chain);
     bool handle_alternative_block(const Block& b, const Crypto::Hash& id, block_verification_context& bvc, bool sendNewAlternativeBlockMessage = true);
@@ -296,25 +358,24 @@ namespace CryptoNote {
     bool getBlockCumulativeSize(const Block& block, size_t& cumulativeSize);
     bool update_next_comulative_size_limit();
     bool check_tx_input(const KeyInput& txin, const Crypto::Hash& tx_prefix_hash, const std::vector<Crypto::Signature>& sig, uint32_t* pmax_related_block_height = NULL);
-    bool checkTransactionInputs(const Transaction& tx, const Crypto::Hash& tx_prefix_hash, uint32_t* pmax_used_block_height = NULL);
-    bool checkTransactionInputs(const Transaction& tx, uint32_t* pmax_used_block_height = NULL);
+    bool checkTransactionInputs(const CachedTransaction& transaction, uint32_t* pmax_used_block_height = NULL);
     bool check_tx_outputs(const Transaction& tx) const;
     bool have_tx_keyimg_as_spent(const Crypto::KeyImage &key_im);
     const TransactionEntry& transactionByIndex(TransactionIndex index);
     bool pushBlock(const Block& blockData, block_verification_context& bvc, uint32_t height);
-    bool pushBlock(const Block& blockData, const std::vector<Transaction>& transactions, block_verification_context& bvc);
-    bool pushBlock(BlockEntry& block);
+    bool pushBlock(const Block& blockData, const std::vector<CachedTransaction>& transactions, block_verification_context& bvc);
+    bool pushBlock(BlockEntry& block, const RawBlockEntry& rawBlock);
     void popBlock(const Crypto::Hash& blockHash);
-    bool pushTransaction(BlockEntry& block, const Crypto::Hash& transactionHash, TransactionIndex transactionIndex);
-    void popTransaction(const Transaction& transaction, const Crypto::Hash& transactionHash);
-    void popTransactions(const BlockEntry& block, const Crypto::Hash& minerTransactionHash);
+    bool pushTransaction(BlockEntry& block, TransactionIndex transactionIndex);
+    void popTransaction(const CachedTransaction& transaction);
+    void popTransactions(const BlockEntry& block);
     bool validateInput(const MultisignatureInput& input, const Crypto::Hash& transactionHash, const Crypto::Hash& transactionPrefixHash, const std::vector<Crypto::Signature>& transactionSignatures);
 
     bool storeBlockchainIndices();
     bool loadBlockchainIndices();
 
-    bool loadTransactions(const Block& block, std::vector<Transaction>& transactions, uint32_t height);
-    void saveTransactions(const std::vector<Transaction>& transactions, uint32_t height);
+    bool loadTransactions(const Block& block, std::vector<CachedTransaction>& transactions, uint32_t height);
+    void saveTransactions(const std::vector<CachedTransaction>& transactions, uint32_t height);
 
     void sendMessage(const BlockchainMessage& message);
 
@@ -343,10 +404,13 @@ namespace CryptoNote {
     if (it == m_outputs.end() || !tx_in_to_key.outputIndexes.size())
       return false;
 
-    std::vector<uint32_t> absolute_offsets = relative_output_offsets_to_absolute(tx_in_to_key.outputIndexes);
     std::vector<std::pair<TransactionIndex, uint16_t>>& amount_outs_vec = it->second;
     size_t count = 0;
-    for (uint64_t i : absolute_offsets) {
+    // relative offsets are turned into absolute ones as they are scanned, like relative_output_offsets_to_absolute does
+    uint32_t absoluteOffset = 0;
+    for (uint32_t relativeOffset : tx_in_to_key.outputIndexes) {
+      absoluteOffset += relativeOffset;
+      uint64_t i = absoluteOffset;
       if(i >= amount_outs_vec.size() ) {
         logger(Logging::INFO) << "Wrong index in transaction inputs: " << i << ", expected maximum " << amount_outs_vec.size() - 1;
         return false;
@@ -357,20 +421,21 @@ namespace CryptoNote {
 
       const TransactionEntry& tx = transactionByIndex(amount_outs_vec[i].first);
 
-      if (!(amount_outs_vec[i].second < tx.tx.outputs.size())) {
+      const Transaction& transaction = tx.tx.getTransaction();
+      if (!(amount_outs_vec[i].second < transaction.outputs.size())) {
         logger(Logging::ERROR, Logging::BRIGHT_RED)
             << "Wrong index in transaction outputs: "
             << amount_outs_vec[i].second << ", expected less then "
-            << tx.tx.outputs.size();
+            << transaction.outputs.size();
         return false;
       }
 
-      if (!vis.handle_output(tx.tx, tx.tx.outputs[amount_outs_vec[i].second], amount_outs_vec[i].second)) {
+      if (!vis.handle_output(transaction, transaction.outputs[amount_outs_vec[i].second], amount_outs_vec[i].second)) {
         logger(Logging::INFO) << "Failed to handle_output for output no = " << count << ", with absolute offset " << i;
         return false;
       }
 
-      if(count++ == absolute_offsets.size()-1 && pmax_related_block_height) {
+      if(count++ == tx_in_to_key.outputIndexes.size()-1 && pmax_related_block_height) {
         if (*pmax_related_block_height < amount_outs_vec[i].first.block) {
           *pmax_related_block_height = amount_outs_vec[i].first.block;
         }
@@ -0,0 +1,74 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "CachedTransaction.h"
+
+#include <cassert>
+
+#include "crypto/hash.h"
+#include "CryptoNoteSerialization.h"
+#include "Serialization/ISerializer.h"
+#include "TransactionView.h"
+
+namespace CryptoNote {
+
+CachedTransaction::CachedTransaction() : m_transactionHash(NULL_HASH), m_transactionPrefixHash(NULL_HASH), m_transactionBinarySize(0) {
+}
+
+CachedTransaction::CachedTransaction(Transaction&& transaction) : m_transaction(std::move(transaction)) {
+  BinaryEncoder encoder(m_transactionBinaryArray);
+  CryptoNote::encode(encoder, static_cast<const TransactionPrefix&>(m_transaction));
+  m_transactionPrefixHash = Crypto::cn_fast_hash(m_transactionBinaryArray.data(), m_transactionBinaryArray.size());
+  encodeSignatures(encoder, m_transaction);
+  m_transactionHash = Crypto::cn_fast_hash(m_transactionBinaryArray.data(), m_transactionBinaryArray.size());
+  m_transactionBinarySize = m_transactionBinaryArray.size();
+}
+
+CachedTransaction::CachedTransaction(const Transaction& transaction) : CachedTransaction(Transaction(transaction)) {
+}
+
+CachedTransaction::CachedTransaction(const TransactionView& view) :
+  m_transactionHash(view.getHash()),
+  m_transactionPrefixHash(view.getPrefixHash()),
+  m_transactionBinarySize(view.getBlobSize()),
+  m_transactionBinaryArray(view.getBlob().getData(), view.getBlob().getData() + view.getBlobSize()) {
+  view.toTransaction(m_transaction);
+}
+
+const BinaryArray& CachedTransaction::getTransactionBinaryArray() const {
+  assert(hasTransactionBinaryArray());
+  return m_transactionBinaryArray;
+}
+
+void CachedTransaction::serialize(ISerializer& s) {
+  if (s.type() == ISerializer::INPUT) {
+    Transaction transaction;
+    CryptoNote::serialize(transaction, s);
+    *this = CachedTransaction(std::move(transaction));
+  } else {
+    CryptoNote::serialize(m_transaction, s);
+  }
+}
+
+void CachedTransaction::decode(BinaryDecoder& decoder) {
+  // the decoder only accepts canonical encodings, so the bytes just read are the ones serializing would give
+  const uint8_t* begin = decoder.current();
+  CryptoNote::decode(decoder, static_cast<TransactionPrefix&>(m_transaction));
+  m_transactionPrefixHash = Crypto::cn_fast_hash(begin, decoder.current() - begin);
+  decodeSignatures(decoder, m_transaction);
+  m_transactionBinarySize = decoder.current() - begin;
+  m_transactionHash = Crypto::cn_fast_hash(begin, m_transactionBinarySize);
+  m_transactionBinaryArray.clear();
+}
+
+void CachedTransaction::encode(BinaryEncoder& encoder) const {
+  if (hasTransactionBinaryArray()) {
+    encoder.write(m_transactionBinaryArray.data(), m_transactionBinaryArray.size());
+  } else {
+    CryptoNote::encode(encoder, m_transaction);
+  }
+}
+
+}
@@ -0,0 +1,49 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include "CryptoNoteCore/BinaryCodec.h"
+#include "CryptoNoteCore/CryptoNoteBasic.h"
+
+namespace CryptoNote {
+
+class ISerializer;
+class TransactionView;
+
+// Transaction together with its hash, prefix hash and binary size, worked out once when the wrapper is built:
+// from the blob the transaction arrived in, or by serializing it if there is none. The blob is kept, so that
+// storing or relaying the transaction doesn't serialize it again, except when the transaction was decoded
+// from the blockchain storage, which has the blobs of its transactions elsewhere.
+class CachedTransaction {
+public:
+  CachedTransaction();
+  explicit CachedTransaction(Transaction&& transaction);
+  explicit CachedTransaction(const Transaction& transaction);
+  // The view must have been parsed successfully.
+  explicit CachedTransaction(const TransactionView& view);
+
+  const Transaction& getTransaction() const { return m_transaction; }
+  const Crypto::Hash& getTransactionHash() const { return m_transactionHash; }
+  const Crypto::Hash& getTransactionPrefixHash() const { return m_transactionPrefixHash; }
+  size_t getTransactionBinarySize() const { return m_transactionBinarySize; }
+
+  bool hasTransactionBinaryArray() const { return !m_transactionBinaryArray.empty(); }
+  const BinaryArray& getTransactionBinaryArray() const;
+
+  // Same format as the Transaction itself.
+  void serialize(ISerializer& s);
+  void decode(BinaryDecoder& decoder);
+  void encode(BinaryEncoder& encoder) const;
+
+private:
+  Transaction m_transaction;
+  Crypto::Hash m_transactionHash;
+  Crypto::Hash m_transactionPrefixHash;
+  size_t m_transactionBinarySize;
+  BinaryArray m_transactionBinaryArray;
+};
+
+}
@@ -21,7 +21,10 @@
 #include "CryptoNoteTools.h"
 #include "CryptoNoteStatInfo.h"
 #include "Miner.h"
+#include "TraceLog.h"
 #include "TransactionExtra.h"
+#include "TransactionUtils.h"
+#include "TransactionView.h"
 #include "IBlock.h"
 #undef ERROR
 
@@ -32,6 +35,18 @@ using namespace  Common;
 
 namespace CryptoNote {
 
+namespace {
+
+bool hasInputs(const TransactionPrefix& tx) {
+  return !tx.inputs.empty();
+}
+
+bool hasInputs(const TransactionView& tx) {
+  return !tx.getInputs().empty();
+}
+
+}
+
 class BlockWithTransactions : public IBlock {
 public:
   virtual const Block& getBlock() const override {
@@ -59,6 +74,8 @@ m_currency(currency),
 logger(logger, "core"),
 m_mempool(currency, m_blockchain, m_timeProvider, logger),
 m_blockchain(currency, m_mempool, logger),
+m_seenTransactions(parameters::CRYPTONOTE_SEEN_TX_CACHE_SIZE, parameters::CRYPTONOTE_SEEN_TX_CACHE_LIFETIME),
+m_rejectedTransactions(parameters::CRYPTONOTE_REJECTED_TX_CACHE_SIZE, parameters::CRYPTONOTE_REJECTED_TX_CACHE_LIFETIME),
 m_miner(new miner(currency, *this, logger)),
 m_starter_message_showed(false) {
   set_cryptonote_protocol(pprotocol);
@@ -153,14 +170,12 @@ size_t core::addChain(const std::vector<const IBlock*>& chain) {
   for (const IBlock* block : chain) {
     bool allTransactionsAdded = true;
     for (size_t txNumber = 0; txNumber < block->getTransactionCount(); ++txNumber) {
-      const Transaction& tx = block->getTransaction(txNumber);
-
-      Crypto::Hash txHash = NULL_HASH;
-      size_t blobSize = 0;
-      getObjectHash(tx, txHash, blobSize);
+      // serialized and hashed once here, the pool keeps the blob and hashes
+      CachedTransaction transaction(block->getTransaction(txNumber));
+      const Crypto::Hash txHash = transaction.getTransactionHash();
       tx_verification_context tvc = boost::value_initialized<tx_verification_context>();
 
-      if (!handleIncomingTransaction(tx, txHash, blobSize, tvc, true, get_block_height(block->getBlock()))) {
+      if (!handleIncomingTransaction(std::move(transaction), tvc, true, get_block_height(block->getBlock()))) {
         logger(ERROR, BRIGHT_RED) << "core::addChain() failed to handle transaction " << txHash << " from block " << blocksCounter << "/" << chain.size();
         allTransactionsAdded = false;
         break;
@@ -188,7 +203,8 @@ size_t core::addChain(const std::vector<const IBlock*>& chain) {
 
 bool core::handle_incoming_tx(const BinaryArray& tx_blob, tx_verification_context& tvc, bool keeped_by_block) { //Deprecated. Should be removed with CryptoNoteProtocolHandler.
   tvc = boost::value_initialized<tx_verification_context>();
-  //want to process all transactions sequentially
+  // may run on several threads at once: the hash caches have their own lock, parsing and the semantic checks
+  // need none, and add_new_tx holds the pool and blockchain locks while it checks the inputs and adds the transaction
 
   if (tx_blob.size() > m_currency.maxTxSize()) {
     logger(INFO) << "WRONG TRANSACTION BLOB, too big size " << tx_blob.size() << ", rejected";
@@ -196,22 +212,53 @@ bool core::handle_incoming_tx(const BinaryArray& tx_blob, tx_verification_contex
     return false;
   }
 
-  Crypto::Hash tx_hash = NULL_HASH;
-  Crypto::Hash tx_prefixt_hash = NULL_HASH;
-  Transaction tx;
+  // the transaction hash is the hash of its blob, so a relayed duplicate is recognized before it's parsed;
+  // transactions of blocks are always handled, they may have to go to the pool whatever happened to them before
+  Crypto::Hash tx_hash = getBinaryArrayHash(tx_blob);
+  uint64_t now = m_timeProvider.now();
+  if (!keeped_by_block) {
+    if (m_seenTransactions.contains(tx_hash, now)) {
+      logger(TRACE) << "tx " << tx_hash << " was handled recently";
+      return true;
+    }
+
+    if (m_rejectedTransactions.contains(tx_hash, now)) {
+      logger(DEBUGGING) << "tx " << tx_hash << " was rejected recently, rejected";
+      tvc.m_verifivation_failed = true;
+      return false;
+    }
+  }
+
+  // reused between calls, so that parsing and the semantic checks don't allocate per field
+  thread_local TransactionView view;
 
-  if (!parse_tx_from_blob(tx, tx_hash, tx_prefixt_hash, tx_blob)) {
+  TraceSpan parseSpan(TraceEvent::TX_PARSED, tx_hash);
+  if (!view.parse(tx_blob)) {
     logger(INFO) << "WRONG TRANSACTION BLOB, Failed to parse, rejected";
     tvc.m_verifivation_failed = true;
+    if (!keeped_by_block) {
+      m_rejectedTransactions.add(tx_hash, now);
+    }
+
     return false;
   }
-  //std::cout << "!"<< tx.inputs.size() << std::endl;
+
+  parseSpan.finish();
   
   Crypto::Hash blockId;
   uint32_t blockHeight;
   bool ok = getBlockContainingTx(tx_hash, blockId, blockHeight);
   if (!ok) blockHeight = this->get_current_blockchain_height(); //this assumption fails for withdrawals
-  return handleIncomingTransaction(tx, tx_hash, tx_blob.size(), tvc, keeped_by_block, blockHeight);
+  bool r = handleIncomingTransaction(view, tx_hash, tvc, keeped_by_block, blockHeight);
+  if (!keeped_by_block) {
+    if (tvc.m_verifivation_failed) {
+      m_rejectedTransactions.add(tx_hash, now);
+    } else if (!tvc.m_verifivation_impossible) {
+      m_seenTransactions.add(tx_hash, now);
+    }
+  }
+
+  return r;
 }
 
 bool core::get_stat_info(core_stat_info& st_inf) {
@@ -224,25 +271,26 @@ bool core::get_stat_info(core_stat_info& st_inf) {
 }
 
 
-bool core::check_tx_semantic(const Transaction& tx, bool keeped_by_block, uint32_t &height) {
-  if (!tx.inputs.size()) {
-    logger(ERROR) << "tx with empty inputs, rejected for tx id= " << getObjectHash(tx);
+template<class TransactionType>
+bool core::check_tx_semantic(const TransactionType& tx, const Crypto::Hash& txHash, bool keeped_by_block, uint32_t &height) {
+  if (!hasInputs(tx)) {
+    logger(ERROR) << "tx with empty inputs, rejected for tx id= " << txHash;
     return false;
   }
 
   if (!check_inputs_types_supported(tx)) {
-    logger(ERROR) << "unsupported input types for tx id= " << getObjectHash(tx);
+    logger(ERROR) << "unsupported input types for tx id= " << txHash;
     return false;
   }
 
   std::string errmsg;
   if (!check_outs_valid(tx, &errmsg)) {
-    logger(ERROR) << "tx with invalid outputs, rejected for tx id= " << getObjectHash(tx) << ": " << errmsg;
+    logger(ERROR) << "tx with invalid outputs, rejected for tx id= " << txHash << ": " << errmsg;
     return false;
   }
 
   if (!check_money_overflow(tx)) {
-    logger(ERROR) << "tx have money overflow, rejected for tx id= " << getObjectHash(tx);
+    logger(ERROR) << "tx have money overflow, rejected for tx id= " << txHash;
     return false;
   }
 
@@ -254,7 +302,7 @@ bool core::check_tx_semantic(const Transaction& tx, bool keeped_by_block, uint32
 	  uint32_t testHeight = height > parameters::END_MULTIPLIER_BLOCK ? 0 : (uint32_t)(-1); //try other mode
 	  amount_in = m_currency.getTransactionAllInputsAmount(tx, testHeight);
 	  if (amount_in < amount_out) {
-		logger(ERROR) << "tx with wrong amounts: ins " << amount_in << ", outs " << amount_out << ", rejected for tx id= " << getObjectHash(tx);
+		logger(ERROR) << "tx with wrong amounts: ins " << amount_in << ", outs " << amount_out << ", rejected for tx id= " << txHash;
 		return false;
 	  } else {
 		  height = testHeight;
@@ -262,7 +310,7 @@ bool core::check_tx_semantic(const Transaction& tx, bool keeped_by_block, uint32
   }
 
   //check if tx use different key images
-  if (!check_tx_inputs_keyimages_diff(tx)) {
+  if (!checkInputsKeyimagesDiff(tx)) {
     logger(ERROR) << "tx has a few inputs with identical keyimages";
     return false;
   }
@@ -275,17 +323,6 @@ bool core::check_tx_semantic(const Transaction& tx, bool keeped_by_block, uint32
   return true;
 }
 
-bool core::check_tx_inputs_keyimages_diff(const Transaction& tx) {
-  std::unordered_set<Crypto::KeyImage> ki;
-  for (const auto& in : tx.inputs) {
-    if (in.type() == typeid(KeyInput)) {
-      if (!ki.insert(boost::get<KeyInput>(in).keyImage).second)
-        return false;
-    }
-  }
-  return true;
-}
-
 size_t core::get_blockchain_total_transactions() {
   return m_blockchain.getTotalTransactions();
 }
@@ -295,11 +332,13 @@ size_t core::get_blockchain_total_transactions() {
 //  return m_blockchain.get_outs(amount, pkeys);
 //}
 
-bool core::add_new_tx(const Transaction& tx, const Crypto::Hash& tx_hash, size_t blob_size, tx_verification_context& tvc, bool keeped_by_block, uint32_t height) {
+bool core::add_new_tx(CachedTransaction&& transaction, tx_verification_context& tvc, bool keeped_by_block, uint32_t height) {
   //Locking on m_mempool and m_blockchain closes possibility to add tx to memory pool which is already in blockchain 
   std::lock_guard<decltype(m_mempool)> lk(m_mempool);
   LockedBlockchainStorage lbs(m_blockchain);
 
+  const Crypto::Hash& tx_hash = transaction.getTransactionHash();
+
   if (m_blockchain.haveTransaction(tx_hash)) {
     logger(TRACE) << "tx " << tx_hash << " is already in blockchain";
     return true;
@@ -309,7 +348,7 @@ bool core::add_new_tx(const Transaction& tx, const Crypto::Hash& tx_hash, size_t
     logger(TRACE) << "tx " << tx_hash << " is already in transaction pool";
     return true;
   }
-  return m_mempool.add_tx(tx, tx_hash, blob_size, tvc, keeped_by_block, height);
+  return m_mempool.add_tx(std::move(transaction), tvc, keeped_by_block, height);
 }
 
 bool core::get_block_template(Block& b, const AccountPublicAddress& adr, difficulty_type& diffic, uint32_t& height, const BinaryArray& ex_nonce) {
@@ -516,18 +555,27 @@ bool core::getPoolChanges(const Crypto::Hash& tailBlockId, const std::vector<Cry
 
 bool core::getPoolChangesLite(const Crypto::Hash& tailBlockId, const std::vector<Crypto::Hash>& knownTxsIds,
         std::vector<TransactionPrefixInfo>& addedTxs, std::vector<Crypto::Hash>& deletedTxsIds) {
+  std::vector<Crypto::Hash> addedTxsIds;
   std::vector<Transaction> added;
-  bool returnStatus = getPoolChanges(tailBlockId, knownTxsIds, added, deletedTxsIds);
+  {
+    auto guard = m_mempool.obtainGuard();
+    m_mempool.get_difference(knownTxsIds, addedTxsIds, deletedTxsIds);
+    std::vector<Crypto::Hash> misses;
+    m_mempool.getTransactions(addedTxsIds, added, misses);
+    assert(misses.empty());
+  }
 
-  for (const auto& tx: added) {
+  // the pool hands the transactions out in the order of their ids, which it already knows
+  addedTxs.reserve(added.size());
+  for (size_t i = 0; i < added.size(); ++i) {
     TransactionPrefixInfo tpi;
-    tpi.txPrefix = tx;
-    tpi.txHash = getObjectHash(tx);
+    tpi.txPrefix = std::move(added[i]);
+    tpi.txHash = addedTxsIds[i];
 
     addedTxs.push_back(std::move(tpi));
   }
 
-  return returnStatus;
+  return tailBlockId == m_blockchain.getTailId();
 }
 
 void core::getPoolChanges(const std::vector<Crypto::Hash>& knownTxsIds, std::vector<Transaction>& addedTxs,
@@ -573,11 +621,17 @@ bool core::handle_incoming_block_blob(const BinaryArray& block_blob, block_verif
   }
 
   Block b;
+  TraceSpan parseSpan(TraceEvent::BLOCK_PARSED);
   if (!fromBinaryArray(b, block_blob)) {
     logger(INFO) << "Failed to parse and validate new block";
     bvc.m_verifivation_failed = true;
     return false;
   }
+
+  if (parseSpan.isActive()) {
+    parseSpan.setId(get_block_hash(b));
+    parseSpan.finish();
+  }
   
   
   return handle_incoming_block(b, bvc, control_miner, relay_block);
@@ -595,17 +649,10 @@ bool core::handle_incoming_block(const Block& b, block_verification_context& bvc
   }
 
   if (relay_block && bvc.m_added_to_main_chain) {
-    std::list<Crypto::Hash> missed_txs;
-    std::list<Transaction> txs;
-    m_blockchain.getTransactions(b.transactionHashes, txs, missed_txs);
-    if (!missed_txs.empty() && getBlockIdByHeight(get_block_height(b)) != get_block_hash(b)) {
+    if (getBlockIdByHeight(get_block_height(b)) != get_block_hash(b)) {
       logger(INFO) << "Block added, but it seems that reorganize just happened after that, do not relay this block";
     } else {
-      if (!(txs.size() == b.transactionHashes.size() && missed_txs.empty())) {
-        logger(ERROR, BRIGHT_RED) << "can't find some transactions in found block:" <<
-          get_block_hash(b) << " txs.size()=" << txs.size() << ", b.transactionHashes.size()=" << b.transactionHashes.size() << ", missed_txs.size()" << missed_txs.size(); return false;
-      }
-
+      // the transactions are left out, the protocol loads them only for peers that take full blocks
       NOTIFY_NEW_BLOCK::request arg;
       arg.hop = 0;
       arg.current_blockchain_height = m_blockchain.getCurrentBlockchainHeight();
@@ -613,11 +660,11 @@ bool core::handle_incoming_block(const Block& b, block_verification_context& bvc
       bool r = toBinaryArray(b, blockBa);
       if (!(r)) { logger(ERROR, BRIGHT_RED) << "failed to serialize block"; return false; }
       arg.b.block = asString(blockBa);
-      for (auto& tx : txs) {
-        arg.b.txs.push_back(asString(toBinaryArray(tx)));
-      }
 
       m_pprotocol->relay_block(arg);
+      if (TraceLog::isEnabled()) {
+        TraceLog::instant(TraceEvent::BLOCK_RELAYED, get_block_hash(b));
+      }
     }
   }
 
@@ -636,10 +683,6 @@ bool core::have_block(const Crypto::Hash& id) {
   return m_blockchain.haveBlock(id);
 }
 
-bool core::parse_tx_from_blob(Transaction& tx, Crypto::Hash& tx_hash, Crypto::Hash& tx_prefix_hash, const BinaryArray& blob) {
-  return parseAndValidateTransactionFromBinaryArray(blob, tx, tx_hash, tx_prefix_hash);
-}
-
 bool core::check_tx_syntax(const Transaction& tx) {
   return true;
 }
@@ -655,6 +698,36 @@ std::vector<Transaction> core::getPoolTransactions() {
   return result;
 }
 
+std::vector<Crypto::Hash> core::getMissingPoolTransactions(const std::vector<Crypto::Hash>& txIds) {
+  std::vector<Crypto::Hash> missingTxIds;
+  for (const auto& txId : txIds) {
+    if (!m_mempool.have_tx(txId)) {
+      missingTxIds.push_back(txId);
+    }
+  }
+
+  return missingTxIds;
+}
+
+std::vector<Crypto::Hash> core::getUnknownTransactions(const std::vector<Crypto::Hash>& txIds) {
+  std::vector<Crypto::Hash> unknownTxIds;
+  for (const auto& txId : txIds) {
+    if (!m_mempool.have_tx(txId) && !m_blockchain.haveTransaction(txId)) {
+      unknownTxIds.push_back(txId);
+    }
+  }
+
+  return unknownTxIds;
+}
+
+bool core::isTransactionRejected(const Crypto::Hash& txId) {
+  return m_rejectedTransactions.contains(txId, m_timeProvider.now());
+}
+
+void core::getPoolTransactionBlobs(const std::vector<Crypto::Hash>& txIds, std::vector<BinaryArray>& txs, std::vector<Crypto::Hash>& missedTxIds) {
+  m_mempool.getTransactionBlobs(txIds, txs, missedTxIds);
+}
+
 std::vector<Crypto::Hash> core::buildSparseChain() {
   assert(m_blockchain.getCurrentBlockchainHeight() != 0);
   return m_blockchain.buildSparseChain();
@@ -670,6 +743,10 @@ bool core::handle_get_objects(NOTIFY_REQUEST_GET_OBJECTS::request& arg, NOTIFY_R
   return m_blockchain.handleGetObjects(arg, rsp);
 }
 
+bool core::handle_get_blocks_by_range(const NOTIFY_REQUEST_BLOCKS_BY_RANGE_request& arg, NOTIFY_RESPONSE_BLOCKS_BY_RANGE_request& rsp) {
+  return m_blockchain.handleGetBlocksByRange(arg, rsp);
+}
+
 Crypto::Hash core::getBlockIdByHeight(uint32_t height) {
   LockedBlockchainStorage lbs(m_blockchain);
   if (height < m_blockchain.getCurrentBlockchainHeight()) {
@@ -739,6 +816,10 @@ void core::blockchainUpdated() {
   m_observerManager.notify(&ICoreObserver::blockchainUpdated);
 }
 
+void core::blockPopped(const Crypto::Hash& blockHash, const std::vector<Crypto::Hash>& transactionHashes) {
+  m_observerManager.notify(&ICoreObserver::blockPopped, blockHash, transactionHashes);
+}
+
 void core::txDeletedFromPool() {
   poolUpdated();
 }
@@ -1053,19 +1134,49 @@ uint64_t core::depositInterestAtHeight(size_t height) const {
 }
 
 bool core::handleIncomingTransaction(const Transaction& tx, const Crypto::Hash& txHash, size_t blobSize, tx_verification_context& tvc, bool keptByBlock, uint32_t height) {
-  if (!check_tx_syntax(tx)) {
-    logger(INFO) << "WRONG TRANSACTION BLOB, Failed to check tx " << txHash << " syntax, rejected";
+  TraceSpan verifySpan(TraceEvent::TX_INPUTS_VERIFIED, txHash);
+  if (!check_tx_semantic(tx, txHash, keptByBlock, height)) {
+    logger(INFO) << "WRONG TRANSACTION, Failed to check tx " << txHash << " semantic, rejected";
+    tvc.m_verifivation_failed = true;
+    return false;
+  }
+
+  return addIncomingTransaction(CachedTransaction(tx), tvc, keptByBlock, height);
+}
+
+bool core::handleIncomingTransaction(CachedTransaction&& transaction, tx_verification_context& tvc, bool keptByBlock, uint32_t height) {
+  const Crypto::Hash txHash = transaction.getTransactionHash();
+  TraceSpan verifySpan(TraceEvent::TX_INPUTS_VERIFIED, txHash);
+  if (!check_tx_semantic(transaction.getTransaction(), txHash, keptByBlock, height)) {
+    logger(INFO) << "WRONG TRANSACTION, Failed to check tx " << txHash << " semantic, rejected";
     tvc.m_verifivation_failed = true;
     return false;
   }
 
-  if (!check_tx_semantic(tx, keptByBlock, height)) {
+  return addIncomingTransaction(std::move(transaction), tvc, keptByBlock, height);
+}
+
+bool core::handleIncomingTransaction(const TransactionView& view, const Crypto::Hash& txHash, tx_verification_context& tvc, bool keptByBlock, uint32_t height) {
+  TraceSpan verifySpan(TraceEvent::TX_INPUTS_VERIFIED, txHash);
+  if (!check_tx_semantic(view, txHash, keptByBlock, height)) {
     logger(INFO) << "WRONG TRANSACTION BLOB, Failed to check tx " << txHash << " semantic, rejected";
     tvc.m_verifivation_failed = true;
     return false;
   }
 
-  bool r = add_new_tx(tx, txHash, blobSize, tvc, keptByBlock, height);
+  // only transactions that passed the cheap checks are materialized for the pool, together with their blob and hashes
+  return addIncomingTransaction(CachedTransaction(view), tvc, keptByBlock, height);
+}
+
+bool core::addIncomingTransaction(CachedTransaction&& transaction, tx_verification_context& tvc, bool keptByBlock, uint32_t height) {
+  const Crypto::Hash txHash = transaction.getTransactionHash();
+  if (!check_tx_syntax(transaction.getTransaction())) {
+    logger(INFO) << "WRONG TRANSACTION BLOB, Failed to check tx " << txHash << " syntax, rejected";
+    tvc.m_verifivation_failed = true;
+    return false;
+  }
+
+  bool r = add_new_tx(std::move(transaction), tvc, keptByBlock, height);
   if (tvc.m_verifivation_failed) {
     if (!tvc.m_tx_fee_too_small) {
       logger(ERROR) << "Transaction verification failed: " << txHash;
@@ -1107,6 +1218,10 @@ std::unique_ptr<IBlock> core::getBlock(const Crypto::Hash& blockId) {
   return blockPtr;//return std::move(blockPtr);
 }
 
+bool core::getRawBlock(const Crypto::Hash& blockId, block_complete_entry& entry) {
+  return m_blockchain.getRawBlock(blockId, entry);
+}
+
 bool core::addMessageQueue(MessageQueue<BlockchainMessage>& messageQueue) {
   return m_blockchain.addMessageQueue(messageQueue);
 }
@@ -13,6 +13,7 @@
 #include "P2p/NetNodeCommon.h"
 #include "CryptoNoteProtocol/CryptoNoteProtocolHandlerCommon.h"
 #include "Currency.h"
+#include "TransactionHashCache.h"
 #include "TransactionPool.h"
 #include "Blockchain.h"
 #include "CryptoNoteCore/IMinerHandler.h"
@@ -61,6 +62,7 @@ namespace CryptoNote {
      // ICore
      virtual size_t addChain(const std::vector<const IBlock*>& chain) override;
      virtual bool handle_get_objects(NOTIFY_REQUEST_GET_OBJECTS_request& arg, NOTIFY_RESPONSE_GET_OBJECTS_request& rsp) override; //Deprecated. Should be removed with CryptoNoteProtocolHandler.
+     virtual bool handle_get_blocks_by_range(const NOTIFY_REQUEST_BLOCKS_BY_RANGE_request& arg, NOTIFY_RESPONSE_BLOCKS_BY_RANGE_request& rsp) override;
      virtual bool getBackwardBlocksSizes(uint32_t fromHeight, std::vector<size_t>& sizes, size_t count) override;
      virtual bool getBlockSize(const Crypto::Hash& hash, size_t& size) override;
      virtual bool getAlreadyGeneratedCoins(const Crypto::Hash& hash, uint64_t& generatedCoins) override;
@@ -77,6 +79,7 @@ namespace CryptoNote {
      virtual bool getTransactionsByPaymentId(const Crypto::Hash& paymentId, std::vector<Transaction>& transactions) override;
      virtual bool getOutByMSigGIndex(uint64_t amount, uint64_t gindex, MultisignatureOutput& out) override;
      virtual std::unique_ptr<IBlock> getBlock(const Crypto::Hash& blocksId) override;
+     virtual bool getRawBlock(const Crypto::Hash& blockId, block_complete_entry& entry) override;
      virtual bool handleIncomingTransaction(const Transaction& tx, const Crypto::Hash& txHash, size_t blobSize, tx_verification_context& tvc, bool keptByBlock, uint32_t height) override;
      virtual std::error_code executeLocked(const std::function<std::error_code()>& func) override;
      
@@ -116,6 +119,10 @@ namespace CryptoNote {
      void set_checkpoints(Checkpoints&& chk_pts);
 
      std::vector<Transaction> getPoolTransactions() override;
+     std::vector<Crypto::Hash> getMissingPoolTransactions(const std::vector<Crypto::Hash>& txIds) override;
+     std::vector<Crypto::Hash> getUnknownTransactions(const std::vector<Crypto::Hash>& txIds) override;
+     bool isTransactionRejected(const Crypto::Hash& txId) override;
+     void getPoolTransactionBlobs(const std::vector<Crypto::Hash>& txIds, std::vector<BinaryArray>& txs, std::vector<Crypto::Hash>& missedTxIds) override;
      size_t get_pool_transactions_count();
      size_t get_blockchain_total_transactions();
      //bool get_outs(uint64_t amount, std::list<Crypto::PublicKey>& pkeys);
@@ -149,14 +156,17 @@ namespace CryptoNote {
      uint64_t depositInterestAtHeight(size_t height) const;
 
    private:
-     bool add_new_tx(const Transaction& tx, const Crypto::Hash& tx_hash, size_t blob_size, tx_verification_context& tvc, bool keeped_by_block, uint32_t height);
+     bool add_new_tx(CachedTransaction&& transaction, tx_verification_context& tvc, bool keeped_by_block, uint32_t height);
+     bool handleIncomingTransaction(CachedTransaction&& transaction, tx_verification_context& tvc, bool keptByBlock, uint32_t height);
+     bool handleIncomingTransaction(const TransactionView& view, const Crypto::Hash& txHash, tx_verification_context& tvc, bool keptByBlock, uint32_t height);
+     bool addIncomingTransaction(CachedTransaction&& transaction, tx_verification_context& tvc, bool keptByBlock, uint32_t height);
      bool load_state_data();
-     bool parse_tx_from_blob(Transaction& tx, Crypto::Hash& tx_hash, Crypto::Hash& tx_prefix_hash, const BinaryArray& blob);
      bool handle_incoming_block(const Block& b, block_verification_context& bvc, bool control_miner, bool relay_block);
 
      bool check_tx_syntax(const Transaction& tx);
      //check correct values, amounts and all lightweight checks not related with database
-     bool check_tx_semantic(const Transaction& tx, bool keeped_by_block, uint32_t &height);
+     template<class TransactionType>
+     bool check_tx_semantic(const TransactionType& tx, const Crypto::Hash& txHash, bool keeped_by_block, uint32_t &height);
      //check if tx already in memory pool or in main blockchain
 
      bool is_key_image_spent(const Crypto::KeyImage& key_im);
@@ -166,8 +176,8 @@ namespace CryptoNote {
      bool update_miner_block_template();
      bool handle_command_line(const boost::program_options::variables_map& vm);
      bool on_update_blocktemplate_interval();
-     bool check_tx_inputs_keyimages_diff(const Transaction& tx);
      virtual void blockchainUpdated() override;
+     virtual void blockPopped(const Crypto::Hash& blockHash, const std::vector<Crypto::Hash>& transactionHashes) override;
      virtual void txDeletedFromPool() override;
      void poolUpdated();
 
@@ -179,6 +189,9 @@ namespace CryptoNote {
      CryptoNote::RealTimeProvider m_timeProvider;
      tx_memory_pool m_mempool;
      Blockchain m_blockchain;
+     // relayed transactions handled lately, by the hash of their blob, so that their duplicates aren't parsed
+     TransactionHashCache m_seenTransactions;
+     TransactionHashCache m_rejectedTransactions;
      i_cryptonote_protocol* m_pprotocol;
      std::unique_ptr<miner> m_miner;
      std::string m_config_folder;
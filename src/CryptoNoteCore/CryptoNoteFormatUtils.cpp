@@ -16,9 +16,11 @@
 #include "Serialization/BinaryInputStreamSerializer.h"
 
 #include "Account.h"
+#include "BinaryCodec.h"
 #include "CryptoNoteBasicImpl.h"
 #include "CryptoNoteSerialization.h"
 #include "TransactionExtra.h"
+#include "TransactionView.h"
 #include "CryptoNoteTools.h"
 
 #include "CryptoNoteConfig.h"
@@ -30,13 +32,23 @@ using namespace Common;
 namespace CryptoNote {
 
 bool parseAndValidateTransactionFromBinaryArray(const BinaryArray& tx_blob, Transaction& tx, Hash& tx_hash, Hash& tx_prefix_hash) {
-  if (!fromBinaryArray(tx, tx_blob)) {
+  size_t prefixSize;
+  try {
+    BinaryDecoder decoder(tx_blob.data(), tx_blob.size());
+    decode(decoder, static_cast<TransactionPrefix&>(tx));
+    prefixSize = decoder.position();
+    decodeSignatures(decoder, tx);
+    if (decoder.remaining() != 0) {
+      return false;
+    }
+  } catch (std::exception&) {
     return false;
   }
 
   //TODO: validate tx
   cn_fast_hash(tx_blob.data(), tx_blob.size(), tx_hash);
-  getObjectHash(*static_cast<TransactionPrefix*>(&tx), tx_prefix_hash);
+  // the decoder only accepts canonical encodings, so the prefix bytes are what serializing the prefix would give
+  cn_fast_hash(tx_blob.data(), prefixSize, tx_prefix_hash);
   return true;
 }
 
@@ -350,6 +362,29 @@ bool check_money_overflow(const TransactionPrefix &tx) {
   return check_inputs_overflow(tx) && check_outs_overflow(tx);
 }
 
+namespace {
+
+// A deposit can return its amount plus at most DEPOSIT_MAX_TOTAL_RATE percent of interest.
+bool addMaxDepositInterest(uint64_t& amount) {
+  uint64_t hi;
+  uint64_t lo = mul128(amount, CryptoNote::parameters::DEPOSIT_MAX_TOTAL_RATE, &hi);
+  uint64_t maxInterestHi;
+  uint64_t maxInterestLo;
+  div128_32(hi, lo, 100, &maxInterestHi, &maxInterestLo);
+  if (maxInterestHi > 0) {
+    return false;
+  }
+
+  if (amount > std::numeric_limits<uint64_t>::max() - maxInterestLo) {
+    return false;
+  }
+
+  amount += maxInterestLo;
+  return true;
+}
+
+}
+
 bool check_inputs_overflow(const TransactionPrefix &tx) {
   uint64_t money = 0;
 
@@ -360,21 +395,8 @@ bool check_inputs_overflow(const TransactionPrefix &tx) {
       amount = boost::get<KeyInput>(in).amount;
     } else if (in.type() == typeid(MultisignatureInput)) {
       amount = boost::get<MultisignatureInput>(in).amount;
-      if (boost::get<MultisignatureInput>(in).term != 0) {
-        uint64_t hi;
-        uint64_t lo = mul128(amount, CryptoNote::parameters::DEPOSIT_MAX_TOTAL_RATE, &hi);
-        uint64_t maxInterestHi;
-        uint64_t maxInterestLo;
-        div128_32(hi, lo, 100, &maxInterestHi, &maxInterestLo);
-        if (maxInterestHi > 0) {
-          return false;
-        }
-
-        if (amount > std::numeric_limits<uint64_t>::max() - maxInterestLo) {
-          return false;
-        }
-
-        amount += maxInterestLo;
+      if (boost::get<MultisignatureInput>(in).term != 0 && !addMaxDepositInterest(amount)) {
+        return false;
       }
     }
 
@@ -404,6 +426,152 @@ uint64_t get_outs_money_amount(const Transaction& tx) {
   return outputs_amount;
 }
 
+uint64_t get_outs_money_amount(const TransactionView& tx) {
+  uint64_t outputs_amount = 0;
+  for (const auto& o : tx.getOutputs()) {
+    outputs_amount += o.amount;
+  }
+  return outputs_amount;
+}
+
+bool check_inputs_types_supported(const TransactionView& tx) {
+  for (const auto& in : tx.getInputs()) {
+    if (in.type == TransactionTypes::InputType::Multisignature) {
+      if (tx.getVersion() < TRANSACTION_VERSION_2) {
+        return false;
+      }
+    } else if (in.type != TransactionTypes::InputType::Key) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool check_outs_valid(const TransactionView& tx, std::string* error) {
+  // every output key, checked for duplicates at the end by sorting instead of with a node per key
+  std::vector<const PublicKey*> keys;
+  for (const auto& out : tx.getOutputs()) {
+    keys.reserve(keys.size() + out.keys.getSize());
+    if (out.type == TransactionTypes::OutputType::Key) {
+      if (out.amount == 0) {
+        if (error) {
+          *error = "Zero amount ouput";
+        }
+        return false;
+      }
+
+      if (!check_key(out.keys[0])) {
+        if (error) {
+          *error = "Output with invalid key";
+        }
+        return false;
+      }
+    } else {
+      if (tx.getVersion() < TRANSACTION_VERSION_2) {
+        if (error) {
+          *error = "Transaction contains multisignature output but its version is less than 2";
+        }
+        return false;
+      }
+
+      if (out.requiredSignatureCount > out.keys.getSize()) {
+        if (error) {
+          *error = "Multisignature output with invalid required signature count";
+        }
+        return false;
+      }
+
+      for (const PublicKey& key : out.keys) {
+        if (!check_key(key)) {
+          if (error) {
+            *error = "Multisignature output with invalid public key";
+          }
+          return false;
+        }
+      }
+    }
+
+    for (const PublicKey& key : out.keys) {
+      keys.push_back(&key);
+    }
+  }
+
+  auto less = [](const PublicKey* left, const PublicKey* right) { return memcmp(left, right, sizeof(PublicKey)) < 0; };
+  auto equal = [](const PublicKey* left, const PublicKey* right) { return *left == *right; };
+  std::sort(keys.begin(), keys.end(), less);
+  if (std::adjacent_find(keys.begin(), keys.end(), equal) != keys.end()) {
+    if (error) {
+      *error = "The same output target is present more than once";
+    }
+    return false;
+  }
+
+  return true;
+}
+
+bool checkMultisignatureInputsDiff(const TransactionView& tx) {
+  std::vector<std::pair<uint64_t, uint32_t>> inputsUsage;
+  for (const auto& in : tx.getInputs()) {
+    if (in.type == TransactionTypes::InputType::Multisignature) {
+      inputsUsage.emplace_back(in.amount, in.outputIndex);
+    }
+  }
+
+  std::sort(inputsUsage.begin(), inputsUsage.end());
+  return std::adjacent_find(inputsUsage.begin(), inputsUsage.end()) == inputsUsage.end();
+}
+
+bool checkInputsKeyimagesDiff(const TransactionView& tx) {
+  std::vector<const KeyImage*> keyImages;
+  keyImages.reserve(tx.getInputs().size());
+  for (const auto& in : tx.getInputs()) {
+    if (in.type == TransactionTypes::InputType::Key) {
+      keyImages.push_back(in.keyImage);
+    }
+  }
+
+  auto less = [](const KeyImage* left, const KeyImage* right) { return memcmp(left, right, sizeof(KeyImage)) < 0; };
+  auto equal = [](const KeyImage* left, const KeyImage* right) { return *left == *right; };
+  std::sort(keyImages.begin(), keyImages.end(), less);
+  return std::adjacent_find(keyImages.begin(), keyImages.end(), equal) == keyImages.end();
+}
+
+bool check_money_overflow(const TransactionView& tx) {
+  return check_inputs_overflow(tx) && check_outs_overflow(tx);
+}
+
+bool check_inputs_overflow(const TransactionView& tx) {
+  uint64_t money = 0;
+  for (const auto& in : tx.getInputs()) {
+    uint64_t amount = in.amount;
+    if (in.type == TransactionTypes::InputType::Multisignature && in.term != 0 && !addMaxDepositInterest(amount)) {
+      return false;
+    }
+
+    if (money > amount + money) {
+      return false;
+    }
+
+    money += amount;
+  }
+
+  return true;
+}
+
+bool check_outs_overflow(const TransactionView& tx) {
+  uint64_t money = 0;
+  for (const auto& o : tx.getOutputs()) {
+    if (money > o.amount + money) {
+      return false;
+    }
+
+    money += o.amount;
+  }
+
+  return true;
+}
+
 std::string short_hash_str(const Hash& h) {
   std::string res = Common::podToHex(h);
 
@@ -21,6 +21,8 @@ class ILogger;
 
 namespace CryptoNote {
 
+class TransactionView;
+
 bool parseAndValidateTransactionFromBinaryArray(const BinaryArray& transactionBinaryArray, Transaction& transaction, Crypto::Hash& transactionHash, Crypto::Hash& transactionPrefixHash);
 
 struct TransactionSourceEntry {
@@ -85,6 +87,17 @@ bool checkMultisignatureInputsDiff(const TransactionPrefix& tx);
 bool check_money_overflow(const TransactionPrefix& tx);
 bool check_outs_overflow(const TransactionPrefix& tx);
 bool check_inputs_overflow(const TransactionPrefix& tx);
+
+// The same checks over a parsed blob, without materializing the transaction
+uint64_t get_outs_money_amount(const TransactionView& tx);
+bool check_inputs_types_supported(const TransactionView& tx);
+bool check_outs_valid(const TransactionView& tx, std::string* error = 0);
+bool checkMultisignatureInputsDiff(const TransactionView& tx);
+bool checkInputsKeyimagesDiff(const TransactionView& tx);
+bool check_money_overflow(const TransactionView& tx);
+bool check_outs_overflow(const TransactionView& tx);
+bool check_inputs_overflow(const TransactionView& tx);
+
 uint32_t get_block_height(const Block& b);
 std::vector<uint32_t> relative_output_offsets_to_absolute(const std::vector<uint32_t>& off);
 std::vector<uint32_t> absolute_output_offsets_to_relative(const std::vector<uint32_t>& off);
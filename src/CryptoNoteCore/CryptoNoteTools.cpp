@@ -6,9 +6,38 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "CryptoNoteTools.h"
+#include "BinaryCodec.h"
 #include "CryptoNoteFormatUtils.h"
 
 namespace CryptoNote {
+
+namespace {
+
+template<class T>
+bool encodeToBinaryArray(const T& object, BinaryArray& binaryArray) {
+  try {
+    BinaryEncoder encoder(binaryArray);
+    encode(encoder, object);
+  } catch (std::exception&) {
+    return false;
+  }
+
+  return true;
+}
+
+template<class T>
+bool decodeFromBinaryArray(T& object, const BinaryArray& binaryArray) {
+  try {
+    BinaryDecoder decoder(binaryArray.data(), binaryArray.size());
+    decode(decoder, object);
+    return decoder.remaining() == 0; // check that all data was consumed
+  } catch (std::exception&) {
+    return false;
+  }
+}
+
+}
+
 template<>
 bool toBinaryArray(const BinaryArray& object, BinaryArray& binaryArray) {
   try {
@@ -23,6 +52,36 @@ bool toBinaryArray(const BinaryArray& object, BinaryArray& binaryArray) {
   return true;
 }
 
+template<>
+bool toBinaryArray(const TransactionPrefix& object, BinaryArray& binaryArray) {
+  return encodeToBinaryArray(object, binaryArray);
+}
+
+template<>
+bool toBinaryArray(const Transaction& object, BinaryArray& binaryArray) {
+  return encodeToBinaryArray(object, binaryArray);
+}
+
+template<>
+bool toBinaryArray(const Block& object, BinaryArray& binaryArray) {
+  return encodeToBinaryArray(object, binaryArray);
+}
+
+template<>
+bool fromBinaryArray(TransactionPrefix& object, const BinaryArray& binaryArray) {
+  return decodeFromBinaryArray(object, binaryArray);
+}
+
+template<>
+bool fromBinaryArray(Transaction& object, const BinaryArray& binaryArray) {
+  return decodeFromBinaryArray(object, binaryArray);
+}
+
+template<>
+bool fromBinaryArray(Block& object, const BinaryArray& binaryArray) {
+  return decodeFromBinaryArray(object, binaryArray);
+}
+
 void getBinaryArrayHash(const BinaryArray& binaryArray, Crypto::Hash& hash) {
   cn_fast_hash(binaryArray.data(), binaryArray.size(), hash);
 }
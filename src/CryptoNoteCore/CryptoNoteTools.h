@@ -36,6 +36,14 @@ bool toBinaryArray(const T& object, BinaryArray& binaryArray) {
 template<>
 bool toBinaryArray(const BinaryArray& object, BinaryArray& binaryArray); 
 
+// consensus types go through BinaryCodec rather than the serializer
+template<>
+bool toBinaryArray(const TransactionPrefix& object, BinaryArray& binaryArray);
+template<>
+bool toBinaryArray(const Transaction& object, BinaryArray& binaryArray);
+template<>
+bool toBinaryArray(const Block& object, BinaryArray& binaryArray);
+
 template<class T>
 BinaryArray toBinaryArray(const T& object) {
   BinaryArray ba;
@@ -57,6 +65,13 @@ bool fromBinaryArray(T& object, const BinaryArray& binaryArray) {
   return result;
 }
 
+template<>
+bool fromBinaryArray(TransactionPrefix& object, const BinaryArray& binaryArray);
+template<>
+bool fromBinaryArray(Transaction& object, const BinaryArray& binaryArray);
+template<>
+bool fromBinaryArray(Block& object, const BinaryArray& binaryArray);
+
 template<class T>
 bool getObjectBinarySize(const T& object, size_t& size) {
   BinaryArray ba;
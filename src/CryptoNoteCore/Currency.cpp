@@ -92,6 +92,8 @@ bool Currency::init() {
     m_blocksFileName = "testnet_" + m_blocksFileName;
     m_blocksCacheFileName = "testnet_" + m_blocksCacheFileName;
     m_blockIndexesFileName = "testnet_" + m_blockIndexesFileName;
+    m_rawBlocksFileName = "testnet_" + m_rawBlocksFileName;
+    m_rawBlockIndexesFileName = "testnet_" + m_rawBlockIndexesFileName;
     m_txPoolFileName = "testnet_" + m_txPoolFileName;
     m_blockchinIndicesFileName = "testnet_" + m_blockchinIndicesFileName;
   }
@@ -242,6 +244,22 @@ uint64_t Currency::getTransactionAllInputsAmount(const Transaction& tx, uint32_t
   return amount;
 }
 
+namespace {
+
+bool getFeeFromAmounts(uint64_t amount_in, uint64_t amount_out, size_t inputCount, size_t outputCount, uint64_t& fee) {
+  if (amount_out > amount_in){
+	if (inputCount > 0 && outputCount > 0 && amount_out > amount_in + parameters::MINIMUM_FEE) //interest shows up in the output of the W/D transactions and W/Ds always have min fee
+	  fee = parameters::MINIMUM_FEE;
+	else
+	  return false;
+  } else
+	fee = amount_in - amount_out;
+
+  return true;
+}
+
+}
+
 bool Currency::getTransactionFee(const Transaction& tx, uint64_t& fee, uint32_t height) const {
   uint64_t amount_in = 0;
   uint64_t amount_out = 0;
@@ -257,15 +275,7 @@ bool Currency::getTransactionFee(const Transaction& tx, uint64_t& fee, uint32_t
     amount_out += o.amount;
   }
 
-  if (amount_out > amount_in){
-	if (tx.inputs.size() > 0 && tx.outputs.size() > 0 && amount_out > amount_in + parameters::MINIMUM_FEE) //interest shows up in the output of the W/D transactions and W/Ds always have min fee
-	  fee = parameters::MINIMUM_FEE;
-	else
-	  return false;
-  } else
-	fee = amount_in - amount_out;
-
-  return true;
+  return getFeeFromAmounts(amount_in, amount_out, tx.inputs.size(), tx.outputs.size(), fee);
 }
 
 uint64_t Currency::getTransactionFee(const Transaction& tx, uint32_t height) const {
@@ -276,6 +286,28 @@ uint64_t Currency::getTransactionFee(const Transaction& tx, uint32_t height) con
   return r;
 }
 
+uint64_t Currency::getTransactionInputAmount(const TransactionView::Input& in, uint32_t height) const {
+  // amount is zero for a generating input
+  if (in.type == TransactionTypes::InputType::Multisignature && in.term != 0) {
+    return in.amount + calculateInterest(in.amount, in.term, height);
+  }
+
+  return in.amount;
+}
+
+uint64_t Currency::getTransactionAllInputsAmount(const TransactionView& tx, uint32_t height) const {
+  uint64_t amount = 0;
+  for (const auto& in : tx.getInputs()) {
+    amount += getTransactionInputAmount(in, height);
+  }
+  return amount;
+}
+
+bool Currency::getTransactionFee(const TransactionView& tx, uint64_t& fee, uint32_t height) const {
+  return getFeeFromAmounts(getTransactionAllInputsAmount(tx, height), get_outs_money_amount(tx), tx.getInputs().size(),
+    tx.getOutputs().size(), fee);
+}
+
 size_t Currency::maxBlockCumulativeSize(uint64_t height) const {
   assert(height <= std::numeric_limits<uint64_t>::max() / m_maxBlockSizeGrowthSpeedNumerator);
   size_t maxSize = static_cast<size_t>(m_maxBlockSizeInitial +
@@ -934,6 +966,8 @@ CurrencyBuilder::CurrencyBuilder(Logging::ILogger& log) : m_currency(log) {
   blocksFileName(parameters::CRYPTONOTE_BLOCKS_FILENAME);
   blocksCacheFileName(parameters::CRYPTONOTE_BLOCKSCACHE_FILENAME);
   blockIndexesFileName(parameters::CRYPTONOTE_BLOCKINDEXES_FILENAME);
+  rawBlocksFileName(parameters::CRYPTONOTE_RAWBLOCKS_FILENAME);
+  rawBlockIndexesFileName(parameters::CRYPTONOTE_RAWBLOCKINDEXES_FILENAME);
   txPoolFileName(parameters::CRYPTONOTE_POOLDATA_FILENAME);
   blockchinIndicesFileName(parameters::CRYPTONOTE_BLOCKCHAIN_INDICES_FILENAME);
 
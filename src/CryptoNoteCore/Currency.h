@@ -16,6 +16,7 @@
 #include "../Logging/LoggerRef.h"
 #include "CryptoNoteBasic.h"
 #include "Difficulty.h"
+#include "TransactionView.h"
 
 
 namespace CryptoNote {
@@ -100,6 +101,8 @@ public:
   const std::string& blocksFileName() const { return m_blocksFileName; }
   const std::string& blocksCacheFileName() const { return m_blocksCacheFileName; }
   const std::string& blockIndexesFileName() const { return m_blockIndexesFileName; }
+  const std::string& rawBlocksFileName() const { return m_rawBlocksFileName; }
+  const std::string& rawBlockIndexesFileName() const { return m_rawBlockIndexesFileName; }
   const std::string& txPoolFileName() const { return m_txPoolFileName; }
   const std::string& blockchinIndicesFileName() const { return m_blockchinIndicesFileName; }
 
@@ -116,6 +119,9 @@ public:
   uint64_t getTransactionAllInputsAmount(const Transaction& tx, uint32_t height) const;
   bool getTransactionFee(const Transaction& tx, uint64_t & fee, uint32_t height) const;
   uint64_t getTransactionFee(const Transaction& tx, uint32_t height) const;
+  uint64_t getTransactionInputAmount(const TransactionView::Input& in, uint32_t height) const;
+  uint64_t getTransactionAllInputsAmount(const TransactionView& tx, uint32_t height) const;
+  bool getTransactionFee(const TransactionView& tx, uint64_t& fee, uint32_t height) const;
   size_t maxBlockCumulativeSize(uint64_t height) const;
 
   bool constructMinerTx(uint32_t height, size_t medianSize, uint64_t alreadyGeneratedCoins, size_t currentBlockSize,
@@ -214,6 +220,8 @@ private:
   std::string m_blocksFileName;
   std::string m_blocksCacheFileName;
   std::string m_blockIndexesFileName;
+  std::string m_rawBlocksFileName;
+  std::string m_rawBlockIndexesFileName;
   std::string m_txPoolFileName;
   std::string m_blockchinIndicesFileName;
 
@@ -302,6 +310,8 @@ CurrencyBuilder& upgradeHeightV3(uint64_t val) { m_currency.m_upgradeHeightV3 =
   CurrencyBuilder& blocksFileName(const std::string& val) { m_currency.m_blocksFileName = val; return *this; }
   CurrencyBuilder& blocksCacheFileName(const std::string& val) { m_currency.m_blocksCacheFileName = val; return *this; }
   CurrencyBuilder& blockIndexesFileName(const std::string& val) { m_currency.m_blockIndexesFileName = val; return *this; }
+  CurrencyBuilder& rawBlocksFileName(const std::string& val) { m_currency.m_rawBlocksFileName = val; return *this; }
+  CurrencyBuilder& rawBlockIndexesFileName(const std::string& val) { m_currency.m_rawBlockIndexesFileName = val; return *this; }
   CurrencyBuilder& txPoolFileName(const std::string& val) { m_currency.m_txPoolFileName = val; return *this; }
   CurrencyBuilder& blockchinIndicesFileName(const std::string& val) { m_currency.m_blockchinIndicesFileName = val; return *this; }
   
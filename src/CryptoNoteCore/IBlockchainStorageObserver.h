@@ -7,6 +7,10 @@
 
 #pragma once
 
+#include <vector>
+
+#include "CryptoTypes.h"
+
 namespace CryptoNote {
   class IBlockchainStorageObserver {
   public:
@@ -14,5 +18,6 @@ namespace CryptoNote {
     }
 
     virtual void blockchainUpdated() = 0;
+    virtual void blockPopped(const Crypto::Hash& blockHash, const std::vector<Crypto::Hash>& transactionHashes) {}
   };
 }
@@ -25,8 +25,11 @@ struct COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS_request;
 struct COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS_response;
 struct NOTIFY_RESPONSE_GET_OBJECTS_request;
 struct NOTIFY_REQUEST_GET_OBJECTS_request;
+struct NOTIFY_REQUEST_BLOCKS_BY_RANGE_request;
+struct NOTIFY_RESPONSE_BLOCKS_BY_RANGE_request;
 
 class Currency;
+struct block_complete_entry;
 class IBlock;
 class ICoreObserver;
 struct Block;
@@ -59,6 +62,7 @@ public:
   virtual void update_block_template_and_resume_mining() = 0;
   virtual bool handle_incoming_block_blob(const CryptoNote::BinaryArray& block_blob, CryptoNote::block_verification_context& bvc, bool control_miner, bool relay_block) = 0;
   virtual bool handle_get_objects(NOTIFY_REQUEST_GET_OBJECTS_request& arg, NOTIFY_RESPONSE_GET_OBJECTS_request& rsp) = 0; //Deprecated. Should be removed with CryptoNoteProtocolHandler.
+  virtual bool handle_get_blocks_by_range(const NOTIFY_REQUEST_BLOCKS_BY_RANGE_request& arg, NOTIFY_RESPONSE_BLOCKS_BY_RANGE_request& rsp) = 0;
   virtual void on_synchronized() = 0;
   virtual size_t addChain(const std::vector<const IBlock*>& chain) = 0;
 
@@ -71,6 +75,13 @@ public:
   virtual i_cryptonote_protocol* get_protocol() = 0;
   virtual bool handle_incoming_tx(const BinaryArray& tx_blob, tx_verification_context& tvc, bool keeped_by_block) = 0; //Deprecated. Should be removed with CryptoNoteProtocolHandler.
   virtual std::vector<Transaction> getPoolTransactions() = 0;
+  // The ids among txIds that aren't in the pool.
+  virtual std::vector<Crypto::Hash> getMissingPoolTransactions(const std::vector<Crypto::Hash>& txIds) = 0;
+  // The ids among txIds that are neither in the pool nor in the blockchain.
+  virtual std::vector<Crypto::Hash> getUnknownTransactions(const std::vector<Crypto::Hash>& txIds) = 0;
+  // Whether a relayed transaction with this id failed verification recently, so it isn't worth asking for.
+  virtual bool isTransactionRejected(const Crypto::Hash& txId) = 0;
+  virtual void getPoolTransactionBlobs(const std::vector<Crypto::Hash>& txIds, std::vector<BinaryArray>& txs, std::vector<Crypto::Hash>& missedTxIds) = 0;
   virtual bool getPoolChanges(const Crypto::Hash& tailBlockId, const std::vector<Crypto::Hash>& knownTxsIds,
                               std::vector<Transaction>& addedTxs, std::vector<Crypto::Hash>& deletedTxsIds) = 0;
   virtual bool getPoolChangesLite(const Crypto::Hash& tailBlockId, const std::vector<Crypto::Hash>& knownTxsIds,
@@ -103,6 +114,7 @@ public:
   virtual bool getTransactionsByPaymentId(const Crypto::Hash& paymentId, std::vector<Transaction>& transactions) = 0;
 
   virtual std::unique_ptr<IBlock> getBlock(const Crypto::Hash& blocksId) = 0;
+  virtual bool getRawBlock(const Crypto::Hash& blockId, block_complete_entry& entry) = 0;
   virtual bool handleIncomingTransaction(const Transaction& tx, const Crypto::Hash& txHash, size_t blobSize, tx_verification_context& tvc, bool keptByBlock, uint32_t height) = 0;
   virtual std::error_code executeLocked(const std::function<std::error_code()>& func) = 0;
 
@@ -7,6 +7,10 @@
 
 #pragma once
 
+#include <vector>
+
+#include "CryptoTypes.h"
+
 namespace CryptoNote {
 
 class ICoreObserver {
@@ -14,6 +18,7 @@ public:
   virtual ~ICoreObserver() {};
   virtual void blockchainUpdated() {};
   virtual void poolUpdated() {};
+  virtual void blockPopped(const Crypto::Hash& blockHash, const std::vector<Crypto::Hash>& transactionHashes) {};
 };
 
 }
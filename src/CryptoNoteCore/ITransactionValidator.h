@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "CryptoNoteCore/CachedTransaction.h"
 #include "CryptoNoteCore/CryptoNoteBasic.h"
 
 namespace CryptoNote {
@@ -33,8 +34,8 @@ namespace CryptoNote {
   public:
     virtual ~ITransactionValidator() {}
     
-    virtual bool checkTransactionInputs(const CryptoNote::Transaction& tx, BlockInfo& maxUsedBlock) = 0;
-    virtual bool checkTransactionInputs(const CryptoNote::Transaction& tx, BlockInfo& maxUsedBlock, BlockInfo& lastFailed) = 0;
+    virtual bool checkTransactionInputs(const CryptoNote::CachedTransaction& tx, BlockInfo& maxUsedBlock) = 0;
+    virtual bool checkTransactionInputs(const CryptoNote::CachedTransaction& tx, BlockInfo& maxUsedBlock, BlockInfo& lastFailed) = 0;
     virtual bool haveSpentKeyImages(const CryptoNote::Transaction& tx) = 0;
     virtual bool checkTransactionSize(size_t blobSize) = 0;
   };
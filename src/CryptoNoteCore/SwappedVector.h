@@ -17,10 +17,8 @@
 #include <string>
 #include <vector>
 
-#include "Common/StdInputStream.h"
-#include "Common/StdOutputStream.h"
-#include "Serialization/BinaryInputStreamSerializer.h"
-#include "Serialization/BinaryOutputStreamSerializer.h"
+#include "Common/Metrics.h"
+#include "CryptoNoteCore/BinaryCodec.h"
 
 template<class T> class SwappedVector {
 public:
@@ -152,6 +150,9 @@ public:
   void pop_back();
   void push_back(const T& item);
 
+  // Counts cache hits and misses into ultranote_swapped_vector_cache_*_total{vector="name"}.
+  void enableMetrics(const std::string& name);
+
 private:
   struct ItemEntry;
   struct CacheEntry;
@@ -176,11 +177,15 @@ private:
   std::list<CacheEntry> m_cache;
   uint64_t m_cacheHits;
   uint64_t m_cacheMisses;
+  Common::MetricCounter* m_hitsCounter;
+  Common::MetricCounter* m_missesCounter;
+  // encoded item being read or written
+  CryptoNote::BinaryArray m_itemBuffer;
 
   T* prepare(uint64_t index);
 };
 
-template<class T> SwappedVector<T>::SwappedVector() {
+template<class T> SwappedVector<T>::SwappedVector() : m_hitsCounter(nullptr), m_missesCounter(nullptr) {
 }
 
 template<class T> SwappedVector<T>::~SwappedVector() {
@@ -269,6 +274,10 @@ template<class T> const T& SwappedVector<T>::operator[](uint64_t index) {
     }
 
     ++m_cacheHits;
+    if (m_hitsCounter != nullptr) {
+      m_hitsCounter->inc();
+    }
+
     return itemIter->second.item;
   }
 
@@ -280,19 +289,34 @@ template<class T> const T& SwappedVector<T>::operator[](uint64_t index) {
     throw std::runtime_error("SwappedVector::operator[]");
   }
 
+  uint64_t itemEnd = index + 1 < m_offsets.size() ? m_offsets[index + 1] : m_itemsFileSize;
+  m_itemBuffer.resize(static_cast<size_t>(itemEnd - m_offsets[index]));
   m_itemsFile.seekg(m_offsets[index]);
+  m_itemsFile.read(reinterpret_cast<char*>(m_itemBuffer.data()), m_itemBuffer.size());
+  if (!m_itemsFile) {
+    throw std::runtime_error("SwappedVector::operator[]");
+  }
+
   T tempItem;
-  
-  Common::StdInputStream stream(m_itemsFile);
-  CryptoNote::BinaryInputStreamSerializer archive(stream);
-  serialize(tempItem, archive);
+  CryptoNote::BinaryDecoder decoder(m_itemBuffer.data(), m_itemBuffer.size());
+  decode(decoder, tempItem);
 
   T* item = prepare(index);
   std::swap(tempItem, *item);
   ++m_cacheMisses;
+  if (m_missesCounter != nullptr) {
+    m_missesCounter->inc();
+  }
+
   return *item;
 }
 
+template<class T> void SwappedVector<T>::enableMetrics(const std::string& name) {
+  std::string labels = Common::Metrics::label("vector", name);
+  m_hitsCounter = &Common::Metrics::counter("ultranote_swapped_vector_cache_hits_total", "Reads served from the SwappedVector cache", labels);
+  m_missesCounter = &Common::Metrics::counter("ultranote_swapped_vector_cache_misses_total", "Reads that had to load an item from disk", labels);
+}
+
 template<class T> const T& SwappedVector<T>::front() {
   return operator[](0);
 }
@@ -348,13 +372,17 @@ template<class T> void SwappedVector<T>::push_back(const T& item) {
       throw std::runtime_error("SwappedVector::push_back");
     }
 
-    m_itemsFile.seekp(m_itemsFileSize);
+    m_itemBuffer.clear();
+    CryptoNote::BinaryEncoder encoder(m_itemBuffer);
+    encode(encoder, item);
 
-    Common::StdOutputStream stream(m_itemsFile);
-    CryptoNote::BinaryOutputStreamSerializer archive(stream);
-    serialize(const_cast<T&>(item), archive);
+    m_itemsFile.seekp(m_itemsFileSize);
+    m_itemsFile.write(reinterpret_cast<const char*>(m_itemBuffer.data()), m_itemBuffer.size());
+    if (!m_itemsFile) {
+      throw std::runtime_error("SwappedVector::push_back");
+    }
 
-    itemsFileSize = m_itemsFile.tellp();
+    itemsFileSize = m_itemsFileSize + m_itemBuffer.size();
   }
 
   {
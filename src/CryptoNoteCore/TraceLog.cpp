@@ -0,0 +1,186 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "TraceLog.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Common/StringTools.h"
+
+namespace CryptoNote {
+
+namespace {
+
+const size_t RING_SIZE = 8192;
+
+const char* const TRACE_EVENT_NAMES[] = {
+  "block.received",
+  "block.parsed",
+  "block.pow_checked",
+  "block.inputs_verified",
+  "block.committed",
+  "block.relayed",
+  "tx.received",
+  "tx.parsed",
+  "tx.inputs_verified",
+  "tx.relayed"
+};
+
+struct TraceRecord {
+  uint64_t start;
+  uint64_t duration;
+  Crypto::Hash id;
+  TraceEvent event;
+};
+
+struct TraceRing {
+  std::array<TraceRecord, RING_SIZE> records;
+  // written only by the owning thread; records below head - RING_SIZE are overwritten
+  std::atomic<uint64_t> head;
+  std::atomic<uint64_t> clearedHead;
+  uint32_t thread;
+};
+
+std::atomic<bool> tracingEnabled(false);
+std::mutex ringsMutex;
+std::vector<std::shared_ptr<TraceRing>> rings;
+
+TraceRing& currentRing() {
+  thread_local std::shared_ptr<TraceRing> ring;
+  if (!ring) {
+    ring = std::make_shared<TraceRing>();
+    ring->head = 0;
+    ring->clearedHead = 0;
+
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    ring->thread = static_cast<uint32_t>(rings.size() + 1);
+    rings.push_back(ring);
+  }
+
+  return *ring;
+}
+
+std::vector<std::pair<uint32_t, TraceRecord>> collectRecords() {
+  std::vector<std::shared_ptr<TraceRing>> snapshot;
+  {
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    snapshot = rings;
+  }
+
+  std::vector<std::pair<uint32_t, TraceRecord>> result;
+  for (auto& ring : snapshot) {
+    uint64_t head = ring->head.load(std::memory_order_acquire);
+    uint64_t first = std::max(ring->clearedHead.load(), head > RING_SIZE ? head - RING_SIZE : 0);
+    size_t copiedFrom = result.size();
+    for (uint64_t i = first; i < head; ++i) {
+      result.emplace_back(ring->thread, ring->records[i % RING_SIZE]);
+    }
+
+    // drop whatever the owner overwrote while it was being copied, including the slot it may be writing now
+    uint64_t newHead = ring->head.load(std::memory_order_acquire);
+    if (newHead + 1 > first + RING_SIZE) {
+      size_t overwritten = static_cast<size_t>(std::min(newHead + 1 - RING_SIZE - first, head - first));
+      result.erase(result.begin() + copiedFrom, result.begin() + copiedFrom + overwritten);
+    }
+  }
+
+  std::sort(result.begin(), result.end(), [](const std::pair<uint32_t, TraceRecord>& a, const std::pair<uint32_t, TraceRecord>& b) {
+    return a.second.start < b.second.start;
+  });
+
+  return result;
+}
+
+void writeMicroseconds(std::ostream& stream, uint64_t nanoseconds) {
+  stream << nanoseconds / 1000 << '.' << std::setw(3) << std::setfill('0') << nanoseconds % 1000;
+}
+
+}
+
+void TraceLog::setEnabled(bool enabled) {
+  tracingEnabled.store(enabled);
+}
+
+bool TraceLog::isEnabled() {
+  return tracingEnabled.load(std::memory_order_relaxed);
+}
+
+uint64_t TraceLog::now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void TraceLog::record(TraceEvent event, const Crypto::Hash& id, uint64_t start, uint64_t end) {
+  TraceRing& ring = currentRing();
+  uint64_t head = ring.head.load(std::memory_order_relaxed);
+  TraceRecord& record = ring.records[head % RING_SIZE];
+  record.start = start;
+  record.duration = end - start;
+  record.id = id;
+  record.event = event;
+  ring.head.store(head + 1, std::memory_order_release);
+}
+
+void TraceLog::instant(TraceEvent event, const Crypto::Hash& id) {
+  if (isEnabled()) {
+    uint64_t timestamp = now();
+    record(event, id, timestamp, timestamp);
+  }
+}
+
+size_t TraceLog::dumpChromeTrace(std::ostream& stream) {
+  auto records = collectRecords();
+
+  stream << "{\"traceEvents\":[";
+  for (size_t i = 0; i < records.size(); ++i) {
+    const TraceRecord& record = records[i].second;
+    const char* name = TRACE_EVENT_NAMES[static_cast<size_t>(record.event)];
+    bool isBlock = record.event <= TraceEvent::BLOCK_RELAYED;
+
+    stream << (i == 0 ? "\n" : ",\n") << "{\"name\":\"" << name << "\",\"cat\":\"" << (isBlock ? "block" : "tx") << "\",\"ts\":";
+    writeMicroseconds(stream, record.start);
+    if (record.duration == 0) {
+      stream << ",\"ph\":\"i\",\"s\":\"t\"";
+    } else {
+      stream << ",\"ph\":\"X\",\"dur\":";
+      writeMicroseconds(stream, record.duration);
+    }
+
+    stream << ",\"pid\":1,\"tid\":" << records[i].first << ",\"args\":{\"id\":\"" << Common::podToHex(record.id) << "\"}}";
+  }
+
+  stream << "\n]}\n";
+  return records.size();
+}
+
+void TraceLog::clear() {
+  std::lock_guard<std::mutex> lock(ringsMutex);
+  for (auto& ring : rings) {
+    ring->clearedHead.store(ring->head.load());
+  }
+}
+
+TraceSpan::TraceSpan(TraceEvent event, const Crypto::Hash& id) : event(event), id(id), start(TraceLog::isEnabled() ? TraceLog::now() : 0) {
+}
+
+TraceSpan::~TraceSpan() {
+  finish();
+}
+
+void TraceSpan::finish() {
+  if (isActive()) {
+    // a span never has zero length, zero marks an instant event
+    TraceLog::record(event, id, start, std::max(TraceLog::now(), start + 1));
+    start = 0;
+  }
+}
+
+}
@@ -0,0 +1,74 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+#include "crypto/hash.h"
+
+namespace CryptoNote {
+
+// Lifecycle steps of blocks and transactions. Keep TRACE_EVENT_NAMES in TraceLog.cpp in the same order.
+enum class TraceEvent : uint8_t {
+  BLOCK_RECEIVED,
+  BLOCK_PARSED,
+  BLOCK_POW_CHECKED,
+  BLOCK_INPUTS_VERIFIED,
+  BLOCK_COMMITTED,
+  BLOCK_RELAYED,
+  TX_RECEIVED,
+  TX_PARSED,
+  TX_INPUTS_VERIFIED,
+  TX_RELAYED
+};
+
+// Binary event tracer. Every thread records fixed-size events into its own ring, the oldest events
+// being overwritten, so recording takes no lock. Disabled by default; when disabled a span costs a
+// single relaxed load. dumpChromeTrace() writes the events of all threads as Chrome trace JSON,
+// which chrome://tracing and Perfetto open directly.
+class TraceLog {
+public:
+  static void setEnabled(bool enabled);
+  static bool isEnabled();
+
+  // Steady clock, in nanoseconds.
+  static uint64_t now();
+  static void record(TraceEvent event, const Crypto::Hash& id, uint64_t start, uint64_t end);
+  static void instant(TraceEvent event, const Crypto::Hash& id);
+
+  // Returns the number of events written.
+  static size_t dumpChromeTrace(std::ostream& stream);
+  static void clear();
+};
+
+// Records the time between its construction and destruction. The id may be set once it is known,
+// e.g. after parsing.
+class TraceSpan {
+public:
+  TraceSpan(TraceEvent event, const Crypto::Hash& id = Crypto::Hash());
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+  ~TraceSpan();
+
+  bool isActive() const {
+    return start != 0;
+  }
+
+  void setId(const Crypto::Hash& id) {
+    this->id = id;
+  }
+
+  // Ends the span early; otherwise it ends when destroyed.
+  void finish();
+
+private:
+  TraceEvent event;
+  Crypto::Hash id;
+  uint64_t start;
+};
+
+}
@@ -0,0 +1,49 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "TransactionHashCache.h"
+
+namespace CryptoNote {
+
+TransactionHashCache::TransactionHashCache(size_t capacity, uint64_t lifetime) : m_capacity(capacity), m_lifetime(lifetime) {
+}
+
+void TransactionHashCache::add(const Crypto::Hash& hash, uint64_t now) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  auto inserted = m_hashes.emplace(hash, now);
+  if (!inserted.second) {
+    if (now - inserted.first->second < m_lifetime) {
+      return;
+    }
+
+    inserted.first->second = now;
+  }
+
+  m_order.emplace_back(hash, now);
+
+  while (!m_order.empty() && (m_hashes.size() > m_capacity || now - m_order.front().second >= m_lifetime)) {
+    auto it = m_hashes.find(m_order.front().first);
+    if (it != m_hashes.end() && it->second == m_order.front().second) {
+      m_hashes.erase(it);
+    }
+
+    m_order.pop_front();
+  }
+}
+
+bool TransactionHashCache::contains(const Crypto::Hash& hash, uint64_t now) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  auto it = m_hashes.find(hash);
+  return it != m_hashes.end() && now - it->second < m_lifetime;
+}
+
+size_t TransactionHashCache::size() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_hashes.size();
+}
+
+}
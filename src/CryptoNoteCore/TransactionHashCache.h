@@ -0,0 +1,38 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "crypto/hash.h"
+
+namespace CryptoNote {
+
+// Set of transaction hashes that forgets each hash `lifetime` seconds after it was added, and the oldest ones
+// once it holds more than `capacity`. Adding a hash that is still there changes nothing. Thread safe.
+class TransactionHashCache {
+public:
+  TransactionHashCache(size_t capacity, uint64_t lifetime);
+
+  void add(const Crypto::Hash& hash, uint64_t now);
+  bool contains(const Crypto::Hash& hash, uint64_t now) const;
+  size_t size() const;
+
+private:
+  mutable std::mutex m_mutex;
+  // hash -> time it was added; m_order also keeps the entries of hashes added again after they expired
+  std::unordered_map<Crypto::Hash, uint64_t> m_hashes;
+  std::deque<std::pair<Crypto::Hash, uint64_t>> m_order;
+  size_t m_capacity;
+  uint64_t m_lifetime;
+};
+
+}
@@ -15,6 +15,7 @@
 #include <boost/filesystem.hpp>
 
 #include "Common/int-util.h"
+#include "Common/Metrics.h"
 #include "Common/Util.h"
 #include "crypto/hash.h"
 
@@ -35,6 +36,27 @@ using namespace Logging;
 
 namespace CryptoNote {
 
+  namespace {
+
+    struct PoolMetrics {
+      Common::MetricGauge& transactions;
+      Common::MetricGauge& bytes;
+      Common::MetricHistogram& inputsVerificationTime;
+    };
+
+    PoolMetrics& poolMetrics() {
+      static PoolMetrics metrics = {
+        Common::Metrics::gauge("ultranote_txpool_transactions", "Transactions in the memory pool"),
+        Common::Metrics::gauge("ultranote_txpool_bytes", "Total blob size of the transactions in the memory pool"),
+        Common::Metrics::histogram("ultranote_tx_inputs_verification_seconds", "Time to verify the inputs of a transaction entering the memory pool",
+          Common::Metrics::latencyBuckets())
+      };
+
+      return metrics;
+    }
+
+  }
+
   //---------------------------------------------------------------------------------
   // BlockTemplate
   //---------------------------------------------------------------------------------
@@ -105,7 +127,11 @@ namespace CryptoNote {
     logger(log, "txpool") {
   }
   //---------------------------------------------------------------------------------
-  bool tx_memory_pool::add_tx(const Transaction &tx, /*const Crypto::Hash& tx_prefix_hash,*/ const Crypto::Hash &id, size_t blobSize, tx_verification_context& tvc, bool keptByBlock, uint32_t height) {
+  bool tx_memory_pool::add_tx(CachedTransaction&& transaction, tx_verification_context& tvc, bool keptByBlock, uint32_t height) {
+    const Transaction& tx = transaction.getTransaction();
+    const Crypto::Hash id = transaction.getTransactionHash();
+    const size_t blobSize = transaction.getTransactionBinarySize();
+
     if (!check_inputs_types_supported(tx)) {
       tvc.m_verifivation_failed = true;
       return false;
@@ -170,7 +196,9 @@ namespace CryptoNote {
     BlockInfo maxUsedBlock;
 
     // check inputs
-    bool inputsValid = m_validator.checkTransactionInputs(tx, maxUsedBlock);
+    Common::MetricTimer inputsTimer(poolMetrics().inputsVerificationTime);
+    bool inputsValid = m_validator.checkTransactionInputs(transaction, maxUsedBlock);
+    inputsTimer.finish();
 
     if (!inputsValid) {
       if (!keptByBlock) {
@@ -203,12 +231,11 @@ namespace CryptoNote {
     }
 
     // add to pool
+    tx_container_t::iterator pooled;
     {
       TransactionDetails txd;
 
-      txd.id = id;
-      txd.blobSize = blobSize;
-      txd.tx = tx;
+      txd.tx = std::move(transaction);
       txd.fee = fee;
       txd.keptByBlock = keptByBlock;
       txd.receiveTime = m_timeProvider.now();
@@ -221,8 +248,11 @@ namespace CryptoNote {
         logger(ERROR, BRIGHT_RED) << "transaction already exists at inserting in memory pool";
         return false;
       }
-      m_paymentIdIndex.add(txd.tx);
-      m_timestampIndex.add(txd.receiveTime, txd.id);
+      pooled = txd_p.first;
+      m_paymentIdIndex.add(pooled->tx.getTransaction());
+      m_timestampIndex.add(pooled->receiveTime, id);
+      poolMetrics().transactions.add(1);
+      poolMetrics().bytes.add(blobSize);
 
       if (ttl.ttl != 0) {
         m_ttlIndex.emplace(std::make_pair(id, ttl.ttl));
@@ -233,7 +263,7 @@ namespace CryptoNote {
     tvc.m_should_be_relayed = inputsValid && (fee > 0 || isFusionTransaction || ttl.ttl != 0);
     tvc.m_verifivation_failed = true;
 
-    if (!addTransactionInputs(id, tx, keptByBlock))
+    if (!addTransactionInputs(id, pooled->tx.getTransaction(), keptByBlock))
       return false;
 
     tvc.m_verifivation_failed = false;
@@ -243,13 +273,10 @@ namespace CryptoNote {
 
   //---------------------------------------------------------------------------------
   bool tx_memory_pool::add_tx(const Transaction &tx, tx_verification_context& tvc, bool keeped_by_block, uint32_t height) {
-    Crypto::Hash h = NULL_HASH;
-    size_t blobSize = 0;
-    getObjectHash(tx, h, blobSize);
-    return add_tx(tx, h, blobSize, tvc, keeped_by_block, height);
+    return add_tx(CachedTransaction(tx), tvc, keeped_by_block, height);
   }
   //---------------------------------------------------------------------------------
-  bool tx_memory_pool::take_tx(const Crypto::Hash &id, Transaction &tx, size_t& blobSize, uint64_t& fee) {
+  bool tx_memory_pool::take_tx(const Crypto::Hash &id, CachedTransaction& transaction, uint64_t& fee) {
     std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
     auto it = m_transactions.find(id);
     if (it == m_transactions.end()) {
@@ -258,8 +285,7 @@ namespace CryptoNote {
 
     auto& txd = *it;
 
-    tx = txd.tx;
-    blobSize = txd.blobSize;
+    transaction = txd.tx;
     fee = txd.fee;
 
     removeTransaction(it);
@@ -274,7 +300,7 @@ namespace CryptoNote {
   void tx_memory_pool::get_transactions(std::list<Transaction>& txs) const {
     std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
     for (const auto& tx_vt : m_transactions) {
-      txs.push_back(tx_vt.tx);
+      txs.push_back(tx_vt.tx.getTransaction());
     }
   }
   //---------------------------------------------------------------------------------
@@ -284,7 +310,7 @@ namespace CryptoNote {
     for (const auto& tx : m_transactions) {
       TransactionCheckInfo checkInfo(tx);
       if (is_transaction_ready_to_go(tx.tx, checkInfo)) {
-        ready_tx_ids.insert(tx.id);
+        ready_tx_ids.insert(tx.getId());
       }
     }
 
@@ -320,6 +346,21 @@ namespace CryptoNote {
     return false;
   }
   //---------------------------------------------------------------------------------
+  void tx_memory_pool::getTransactionBlobs(const std::vector<Crypto::Hash>& txsIds, std::vector<BinaryArray>& txs, std::vector<Crypto::Hash>& missedTxs) const {
+    std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
+
+    for (const auto& id : txsIds) {
+      auto it = m_transactions.find(id);
+      if (it == m_transactions.end()) {
+        missedTxs.push_back(id);
+      } else if (it->tx.hasTransactionBinaryArray()) {
+        txs.push_back(it->tx.getTransactionBinaryArray());
+      } else {
+        txs.push_back(toBinaryArray(it->tx.getTransaction()));
+      }
+    }
+  }
+  //---------------------------------------------------------------------------------
   void tx_memory_pool::lock() const {
     m_transactions_lock.lock();
   }
@@ -333,13 +374,13 @@ namespace CryptoNote {
   }
 
   //---------------------------------------------------------------------------------
-  bool tx_memory_pool::is_transaction_ready_to_go(const Transaction& tx, TransactionCheckInfo& txd) const {
+  bool tx_memory_pool::is_transaction_ready_to_go(const CachedTransaction& transaction, TransactionCheckInfo& txd) const {
 
-    if (!m_validator.checkTransactionInputs(tx, txd.maxUsedBlock, txd.lastFailedBlock))
+    if (!m_validator.checkTransactionInputs(transaction, txd.maxUsedBlock, txd.lastFailedBlock))
       return false;
 
     //if we here, transaction seems valid, but, anyway, check for key_images collisions with blockchain, just to be sure
-    if (m_validator.haveSpentKeyImages(tx))
+    if (m_validator.haveSpentKeyImages(transaction.getTransaction()))
       return false;
 
     //transaction is ok.
@@ -350,13 +391,13 @@ namespace CryptoNote {
     std::stringstream ss;
     std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
     for (const auto& txd : m_fee_index) {
-      ss << "id: " << txd.id << std::endl;
+      ss << "id: " << txd.getId() << std::endl;
       
       if (!short_format) {
-        ss << storeToJson(txd.tx) << std::endl;
+        ss << storeToJson(txd.tx.getTransaction()) << std::endl;
       }
 
-      ss << "blobSize: " << txd.blobSize << std::endl
+      ss << "blobSize: " << txd.getBlobSize() << std::endl
         << "fee: " << m_currency.formatAmount(txd.fee) << std::endl
         << "keptByBlock: " << (txd.keptByBlock ? 'T' : 'F') << std::endl
         << "max_used_block_height: " << txd.maxUsedBlock.height << std::endl
@@ -365,7 +406,7 @@ namespace CryptoNote {
         << "last_failed_id: " << txd.lastFailedBlock.id << std::endl
         << "received: " << std::ctime(&txd.receiveTime);
 
-      auto ttlIt = m_ttlIndex.find(txd.id);
+      auto ttlIt = m_ttlIndex.find(txd.getId());
       if (ttlIt != m_ttlIndex.end()) {
         // ctime() returns string that ends with new line
         ss << "TTL: " << std::ctime(reinterpret_cast<const time_t*>(&ttlIt->second));
@@ -392,29 +433,29 @@ namespace CryptoNote {
     for (auto it = m_fee_index.rbegin(); it != m_fee_index.rend() && it->fee == 0; ++it) {
       const auto& txd = *it;
 
-      if (m_ttlIndex.count(txd.id) > 0) {
+      if (m_ttlIndex.count(txd.getId()) > 0) {
         continue;
       }
 
-      if (m_currency.fusionTxMaxSize() < total_size + txd.blobSize) {
+      if (m_currency.fusionTxMaxSize() < total_size + txd.getBlobSize()) {
         continue;
       }
 
       TransactionCheckInfo checkInfo(txd);
-      if (is_transaction_ready_to_go(txd.tx, checkInfo) && blockTemplate.addTransaction(txd.id, txd.tx)) {
-        total_size += txd.blobSize;
+      if (is_transaction_ready_to_go(txd.tx, checkInfo) && blockTemplate.addTransaction(txd.getId(), txd.tx.getTransaction())) {
+        total_size += txd.getBlobSize();
       }
     }
 
     for (auto i = m_fee_index.begin(); i != m_fee_index.end(); ++i) {
       const auto& txd = *i;
 
-      if (m_ttlIndex.count(txd.id) > 0) {
+      if (m_ttlIndex.count(txd.getId()) > 0) {
         continue;
       }
 
       size_t blockSizeLimit = (txd.fee == 0) ? median_size : max_total_size;
-      if (blockSizeLimit < total_size + txd.blobSize) {
+      if (blockSizeLimit < total_size + txd.getBlobSize()) {
         continue;
       }
 
@@ -426,8 +467,8 @@ namespace CryptoNote {
         item = checkInfo;
       });
 
-      if (ready && blockTemplate.addTransaction(txd.id, txd.tx)) {
-        total_size += txd.blobSize;
+      if (ready && blockTemplate.addTransaction(txd.getId(), txd.tx.getTransaction())) {
+        total_size += txd.getBlobSize();
         fee += txd.fee;
       }
     }
@@ -488,8 +529,11 @@ namespace CryptoNote {
 #define CURRENT_MEMPOOL_ARCHIVE_VER 1
 
   void serialize(CryptoNote::tx_memory_pool::TransactionDetails& td, ISerializer& s) {
-    s(td.id, "id");
-    s(td.blobSize, "blobSize");
+    // id and blobSize stay in the file for compatibility, but loading works them out from the transaction
+    Crypto::Hash id = td.getId();
+    size_t blobSize = td.getBlobSize();
+    s(id, "id");
+    s(blobSize, "blobSize");
     s(td.fee, "fee");
     s(td.tx, "tx");
     s(td.maxUsedBlock.height, "maxUsedBlock.height");
@@ -551,17 +595,17 @@ namespace CryptoNote {
         uint64_t txAge = now - it->receiveTime;
         bool remove = txAge > (it->keptByBlock ? m_currency.mempoolTxFromAltBlockLiveTime() : m_currency.mempoolTxLiveTime());
 
-        auto ttlIt = m_ttlIndex.find(it->id);
+        auto ttlIt = m_ttlIndex.find(it->getId());
         bool ttlExpired = (ttlIt != m_ttlIndex.end() && ttlIt->second <= now);
 
         if (remove || ttlExpired) {
           if (ttlExpired) {
-            logger(TRACE) << "Tx " << it->id << " removed from tx pool due to expired TTL, TTL : " << ttlIt->second;
+            logger(TRACE) << "Tx " << it->getId() << " removed from tx pool due to expired TTL, TTL : " << ttlIt->second;
           } else {
-            logger(TRACE) << "Tx " << it->id << " removed from tx pool due to outdated, age: " << txAge;
+            logger(TRACE) << "Tx " << it->getId() << " removed from tx pool due to outdated, age: " << txAge;
           }
 
-          m_recentlyDeletedTransactions.emplace(it->id, now);
+          m_recentlyDeletedTransactions.emplace(it->getId(), now);
           it = removeTransaction(it);
           somethingRemoved = true;
         } else {
@@ -578,10 +622,12 @@ namespace CryptoNote {
   }
 
   tx_memory_pool::tx_container_t::iterator tx_memory_pool::removeTransaction(tx_memory_pool::tx_container_t::iterator i) {
-    removeTransactionInputs(i->id, i->tx, i->keptByBlock);
-    m_paymentIdIndex.remove(i->tx);
-    m_timestampIndex.remove(i->receiveTime, i->id);
-    m_ttlIndex.erase(i->id);
+    removeTransactionInputs(i->getId(), i->tx.getTransaction(), i->keptByBlock);
+    m_paymentIdIndex.remove(i->tx.getTransaction());
+    m_timestampIndex.remove(i->receiveTime, i->getId());
+    m_ttlIndex.erase(i->getId());
+    poolMetrics().transactions.add(-1);
+    poolMetrics().bytes.add(-static_cast<int64_t>(i->getBlobSize()));
     return m_transactions.erase(i);
   }
 
@@ -677,19 +723,24 @@ namespace CryptoNote {
 
   void tx_memory_pool::buildIndices() {
     std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
+    int64_t poolBytes = 0;
     for (auto it = m_transactions.begin(); it != m_transactions.end(); it++) {
-      m_paymentIdIndex.add(it->tx);
-      m_timestampIndex.add(it->receiveTime, it->id);
+      m_paymentIdIndex.add(it->tx.getTransaction());
+      m_timestampIndex.add(it->receiveTime, it->getId());
+      poolBytes += it->getBlobSize();
 
       std::vector<TransactionExtraField> txExtraFields;
-      parseTransactionExtra(it->tx.extra, txExtraFields);
+      parseTransactionExtra(it->tx.getTransaction().extra, txExtraFields);
       TransactionExtraTTL ttl;
       if (findTransactionExtraFieldByType(txExtraFields, ttl)) {
         if (ttl.ttl != 0) {
-          m_ttlIndex.emplace(std::make_pair(it->id, ttl.ttl));
+          m_ttlIndex.emplace(std::make_pair(it->getId(), ttl.ttl));
         }
       }
     }
+
+    poolMetrics().transactions.set(static_cast<int64_t>(m_transactions.size()));
+    poolMetrics().bytes.set(poolBytes);
   }
 
   bool tx_memory_pool::getTransactionIdsByPaymentId(const Crypto::Hash& paymentId, std::vector<Crypto::Hash>& transactionIds) {
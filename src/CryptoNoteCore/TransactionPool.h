@@ -18,6 +18,7 @@
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index/member.hpp>
+#include <boost/multi_index/mem_fun.hpp>
 
 #include "Common/Util.h"
 #include "Common/int-util.h"
@@ -32,6 +33,7 @@
 #include "CryptoNoteCore/ITxPoolObserver.h"
 #include "CryptoNoteCore/VerificationContext.h"
 #include "CryptoNoteCore/BlockchainIndices.h"
+#include "CryptoNoteCore/CachedTransaction.h"
 
 #include <Logging/LoggerRef.h>
 
@@ -87,10 +89,10 @@ namespace CryptoNote {
     bool deinit();
 
     bool have_tx(const Crypto::Hash &id) const;
-    bool add_tx(const Transaction &tx, const Crypto::Hash &id, size_t blobSize, tx_verification_context& tvc, bool keeped_by_block, uint32_t height);
+    bool add_tx(CachedTransaction&& transaction, tx_verification_context& tvc, bool keeped_by_block, uint32_t height);
     bool add_tx(const Transaction &tx, tx_verification_context& tvc, bool keeped_by_block, uint32_t height);
     //gets tx and remove it from pool
-    bool take_tx(const Crypto::Hash &id, Transaction &tx, size_t& blobSize, uint64_t& fee);
+    bool take_tx(const Crypto::Hash &id, CachedTransaction& transaction, uint64_t& fee);
 
     bool on_blockchain_inc(uint64_t new_block_height, const Crypto::Hash& top_block_id);
     bool on_blockchain_dec(uint64_t new_block_height, const Crypto::Hash& top_block_id);
@@ -102,6 +104,7 @@ namespace CryptoNote {
     bool fill_block_template(Block &bl, size_t median_size, size_t maxCumulativeSize, uint64_t already_generated_coins, size_t &total_size, uint64_t &fee);
 
     void get_transactions(std::list<Transaction>& txs) const;
+    void getTransactionBlobs(const std::vector<Crypto::Hash>& txsIds, std::vector<BinaryArray>& txs, std::vector<Crypto::Hash>& missedTxs) const;
     void get_difference(const std::vector<Crypto::Hash>& known_tx_ids, std::vector<Crypto::Hash>& new_tx_ids, std::vector<Crypto::Hash>& deleted_tx_ids) const;
     size_t get_transactions_count() const;
     std::string print_pool(bool short_format) const;
@@ -119,7 +122,7 @@ namespace CryptoNote {
         if (it == m_transactions.end()) {
           missedTxs.push_back(id);
         } else {
-          txs.push_back(it->tx);
+          txs.push_back(it->tx.getTransaction());
         }
       }
     }
@@ -132,12 +135,13 @@ namespace CryptoNote {
     };
 
     struct TransactionDetails : public TransactionCheckInfo {
-      Crypto::Hash id;
-      Transaction tx;
-      size_t blobSize;
+      CachedTransaction tx;
       uint64_t fee;
       bool keptByBlock;
       time_t receiveTime;
+
+      const Crypto::Hash& getId() const { return tx.getTransactionHash(); }
+      size_t getBlobSize() const { return tx.getTransactionBinarySize(); }
     };
 
   private:
@@ -149,21 +153,21 @@ namespace CryptoNote {
         // price(lhs) > price(rhs) -->
         // lhs.fee / lhs.blobSize > rhs.fee / rhs.blobSize -->
         // lhs.fee * rhs.blobSize > rhs.fee * lhs.blobSize
-        uint64_t lhs_hi, lhs_lo = mul128(lhs.fee, rhs.blobSize, &lhs_hi);
-        uint64_t rhs_hi, rhs_lo = mul128(rhs.fee, lhs.blobSize, &rhs_hi);
+        uint64_t lhs_hi, lhs_lo = mul128(lhs.fee, rhs.getBlobSize(), &lhs_hi);
+        uint64_t rhs_hi, rhs_lo = mul128(rhs.fee, lhs.getBlobSize(), &rhs_hi);
 
         return
           // prefer more profitable transactions
           (lhs_hi >  rhs_hi) ||
           (lhs_hi == rhs_hi && lhs_lo >  rhs_lo) ||
           // prefer smaller
-          (lhs_hi == rhs_hi && lhs_lo == rhs_lo && lhs.blobSize <  rhs.blobSize) ||
+          (lhs_hi == rhs_hi && lhs_lo == rhs_lo && lhs.getBlobSize() <  rhs.getBlobSize()) ||
           // prefer older
-          (lhs_hi == rhs_hi && lhs_lo == rhs_lo && lhs.blobSize == rhs.blobSize && lhs.receiveTime < rhs.receiveTime);
+          (lhs_hi == rhs_hi && lhs_lo == rhs_lo && lhs.getBlobSize() == rhs.getBlobSize() && lhs.receiveTime < rhs.receiveTime);
       }
     };
 
-    typedef hashed_unique<BOOST_MULTI_INDEX_MEMBER(TransactionDetails, Crypto::Hash, id)> main_index_t;
+    typedef hashed_unique<BOOST_MULTI_INDEX_CONST_MEM_FUN(TransactionDetails, const Crypto::Hash&, getId)> main_index_t;
     typedef ordered_non_unique<boost::multi_index::identity<TransactionDetails>, TransactionPriorityComparator> fee_index_t;
 
     typedef multi_index_container<TransactionDetails,
@@ -182,7 +186,7 @@ namespace CryptoNote {
 
     tx_container_t::iterator removeTransaction(tx_container_t::iterator i);
     bool removeExpiredTransactions();
-    bool is_transaction_ready_to_go(const Transaction& tx, TransactionCheckInfo& txd) const;
+    bool is_transaction_ready_to_go(const CachedTransaction& transaction, TransactionCheckInfo& txd) const;
 
     void buildIndices();
 
@@ -0,0 +1,195 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "TransactionView.h"
+
+#include "BinaryCodec.h"
+#include "CryptoNoteConfig.h"
+#include "crypto/hash.h"
+
+namespace CryptoNote {
+
+namespace {
+
+// tags of BinaryVariantTagGetter in CryptoNoteSerialization.cpp
+const uint8_t BASE_INPUT_TAG = 0xff;
+const uint8_t KEY_TAG = 0x2;
+const uint8_t MULTISIGNATURE_TAG = 0x3;
+
+template<typename T>
+Common::ArrayView<T> readArray(BinaryDecoder& decoder, size_t count) {
+  if (count > decoder.remaining() / sizeof(T)) {
+    throw std::runtime_error("BinaryDecoder: unexpected end of data");
+  }
+
+  return Common::ArrayView<T>(reinterpret_cast<const T*>(decoder.skip(count * sizeof(T))), count);
+}
+
+}
+
+TransactionView::TransactionView() {
+  clear();
+}
+
+void TransactionView::clear() {
+  m_blob = nullptr;
+  m_blobSize = 0;
+  m_prefixSize = 0;
+  m_version = 0;
+  m_unlockTime = 0;
+  m_inputs.clear();
+  m_outputs.clear();
+  m_extra = Common::ArrayView<uint8_t>::NIL;
+  m_outputIndexes.clear();
+  m_outputIndexCounts.clear();
+}
+
+bool TransactionView::parse(const BinaryArray& blob) {
+  clear();
+
+  try {
+    BinaryDecoder decoder(blob.data(), blob.size());
+    decode(decoder, m_version);
+    decode(decoder, m_unlockTime);
+
+    m_inputs.resize(decoder.readCount());
+    for (Input& input : m_inputs) {
+      input = Input();
+      switch (decoder.readByte()) {
+      case BASE_INPUT_TAG:
+        input.type = TransactionTypes::InputType::Generating;
+        decode(decoder, input.blockIndex);
+        break;
+      case KEY_TAG: {
+        input.type = TransactionTypes::InputType::Key;
+        decode(decoder, input.amount);
+        size_t count = decoder.readCount();
+        for (size_t i = 0; i < count; ++i) {
+          m_outputIndexes.push_back(decoder.readVarint<uint32_t>());
+        }
+
+        m_outputIndexCounts.push_back(count);
+        input.keyImage = reinterpret_cast<const Crypto::KeyImage*>(decoder.skip(sizeof(Crypto::KeyImage)));
+        break;
+      }
+      case MULTISIGNATURE_TAG:
+        input.type = TransactionTypes::InputType::Multisignature;
+        decode(decoder, input.amount);
+        decode(decoder, input.signatureCount);
+        decode(decoder, input.outputIndex);
+        decode(decoder, input.term);
+        break;
+      default:
+        throw std::runtime_error("Unknown variant tag");
+      }
+    }
+
+    m_outputs.resize(decoder.readCount());
+    for (Output& output : m_outputs) {
+      output = Output();
+      decode(decoder, output.amount);
+      switch (decoder.readByte()) {
+      case KEY_TAG:
+        output.type = TransactionTypes::OutputType::Key;
+        output.keys = readArray<Crypto::PublicKey>(decoder, 1);
+        break;
+      case MULTISIGNATURE_TAG:
+        output.type = TransactionTypes::OutputType::Multisignature;
+        output.keys = readArray<Crypto::PublicKey>(decoder, decoder.readCount());
+        decode(decoder, output.requiredSignatureCount);
+        decode(decoder, output.term);
+        break;
+      default:
+        throw std::runtime_error("Unknown variant tag");
+      }
+    }
+
+    m_extra = readArray<uint8_t>(decoder, decoder.readCount());
+    m_prefixSize = decoder.position();
+
+    if (TRANSACTION_VERSION_2 < m_version) {
+      throw std::runtime_error("Wrong transaction version");
+    }
+
+    // m_outputIndexes is complete, so key inputs can point into it now
+    size_t keyInput = 0;
+    size_t outputIndexesOffset = 0;
+    for (Input& input : m_inputs) {
+      size_t signatureCount = 0;
+      if (input.type == TransactionTypes::InputType::Key) {
+        signatureCount = m_outputIndexCounts[keyInput++];
+        input.outputIndexes = Common::ArrayView<uint32_t>(m_outputIndexes.data() + outputIndexesOffset, signatureCount);
+        outputIndexesOffset += signatureCount;
+      } else if (input.type == TransactionTypes::InputType::Multisignature) {
+        signatureCount = input.signatureCount;
+      }
+
+      input.signatures = readArray<Crypto::Signature>(decoder, signatureCount);
+    }
+
+    if (decoder.remaining() != 0) {
+      throw std::runtime_error("Unexpected data after transaction");
+    }
+  } catch (std::exception&) {
+    clear();
+    return false;
+  }
+
+  m_blob = blob.data();
+  m_blobSize = blob.size();
+  return true;
+}
+
+Crypto::Hash TransactionView::getHash() const {
+  return Crypto::cn_fast_hash(m_blob, m_blobSize);
+}
+
+Crypto::Hash TransactionView::getPrefixHash() const {
+  // the view only accepts canonical encodings, so the prefix bytes are what serializing the prefix would give
+  return Crypto::cn_fast_hash(m_blob, m_prefixSize);
+}
+
+void TransactionView::toTransaction(Transaction& transaction) const {
+  transaction.version = m_version;
+  transaction.unlockTime = m_unlockTime;
+
+  transaction.inputs.clear();
+  transaction.inputs.reserve(m_inputs.size());
+  transaction.signatures.clear();
+  transaction.signatures.reserve(m_inputs.size());
+  for (const Input& input : m_inputs) {
+    if (input.type == TransactionTypes::InputType::Generating) {
+      transaction.inputs.emplace_back(BaseInput{ input.blockIndex });
+    } else if (input.type == TransactionTypes::InputType::Key) {
+      KeyInput key;
+      key.amount = input.amount;
+      key.outputIndexes.assign(input.outputIndexes.begin(), input.outputIndexes.end());
+      key.keyImage = *input.keyImage;
+      transaction.inputs.emplace_back(std::move(key));
+    } else {
+      transaction.inputs.emplace_back(MultisignatureInput{ input.amount, input.signatureCount, input.outputIndex, input.term });
+    }
+
+    transaction.signatures.emplace_back(input.signatures.begin(), input.signatures.end());
+  }
+
+  transaction.outputs.clear();
+  transaction.outputs.reserve(m_outputs.size());
+  for (const Output& output : m_outputs) {
+    if (output.type == TransactionTypes::OutputType::Key) {
+      transaction.outputs.push_back({ output.amount, KeyOutput{ output.keys[0] } });
+    } else {
+      MultisignatureOutput multisignature;
+      multisignature.keys.assign(output.keys.begin(), output.keys.end());
+      multisignature.requiredSignatureCount = output.requiredSignatureCount;
+      multisignature.term = output.term;
+      transaction.outputs.push_back({ output.amount, std::move(multisignature) });
+    }
+  }
+
+  transaction.extra.assign(m_extra.begin(), m_extra.end());
+}
+
+}
@@ -0,0 +1,76 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <vector>
+
+#include "Common/ArrayView.h"
+#include "CryptoNoteCore/CryptoNoteBasic.h"
+#include "ITransaction.h"
+
+namespace CryptoNote {
+
+// Read-only transaction parsed in place over its blob. Key images, keys, signatures and extra point into the blob,
+// which must outlive the view; only the decoded output indexes are copied, into storage owned by the view.
+// Parsing again reuses that storage, so a long lived view stops allocating once it has seen its largest transaction.
+class TransactionView {
+public:
+  struct Input {
+    TransactionTypes::InputType type;
+    uint64_t amount;
+    uint32_t blockIndex;
+    const Crypto::KeyImage* keyImage;
+    Common::ArrayView<uint32_t> outputIndexes;
+    uint8_t signatureCount;
+    uint32_t outputIndex;
+    uint32_t term;
+    Common::ArrayView<Crypto::Signature> signatures;
+  };
+
+  struct Output {
+    uint64_t amount;
+    TransactionTypes::OutputType type;
+    // a single key for a key output
+    Common::ArrayView<Crypto::PublicKey> keys;
+    uint8_t requiredSignatureCount;
+    uint32_t term;
+  };
+
+  TransactionView();
+
+  // Accepts exactly what parseAndValidateTransactionFromBinaryArray does. On failure the view is left empty.
+  bool parse(const BinaryArray& blob);
+
+  uint8_t getVersion() const { return m_version; }
+  uint64_t getUnlockTime() const { return m_unlockTime; }
+  const std::vector<Input>& getInputs() const { return m_inputs; }
+  const std::vector<Output>& getOutputs() const { return m_outputs; }
+  Common::ArrayView<uint8_t> getExtra() const { return m_extra; }
+  size_t getBlobSize() const { return m_blobSize; }
+  Common::ArrayView<uint8_t> getBlob() const { return Common::ArrayView<uint8_t>(m_blob, m_blobSize); }
+
+  Crypto::Hash getHash() const;
+  Crypto::Hash getPrefixHash() const;
+
+  void toTransaction(Transaction& transaction) const;
+
+private:
+  void clear();
+
+  const uint8_t* m_blob;
+  size_t m_blobSize;
+  size_t m_prefixSize;
+  uint8_t m_version;
+  uint64_t m_unlockTime;
+  std::vector<Input> m_inputs;
+  std::vector<Output> m_outputs;
+  Common::ArrayView<uint8_t> m_extra;
+  // output indexes of all key inputs, one after another, and how many each input has
+  std::vector<uint32_t> m_outputIndexes;
+  std::vector<size_t> m_outputIndexCounts;
+};
+
+}
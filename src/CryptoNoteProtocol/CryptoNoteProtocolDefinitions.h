@@ -14,6 +14,7 @@
 #include "Serialization/ISerializer.h"
 #include "Serialization/SerializationOverloads.h"
 #include "CryptoNoteCore/CryptoNoteSerialization.h"
+#include "CryptoNoteCore/BinaryCodec.h"
 
 namespace CryptoNote
 {
@@ -33,6 +34,15 @@ namespace CryptoNote
       KV_MEMBER(txs);
     }
 
+    void decode(BinaryDecoder& decoder) {
+      CryptoNote::decode(decoder, block);
+      CryptoNote::decode(decoder, txs);
+    }
+
+    void encode(BinaryEncoder& encoder) const {
+      CryptoNote::encode(encoder, block);
+      CryptoNote::encode(encoder, txs);
+    }
   };
 
   struct BlockFullInfo : public block_complete_entry
@@ -184,6 +194,148 @@ namespace CryptoNote
     typedef NOTIFY_RESPONSE_CHAIN_ENTRY_request request;
   };
 
+  /************************************************************************/
+  /*                                                                      */
+  /************************************************************************/
+  // Only sent to peers advertising P2P_CAPABILITY_BLOCKS_BY_RANGE. Asks for the main chain blocks from start_height on,
+  // provided the peer's block at start_height - 1 is anchor_id, so the requester needs no list of their ids.
+  struct NOTIFY_REQUEST_BLOCKS_BY_RANGE_request {
+    Crypto::Hash anchor_id;
+    uint32_t start_height;
+    uint32_t count;
+
+    void serialize(ISerializer& s) {
+      KV_MEMBER(anchor_id)
+      KV_MEMBER(start_height)
+      KV_MEMBER(count)
+    }
+  };
+
+  struct NOTIFY_REQUEST_BLOCKS_BY_RANGE {
+    const static int ID = BC_COMMANDS_POOL_BASE + 9;
+    typedef NOTIFY_REQUEST_BLOCKS_BY_RANGE_request request;
+  };
+
+  // blocks is a std::vector<block_complete_entry> in the BinaryCodec format, packed into one blob instead of a KV array
+  // of sections; it is empty when anchor_found is false, that is when the anchor is no longer on the main chain.
+  struct NOTIFY_RESPONSE_BLOCKS_BY_RANGE_request {
+    uint32_t start_height;
+    uint32_t current_blockchain_height;
+    bool anchor_found;
+    std::string blocks;
+
+    void serialize(ISerializer& s) {
+      KV_MEMBER(start_height)
+      KV_MEMBER(current_blockchain_height)
+      KV_MEMBER(anchor_found)
+      s.binary(blocks, "blocks");
+    }
+  };
+
+  struct NOTIFY_RESPONSE_BLOCKS_BY_RANGE {
+    const static int ID = BC_COMMANDS_POOL_BASE + 10;
+    typedef NOTIFY_RESPONSE_BLOCKS_BY_RANGE_request request;
+  };
+
+  /************************************************************************/
+  /*                                                                      */
+  /************************************************************************/
+  // NOTIFY_NEW_BLOCK for peers advertising P2P_CAPABILITY_COMPACT_BLOCKS: the block blob alone, that is the header, the
+  // coinbase and the transaction ids. The receiver takes the transactions from its pool and asks for the ones it lacks
+  // with NOTIFY_REQUEST_BLOCK_TXS.
+  struct NOTIFY_NEW_COMPACT_BLOCK_request {
+    std::string block;
+    uint32_t current_blockchain_height;
+    uint32_t hop;
+
+    void serialize(ISerializer& s) {
+      KV_MEMBER(block)
+      KV_MEMBER(current_blockchain_height)
+      KV_MEMBER(hop)
+    }
+  };
+
+  struct NOTIFY_NEW_COMPACT_BLOCK {
+    const static int ID = BC_COMMANDS_POOL_BASE + 11;
+    typedef NOTIFY_NEW_COMPACT_BLOCK_request request;
+  };
+
+  struct NOTIFY_REQUEST_BLOCK_TXS_request {
+    Crypto::Hash block_id;
+    std::vector<Crypto::Hash> txs;
+
+    void serialize(ISerializer& s) {
+      KV_MEMBER(block_id)
+      serializeAsBinary(txs, "txs", s);
+    }
+  };
+
+  struct NOTIFY_REQUEST_BLOCK_TXS {
+    const static int ID = BC_COMMANDS_POOL_BASE + 12;
+    typedef NOTIFY_REQUEST_BLOCK_TXS_request request;
+  };
+
+  // txs are in the order they were requested in, and empty if the peer no longer has the block in its main chain.
+  struct NOTIFY_RESPONSE_BLOCK_TXS_request {
+    Crypto::Hash block_id;
+    std::vector<std::string> txs;
+
+    void serialize(ISerializer& s) {
+      KV_MEMBER(block_id)
+      KV_MEMBER(txs)
+    }
+  };
+
+  struct NOTIFY_RESPONSE_BLOCK_TXS {
+    const static int ID = BC_COMMANDS_POOL_BASE + 13;
+    typedef NOTIFY_RESPONSE_BLOCK_TXS_request request;
+  };
+
+  /************************************************************************/
+  /*                                                                      */
+  /************************************************************************/
+  // Ids of new transactions, sent in batches to peers advertising P2P_CAPABILITY_TX_INVENTORY instead of the
+  // transactions themselves. The receiver asks for the ones it doesn't know with NOTIFY_REQUEST_TXS and gets
+  // them in a NOTIFY_NEW_TRANSACTIONS, and the ids of those no longer in the pool in a NOTIFY_TXS_NOT_FOUND.
+  struct NOTIFY_TX_INVENTORY_request {
+    std::vector<Crypto::Hash> txs;
+
+    void serialize(ISerializer& s) {
+      serializeAsBinary(txs, "txs", s);
+    }
+  };
+
+  struct NOTIFY_TX_INVENTORY {
+    const static int ID = BC_COMMANDS_POOL_BASE + 14;
+    typedef NOTIFY_TX_INVENTORY_request request;
+  };
+
+  struct NOTIFY_REQUEST_TXS_request {
+    std::vector<Crypto::Hash> txs;
+
+    void serialize(ISerializer& s) {
+      serializeAsBinary(txs, "txs", s);
+    }
+  };
+
+  struct NOTIFY_REQUEST_TXS {
+    const static int ID = BC_COMMANDS_POOL_BASE + 15;
+    typedef NOTIFY_REQUEST_TXS_request request;
+  };
+
+  struct NOTIFY_TXS_NOT_FOUND_request {
+    std::vector<Crypto::Hash> txs;
+
+    void serialize(ISerializer& s) {
+      serializeAsBinary(txs, "txs", s);
+    }
+  };
+
+  struct NOTIFY_TXS_NOT_FOUND {
+    const static int ID = BC_COMMANDS_POOL_BASE + 16;
+    typedef NOTIFY_TXS_NOT_FOUND_request request;
+  };
+
   /************************************************************************/
   /*                                                                      */
   /************************************************************************/
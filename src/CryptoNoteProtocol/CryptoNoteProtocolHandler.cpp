@@ -7,15 +7,24 @@
 
 #include "CryptoNoteProtocolHandler.h"
 
+#include <algorithm>
+#include <cassert>
 #include <future>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include <boost/scope_exit.hpp>
 #include <boost/uuid/uuid_io.hpp>
 #include <System/Dispatcher.h>
+#include <System/DispatcherPool.h>
 
+#include "Common/Metrics.h"
 #include "CryptoNoteCore/CryptoNoteBasicImpl.h"
 #include "CryptoNoteCore/CryptoNoteFormatUtils.h"
 #include "CryptoNoteCore/CryptoNoteTools.h"
 #include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/TraceLog.h"
 #include "CryptoNoteCore/VerificationContext.h"
 #include "P2p/LevinProtocol.h"
 
@@ -31,9 +40,24 @@ bool post_notify(IP2pEndpoint& p2p, typename t_parametr::request& arg, const Cry
   return p2p.invoke_notify_to_peer(t_parametr::ID, LevinProtocol::encode(arg), context);
 }
 
-template<class t_parametr>
-void relay_post_notify(IP2pEndpoint& p2p, typename t_parametr::request& arg, const net_connection_id* excludeConnection = nullptr) {
-  p2p.relay_notify_to_all(t_parametr::ID, LevinProtocol::encode(arg), excludeConnection);
+// The strike counts against the peer's score, so it is not connected to again soon. Only for data that is malformed
+// or wasn't asked for: a peer on another chain or with another pool can fail verification honestly, and is just
+// disconnected.
+void dropForInvalidData(CryptoNoteConnectionContext& context) {
+  context.m_peer_score.addStrike(time(nullptr));
+  context.m_state = CryptoNoteConnectionContext::state_shutdown;
+}
+
+// Times the response to the block request in flight, if there is one.
+void addBlockDelivery(CryptoNoteConnectionContext& context, uint64_t bytes) {
+  auto now = std::chrono::steady_clock::now();
+  if (context.m_blocks_requested_at != std::chrono::steady_clock::time_point()) {
+    context.m_peer_score.addBlockDelivery(static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(now - context.m_blocks_requested_at).count()), bytes);
+    context.m_blocks_requested_at = std::chrono::steady_clock::time_point();
+  }
+
+  context.m_sync_progress_at = now;
 }
 
 }
@@ -43,6 +67,7 @@ CryptoNoteProtocolHandler::CryptoNoteProtocolHandler(const Currency& currency, S
   m_currency(currency),
   m_core(rcore),
   m_p2p(p_net_layout),
+  m_coreDispatchers(nullptr),
   m_synchronized(false),
   m_stop(false),
   m_observedHeight(0),
@@ -58,6 +83,10 @@ size_t CryptoNoteProtocolHandler::getPeerCount() const {
   return m_peersCount;
 }
 
+void CryptoNoteProtocolHandler::setCoreDispatchers(System::DispatcherPool* dispatchers) {
+  m_coreDispatchers = dispatchers;
+}
+
 void CryptoNoteProtocolHandler::set_p2p_endpoint(IP2pEndpoint* p2p) {
   if (p2p)
     m_p2p = p2p;
@@ -99,6 +128,7 @@ bool CryptoNoteProtocolHandler::start_sync(CryptoNoteConnectionContext& context)
 
   if (context.m_state == CryptoNoteConnectionContext::state_synchronizing) {
     assert(context.m_needed_objects.empty());
+    context.m_sync_progress_at = std::chrono::steady_clock::now();
     assert(context.m_requested_objects.empty());
 
     NOTIFY_REQUEST_CHAIN::request r = boost::value_initialized<NOTIFY_REQUEST_CHAIN::request>();
@@ -145,6 +175,8 @@ bool CryptoNoteProtocolHandler::process_payload_sync_data(const CORE_SYNC_DATA&
   if (context.m_state == CryptoNoteConnectionContext::state_befor_handshake && !is_inital)
     return true;
 
+  context.m_remote_capabilities = hshd.capabilities;
+
   if (context.m_state == CryptoNoteConnectionContext::state_synchronizing) {
   } else if (m_core.have_block(hshd.top_id)) {
     if (is_inital) {
@@ -153,6 +185,9 @@ bool CryptoNoteProtocolHandler::process_payload_sync_data(const CORE_SYNC_DATA&
     } else {
       context.m_state = CryptoNoteConnectionContext::state_normal;
     }
+  } else if (!shouldSynchronizeWith(context)) {
+    logger(Logging::DEBUGGING) << context << "Sync data returned unknown top block, but better peers are synchronizing";
+    context.m_state = CryptoNoteConnectionContext::state_normal;
   } else {
     int64_t diff = static_cast<int64_t>(hshd.current_height) - static_cast<int64_t>(get_current_blockchain_height());
 
@@ -178,11 +213,44 @@ bool CryptoNoteProtocolHandler::process_payload_sync_data(const CORE_SYNC_DATA&
   return true;
 }
 
+bool CryptoNoteProtocolHandler::shouldSynchronizeWith(const CryptoNoteConnectionContext& context) {
+  // Up to P2P_MAX_SYNCHRONIZING_PEERS peers synchronize at once, and one more only if it scores better than one of
+  // them; a peer that stalled doesn't take a place. Deferred peers are reconsidered on their next timed sync.
+  auto now = std::chrono::steady_clock::now();
+  uint64_t currentTime = time(nullptr);
+  int64_t score = context.m_peer_score.getValue(currentTime);
+  size_t synchronizingCount = 0;
+  bool betterThanSynchronizing = false;
+
+  m_p2p->for_each_connection([&](const CryptoNoteConnectionContext& conn, PeerIdType peerId) {
+    if (conn.m_connection_id == context.m_connection_id) {
+      return;
+    }
+
+    if (conn.m_state == CryptoNoteConnectionContext::state_synchronizing) {
+      if (now - conn.m_sync_progress_at > std::chrono::seconds(P2P_SYNC_STALL_TIMEOUT)) {
+        return;
+      }
+    } else if (conn.m_state != CryptoNoteConnectionContext::state_sync_required) {
+      return;
+    }
+
+    ++synchronizingCount;
+    if (conn.m_peer_score.getValue(currentTime) < score) {
+      betterThanSynchronizing = true;
+    }
+  });
+
+  return synchronizingCount < P2P_MAX_SYNCHRONIZING_PEERS ||
+    (synchronizingCount == P2P_MAX_SYNCHRONIZING_PEERS && betterThanSynchronizing);
+}
+
 bool CryptoNoteProtocolHandler::get_payload_sync_data(CORE_SYNC_DATA& hshd) {
   uint32_t current_height;
   m_core.get_blockchain_top(current_height, hshd.top_id);
   hshd.current_height = current_height;
   hshd.current_height += 1;
+  hshd.capabilities = P2P_CAPABILITY_BLOCKS_BY_RANGE | P2P_CAPABILITY_COMPACT_BLOCKS | P2P_CAPABILITY_TX_INVENTORY;
   return true;
 }
 
@@ -215,6 +283,14 @@ int CryptoNoteProtocolHandler::handleCommand(bool is_notify, int command, const
     HANDLE_NOTIFY(NOTIFY_REQUEST_CHAIN, &CryptoNoteProtocolHandler::handle_request_chain)
     HANDLE_NOTIFY(NOTIFY_RESPONSE_CHAIN_ENTRY, &CryptoNoteProtocolHandler::handle_response_chain_entry)
     HANDLE_NOTIFY(NOTIFY_REQUEST_TX_POOL, &CryptoNoteProtocolHandler::handleRequestTxPool)
+    HANDLE_NOTIFY(NOTIFY_REQUEST_BLOCKS_BY_RANGE, &CryptoNoteProtocolHandler::handle_request_blocks_by_range)
+    HANDLE_NOTIFY(NOTIFY_RESPONSE_BLOCKS_BY_RANGE, &CryptoNoteProtocolHandler::handle_response_blocks_by_range)
+    HANDLE_NOTIFY(NOTIFY_NEW_COMPACT_BLOCK, &CryptoNoteProtocolHandler::handle_notify_new_compact_block)
+    HANDLE_NOTIFY(NOTIFY_REQUEST_BLOCK_TXS, &CryptoNoteProtocolHandler::handle_request_block_txs)
+    HANDLE_NOTIFY(NOTIFY_RESPONSE_BLOCK_TXS, &CryptoNoteProtocolHandler::handle_response_block_txs)
+    HANDLE_NOTIFY(NOTIFY_TX_INVENTORY, &CryptoNoteProtocolHandler::handle_notify_tx_inventory)
+    HANDLE_NOTIFY(NOTIFY_REQUEST_TXS, &CryptoNoteProtocolHandler::handle_request_txs)
+    HANDLE_NOTIFY(NOTIFY_TXS_NOT_FOUND, &CryptoNoteProtocolHandler::handle_txs_not_found)
 
   default:
     handled = false;
@@ -228,6 +304,17 @@ int CryptoNoteProtocolHandler::handleCommand(bool is_notify, int command, const
 int CryptoNoteProtocolHandler::handle_notify_new_block(int command, NOTIFY_NEW_BLOCK::request& arg, CryptoNoteConnectionContext& context) {
   logger(Logging::TRACE) << context << "NOTIFY_NEW_BLOCK (hop " << arg.hop << ")";
 
+  // the block is parsed once more only to label the trace
+  Crypto::Hash tracedBlockHash = NULL_HASH;
+  if (TraceLog::isEnabled()) {
+    Block block;
+    if (fromBinaryArray(block, asBinaryArray(arg.b.block))) {
+      tracedBlockHash = get_block_hash(block);
+    }
+
+    TraceLog::instant(TraceEvent::BLOCK_RECEIVED, tracedBlockHash);
+  }
+
   updateObservedHeight(arg.current_blockchain_height, context);
 
   context.m_remote_blockchain_height = arg.current_blockchain_height;
@@ -236,69 +323,399 @@ int CryptoNoteProtocolHandler::handle_notify_new_block(int command, NOTIFY_NEW_B
     return 1;
   }
 
-  for (auto tx_blob_it = arg.b.txs.begin(); tx_blob_it != arg.b.txs.end(); tx_blob_it++) {
-    CryptoNote::tx_verification_context tvc = boost::value_initialized<decltype(tvc)>();
-    m_core.handle_incoming_tx(asBinaryArray(*tx_blob_it), tvc, true);
-    if (tvc.m_verifivation_failed) {
-      logger(Logging::INFO) << context << "Block verification failed: transaction verification failed, dropping connection";
-      context.m_state = CryptoNoteConnectionContext::state_shutdown;
+  processNewBlock(context, arg, tracedBlockHash, nullptr);
+  return 1;
+}
+
+int CryptoNoteProtocolHandler::handle_notify_new_compact_block(int command, NOTIFY_NEW_COMPACT_BLOCK::request& arg, CryptoNoteConnectionContext& context) {
+  logger(Logging::TRACE) << context << "NOTIFY_NEW_COMPACT_BLOCK (hop " << arg.hop << ")";
+
+  Block block;
+  if (!fromBinaryArray(block, asBinaryArray(arg.block))) {
+    logger(Logging::DEBUGGING) << context << "Failed to parse compact block, dropping connection";
+    dropForInvalidData(context);
+    return 1;
+  }
+
+  Crypto::Hash blockId = get_block_hash(block);
+  TraceLog::instant(TraceEvent::BLOCK_RECEIVED, blockId);
+
+  updateObservedHeight(arg.current_blockchain_height, context);
+
+  context.m_remote_blockchain_height = arg.current_blockchain_height;
+
+  if (context.m_state != CryptoNoteConnectionContext::state_normal || m_core.have_block(blockId)) {
+    return 1;
+  }
+
+  NOTIFY_NEW_BLOCK::request fullArg;
+  fullArg.b.block = std::move(arg.block);
+  fullArg.current_blockchain_height = arg.current_blockchain_height;
+  fullArg.hop = arg.hop;
+  processNewBlock(context, fullArg, blockId, &block.transactionHashes);
+  return 1;
+}
+
+int CryptoNoteProtocolHandler::handle_request_block_txs(int command, NOTIFY_REQUEST_BLOCK_TXS::request& arg, CryptoNoteConnectionContext& context) {
+  logger(Logging::TRACE) << context << "NOTIFY_REQUEST_BLOCK_TXS: block_id = " << arg.block_id << ", txs.size() = " << arg.txs.size();
+
+  NOTIFY_RESPONSE_BLOCK_TXS::request rsp;
+  rsp.block_id = arg.block_id;
+
+  block_complete_entry entry;
+  Block block;
+  if (m_core.getRawBlock(arg.block_id, entry) && fromBinaryArray(block, asBinaryArray(entry.block)) &&
+      arg.txs.size() <= entry.txs.size()) {
+    std::unordered_map<Crypto::Hash, size_t> txIndexes;
+    for (size_t i = 0; i < block.transactionHashes.size() && i < entry.txs.size(); ++i) {
+      txIndexes.emplace(block.transactionHashes[i], i);
+    }
+
+    for (const auto& txId : arg.txs) {
+      auto it = txIndexes.find(txId);
+      if (it == txIndexes.end()) {
+        rsp.txs.clear();
+        break;
+      }
+
+      rsp.txs.push_back(entry.txs[it->second]);
+    }
+  }
+
+  logger(Logging::TRACE) << context << "-->>NOTIFY_RESPONSE_BLOCK_TXS: txs.size() = " << rsp.txs.size();
+  post_notify<NOTIFY_RESPONSE_BLOCK_TXS>(*m_p2p, rsp, context);
+  return 1;
+}
+
+int CryptoNoteProtocolHandler::handle_response_block_txs(int command, NOTIFY_RESPONSE_BLOCK_TXS::request& arg, CryptoNoteConnectionContext& context) {
+  logger(Logging::TRACE) << context << "NOTIFY_RESPONSE_BLOCK_TXS: block_id = " << arg.block_id << ", txs.size() = " << arg.txs.size();
+
+  if (context.m_pending_block.empty() || arg.block_id != context.m_pending_block_id) {
+    return 1;
+  }
+
+  NOTIFY_NEW_BLOCK::request fullArg;
+  fullArg.b.block = std::move(context.m_pending_block);
+  fullArg.current_blockchain_height = context.m_remote_blockchain_height;
+  fullArg.hop = context.m_pending_block_hop;
+  std::vector<Crypto::Hash> missingTxIds = std::move(context.m_pending_block_missing_txs);
+  context.m_pending_block.clear();
+  context.m_pending_block_missing_txs.clear();
+
+  if (context.m_state != CryptoNoteConnectionContext::state_normal) {
+    return 1;
+  }
+
+  // an empty response means the peer has left the block's chain; the block comes with synchronization if it matters
+  if (arg.txs.size() != missingTxIds.size()) {
+    logger(Logging::DEBUGGING) << context << "Peer didn't return the transactions of block " << arg.block_id;
+    return 1;
+  }
+
+  for (size_t i = 0; i < arg.txs.size(); ++i) {
+    if (getBinaryArrayHash(asBinaryArray(arg.txs[i])) != missingTxIds[i]) {
+      logger(Logging::DEBUGGING) << context << "Peer returned a transaction that wasn't requested, dropping connection";
+      dropForInvalidData(context);
       return 1;
     }
   }
 
+  Block block;
+  if (!fromBinaryArray(block, asBinaryArray(fullArg.b.block))) {
+    return 1;
+  }
+
+  fullArg.b.txs = std::move(arg.txs);
+  processNewBlock(context, fullArg, arg.block_id, &block.transactionHashes);
+  return 1;
+}
+
+// Adds the block, after the transactions in arg.b.txs, and relays it on. For a compact block poolTxIds are the
+// transactions of the block, which have to be in the pool once arg.b.txs is added; those that aren't are asked
+// from the peer, the first time round.
+// The pool stays locked from the first transaction to the block, so transactions handled on the other core
+// dispatchers can't take the block's transactions out of it in between.
+void CryptoNoteProtocolHandler::processNewBlock(CryptoNoteConnectionContext& context, NOTIFY_NEW_BLOCK::request& arg, const Crypto::Hash& blockId, const std::vector<Crypto::Hash>* poolTxIds) {
+  bool txVerificationFailed = false;
+  std::vector<Crypto::Hash> missingTxIds;
   block_verification_context bvc = boost::value_initialized<block_verification_context>();
-  m_core.handle_incoming_block_blob(asBinaryArray(arg.b.block), bvc, true, false);
+  executeInCore(true, [&] {
+    m_core.executeLocked([&] {
+      for (auto tx_blob_it = arg.b.txs.begin(); tx_blob_it != arg.b.txs.end(); tx_blob_it++) {
+        CryptoNote::tx_verification_context tvc = boost::value_initialized<decltype(tvc)>();
+        m_core.handle_incoming_tx(asBinaryArray(*tx_blob_it), tvc, true);
+        if (tvc.m_verifivation_failed) {
+          txVerificationFailed = true;
+          return std::error_code();
+        }
+      }
+
+      if (poolTxIds != nullptr) {
+        missingTxIds = m_core.getMissingPoolTransactions(*poolTxIds);
+        if (!missingTxIds.empty()) {
+          return std::error_code();
+        }
+      }
+
+      m_core.handle_incoming_block_blob(asBinaryArray(arg.b.block), bvc, true, false);
+
+      // a full block whose transactions weren't all sent fails for want of them, which isn't the peer lying
+      Block block;
+      if (bvc.m_verifivation_failed && poolTxIds == nullptr && fromBinaryArray(block, asBinaryArray(arg.b.block))) {
+        missingTxIds = m_core.getMissingPoolTransactions(block.transactionHashes);
+      }
+
+      return std::error_code();
+    });
+  });
+
+  if (txVerificationFailed) {
+    logger(Logging::INFO) << context << "Block verification failed: transaction verification failed, dropping connection";
+    context.m_state = CryptoNoteConnectionContext::state_shutdown;
+    return;
+  }
+
+  if (!missingTxIds.empty()) {
+    if (!arg.b.txs.empty() || poolTxIds == nullptr) {
+      logger(Logging::DEBUGGING) << context << "Transactions of block " << blockId << " left the pool, leaving the block to synchronization";
+      return;
+    }
+
+    context.m_pending_block = std::move(arg.b.block);
+    context.m_pending_block_id = blockId;
+    context.m_pending_block_hop = arg.hop;
+    context.m_pending_block_missing_txs = missingTxIds;
+
+    NOTIFY_REQUEST_BLOCK_TXS::request req;
+    req.block_id = blockId;
+    req.txs = std::move(missingTxIds);
+    logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_BLOCK_TXS: txs.size() = " << req.txs.size();
+    post_notify<NOTIFY_REQUEST_BLOCK_TXS>(*m_p2p, req, context);
+    return;
+  }
+
   if (bvc.m_verifivation_failed) {
     logger(Logging::DEBUGGING) << context << "Block verification failed, dropping connection";
     context.m_state = CryptoNoteConnectionContext::state_shutdown;
-    return 1;
+    return;
   }
   if (bvc.m_added_to_main_chain) {
     ++arg.hop;
-    //TODO: Add here announce protocol usage
-    relay_post_notify<NOTIFY_NEW_BLOCK>(*m_p2p, arg, &context.m_connection_id);
-    // relay_block(arg, context);
+    relayBlock(arg, blockId, poolTxIds == nullptr, &context.m_connection_id);
+    TraceLog::instant(TraceEvent::BLOCK_RELAYED, blockId);
 
     if (bvc.m_switched_to_alt_chain) {
       requestMissingPoolTransactions(context);
     }
   } else if (bvc.m_marked_as_orphaned) {
     context.m_state = CryptoNoteConnectionContext::state_synchronizing;
+    context.m_sync_progress_at = std::chrono::steady_clock::now();
     NOTIFY_REQUEST_CHAIN::request r = boost::value_initialized<NOTIFY_REQUEST_CHAIN::request>();
     r.block_ids = m_core.buildSparseChain();
     logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_CHAIN: m_block_ids.size()=" << r.block_ids.size();
     post_notify<NOTIFY_REQUEST_CHAIN>(*m_p2p, r, context);
   }
+}
 
-  return 1;
+// Peers that advertise P2P_CAPABILITY_COMPACT_BLOCKS get the block without its transactions, the others get
+// all of it; with txsLoaded unset arg.b.txs is filled from the blockchain the first time it's needed.
+void CryptoNoteProtocolHandler::relayBlock(NOTIFY_NEW_BLOCK::request& arg, const Crypto::Hash& blockId, bool txsLoaded, const net_connection_id* excludeConnection) {
+  net_connection_id excludeId = excludeConnection ? *excludeConnection : boost::value_initialized<net_connection_id>();
+  BinaryArray compactBuffer;
+  BinaryArray fullBuffer;
+
+  m_p2p->for_each_connection([&](CryptoNoteConnectionContext& conn, PeerIdType peerId) {
+    if (peerId == 0 || conn.m_connection_id == excludeId ||
+        (conn.m_state != CryptoNoteConnectionContext::state_normal && conn.m_state != CryptoNoteConnectionContext::state_synchronizing)) {
+      return;
+    }
+
+    if ((conn.m_remote_capabilities & P2P_CAPABILITY_COMPACT_BLOCKS) != 0) {
+      if (compactBuffer.empty()) {
+        NOTIFY_NEW_COMPACT_BLOCK::request compactArg;
+        compactArg.block = arg.b.block;
+        compactArg.current_blockchain_height = arg.current_blockchain_height;
+        compactArg.hop = arg.hop;
+        compactBuffer = LevinProtocol::encode(compactArg);
+      }
+
+      m_p2p->invoke_notify_to_peer(NOTIFY_NEW_COMPACT_BLOCK::ID, compactBuffer, conn);
+    } else {
+      if (fullBuffer.empty()) {
+        if (!txsLoaded) {
+          block_complete_entry entry;
+          if (!m_core.getRawBlock(blockId, entry)) {
+            return;
+          }
+
+          arg.b.txs = std::move(entry.txs);
+          txsLoaded = true;
+        }
+
+        fullBuffer = LevinProtocol::encode(arg);
+      }
+
+      m_p2p->invoke_notify_to_peer(NOTIFY_NEW_BLOCK::ID, fullBuffer, conn);
+    }
+  });
 }
 
 int CryptoNoteProtocolHandler::handle_notify_new_transactions(int command, NOTIFY_NEW_TRANSACTIONS::request& arg, CryptoNoteConnectionContext& context) {
   logger(Logging::TRACE) << context << "NOTIFY_NEW_TRANSACTIONS";
+
+  std::vector<Crypto::Hash> txIds;
+  txIds.reserve(arg.txs.size());
+  for (const auto& txBlob : arg.txs) {
+    txIds.push_back(getBinaryArrayHash(asBinaryArray(txBlob)));
+    TraceLog::instant(TraceEvent::TX_RECEIVED, txIds.back());
+    context.m_known_txs.insert(txIds.back());
+    m_requestedTxs.erase(txIds.back());
+  }
+
   if (context.m_state != CryptoNoteConnectionContext::state_normal)
     return 1;
 
-  for (auto tx_blob_it = arg.txs.begin(); tx_blob_it != arg.txs.end();) {
-    CryptoNote::tx_verification_context tvc = boost::value_initialized<decltype(tvc)>();
-    m_core.handle_incoming_tx(asBinaryArray(*tx_blob_it), tvc, false);
-    if (tvc.m_verifivation_failed) {
-      logger(Logging::INFO) << context << "Tx verification failed";
-    }
-    if (!tvc.m_verifivation_failed && tvc.m_should_be_relayed) {
-      ++tx_blob_it;
-    } else {
-      tx_blob_it = arg.txs.erase(tx_blob_it);
+  size_t failedCount = 0;
+  size_t relayedCount = 0;
+  executeInCore(false, [&] {
+    for (size_t i = 0; i < arg.txs.size(); ++i) {
+      CryptoNote::tx_verification_context tvc = boost::value_initialized<decltype(tvc)>();
+      m_core.handle_incoming_tx(asBinaryArray(arg.txs[i]), tvc, false);
+      if (tvc.m_verifivation_failed) {
+        ++failedCount;
+      }
+      if (!tvc.m_verifivation_failed && tvc.m_should_be_relayed) {
+        arg.txs[relayedCount].swap(arg.txs[i]);
+        txIds[relayedCount] = txIds[i];
+        ++relayedCount;
+      }
     }
+  });
+
+  for (size_t i = 0; i < failedCount; ++i) {
+    logger(Logging::INFO) << context << "Tx verification failed";
   }
 
-  if (arg.txs.size()) {
-    //TODO: add announce usage here
-    relay_post_notify<NOTIFY_NEW_TRANSACTIONS>(*m_p2p, arg, &context.m_connection_id);
+  if (relayedCount != 0) {
+    arg.txs.resize(relayedCount);
+    txIds.resize(relayedCount);
+    relayTransactions(arg.txs, txIds, &context.m_connection_id);
+    for (const auto& txId : txIds) {
+      TraceLog::instant(TraceEvent::TX_RELAYED, txId);
+    }
   }
 
   return true;
 }
 
+int CryptoNoteProtocolHandler::handle_notify_tx_inventory(int command, NOTIFY_TX_INVENTORY::request& arg, CryptoNoteConnectionContext& context) {
+  logger(Logging::TRACE) << context << "NOTIFY_TX_INVENTORY: txs.size() = " << arg.txs.size();
+
+  if (arg.txs.size() > P2P_MAX_TX_INVENTORY_SIZE) {
+    arg.txs.resize(P2P_MAX_TX_INVENTORY_SIZE);
+  }
+
+  for (const auto& txId : arg.txs) {
+    context.m_known_txs.insert(txId);
+  }
+
+  if (context.m_state != CryptoNoteConnectionContext::state_normal) {
+    return 1;
+  }
+
+  // a transaction already asked from another peer is only asked again once that request is overdue; until then
+  // the peer is remembered as one to ask next. Those that failed verification recently aren't asked at all.
+  auto now = std::chrono::steady_clock::now();
+  std::vector<Crypto::Hash> candidates;
+  for (const auto& txId : arg.txs) {
+    if (m_core.isTransactionRejected(txId)) {
+      continue;
+    }
+
+    auto it = m_requestedTxs.find(txId);
+    if (it == m_requestedTxs.end() || now - it->second.requestTime >= std::chrono::milliseconds(P2P_DEFAULT_TX_REQUEST_TIMEOUT)) {
+      candidates.push_back(txId);
+    } else if (it->second.peer != context.m_connection_id &&
+               std::find(it->second.announcers.begin(), it->second.announcers.end(), context.m_connection_id) == it->second.announcers.end()) {
+      it->second.announcers.push_back(context.m_connection_id);
+    }
+  }
+
+  if (candidates.empty()) {
+    return 1;
+  }
+
+  NOTIFY_REQUEST_TXS::request req;
+  req.txs = m_core.getUnknownTransactions(candidates);
+  if (req.txs.empty()) {
+    return 1;
+  }
+
+  for (const auto& txId : req.txs) {
+    RequestedTransaction& request = m_requestedTxs[txId];
+    request.requestTime = now;
+    request.peer = context.m_connection_id;
+  }
+
+  logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_TXS: txs.size() = " << req.txs.size();
+  post_notify<NOTIFY_REQUEST_TXS>(*m_p2p, req, context);
+  return 1;
+}
+
+int CryptoNoteProtocolHandler::handle_request_txs(int command, NOTIFY_REQUEST_TXS::request& arg, CryptoNoteConnectionContext& context) {
+  logger(Logging::TRACE) << context << "NOTIFY_REQUEST_TXS: txs.size() = " << arg.txs.size();
+
+  if (arg.txs.size() > P2P_MAX_TX_INVENTORY_SIZE) {
+    arg.txs.resize(P2P_MAX_TX_INVENTORY_SIZE);
+  }
+
+  std::vector<BinaryArray> txs;
+  std::vector<Crypto::Hash> missedTxs;
+  m_core.getPoolTransactionBlobs(arg.txs, txs, missedTxs);
+
+  for (const auto& txId : arg.txs) {
+    context.m_known_txs.insert(txId);
+  }
+
+  if (!txs.empty()) {
+    NOTIFY_NEW_TRANSACTIONS::request notification;
+    notification.txs.reserve(txs.size());
+    for (const auto& tx : txs) {
+      notification.txs.push_back(asString(tx));
+    }
+
+    post_notify<NOTIFY_NEW_TRANSACTIONS>(*m_p2p, notification, context);
+  }
+
+  if (!missedTxs.empty()) {
+    NOTIFY_TXS_NOT_FOUND::request notFound;
+    notFound.txs = std::move(missedTxs);
+    logger(Logging::TRACE) << context << "-->>NOTIFY_TXS_NOT_FOUND: txs.size() = " << notFound.txs.size();
+    post_notify<NOTIFY_TXS_NOT_FOUND>(*m_p2p, notFound, context);
+  }
+
+  return 1;
+}
+
+int CryptoNoteProtocolHandler::handle_txs_not_found(int command, NOTIFY_TXS_NOT_FOUND::request& arg, CryptoNoteConnectionContext& context) {
+  logger(Logging::TRACE) << context << "NOTIFY_TXS_NOT_FOUND: txs.size() = " << arg.txs.size();
+
+  bool overdue = false;
+  for (const auto& txId : arg.txs) {
+    auto it = m_requestedTxs.find(txId);
+    if (it != m_requestedTxs.end() && it->second.peer == context.m_connection_id) {
+      it->second.requestTime = std::chrono::steady_clock::time_point();
+      overdue = true;
+    }
+  }
+
+  if (overdue) {
+    requestOverdueTransactions();
+  }
+
+  return 1;
+}
+
 int CryptoNoteProtocolHandler::handle_request_get_objects(int command, NOTIFY_REQUEST_GET_OBJECTS::request& arg, CryptoNoteConnectionContext& context) {
   logger(Logging::TRACE) << context << "NOTIFY_REQUEST_GET_OBJECTS";
   NOTIFY_RESPONSE_GET_OBJECTS::request rsp;
@@ -326,6 +743,16 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(int command, NOTIFY_R
 
   context.m_remote_blockchain_height = arg.current_blockchain_height;
 
+  uint64_t bytes = 0;
+  for (const block_complete_entry& block_entry : arg.blocks) {
+    bytes += block_entry.block.size();
+    for (const std::string& tx : block_entry.txs) {
+      bytes += tx.size();
+    }
+  }
+
+  addBlockDelivery(context, bytes);
+
   size_t count = 0;
   for (const block_complete_entry& block_entry : arg.blocks) {
     ++count;
@@ -333,7 +760,7 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(int command, NOTIFY_R
     if (!fromBinaryArray(b, asBinaryArray(block_entry.block))) {
       logger(Logging::ERROR) << context << "sent wrong block: failed to parse and validate block: \r\n"
         << toHex(asBinaryArray(block_entry.block)) << "\r\n dropping connection";
-      context.m_state = CryptoNoteConnectionContext::state_shutdown;
+      dropForInvalidData(context);
       return 1;
     }
 
@@ -353,13 +780,13 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(int command, NOTIFY_R
     if (req_it == context.m_requested_objects.end()) {
       logger(Logging::ERROR) << context << "sent wrong NOTIFY_RESPONSE_GET_OBJECTS: block with id=" << Common::podToHex(blockHash)
         << " wasn't requested, dropping connection";
-      context.m_state = CryptoNoteConnectionContext::state_shutdown;
+      dropForInvalidData(context);
       return 1;
     }
     if (b.transactionHashes.size() != block_entry.txs.size()) {
       logger(Logging::ERROR) << context << "sent wrong NOTIFY_RESPONSE_GET_OBJECTS: block with id=" << Common::podToHex(blockHash)
         << ", transactionHashes.size()=" << b.transactionHashes.size() << " mismatch with block_complete_entry.m_txs.size()=" << block_entry.txs.size() << ", dropping connection";
-      context.m_state = CryptoNoteConnectionContext::state_shutdown;
+      dropForInvalidData(context);
       return 1;
     }
 
@@ -404,21 +831,29 @@ int CryptoNoteProtocolHandler::processObjects(CryptoNoteConnectionContext& conte
       break;
     }
 
-    //process transactions
-    for (auto& tx_blob : block_entry.txs) {
-      tx_verification_context tvc = boost::value_initialized<decltype(tvc)>();
-      m_core.handle_incoming_tx(asBinaryArray(tx_blob), tvc, true);
-      if (tvc.m_verifivation_failed) {
-        logger(Logging::DEBUGGING) << context << "transaction verification failed on NOTIFY_RESPONSE_GET_OBJECTS, \r\ntx_id = "
-          << Common::podToHex(getBinaryArrayHash(asBinaryArray(tx_blob))) << ", dropping connection";
-        context.m_state = CryptoNoteConnectionContext::state_shutdown;
-        return 1;
+    const std::string* failedTxBlob = nullptr;
+    block_verification_context bvc = boost::value_initialized<block_verification_context>();
+    executeInCore(true, [&] {
+      //process transactions
+      for (auto& tx_blob : block_entry.txs) {
+        tx_verification_context tvc = boost::value_initialized<decltype(tvc)>();
+        m_core.handle_incoming_tx(asBinaryArray(tx_blob), tvc, true);
+        if (tvc.m_verifivation_failed) {
+          failedTxBlob = &tx_blob;
+          return;
+        }
       }
-    }
 
-    // process block
-    block_verification_context bvc = boost::value_initialized<block_verification_context>();
-    m_core.handle_incoming_block_blob(asBinaryArray(block_entry.block), bvc, false, false);
+      // process block
+      m_core.handle_incoming_block_blob(asBinaryArray(block_entry.block), bvc, false, false);
+    });
+
+    if (failedTxBlob != nullptr) {
+      logger(Logging::DEBUGGING) << context << "transaction verification failed on NOTIFY_RESPONSE_GET_OBJECTS, \r\ntx_id = "
+        << Common::podToHex(getBinaryArrayHash(asBinaryArray(*failedTxBlob))) << ", dropping connection";
+      context.m_state = CryptoNoteConnectionContext::state_shutdown;
+      return 1;
+    }
 
     if (bvc.m_verifivation_failed) {
       logger(Logging::DEBUGGING) << context << "Block verification failed, dropping connection";
@@ -433,6 +868,7 @@ int CryptoNoteProtocolHandler::processObjects(CryptoNoteConnectionContext& conte
       context.m_state = CryptoNoteConnectionContext::state_idle;
       context.m_needed_objects.clear();
       context.m_requested_objects.clear();
+      context.m_range_next_height = 0;
       return 1;
     }
 
@@ -444,6 +880,29 @@ int CryptoNoteProtocolHandler::processObjects(CryptoNoteConnectionContext& conte
 }
 
 
+// Blocks always go to the first core dispatcher, so they are applied in arrival order;
+// transactions are spread over all of them.
+void CryptoNoteProtocolHandler::executeInCore(bool ordered, std::function<void()>&& operation) {
+  if (m_coreDispatchers == nullptr) {
+    operation();
+    return;
+  }
+
+  static Common::MetricGauge& pendingBlocks = Common::Metrics::gauge("ultranote_core_dispatch_pending",
+    "Operations handed to the core dispatchers and not completed yet", Common::Metrics::label("queue", "blocks"));
+  static Common::MetricGauge& pendingTransactions = Common::Metrics::gauge("ultranote_core_dispatch_pending",
+    "Operations handed to the core dispatchers and not completed yet", Common::Metrics::label("queue", "transactions"));
+
+  Common::MetricGauge& pending = ordered ? pendingBlocks : pendingTransactions;
+  pending.add(1);
+  BOOST_SCOPE_EXIT_ALL(&pending) {
+    pending.add(-1);
+  };
+
+  System::Dispatcher& coreDispatcher = ordered ? m_coreDispatchers->getDispatcher(0) : m_coreDispatchers->nextDispatcher();
+  System::DispatcherPool::invoke<void>(m_dispatcher, coreDispatcher, std::move(operation));
+}
+
 bool CryptoNoteProtocolHandler::on_idle() {
   return m_core.on_idle();
 }
@@ -453,7 +912,7 @@ int CryptoNoteProtocolHandler::handle_request_chain(int command, NOTIFY_REQUEST_
 
   if (arg.block_ids.empty()) {
     logger(Logging::ERROR, Logging::BRIGHT_RED) << context << "Failed to handle NOTIFY_REQUEST_CHAIN. block_ids is empty";
-    context.m_state = CryptoNoteConnectionContext::state_shutdown;
+    dropForInvalidData(context);
     return 1;
   }
 
@@ -472,7 +931,16 @@ int CryptoNoteProtocolHandler::handle_request_chain(int command, NOTIFY_REQUEST_
 }
 
 bool CryptoNoteProtocolHandler::request_missing_objects(CryptoNoteConnectionContext& context, bool check_having_blocks) {
-  if (context.m_needed_objects.size()) {
+  if (context.m_range_next_height != 0 && context.m_range_next_height < context.m_remote_blockchain_height) {
+    NOTIFY_REQUEST_BLOCKS_BY_RANGE::request req;
+    req.anchor_id = context.m_range_anchor_id;
+    req.start_height = context.m_range_next_height;
+    req.count = std::min(static_cast<uint32_t>(BLOCKS_SYNCHRONIZING_DEFAULT_COUNT), context.m_remote_blockchain_height - context.m_range_next_height);
+    context.m_range_requested_count = req.count;
+    logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_BLOCKS_BY_RANGE: start_height=" << req.start_height << ", count=" << req.count;
+    context.m_blocks_requested_at = std::chrono::steady_clock::now();
+    post_notify<NOTIFY_REQUEST_BLOCKS_BY_RANGE>(*m_p2p, req, context);
+  } else if (context.m_needed_objects.size()) {
     //we know objects that we need, request this objects
     NOTIFY_REQUEST_GET_OBJECTS::request req;
     size_t count = 0;
@@ -487,6 +955,7 @@ bool CryptoNoteProtocolHandler::request_missing_objects(CryptoNoteConnectionCont
       it = context.m_needed_objects.erase(it);
     }
     logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_GET_OBJECTS: blocks.size()=" << req.blocks.size() << ", txs.size()=" << req.txs.size();
+    context.m_blocks_requested_at = std::chrono::steady_clock::now();
     post_notify<NOTIFY_REQUEST_GET_OBJECTS>(*m_p2p, req, context);
   } else if (context.m_last_response_height < context.m_remote_blockchain_height - 1) {//we have to fetch more objects ids, request blockchain entry
 
@@ -545,7 +1014,7 @@ int CryptoNoteProtocolHandler::handle_response_chain_entry(int command, NOTIFY_R
 
   if (!arg.m_block_ids.size()) {
     logger(Logging::ERROR) << context << "sent empty m_block_ids, dropping connection";
-    context.m_state = CryptoNoteConnectionContext::state_shutdown;
+    dropForInvalidData(context);
     return 1;
   }
 
@@ -567,18 +1036,164 @@ int CryptoNoteProtocolHandler::handle_response_chain_entry(int command, NOTIFY_R
       << "sent wrong NOTIFY_RESPONSE_CHAIN_ENTRY, with \r\nm_total_height="
       << arg.total_height << "\r\nm_start_height=" << arg.start_height
       << "\r\nm_block_ids.size()=" << arg.m_block_ids.size();
-    context.m_state = CryptoNoteConnectionContext::state_shutdown;
+    dropForInvalidData(context);
   }
 
-  for (auto& bl_id : arg.m_block_ids) {
-    if (!m_core.have_block(bl_id))
-      context.m_needed_objects.push_back(bl_id);
+  context.m_range_next_height = 0;
+  if (context.m_remote_capabilities & P2P_CAPABILITY_BLOCKS_BY_RANGE) {
+    // only the fork point is needed, the blocks after it are requested by height
+    size_t known = 1;
+    while (known < arg.m_block_ids.size() && m_core.have_block(arg.m_block_ids[known])) {
+      ++known;
+    }
+
+    context.m_range_anchor_id = arg.m_block_ids[known - 1];
+    context.m_range_next_height = arg.start_height + static_cast<uint32_t>(known);
+    context.m_last_response_height = context.m_range_next_height - 1;
+  } else {
+    for (auto& bl_id : arg.m_block_ids) {
+      if (!m_core.have_block(bl_id))
+        context.m_needed_objects.push_back(bl_id);
+    }
   }
 
   request_missing_objects(context, false);
   return 1;
 }
 
+int CryptoNoteProtocolHandler::handle_request_blocks_by_range(int command, NOTIFY_REQUEST_BLOCKS_BY_RANGE::request& arg, CryptoNoteConnectionContext& context) {
+  logger(Logging::TRACE) << context << "NOTIFY_REQUEST_BLOCKS_BY_RANGE: start_height=" << arg.start_height << ", count=" << arg.count;
+
+  NOTIFY_RESPONSE_BLOCKS_BY_RANGE::request rsp;
+  if (!m_core.handle_get_blocks_by_range(arg, rsp)) {
+    logger(Logging::ERROR) << context << "failed to handle request NOTIFY_REQUEST_BLOCKS_BY_RANGE, dropping connection";
+    context.m_state = CryptoNoteConnectionContext::state_shutdown;
+    return 1;
+  }
+
+  logger(Logging::TRACE) << context << "-->>NOTIFY_RESPONSE_BLOCKS_BY_RANGE: start_height=" << rsp.start_height << ", anchor_found=" << rsp.anchor_found
+    << ", blocks blob size=" << rsp.blocks.size() << ", current_blockchain_height=" << rsp.current_blockchain_height;
+  post_notify<NOTIFY_RESPONSE_BLOCKS_BY_RANGE>(*m_p2p, rsp, context);
+  return 1;
+}
+
+int CryptoNoteProtocolHandler::handle_response_blocks_by_range(int command, NOTIFY_RESPONSE_BLOCKS_BY_RANGE::request& arg, CryptoNoteConnectionContext& context) {
+  logger(Logging::TRACE) << context << "NOTIFY_RESPONSE_BLOCKS_BY_RANGE: start_height=" << arg.start_height << ", anchor_found=" << arg.anchor_found
+    << ", current_blockchain_height=" << arg.current_blockchain_height;
+
+  if (context.m_range_requested_count == 0 || arg.start_height != context.m_range_next_height) {
+    logger(Logging::ERROR) << context << "sent NOTIFY_RESPONSE_BLOCKS_BY_RANGE from height " << arg.start_height << " that wasn't requested, dropping connection";
+    dropForInvalidData(context);
+    return 1;
+  }
+
+  uint32_t requestedCount = context.m_range_requested_count;
+  context.m_range_requested_count = 0;
+  addBlockDelivery(context, arg.blocks.size());
+
+  if (!arg.anchor_found) {
+    // the peer switched chains since the fork point was found, so it has to be found again
+    logger(Logging::DEBUGGING) << context << "Block " << Common::podToHex(context.m_range_anchor_id) << " left the peer's main chain, requesting chain";
+    context.m_range_next_height = 0;
+    NOTIFY_REQUEST_CHAIN::request r = boost::value_initialized<NOTIFY_REQUEST_CHAIN::request>();
+    r.block_ids = m_core.buildSparseChain();
+    logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_CHAIN: m_block_ids.size()=" << r.block_ids.size();
+    post_notify<NOTIFY_REQUEST_CHAIN>(*m_p2p, r, context);
+    return 1;
+  }
+
+  std::vector<block_complete_entry> blocks;
+  try {
+    BinaryDecoder decoder(reinterpret_cast<const uint8_t*>(arg.blocks.data()), arg.blocks.size());
+    decode(decoder, blocks);
+    if (decoder.remaining() != 0) {
+      throw std::runtime_error("unexpected data after blocks");
+    }
+  } catch (std::exception& e) {
+    logger(Logging::ERROR) << context << "sent wrong NOTIFY_RESPONSE_BLOCKS_BY_RANGE: " << e.what() << ", dropping connection";
+    dropForInvalidData(context);
+    return 1;
+  }
+
+  if (blocks.size() > requestedCount) {
+    logger(Logging::ERROR) << context << "sent wrong NOTIFY_RESPONSE_BLOCKS_BY_RANGE: " << blocks.size() << " blocks for "
+      << requestedCount << " requested, dropping connection";
+    dropForInvalidData(context);
+    return 1;
+  }
+
+  updateObservedHeight(arg.current_blockchain_height, context);
+  context.m_remote_blockchain_height = arg.current_blockchain_height;
+
+  if (blocks.empty()) {
+    logger(Logging::DEBUGGING) << context << "Peer has no blocks from height " << arg.start_height << ", switching to idle state";
+    context.m_state = CryptoNoteConnectionContext::state_idle;
+    context.m_range_next_height = 0;
+    return 1;
+  }
+
+  // the blocks have to follow the anchor and each other, which stands in for checking them against requested ids
+  Crypto::Hash previousBlockId = context.m_range_anchor_id;
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    Block b;
+    if (!fromBinaryArray(b, asBinaryArray(blocks[i].block))) {
+      logger(Logging::ERROR) << context << "sent wrong block: failed to parse and validate block: \r\n"
+        << toHex(asBinaryArray(blocks[i].block)) << "\r\n dropping connection";
+      dropForInvalidData(context);
+      return 1;
+    }
+
+    if (b.previousBlockHash != previousBlockId) {
+      logger(Logging::ERROR) << context << "sent wrong NOTIFY_RESPONSE_BLOCKS_BY_RANGE: block at height " << arg.start_height + i
+        << " doesn't follow block id=" << Common::podToHex(previousBlockId) << ", dropping connection";
+      dropForInvalidData(context);
+      return 1;
+    }
+
+    previousBlockId = get_block_hash(b);
+    if (b.transactionHashes.size() != blocks[i].txs.size()) {
+      logger(Logging::ERROR) << context << "sent wrong NOTIFY_RESPONSE_BLOCKS_BY_RANGE: block with id=" << Common::podToHex(previousBlockId)
+        << ", transactionHashes.size()=" << b.transactionHashes.size() << " mismatch with block_complete_entry.m_txs.size()=" << blocks[i].txs.size() << ", dropping connection";
+      dropForInvalidData(context);
+      return 1;
+    }
+
+    //to avoid concurrency in core between connections, suspend connections which delivered block later then first one
+    if (i == 1 && m_core.have_block(previousBlockId)) {
+      context.m_state = CryptoNoteConnectionContext::state_idle;
+      context.m_range_next_height = 0;
+      logger(Logging::DEBUGGING) << context << "Connection set to idle state.";
+      return 1;
+    }
+  }
+
+  {
+    m_core.pause_mining();
+
+    BOOST_SCOPE_EXIT_ALL(this) { m_core.update_block_template_and_resume_mining(); };
+
+    int result = processObjects(context, blocks);
+    if (result != 0) {
+      return result;
+    }
+  }
+
+  context.m_range_anchor_id = previousBlockId;
+  context.m_range_next_height += static_cast<uint32_t>(blocks.size());
+  context.m_last_response_height = context.m_range_next_height - 1;
+
+  uint32_t height;
+  Crypto::Hash top;
+  m_core.get_blockchain_top(height, top);
+  logger(DEBUGGING, BRIGHT_GREEN) << "Local blockchain updated, new height = " << height;
+
+  if (!m_stop && context.m_state == CryptoNoteConnectionContext::state_synchronizing) {
+    request_missing_objects(context, true);
+  }
+
+  return 1;
+}
+
 int CryptoNoteProtocolHandler::handleRequestTxPool(int command, NOTIFY_REQUEST_TX_POOL::request& arg,
                                                      CryptoNoteConnectionContext& context) {
   logger(Logging::TRACE) << context << "NOTIFY_REQUEST_TX_POOL: txs.size() = " << arg.txs.size();
@@ -604,13 +1219,146 @@ int CryptoNoteProtocolHandler::handleRequestTxPool(int command, NOTIFY_REQUEST_T
 
 
 void CryptoNoteProtocolHandler::relay_block(NOTIFY_NEW_BLOCK::request& arg) {
-  auto buf = LevinProtocol::encode(arg);
-  m_p2p->externalRelayNotifyToAll(NOTIFY_NEW_BLOCK::ID, buf);
+  // the core sends the block alone, relayBlock loads its transactions if a peer takes full blocks
+  Block block;
+  if (!fromBinaryArray(block, asBinaryArray(arg.b.block))) {
+    return;
+  }
+
+  Crypto::Hash blockId = get_block_hash(block);
+
+  // called from the core, the connections are only safe to walk on the dispatcher
+  m_dispatcher.remoteSpawn([this, arg, blockId]() mutable {
+    relayBlock(arg, blockId, !arg.b.txs.empty(), nullptr);
+  });
 }
 
 void CryptoNoteProtocolHandler::relay_transactions(NOTIFY_NEW_TRANSACTIONS::request& arg) {
-  auto buf = LevinProtocol::encode(arg);
-  m_p2p->externalRelayNotifyToAll(NOTIFY_NEW_TRANSACTIONS::ID, buf);
+  std::vector<Crypto::Hash> txIds;
+  for (const auto& txBlob : arg.txs) {
+    txIds.push_back(getBinaryArrayHash(asBinaryArray(txBlob)));
+  }
+
+  m_dispatcher.remoteSpawn([this, arg, txIds] {
+    relayTransactions(arg.txs, txIds, nullptr);
+  });
+}
+
+// Peers that advertise P2P_CAPABILITY_TX_INVENTORY get the ids queued for the next NOTIFY_TX_INVENTORY, the
+// others get the transactions right away; either way only the transactions the peer isn't known to have.
+void CryptoNoteProtocolHandler::relayTransactions(const std::vector<std::string>& txs, const std::vector<Crypto::Hash>& txIds, const net_connection_id* excludeConnection) {
+  assert(txs.size() == txIds.size());
+  net_connection_id excludeId = excludeConnection ? *excludeConnection : boost::value_initialized<net_connection_id>();
+
+  m_p2p->for_each_connection([&](CryptoNoteConnectionContext& conn, PeerIdType peerId) {
+    if (peerId == 0 || conn.m_connection_id == excludeId ||
+        (conn.m_state != CryptoNoteConnectionContext::state_normal && conn.m_state != CryptoNoteConnectionContext::state_synchronizing)) {
+      return;
+    }
+
+    bool inventory = (conn.m_remote_capabilities & P2P_CAPABILITY_TX_INVENTORY) != 0;
+    NOTIFY_NEW_TRANSACTIONS::request notification;
+    for (size_t i = 0; i < txIds.size(); ++i) {
+      if (conn.m_known_txs.contains(txIds[i])) {
+        continue;
+      }
+
+      conn.m_known_txs.insert(txIds[i]);
+      if (inventory) {
+        conn.m_tx_inventory.push_back(txIds[i]);
+      } else {
+        notification.txs.push_back(txs[i]);
+      }
+    }
+
+    if (!notification.txs.empty()) {
+      post_notify<NOTIFY_NEW_TRANSACTIONS>(*m_p2p, notification, conn);
+    }
+  });
+}
+
+void CryptoNoteProtocolHandler::flushTransactionInventory() {
+  requestOverdueTransactions();
+
+  m_p2p->for_each_connection([&](CryptoNoteConnectionContext& conn, PeerIdType peerId) {
+    if (conn.m_tx_inventory.empty()) {
+      return;
+    }
+
+    NOTIFY_TX_INVENTORY::request notification;
+    if (conn.m_tx_inventory.size() > P2P_MAX_TX_INVENTORY_SIZE) {
+      notification.txs.assign(conn.m_tx_inventory.begin(), conn.m_tx_inventory.begin() + P2P_MAX_TX_INVENTORY_SIZE);
+      conn.m_tx_inventory.erase(conn.m_tx_inventory.begin(), conn.m_tx_inventory.begin() + P2P_MAX_TX_INVENTORY_SIZE);
+    } else {
+      notification.txs.swap(conn.m_tx_inventory);
+    }
+
+    logger(Logging::TRACE) << conn << "-->>NOTIFY_TX_INVENTORY: txs.size() = " << notification.txs.size();
+    post_notify<NOTIFY_TX_INVENTORY>(*m_p2p, notification, conn);
+  });
+}
+
+// Asks each transaction whose request is overdue from the next peer that announced it and is still connected;
+// one nobody else announced is forgotten, so a later announcement asks for it afresh. So is one that arrived
+// some other way or failed verification in the meantime.
+void CryptoNoteProtocolHandler::requestOverdueTransactions() {
+  auto now = std::chrono::steady_clock::now();
+  std::vector<Crypto::Hash> overdueTxs;
+  for (const auto& requested : m_requestedTxs) {
+    if (now - requested.second.requestTime >= std::chrono::milliseconds(P2P_DEFAULT_TX_REQUEST_TIMEOUT)) {
+      overdueTxs.push_back(requested.first);
+    }
+  }
+
+  if (overdueTxs.empty()) {
+    return;
+  }
+
+  std::vector<Crypto::Hash> unknownTxs = m_core.getUnknownTransactions(overdueTxs);
+  std::unordered_set<Crypto::Hash> stillWanted;
+  for (const auto& txId : unknownTxs) {
+    if (!m_core.isTransactionRejected(txId)) {
+      stillWanted.insert(txId);
+    }
+  }
+
+  std::set<net_connection_id> connections;
+  m_p2p->for_each_connection([&](CryptoNoteConnectionContext& conn, PeerIdType peerId) {
+    if (conn.m_state == CryptoNoteConnectionContext::state_normal) {
+      connections.insert(conn.m_connection_id);
+    }
+  });
+
+  std::map<net_connection_id, NOTIFY_REQUEST_TXS::request> requests;
+  for (const auto& txId : overdueTxs) {
+    auto it = m_requestedTxs.find(txId);
+    RequestedTransaction& request = it->second;
+    while (!request.announcers.empty() && connections.count(request.announcers.front()) == 0) {
+      request.announcers.pop_front();
+    }
+
+    if (stillWanted.count(txId) == 0 || request.announcers.empty()) {
+      m_requestedTxs.erase(it);
+      continue;
+    }
+
+    request.requestTime = now;
+    request.peer = request.announcers.front();
+    request.announcers.pop_front();
+    requests[request.peer].txs.push_back(txId);
+  }
+
+  if (requests.empty()) {
+    return;
+  }
+
+  m_p2p->for_each_connection([&](CryptoNoteConnectionContext& conn, PeerIdType peerId) {
+    auto it = requests.find(conn.m_connection_id);
+    if (it != requests.end()) {
+      logger(Logging::TRACE) << conn << "-->>NOTIFY_REQUEST_TXS: txs.size() = " << it->second.txs.size();
+      post_notify<NOTIFY_REQUEST_TXS>(*m_p2p, it->second, conn);
+    }
+  });
 }
 
 void CryptoNoteProtocolHandler::requestMissingPoolTransactions(const CryptoNoteConnectionContext& context) {
@@ -8,6 +8,9 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
+#include <deque>
+#include <unordered_map>
 
 #include <Common/ObserverManager.h>
 
@@ -26,6 +29,7 @@
 
 namespace System {
   class Dispatcher;
+  class DispatcherPool;
 }
 
 namespace CryptoNote
@@ -44,6 +48,8 @@ namespace CryptoNote
     virtual bool removeObserver(ICryptoNoteProtocolObserver* observer) override;
 
     void set_p2p_endpoint(IP2pEndpoint* p2p);
+    // Core-mutating work of the handlers runs on these dispatchers instead of the network one.
+    void setCoreDispatchers(System::DispatcherPool* dispatchers);
     // ICore& get_core() { return m_core; }
     virtual bool isSynchronized() const override { return m_synchronized; }
     void log_connections();
@@ -61,6 +67,8 @@ namespace CryptoNote
     virtual size_t getPeerCount() const override;
     virtual uint32_t getObservedHeight() const override;
     void requestMissingPoolTransactions(const CryptoNoteConnectionContext& context);
+    // Sends the transaction ids queued for each peer since the last call.
+    void flushTransactionInventory();
 
   private:
     //----------------- commands handlers ----------------------------------------------
@@ -70,7 +78,15 @@ namespace CryptoNote
     int handle_response_get_objects(int command, NOTIFY_RESPONSE_GET_OBJECTS::request& arg, CryptoNoteConnectionContext& context);
     int handle_request_chain(int command, NOTIFY_REQUEST_CHAIN::request& arg, CryptoNoteConnectionContext& context);
     int handle_response_chain_entry(int command, NOTIFY_RESPONSE_CHAIN_ENTRY::request& arg, CryptoNoteConnectionContext& context);
+    int handle_request_blocks_by_range(int command, NOTIFY_REQUEST_BLOCKS_BY_RANGE::request& arg, CryptoNoteConnectionContext& context);
+    int handle_response_blocks_by_range(int command, NOTIFY_RESPONSE_BLOCKS_BY_RANGE::request& arg, CryptoNoteConnectionContext& context);
     int handleRequestTxPool(int command, NOTIFY_REQUEST_TX_POOL::request& arg, CryptoNoteConnectionContext& context);
+    int handle_notify_new_compact_block(int command, NOTIFY_NEW_COMPACT_BLOCK::request& arg, CryptoNoteConnectionContext& context);
+    int handle_request_block_txs(int command, NOTIFY_REQUEST_BLOCK_TXS::request& arg, CryptoNoteConnectionContext& context);
+    int handle_response_block_txs(int command, NOTIFY_RESPONSE_BLOCK_TXS::request& arg, CryptoNoteConnectionContext& context);
+    int handle_notify_tx_inventory(int command, NOTIFY_TX_INVENTORY::request& arg, CryptoNoteConnectionContext& context);
+    int handle_request_txs(int command, NOTIFY_REQUEST_TXS::request& arg, CryptoNoteConnectionContext& context);
+    int handle_txs_not_found(int command, NOTIFY_TXS_NOT_FOUND::request& arg, CryptoNoteConnectionContext& context);
 
     //----------------- i_cryptonote_protocol ----------------------------------
     virtual void relay_block(NOTIFY_NEW_BLOCK::request& arg) override;
@@ -80,9 +96,15 @@ namespace CryptoNote
     uint32_t get_current_blockchain_height();
     bool request_missing_objects(CryptoNoteConnectionContext& context, bool check_having_blocks);
     bool on_connection_synchronized();
+    bool shouldSynchronizeWith(const CryptoNoteConnectionContext& context);
     void updateObservedHeight(uint32_t peerHeight, const CryptoNoteConnectionContext& context);
     void recalculateMaxObservedHeight(const CryptoNoteConnectionContext& context);
     int processObjects(CryptoNoteConnectionContext& context, const std::vector<block_complete_entry>& blocks);
+    void processNewBlock(CryptoNoteConnectionContext& context, NOTIFY_NEW_BLOCK::request& arg, const Crypto::Hash& blockId, const std::vector<Crypto::Hash>* poolTxIds);
+    void relayBlock(NOTIFY_NEW_BLOCK::request& arg, const Crypto::Hash& blockId, bool txsLoaded, const net_connection_id* excludeConnection);
+    void relayTransactions(const std::vector<std::string>& txs, const std::vector<Crypto::Hash>& txIds, const net_connection_id* excludeConnection);
+    void requestOverdueTransactions();
+    void executeInCore(bool ordered, std::function<void()>&& operation);
     Logging::LoggerRef logger;
 
   private:
@@ -93,6 +115,7 @@ namespace CryptoNote
 
     p2p_endpoint_stub m_p2p_stub;
     IP2pEndpoint* m_p2p;
+    System::DispatcherPool* m_coreDispatchers;
     std::atomic<bool> m_synchronized;
     std::atomic<bool> m_stop;
 
@@ -100,6 +123,16 @@ namespace CryptoNote
     uint32_t m_observedHeight;
 
     std::atomic<size_t> m_peersCount;
+    // An announced transaction asked from a peer, and the other peers that announced it since, in the order they
+    // are asked if the request is overdue or the peer no longer has the transaction.
+    struct RequestedTransaction {
+      std::chrono::steady_clock::time_point requestTime;
+      net_connection_id peer;
+      std::deque<net_connection_id> announcers;
+    };
+
+    // Only used on the dispatcher.
+    std::unordered_map<Crypto::Hash, RequestedTransaction> m_requestedTxs;
     Tools::ObserverManager<ICryptoNoteProtocolObserver> m_observerManager;
   };
 }
@@ -8,6 +8,7 @@
 #include "version.h"
 
 #include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
 #include <boost/program_options.hpp>
 
 #include "DaemonCommandsHandler.h"
@@ -25,8 +26,10 @@
 #include "P2p/NetNodeConfig.h"
 #include "Rpc/RpcServer.h"
 #include "Rpc/RpcServerConfig.h"
+#include "System/DispatcherPool.h"
 #include "version.h"
 
+#include "Logging/AsyncLogger.h"
 #include "Logging/ConsoleLogger.h"
 #include <Logging/LoggerManager.h>
 
@@ -49,6 +52,13 @@ namespace
   const command_line::arg_descriptor<bool>        arg_console     = {"no-console", "Disable daemon console commands"};
   const command_line::arg_descriptor<bool>        arg_testnet_on  = {"testnet", "Used to deploy test nets. Checkpoints and hardcoded seeds are ignored, "
     "network id is changed. Use it with --data-dir flag. The wallet must be launched with --testnet flag.", false};
+  const command_line::arg_descriptor<uint32_t>    arg_coroutine_stack_size = {"coroutine-stack-size", "Stack size of each network and RPC coroutine, in KB, 0 keeps the platform default", 0};
+#ifdef __linux__
+  const command_line::arg_descriptor<bool>        arg_io_uring = {"io-uring", "Complete network I/O and timers through io_uring instead of epoll, if the kernel supports it"};
+#endif
+  const command_line::arg_descriptor<uint32_t>    arg_core_threads = {"core-threads", "Number of threads validating blocks and transactions received from peers, 0 validates them on the network thread", 1};
+  const command_line::arg_descriptor<uint32_t>    arg_log_queue_size = {"log-queue-size", "Number of log messages buffered for the background log writer, 0 writes them on the logging thread", 8192};
+  const command_line::arg_descriptor<bool>        arg_log_drop_on_overflow = {"log-drop-on-overflow", "Drop log messages instead of waiting when the log buffer is full"};
   const command_line::arg_descriptor<bool>        arg_print_genesis_tx = { "print-genesis-tx", "Prints genesis' block tx hex to insert it to config and exits" };
 //  const command_line::arg_descriptor<std::vector<std::string>> arg_genesis_block_reward_address = {"genesis-block-reward-address", ""};
 }
@@ -173,9 +183,16 @@ int main(int argc, char* argv[])
 
     command_line::add_arg(desc_cmd_sett, arg_log_file);
     command_line::add_arg(desc_cmd_sett, arg_log_level);
+    command_line::add_arg(desc_cmd_sett, arg_log_queue_size);
+    command_line::add_arg(desc_cmd_sett, arg_log_drop_on_overflow);
     command_line::add_arg(desc_cmd_sett, arg_console);
     command_line::add_arg(desc_cmd_sett, arg_testnet_on);
     command_line::add_arg(desc_cmd_sett, arg_print_genesis_tx);
+    command_line::add_arg(desc_cmd_sett, arg_coroutine_stack_size);
+    command_line::add_arg(desc_cmd_sett, arg_core_threads);
+#ifdef __linux__
+    command_line::add_arg(desc_cmd_sett, arg_io_uring);
+#endif
   //  command_line::add_arg(desc_cmd_sett, arg_genesis_block_reward_address);
 
     RpcServerConfig::initOptions(desc_cmd_sett);
@@ -262,13 +279,24 @@ int main(int argc, char* argv[])
       "                                                    \n" << ENDL;
     logger(INFO) << "Module folder: " << argv[0];
 
+    // the core, P2P and RPC log through a writer thread so they never wait for the log file
+    // held in place rather than on the heap: its queue is cache-line aligned, which plain new does not honour in C++11
+    boost::optional<AsyncLogger> asyncLogger;
+    uint32_t logQueueSize = command_line::get_arg(vm, arg_log_queue_size);
+    if (logQueueSize != 0) {
+      asyncLogger.emplace(logManager, logQueueSize,
+        command_line::get_arg(vm, arg_log_drop_on_overflow) ? AsyncLogger::OverflowPolicy::DROP : AsyncLogger::OverflowPolicy::BLOCK);
+    }
+
+    ILogger& componentLogger = asyncLogger ? static_cast<ILogger&>(*asyncLogger) : logManager;
+
     bool testnet_mode = command_line::get_arg(vm, arg_testnet_on);
     if (testnet_mode) {
       logger(INFO) << "Starting in testnet mode!";
     }
 
     //create objects and link them
-    CryptoNote::CurrencyBuilder currencyBuilder(logManager);
+    CryptoNote::CurrencyBuilder currencyBuilder(componentLogger);
     currencyBuilder.testnet(testnet_mode);
 
     try {
@@ -279,9 +307,9 @@ int main(int argc, char* argv[])
     }
 
     CryptoNote::Currency currency = currencyBuilder.currency();
-    CryptoNote::core ccore(currency, nullptr, logManager);
+    CryptoNote::core ccore(currency, nullptr, componentLogger);
 
-    CryptoNote::Checkpoints checkpoints(logManager);
+    CryptoNote::Checkpoints checkpoints(componentLogger);
     for (const auto& cp : CryptoNote::CHECKPOINTS) {
       checkpoints.add_checkpoint(cp.height, cp.blockId);
     }
@@ -310,11 +338,26 @@ int main(int argc, char* argv[])
       }
     }
 
+#ifdef __linux__
+    System::Dispatcher dispatcher(command_line::get_arg(vm, arg_io_uring));
+#else
     System::Dispatcher dispatcher;
+#endif
+    uint32_t coroutineStackSize = command_line::get_arg(vm, arg_coroutine_stack_size);
+    if (coroutineStackSize != 0) {
+      dispatcher.setStackSize(static_cast<size_t>(coroutineStackSize) * 1024);
+    }
+
+    std::unique_ptr<System::DispatcherPool> coreDispatchers;
+    uint32_t coreThreads = command_line::get_arg(vm, arg_core_threads);
+    if (coreThreads != 0) {
+      coreDispatchers.reset(new System::DispatcherPool(coreThreads));
+    }
 
-    CryptoNote::CryptoNoteProtocolHandler cprotocol(currency, dispatcher, ccore, nullptr, logManager);
-    CryptoNote::NodeServer p2psrv(dispatcher, cprotocol, logManager);
-    CryptoNote::RpcServer rpcServer(dispatcher, logManager, ccore, p2psrv, cprotocol);
+    CryptoNote::CryptoNoteProtocolHandler cprotocol(currency, dispatcher, ccore, nullptr, componentLogger);
+    cprotocol.setCoreDispatchers(coreDispatchers.get());
+    CryptoNote::NodeServer p2psrv(dispatcher, cprotocol, componentLogger);
+    CryptoNote::RpcServer rpcServer(dispatcher, componentLogger, ccore, p2psrv, cprotocol);
 
     cprotocol.set_p2p_endpoint(&p2psrv);
     ccore.set_cryptonote_protocol(&cprotocol);
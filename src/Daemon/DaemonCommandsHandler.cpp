@@ -7,10 +7,13 @@
 
 #include "DaemonCommandsHandler.h"
 
+#include <fstream>
+
 #include "P2p/NetNode.h"
 #include "CryptoNoteCore/Miner.h"
 #include "CryptoNoteCore/Core.h"
 #include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/TraceLog.h"
 #include "CryptoNoteProtocol/CryptoNoteProtocolHandler.h"
 #include "Serialization/SerializationTools.h"
 #include "version.h"
@@ -43,6 +46,9 @@ DaemonCommandsHandler::DaemonCommandsHandler(CryptoNote::core& core, CryptoNote:
   m_consoleHandler.setHandler("show_hr", boost::bind(&DaemonCommandsHandler::show_hr, this, _1), "Start showing hash rate");
   m_consoleHandler.setHandler("hide_hr", boost::bind(&DaemonCommandsHandler::hide_hr, this, _1), "Stop showing hash rate");
   m_consoleHandler.setHandler("set_log", boost::bind(&DaemonCommandsHandler::set_log, this, _1), "set_log <level> - Change current log level, <level> is a number 0-4");
+  m_consoleHandler.setHandler("start_trace", boost::bind(&DaemonCommandsHandler::start_trace, this, _1), "Start recording block and transaction lifecycle events");
+  m_consoleHandler.setHandler("stop_trace", boost::bind(&DaemonCommandsHandler::stop_trace, this, _1), "Stop recording lifecycle events");
+  m_consoleHandler.setHandler("dump_trace", boost::bind(&DaemonCommandsHandler::dump_trace, this, _1), "Write recorded lifecycle events as Chrome trace JSON, dump_trace <file>");
 }
 
 //--------------------------------------------------------------------------------
@@ -178,6 +184,40 @@ bool DaemonCommandsHandler::set_log(const std::vector<std::string>& args)
   return true;
 }
 
+//--------------------------------------------------------------------------------
+bool DaemonCommandsHandler::start_trace(const std::vector<std::string>& args)
+{
+  CryptoNote::TraceLog::clear();
+  CryptoNote::TraceLog::setEnabled(true);
+  std::cout << "Tracing started" << ENDL;
+  return true;
+}
+//--------------------------------------------------------------------------------
+bool DaemonCommandsHandler::stop_trace(const std::vector<std::string>& args)
+{
+  CryptoNote::TraceLog::setEnabled(false);
+  std::cout << "Tracing stopped" << ENDL;
+  return true;
+}
+//--------------------------------------------------------------------------------
+bool DaemonCommandsHandler::dump_trace(const std::vector<std::string>& args)
+{
+  if (args.size() != 1) {
+    std::cout << "use: dump_trace <file>" << ENDL;
+    return true;
+  }
+
+  std::ofstream file(args[0], std::ios::trunc);
+  if (!file) {
+    std::cout << "can't open " << args[0] << ENDL;
+    return true;
+  }
+
+  size_t count = CryptoNote::TraceLog::dumpChromeTrace(file);
+  std::cout << count << " events written to " << args[0] << ENDL;
+  return true;
+}
+
 //--------------------------------------------------------------------------------
 bool DaemonCommandsHandler::print_block_by_height(uint32_t height)
 {
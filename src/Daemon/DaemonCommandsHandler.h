@@ -55,6 +55,9 @@ private:
   bool print_bc(const std::vector<std::string>& args);
   bool print_bci(const std::vector<std::string>& args);
   bool set_log(const std::vector<std::string>& args);
+  bool start_trace(const std::vector<std::string>& args);
+  bool stop_trace(const std::vector<std::string>& args);
+  bool dump_trace(const std::vector<std::string>& args);
   bool print_block(const std::vector<std::string>& args);
   bool print_tx(const std::vector<std::string>& args);
   bool print_pool(const std::vector<std::string>& args);
@@ -60,12 +60,21 @@ void JsonRpcServer::processRequest(const CryptoNote::HttpRequest& req, CryptoNot
         return;
       }
 
-      processJsonRpcRequest(jsonRpcRequest, jsonRpcResponse);
+      if (jsonRpcRequest.isArray()) {
+        processJsonRpcBatch(jsonRpcRequest, jsonRpcResponse);
+      } else {
+        processJsonRpcRequest(jsonRpcRequest, jsonRpcResponse);
+      }
+
+      resp.setStatus(CryptoNote::HttpResponse::STATUS_200);
+
+      // a batch of notifications only is answered with nothing at all
+      if (jsonRpcResponse.isArray() && jsonRpcResponse.size() == 0) {
+        return;
+      }
 
       std::ostringstream jsonOutputStream;
       jsonOutputStream << jsonRpcResponse;
-
-      resp.setStatus(CryptoNote::HttpResponse::STATUS_200);
       resp.setBody(jsonOutputStream.str());
 
     } else {
@@ -79,6 +88,34 @@ void JsonRpcServer::processRequest(const CryptoNote::HttpRequest& req, CryptoNot
   }
 }
 
+void JsonRpcServer::processJsonRpcBatch(const Common::JsonValue& batch, Common::JsonValue& resp) {
+  using Common::JsonValue;
+
+  if (batch.size() == 0) {
+    resp.insert("jsonrpc", "2.0");
+    makeGenericErrorReponse(resp, "Invalid Request", -32600);
+    return;
+  }
+
+  // notifications, members without an id, are run but get no response
+  resp = JsonValue(JsonValue::ARRAY);
+  for (size_t i = 0; i < batch.size(); ++i) {
+    JsonValue callResponse(JsonValue::OBJECT);
+
+    if (batch[i].isObject()) {
+      processJsonRpcRequest(batch[i], callResponse);
+      if (batch[i].contains("method") && !batch[i].contains("id")) {
+        continue;
+      }
+    } else {
+      callResponse.insert("jsonrpc", "2.0");
+      makeGenericErrorReponse(callResponse, "Invalid Request", -32600);
+    }
+
+    resp.pushBack(std::move(callResponse));
+  }
+}
+
 void JsonRpcServer::prepareJsonResponse(const Common::JsonValue& req, Common::JsonValue& resp) {
   using Common::JsonValue;
 
@@ -47,6 +47,7 @@ protected:
   static void makeJsonParsingErrorResponse(Common::JsonValue& resp);
 
   virtual void processJsonRpcRequest(const Common::JsonValue& req, Common::JsonValue& resp) = 0;
+  virtual void processJsonRpcBatch(const Common::JsonValue& batch, Common::JsonValue& resp);
 
 private:
   // HttpServer
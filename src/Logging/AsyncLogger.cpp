@@ -0,0 +1,76 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "AsyncLogger.h"
+
+namespace Logging {
+
+namespace {
+
+const size_t MAX_BATCH_SIZE = 256;
+const std::chrono::milliseconds FLUSH_POLL_INTERVAL(10);
+
+}
+
+AsyncLogger::AsyncLogger(ILogger& logger, size_t queueSize, OverflowPolicy policy) :
+  logger(logger), policy(policy), queue(queueSize), queuedCount(0), droppedCount(0), writtenCount(0) {
+  writer = std::thread(&AsyncLogger::writerThread, this);
+}
+
+AsyncLogger::~AsyncLogger() {
+  queue.close();
+  writer.join();
+}
+
+void AsyncLogger::operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) {
+  // counted before it takes a slot, so flush() never misses a message that is already queued
+  ++queuedCount;
+  Entry entry = { category, level, time, body };
+  bool queued = policy == OverflowPolicy::DROP ? queue.tryPush(std::move(entry)) : queue.push(std::move(entry));
+  if (!queued) {
+    ++droppedCount;
+  }
+}
+
+void AsyncLogger::flush() {
+  uint64_t target = queuedCount.load();
+  std::unique_lock<std::mutex> lock(writtenMutex);
+  while (writtenCount + droppedCount.load() < target) {
+    // dropped messages don't wake anybody up
+    writtenChanged.wait_for(lock, FLUSH_POLL_INTERVAL);
+  }
+}
+
+uint64_t AsyncLogger::getDroppedCount() const {
+  return droppedCount.load();
+}
+
+void AsyncLogger::writerThread() {
+  uint64_t reportedDrops = 0;
+  Entry entry;
+  while (queue.pop(entry)) {
+    uint64_t written = 0;
+    do {
+      logger(entry.category, entry.level, entry.time, entry.body);
+      ++written;
+    } while (written < MAX_BATCH_SIZE && queue.tryPop(entry));
+
+    uint64_t drops = droppedCount.load();
+    if (drops != reportedDrops) {
+      logger("AsyncLogger", WARNING, boost::posix_time::microsec_clock::local_time(),
+        YELLOW + std::to_string(drops - reportedDrops) + " log messages were dropped, the log buffer was full\n");
+      reportedDrops = drops;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(writtenMutex);
+      writtenCount += written;
+    }
+
+    writtenChanged.notify_all();
+  }
+}
+
+}
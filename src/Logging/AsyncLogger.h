@@ -0,0 +1,61 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "Common/MpmcQueue.h"
+#include "ILogger.h"
+
+namespace Logging {
+
+// Hands messages to a writer thread that passes them to the wrapped logger, so the logging thread
+// never waits for the file or the console. When the buffer is full a message either waits for
+// room or is dropped; dropped messages are counted and reported by the writer.
+class AsyncLogger : public ILogger {
+public:
+  enum class OverflowPolicy {
+    BLOCK,
+    DROP
+  };
+
+  AsyncLogger(ILogger& logger, size_t queueSize = 8192, OverflowPolicy policy = OverflowPolicy::BLOCK);
+  AsyncLogger(const AsyncLogger&) = delete;
+  AsyncLogger& operator=(const AsyncLogger&) = delete;
+  // Writes every queued message before returning.
+  ~AsyncLogger();
+
+  virtual void operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) override;
+
+  // Waits until every message logged before the call has been written.
+  void flush();
+  uint64_t getDroppedCount() const;
+
+private:
+  struct Entry {
+    std::string category;
+    Level level;
+    boost::posix_time::ptime time;
+    std::string body;
+  };
+
+  void writerThread();
+
+  ILogger& logger;
+  const OverflowPolicy policy;
+  Common::MpmcQueue<Entry> queue;
+  std::atomic<uint64_t> queuedCount;
+  std::atomic<uint64_t> droppedCount;
+  uint64_t writtenCount;
+  std::mutex writtenMutex;
+  std::condition_variable writtenChanged;
+  std::thread writer;
+};
+
+}
@@ -24,6 +24,14 @@ enum Level {
   TRACE = 5
 };
 
+// Messages above LOGGING_MAX_LEVEL are compiled out: LoggerMessage neither formats nor forwards them.
+// Release builds can pass e.g. -DLOGGING_MAX_LEVEL=INFO to take DEBUGGING and TRACE off the hot paths.
+#ifndef LOGGING_MAX_LEVEL
+#define LOGGING_MAX_LEVEL TRACE
+#endif
+
+const Level COMPILED_MAX_LEVEL = LOGGING_MAX_LEVEL;
+
 extern const std::string BLUE;
 extern const std::string GREEN;
 extern const std::string RED;
@@ -16,8 +16,12 @@ LoggerMessage::LoggerMessage(ILogger& logger, const std::string& category, Level
   , category(category)
   , logLevel(level)
   , message(color)
-  , timestamp(boost::posix_time::microsec_clock::local_time())
+  , timestamp(level > COMPILED_MAX_LEVEL ? boost::posix_time::ptime() : boost::posix_time::microsec_clock::local_time())
   , gotText(false) {
+  if (level > COMPILED_MAX_LEVEL) {
+    // a bad stream skips every insertion, so nothing gets formatted
+    setstate(std::ios_base::badbit);
+  }
 }
 
 LoggerMessage::~LoggerMessage() {
@@ -91,6 +95,10 @@ LoggerMessage::LoggerMessage(LoggerMessage&& other)
 #endif
 
 int LoggerMessage::sync() {
+  if (logLevel > COMPILED_MAX_LEVEL) {
+    return 0;
+  }
+
   logger(category, logLevel, timestamp, message);
   gotText = false;
   message = DEFAULT;
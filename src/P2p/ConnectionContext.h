@@ -7,13 +7,19 @@
 
 #pragma once
 
+#include <chrono>
 #include <list>
 #include <ostream>
+#include <string>
 #include <unordered_set>
+#include <vector>
 
 #include <boost/uuid/uuid.hpp>
+#include "Common/RollingBloomFilter.h"
 #include "Common/StringTools.h"
+#include "CryptoNoteConfig.h"
 #include "crypto/hash.h"
+#include "PeerScore.h"
 
 namespace CryptoNote {
 
@@ -40,6 +46,26 @@ struct CryptoNoteConnectionContext {
   std::unordered_set<Crypto::Hash> m_requested_objects;
   uint32_t m_remote_blockchain_height = 0;
   uint32_t m_last_response_height = 0;
+  uint32_t m_remote_capabilities = 0;
+  // Blocks-by-range sync: the last block known to be on the peer's chain, the height that follows it and how many
+  // blocks the request in flight asked for. m_range_next_height is 0 while the fork point is not known.
+  Crypto::Hash m_range_anchor_id = {};
+  uint32_t m_range_next_height = 0;
+  uint32_t m_range_requested_count = 0;
+  // Compact block waiting for the transactions requested with NOTIFY_REQUEST_BLOCK_TXS, empty if there is none.
+  std::string m_pending_block;
+  Crypto::Hash m_pending_block_id = {};
+  uint32_t m_pending_block_hop = 0;
+  std::vector<Crypto::Hash> m_pending_block_missing_txs;
+  // Transactions the peer is known to have, because it sent or announced them or they were sent or announced to it.
+  Common::RollingBloomFilter m_known_txs{P2P_KNOWN_TXS_FILTER_SIZE, 0.00001};
+  // Transaction ids for the next NOTIFY_TX_INVENTORY.
+  std::vector<Crypto::Hash> m_tx_inventory;
+  // Seeded from the peerlist for outgoing connections and stored back to it when they close.
+  PeerScore m_peer_score;
+  // When the block request in flight was sent, and when synchronization last made progress with the peer.
+  std::chrono::steady_clock::time_point m_blocks_requested_at;
+  std::chrono::steady_clock::time_point m_sync_progress_at;
 };
 
 inline std::string get_protocol_state_string(CryptoNoteConnectionContext::state s) {
@@ -6,7 +6,13 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "LevinProtocol.h"
-#include <System/TcpConnection.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <string>
+
+#include "Common/Metrics.h"
 
 using namespace CryptoNote;
 
@@ -32,6 +38,52 @@ struct bucket_head2
 };
 #pragma pack(pop)
 
+struct CommandTraffic {
+  Common::MetricCounter& receivedMessages;
+  Common::MetricCounter& receivedBytes;
+  Common::MetricCounter& sentMessages;
+  Common::MetricCounter& sentBytes;
+};
+
+// Command ids are small offsets from a thousand based pool (P2P commands from 1000, protocol ones from 2000),
+// so the counters of the common ones are found by index; anything else is reported as "other".
+const uint32_t TRAFFIC_POOL_COUNT = 4;
+const uint32_t TRAFFIC_POOL_SIZE = 64;
+std::array<std::atomic<CommandTraffic*>, TRAFFIC_POOL_COUNT * TRAFFIC_POOL_SIZE> commandTraffic;
+
+CommandTraffic* createCommandTraffic(const std::string& command) {
+  std::string labels = Common::Metrics::label("command", command);
+  return new CommandTraffic {
+    Common::Metrics::counter("ultranote_p2p_received_messages_total", "Levin messages received, by command", labels),
+    Common::Metrics::counter("ultranote_p2p_received_bytes_total", "Levin bytes received including headers, by command", labels),
+    Common::Metrics::counter("ultranote_p2p_sent_messages_total", "Levin messages sent, by command", labels),
+    Common::Metrics::counter("ultranote_p2p_sent_bytes_total", "Levin bytes sent including headers, by command", labels)
+  };
+}
+
+CommandTraffic& getCommandTraffic(uint32_t command) {
+  uint32_t pool = command / 1000;
+  uint32_t offset = command % 1000;
+  if (pool == 0 || pool > TRAFFIC_POOL_COUNT || offset >= TRAFFIC_POOL_SIZE) {
+    static CommandTraffic* other = createCommandTraffic("other");
+    return *other;
+  }
+
+  std::atomic<CommandTraffic*>& slot = commandTraffic[(pool - 1) * TRAFFIC_POOL_SIZE + offset];
+  CommandTraffic* traffic = slot.load(std::memory_order_acquire);
+  if (traffic == nullptr) {
+    // the registry hands out the same counters to a racing thread, so losing the race costs only the copy
+    CommandTraffic* created = createCommandTraffic(std::to_string(command));
+    if (slot.compare_exchange_strong(traffic, created, std::memory_order_acq_rel)) {
+      traffic = created;
+    } else {
+      delete created;
+    }
+  }
+
+  return *traffic;
+}
+
 }
 
 bool LevinProtocol::Command::needReply() const {
@@ -42,23 +94,35 @@ LevinProtocol::LevinProtocol(System::TcpConnection& connection)
   : m_conn(connection) {}
 
 void LevinProtocol::sendMessage(uint32_t command, const BinaryArray& out, bool needResponse) {
-  bucket_head2 head = { 0 };
-  head.m_signature = LEVIN_SIGNATURE;
-  head.m_cb = out.size();
-  head.m_have_to_return_data = needResponse;
-  head.m_command = command;
-  head.m_protocol_version = LEVIN_PROTOCOL_VER_1;
-  head.m_flags = LEVIN_PACKET_REQUEST;
-
-  // write header and body in one operation
-  BinaryArray writeBuffer;
-  writeBuffer.reserve(sizeof(head) + out.size());
-
-  Common::VectorOutputStream stream(writeBuffer);
-  stream.writeSome(&head, sizeof(head));
-  stream.writeSome(out.data(), out.size());
-
-  writeStrict(writeBuffer.data(), writeBuffer.size());
+  sendMessages({ { command, &out, needResponse, false, 0 } });
+}
+
+void LevinProtocol::sendMessages(const std::vector<OutgoingMessage>& messages) {
+  std::vector<bucket_head2> heads(messages.size());
+  std::vector<System::TcpConnection::Buffer> buffers;
+  buffers.reserve(messages.size() * 2);
+
+  for (size_t i = 0; i < messages.size(); ++i) {
+    const OutgoingMessage& message = messages[i];
+    bucket_head2& head = heads[i];
+    head = { 0 };
+    head.m_signature = LEVIN_SIGNATURE;
+    head.m_cb = message.body->size();
+    head.m_have_to_return_data = message.needResponse;
+    head.m_command = message.command;
+    head.m_protocol_version = LEVIN_PROTOCOL_VER_1;
+    head.m_flags = message.isResponse ? LEVIN_PACKET_RESPONSE : LEVIN_PACKET_REQUEST;
+    head.m_return_code = message.returnCode;
+
+    buffers.push_back({ reinterpret_cast<const uint8_t*>(&head), sizeof(head) });
+    buffers.push_back({ message.body->data(), message.body->size() });
+
+    CommandTraffic& traffic = getCommandTraffic(message.command);
+    traffic.sentMessages.inc();
+    traffic.sentBytes.inc(sizeof(head) + message.body->size());
+  }
+
+  writeStrict(buffers);
 }
 
 bool LevinProtocol::readCommand(Command& cmd) {
@@ -85,6 +149,10 @@ bool LevinProtocol::readCommand(Command& cmd) {
     }
   }
 
+  CommandTraffic& traffic = getCommandTraffic(head.m_command);
+  traffic.receivedMessages.inc();
+  traffic.receivedBytes.inc(sizeof(head) + head.m_cb);
+
   cmd.command = head.m_command;
   cmd.buf = std::move(buf);
   cmd.isNotify = !head.m_have_to_return_data;
@@ -94,29 +162,27 @@ bool LevinProtocol::readCommand(Command& cmd) {
 }
 
 void LevinProtocol::sendReply(uint32_t command, const BinaryArray& out, int32_t returnCode) {
-  bucket_head2 head = { 0 };
-  head.m_signature = LEVIN_SIGNATURE;
-  head.m_cb = out.size();
-  head.m_have_to_return_data = false;
-  head.m_command = command;
-  head.m_protocol_version = LEVIN_PROTOCOL_VER_1;
-  head.m_flags = LEVIN_PACKET_RESPONSE;
-  head.m_return_code = returnCode;
-
-  BinaryArray writeBuffer;
-  writeBuffer.reserve(sizeof(head) + out.size());
-
-  Common::VectorOutputStream stream(writeBuffer);
-  stream.writeSome(&head, sizeof(head));
-  stream.writeSome(out.data(), out.size());
-
-  writeStrict(writeBuffer.data(), writeBuffer.size());
+  sendMessages({ { command, &out, false, true, returnCode } });
 }
 
-void LevinProtocol::writeStrict(const uint8_t* ptr, size_t size) {
-  size_t offset = 0;
-  while (offset < size) {
-    offset += m_conn.write(ptr + offset, size - offset);
+void LevinProtocol::writeStrict(std::vector<System::TcpConnection::Buffer>& buffers) {
+  size_t first = 0;
+  while (first < buffers.size()) {
+    if (buffers[first].size == 0) {
+      ++first;
+      continue;
+    }
+
+    size_t written = m_conn.writeBuffers(&buffers[first], buffers.size() - first);
+    while (written > 0) {
+      size_t consumed = std::min(written, buffers[first].size);
+      buffers[first].data += consumed;
+      buffers[first].size -= consumed;
+      written -= consumed;
+      if (buffers[first].size == 0) {
+        ++first;
+      }
+    }
   }
 }
 
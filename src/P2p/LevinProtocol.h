@@ -7,15 +7,14 @@
 
 #pragma once
 
+#include <vector>
+
 #include "CryptoNote.h"
 #include <Common/MemoryInputStream.h>
 #include <Common/VectorOutputStream.h>
 #include "Serialization/KVBinaryInputStreamSerializer.h"
 #include "Serialization/KVBinaryOutputStreamSerializer.h"
-
-namespace System {
-class TcpConnection;
-}
+#include <System/TcpConnection.h>
 
 namespace CryptoNote {
 
@@ -67,8 +66,18 @@ public:
 
   bool readCommand(Command& cmd);
 
+  struct OutgoingMessage {
+    uint32_t command;
+    const BinaryArray* body;
+    bool needResponse;
+    bool isResponse;
+    int32_t returnCode;
+  };
+
   void sendMessage(uint32_t command, const BinaryArray& out, bool needResponse);
   void sendReply(uint32_t command, const BinaryArray& out, int32_t returnCode);
+  // Frames all messages and writes headers and bodies with gathered writes, without copying the bodies.
+  void sendMessages(const std::vector<OutgoingMessage>& messages);
 
   template <typename T>
   static bool decode(const BinaryArray& buf, T& value) {
@@ -96,7 +105,7 @@ public:
 private:
 
   bool readStrict(uint8_t* ptr, size_t size);
-  void writeStrict(const uint8_t* ptr, size_t size);
+  void writeStrict(std::vector<System::TcpConnection::Buffer>& buffers);
   System::TcpConnection& m_conn;
 };
 
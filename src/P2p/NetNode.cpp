@@ -28,6 +28,7 @@
 #include <System/TcpConnector.h>
  
 #include "version.h"
+#include "Common/Metrics.h"
 #include "Common/StdInputStream.h"
 #include "Common/StdOutputStream.h"
 #include "Common/Util.h"
@@ -49,6 +50,14 @@ using namespace CryptoNote;
 
 namespace {
 
+Common::MetricCounter& connectionsOpened(bool incoming) {
+  static Common::MetricCounter& in = Common::Metrics::counter("ultranote_p2p_connections_opened_total", "P2P connections established",
+    Common::Metrics::label("direction", "in"));
+  static Common::MetricCounter& out = Common::Metrics::counter("ultranote_p2p_connections_opened_total", "P2P connections established",
+    Common::Metrics::label("direction", "out"));
+  return incoming ? in : out;
+}
+
 size_t get_random_index_with_fixed_probability(size_t max_index) {
   //divide by zero workaround
   if (!max_index)
@@ -135,6 +144,9 @@ namespace CryptoNote
     writeQueueSize += msg.size();
 
     if (writeQueueSize > P2P_CONNECTION_MAX_WRITE_BUFFER_SIZE) {
+      static Common::MetricCounter& overflows = Common::Metrics::counter("ultranote_p2p_write_queue_overflows_total",
+        "P2P connections dropped because their write queue overflowed");
+      overflows.inc();
       logger(DEBUGGING) << *this << "Write queue overflows. Interrupt connection";
       interrupt();
       return false;
@@ -203,6 +215,7 @@ namespace CryptoNote
     m_idleTimer(m_dispatcher),
     m_timedSyncTimer(m_dispatcher),
     m_timeoutTimer(m_dispatcher),
+    m_txRelayTimer(m_dispatcher),
     m_stop(false),
     // intervals
     // m_peer_handshake_idle_maker_interval(CryptoNote::P2P_DEFAULT_HANDSHAKE_INTERVAL),
@@ -494,6 +507,7 @@ namespace CryptoNote
     m_workingContextGroup.spawn(std::bind(&NodeServer::onIdle, this));
     m_workingContextGroup.spawn(std::bind(&NodeServer::timedSyncLoop, this));
     m_workingContextGroup.spawn(std::bind(&NodeServer::timeoutLoop, this));
+    m_workingContextGroup.spawn(std::bind(&NodeServer::txRelayLoop, this));
 
     m_stopEvent.wait();
 
@@ -584,6 +598,7 @@ namespace CryptoNote
 	};
 	*/ 
 	
+    auto handshakeStart = std::chrono::steady_clock::now();
     if (!proto.invoke(COMMAND_HANDSHAKE::ID, arg, rsp)) {
       logger(Logging::ERROR) << context << "Failed to invoke COMMAND_HANDSHAKE, closing connection.";	  
 	  //logArgAndResp();
@@ -593,6 +608,8 @@ namespace CryptoNote
 	//  logArgAndResp();
 	//}
 
+    context.m_peer_score.addHandshakeRtt(static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - handshakeStart).count()));
     context.version = rsp.node_data.version;
 
     if (rsp.node_data.network_id != m_network_id) {
@@ -631,13 +648,17 @@ namespace CryptoNote
     COMMAND_TIMED_SYNC::request arg = boost::value_initialized<COMMAND_TIMED_SYNC::request>();
     m_payload_handler.get_payload_sync_data(arg.payload_data);
     auto cmdBuf = LevinProtocol::encode<COMMAND_TIMED_SYNC::request>(arg);
+    auto now = P2pConnectionContext::Clock::now();
 
     forEachConnection([&](P2pConnectionContext& conn) {
       if (conn.peerId && 
           (conn.m_state == CryptoNoteConnectionContext::state_normal || 
            conn.m_state == CryptoNoteConnectionContext::state_idle)) {
+        conn.timedSyncStartTime = now;
         conn.pushMessage(P2pMessage(P2pMessage::COMMAND, COMMAND_TIMED_SYNC::ID, cmdBuf));
       }
+
+      store_peer_score(conn);
     });
 
     return true;
@@ -649,6 +670,12 @@ namespace CryptoNote
       return false;
     }
 
+    if (context.timedSyncStartTime != P2pConnectionContext::TimePoint()) {
+      context.m_peer_score.addHandshakeRtt(static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(P2pConnectionContext::Clock::now() - context.timedSyncStartTime).count()));
+      context.timedSyncStartTime = P2pConnectionContext::TimePoint();
+    }
+
     if (!handle_remote_peerlist(rsp.local_peerlist, rsp.local_time, context)) {
       logger(Logging::ERROR) << context << "COMMAND_TIMED_SYNC: failed to handle_remote_peerlist(...), closing connection.";
       return false;
@@ -740,6 +767,7 @@ namespace CryptoNote
       ctx.m_remote_port = na.port;
       ctx.m_is_income = false;
       ctx.m_started = time(nullptr);
+      m_peerlist.get_peer_score(na, ctx.m_peer_score);
 
 
       try {
@@ -782,6 +810,7 @@ namespace CryptoNote
       auto iter = m_connections.emplace(ctx.m_connection_id, std::move(ctx)).first;
       const boost::uuids::uuid& connectionId = iter->first;
       P2pConnectionContext& connectionContext = iter->second;
+      connectionsOpened(false).inc();
 	  
       m_workingContextGroup.spawn(std::bind(&NodeServer::connectionHandler, this, std::cref(connectionId), std::ref(connectionContext)));
 	  
@@ -806,10 +835,13 @@ namespace CryptoNote
     size_t max_random_index = std::min<uint64_t>(local_peers_count -1, 20);
 
     std::set<size_t> tried_peers;
+    // a few random peers are picked as before, then tried best score first; peers that recently sent invalid data are skipped
+    std::vector<std::pair<int64_t, PeerlistEntry>> candidates;
+    uint64_t now = time(nullptr);
 
     size_t try_count = 0;
     size_t rand_count = 0;
-    while(rand_count < (max_random_index+1)*3 &&  try_count < 10 && !m_stop) {
+    while(rand_count < (max_random_index+1)*3 &&  try_count < 10 && candidates.size() < P2P_CONNECTION_CANDIDATES_COUNT && !m_stop) {
       ++rand_count;
       size_t random_index = get_random_index_with_fixed_probability(max_random_index);
       if (!(random_index < local_peers_count)) { logger(ERROR, BRIGHT_RED) << "random_starter_index < peers_local.size() failed!!"; return false; }
@@ -827,13 +859,31 @@ namespace CryptoNote
       if(is_peer_used(pe))
         continue;
 
-      logger(DEBUGGING) << "Selected peer: " << pe.id << " " << pe.adr << " [white=" << use_white_list
-                    << "] last_seen: " << (pe.last_seen ? Common::timeIntervalToString(time(NULL) - pe.last_seen) : "never");
-      
-      if(!try_to_connect_and_handshake_with_new_peer(pe.adr, false, pe.last_seen, use_white_list))
+      PeerScore score;
+      m_peerlist.get_peer_score(pe.adr, score);
+      if (score.getStrikes(now) >= P2P_PEER_MAX_STRIKES) {
+        logger(DEBUGGING) << "Skipping peer " << pe.adr << ": " << score.getStrikes(now) << " strikes";
         continue;
+      }
 
-      return true;
+      candidates.emplace_back(score.getValue(now), pe);
+    }
+
+    std::stable_sort(candidates.begin(), candidates.end(), [](const std::pair<int64_t, PeerlistEntry>& a, const std::pair<int64_t, PeerlistEntry>& b) {
+      return a.first > b.first;
+    });
+
+    for (const auto& candidate : candidates) {
+      if (m_stop) {
+        break;
+      }
+
+      const PeerlistEntry& pe = candidate.second;
+      logger(DEBUGGING) << "Selected peer: " << pe.id << " " << pe.adr << " [white=" << use_white_list
+                    << "] score: " << candidate.first << " last_seen: " << (pe.last_seen ? Common::timeIntervalToString(time(NULL) - pe.last_seen) : "never");
+
+      if(try_to_connect_and_handshake_with_new_peer(pe.adr, false, pe.last_seen, use_white_list))
+        return true;
     }
     return false;
   }
@@ -911,6 +961,43 @@ namespace CryptoNote
     }
     return true;
   }
+  //-----------------------------------------------------------------------------------
+
+  void NodeServer::evict_worst_connection()
+  {
+    // a peer is only replaced when all outgoing slots are taken, so that a better one from the peerlist can get its slot
+    if (get_outgoing_connections_count() < m_config.m_net_config.connections_count) {
+      return;
+    }
+
+    uint64_t now = time(nullptr);
+    P2pConnectionContext* worst = nullptr;
+    int64_t worstScore = P2P_PEER_EVICTION_SCORE;
+    for (auto& kv : m_connections) {
+      auto& ctx = kv.second;
+      if (ctx.m_is_income || !ctx.peerId || ctx.m_state == CryptoNoteConnectionContext::state_shutdown) {
+        continue;
+      }
+
+      NetworkAddress na;
+      na.ip = ctx.m_remote_ip;
+      na.port = ctx.m_remote_port;
+      if (is_priority_node(na)) {
+        continue;
+      }
+
+      int64_t score = ctx.m_peer_score.getValue(now);
+      if (score < worstScore) {
+        worst = &ctx;
+        worstScore = score;
+      }
+    }
+
+    if (worst != nullptr) {
+      logger(DEBUGGING) << *worst << "Replacing peer with score " << worstScore;
+      worst->interrupt();
+    }
+  }
 
   //-----------------------------------------------------------------------------------
   size_t NodeServer::get_outgoing_connections_count() {
@@ -1066,12 +1153,17 @@ namespace CryptoNote
   
   void NodeServer::relay_notify_to_all(int command, const BinaryArray& data_buff, const net_connection_id* excludeConnection) {
     net_connection_id excludeId = excludeConnection ? *excludeConnection : boost::value_initialized<net_connection_id>();
+    std::shared_ptr<const BinaryArray> sharedBuffer;
 
     forEachConnection([&](P2pConnectionContext& conn) {
       if (conn.peerId && conn.m_connection_id != excludeId &&
           (conn.m_state == CryptoNoteConnectionContext::state_normal ||
            conn.m_state == CryptoNoteConnectionContext::state_synchronizing)) {
-        conn.pushMessage(P2pMessage(P2pMessage::NOTIFY, command, data_buff));
+        if (!sharedBuffer) {
+          sharedBuffer = std::make_shared<const BinaryArray>(data_buff);
+        }
+
+        conn.pushMessage(P2pMessage(P2pMessage::NOTIFY, command, sharedBuffer));
       }
     });
   }
@@ -1259,6 +1351,20 @@ namespace CryptoNote
   {
     logger(TRACE) << context << "CLOSE CONNECTION";
     m_payload_handler.onConnectionClosed(context);
+    store_peer_score(context);
+  }
+
+  void NodeServer::store_peer_score(const P2pConnectionContext& context)
+  {
+    // the address of an incoming connection is not the one the peer listens on
+    if (context.m_is_income || !context.peerId) {
+      return;
+    }
+
+    NetworkAddress na;
+    na.ip = context.m_remote_ip;
+    na.port = context.m_remote_port;
+    m_peerlist.set_peer_score(na, context.m_peer_score);
   }
   
   bool NodeServer::is_priority_node(const NetworkAddress& na)
@@ -1311,6 +1417,7 @@ namespace CryptoNote
         auto iter = m_connections.emplace(ctx.m_connection_id, std::move(ctx)).first;
         const boost::uuids::uuid& connectionId = iter->first;
         P2pConnectionContext& connection = iter->second;
+        connectionsOpened(true).inc();
 
         m_workingContextGroup.spawn(std::bind(&NodeServer::connectionHandler, this, std::cref(connectionId), std::ref(connection)));
       } catch (System::InterruptedException&) {
@@ -1368,6 +1475,7 @@ namespace CryptoNote
       for (;;) {
         m_timedSyncTimer.sleep(std::chrono::seconds(P2P_DEFAULT_HANDSHAKE_INTERVAL));
         timedSync();
+        evict_worst_connection();
       }
     } catch (System::InterruptedException&) {
       logger(DEBUGGING) << "timedSyncLoop() is interrupted";
@@ -1378,6 +1486,19 @@ namespace CryptoNote
     logger(DEBUGGING) << "timedSyncLoop finished";
   }
 
+  void NodeServer::txRelayLoop() {
+    try {
+      while (!m_stop) {
+        m_txRelayTimer.sleep(std::chrono::milliseconds(P2P_DEFAULT_TX_RELAY_INTERVAL));
+        m_payload_handler.flushTransactionInventory();
+      }
+    } catch (System::InterruptedException&) {
+      logger(DEBUGGING) << "txRelayLoop() is interrupted";
+    } catch (std::exception& e) {
+      logger(WARNING) << "Exception in txRelayLoop: " << e.what();
+    }
+  }
+
   void NodeServer::connectionHandler(const boost::uuids::uuid& connectionId, P2pConnectionContext& ctx) {
     // This inner context is necessary in order to stop connection handler at any moment
     System::Context<> context(m_dispatcher, [this, &connectionId, &ctx] {
@@ -1455,22 +1576,27 @@ namespace CryptoNote
           break;
         }
 
+        // everything queued since the last wakeup goes out in as few writes as possible
+        std::vector<LevinProtocol::OutgoingMessage> outgoing;
+        outgoing.reserve(msgs.size());
         for (const auto& msg : msgs) {
           logger(DEBUGGING) << ctx << "msg " << msg.type << ':' << msg.command;
           switch (msg.type) {
           case P2pMessage::COMMAND:
-            proto.sendMessage(msg.command, msg.buffer, true);
+            outgoing.push_back({ msg.command, msg.buffer.get(), true, false, 0 });
             break;
           case P2pMessage::NOTIFY:
-            proto.sendMessage(msg.command, msg.buffer, false);
+            outgoing.push_back({ msg.command, msg.buffer.get(), false, false, 0 });
             break;
           case P2pMessage::REPLY:
-            proto.sendReply(msg.command, msg.buffer, msg.returnCode);
+            outgoing.push_back({ msg.command, msg.buffer.get(), false, true, msg.returnCode });
             break;
           default:
             assert(false);
           }
         }
+
+        proto.sendMessages(outgoing);
       }
     } catch (System::InterruptedException&) {
       // connection stopped
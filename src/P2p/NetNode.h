@@ -8,6 +8,7 @@
 #pragma once
 
 #include <functional>
+#include <memory>
 #include <unordered_map>
 
 #include <boost/functional/hash.hpp>
@@ -50,6 +51,15 @@ namespace CryptoNote
     };
 
     P2pMessage(Type type, uint32_t command, const BinaryArray& buffer, int32_t returnCode = 0) :
+      type(type), command(command), buffer(std::make_shared<const BinaryArray>(buffer)), returnCode(returnCode) {
+    }
+
+    P2pMessage(Type type, uint32_t command, BinaryArray&& buffer, int32_t returnCode = 0) :
+      type(type), command(command), buffer(std::make_shared<const BinaryArray>(std::move(buffer))), returnCode(returnCode) {
+    }
+
+    // Lets a relayed notification share one body across every connection it is queued on.
+    P2pMessage(Type type, uint32_t command, const std::shared_ptr<const BinaryArray>& buffer, int32_t returnCode = 0) :
       type(type), command(command), buffer(buffer), returnCode(returnCode) {
     }
 
@@ -58,12 +68,12 @@ namespace CryptoNote
     }
 
     size_t size() {
-      return buffer.size();
+      return buffer->size();
     }
 
     Type type;
     uint32_t command;
-    const BinaryArray buffer;
+    std::shared_ptr<const BinaryArray> buffer;
     int32_t returnCode;
   };
 
@@ -75,6 +85,7 @@ namespace CryptoNote
     System::Context<void>* context;
     PeerIdType peerId;
     System::TcpConnection connection;
+    TimePoint timedSyncStartTime;
 
     P2pConnectionContext(System::Dispatcher& dispatcher, Logging::ILogger& log, System::TcpConnection&& conn) :
       context(nullptr),
@@ -90,6 +101,7 @@ namespace CryptoNote
       context(ctx.context),
       peerId(ctx.peerId),
       connection(std::move(ctx.connection)),
+      timedSyncStartTime(ctx.timedSyncStartTime),
       logger(ctx.logger.getLogger(), "node_server"),
       queueEvent(std::move(ctx.queueEvent)),
       stopped(std::move(ctx.stopped)) {
@@ -162,6 +174,7 @@ namespace CryptoNote
 
     void on_connection_new(P2pConnectionContext& context);
     void on_connection_close(P2pConnectionContext& context);
+    void store_peer_score(const P2pConnectionContext& context);
 
     //----------------- i_p2p_endpoint -------------------------------------------------------------
     virtual void relay_notify_to_all(int command, const BinaryArray& data_buff, const net_connection_id* excludeConnection) override;
@@ -187,6 +200,7 @@ namespace CryptoNote
     bool is_addr_connected(const NetworkAddress& peer);  
     bool try_ping(basic_node_data& node_data, P2pConnectionContext& context);
     bool make_expected_connections_count(bool white_list, size_t expected_connections);
+    void evict_worst_connection();
     bool is_priority_node(const NetworkAddress& na);
 
     bool connect_to_peerlist(const std::vector<NetworkAddress>& peers);
@@ -207,6 +221,7 @@ namespace CryptoNote
     void onIdle();
     void timedSyncLoop();
     void timeoutLoop();
+    void txRelayLoop();
 
     struct config
     {
@@ -247,6 +262,7 @@ namespace CryptoNote
     OnceInInterval m_connections_maker_interval;
     OnceInInterval m_peerlist_store_interval;
     System::Timer m_timedSyncTimer;
+    System::Timer m_txRelayTimer;
 
     std::string m_bind_ip;
     std::string m_port;
@@ -68,14 +68,24 @@ namespace CryptoNote
     }
   };
   
+  // Bits of CORE_SYNC_DATA::capabilities, the optional protocol features a node supports.
+  const uint32_t P2P_CAPABILITY_BLOCKS_BY_RANGE = 1 << 0;
+  const uint32_t P2P_CAPABILITY_COMPACT_BLOCKS = 1 << 1;
+  const uint32_t P2P_CAPABILITY_TX_INVENTORY = 1 << 2;
+
   struct CORE_SYNC_DATA
   {
     uint32_t current_height;
     Crypto::Hash top_id;
+    uint32_t capabilities;
 
     void serialize(ISerializer& s) {
       KV_MEMBER(current_height)
       KV_MEMBER(top_id)
+      if (s.type() == ISerializer::INPUT) {
+        capabilities = 0;
+      }
+      KV_MEMBER(capabilities)
     }
   };
 
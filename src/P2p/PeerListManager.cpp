@@ -40,22 +40,57 @@ namespace CryptoNote {
 
 }
 
+namespace {
+
+struct PeerScoreEntry {
+  NetworkAddress adr;
+  PeerScore score;
+
+  void serialize(ISerializer& s) {
+    s(adr, "adr");
+    s(score, "score");
+  }
+};
+
+}
+
 PeerlistManager::Peerlist::Peerlist(peers_indexed& peers, size_t maxSize) :
   m_peers(peers), m_maxSize(maxSize) {
 }
 
 void PeerlistManager::serialize(ISerializer& s) {
-  const uint8_t currentVersion = 1;
+  const uint8_t currentVersion = 2;
   uint8_t version = currentVersion;
 
   s(version, "version");
 
-  if (version != currentVersion) {
+  // version 1 had no peer scores
+  if (version != currentVersion && version != 1) {
     return;
   }
 
   s(m_peers_white, "whitelist");
   s(m_peers_gray, "graylist");
+
+  if (version == 1) {
+    return;
+  }
+
+  std::vector<PeerScoreEntry> scores;
+  if (s.type() == ISerializer::OUTPUT) {
+    for (const auto& score : m_scores) {
+      scores.push_back({ score.first, score.second });
+    }
+  }
+
+  s(scores, "scores");
+
+  if (s.type() == ISerializer::INPUT) {
+    m_scores.clear();
+    for (const auto& entry : scores) {
+      m_scores[entry.adr] = entry.score;
+    }
+  }
 }
 
 size_t PeerlistManager::Peerlist::count() const {
@@ -256,6 +291,35 @@ bool PeerlistManager::append_with_peer_gray(const PeerlistEntry& ple)
 }
 //--------------------------------------------------------------------------------------------------
 
+bool PeerlistManager::get_peer_score(const NetworkAddress& addr, PeerScore& score) const
+{
+  auto it = m_scores.find(addr);
+  if (it == m_scores.end()) {
+    return false;
+  }
+
+  score = it->second;
+  return true;
+}
+//--------------------------------------------------------------------------------------------------
+
+void PeerlistManager::set_peer_score(const NetworkAddress& addr, const PeerScore& score)
+{
+  m_scores[addr] = score;
+  if (m_scores.size() <= P2P_LOCAL_WHITE_PEERLIST_LIMIT + P2P_LOCAL_GRAY_PEERLIST_LIMIT) {
+    return;
+  }
+
+  for (auto it = m_scores.begin(); it != m_scores.end();) {
+    if (m_peers_white.get<by_addr>().count(it->first) == 0 && m_peers_gray.get<by_addr>().count(it->first) == 0) {
+      it = m_scores.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+//--------------------------------------------------------------------------------------------------
+
 PeerlistManager::Peerlist& PeerlistManager::getWhite() { 
   return m_whitePeerlist; 
 }
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <list>
+#include <map>
 
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/ordered_index.hpp>
@@ -15,6 +16,7 @@
 #include <boost/multi_index/member.hpp>
 
 #include "P2pProtocolTypes.h"
+#include "PeerScore.h"
 #include "CryptoNoteConfig.h"
 
 namespace CryptoNote {
@@ -70,6 +72,10 @@ public:
   bool is_ip_allowed(uint32_t ip) const;
   void trim_white_peerlist();
   void trim_gray_peerlist();
+  // Performance of the peer at an address over its outgoing connections; scores of addresses that left both lists
+  // are dropped once there are more scores than the lists hold.
+  bool get_peer_score(const NetworkAddress& addr, PeerScore& score) const;
+  void set_peer_score(const NetworkAddress& addr, const PeerScore& score);
 
   void serialize(ISerializer& s);
 
@@ -83,6 +89,7 @@ private:
   peers_indexed m_peers_white;
   Peerlist m_whitePeerlist;
   Peerlist m_grayPeerlist;
+  std::map<NetworkAddress, PeerScore> m_scores;
 };
 
 }
@@ -0,0 +1,74 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "PeerScore.h"
+
+#include <algorithm>
+
+#include "CryptoNoteConfig.h"
+#include "Serialization/ISerializer.h"
+
+namespace CryptoNote {
+
+namespace {
+
+// A new sample moves the average a quarter of the way, so one slow response doesn't ruin a good peer.
+template<typename T>
+T addSample(T average, T sample) {
+  return average == 0 ? sample : static_cast<T>((average * 3 + sample) / 4);
+}
+
+}
+
+void PeerScore::addHandshakeRtt(uint32_t milliseconds) {
+  handshakeRtt = addSample<uint32_t>(handshakeRtt, std::max<uint32_t>(milliseconds, 1));
+}
+
+void PeerScore::addBlockDelivery(uint32_t milliseconds, uint64_t bytes) {
+  milliseconds = std::max<uint32_t>(milliseconds, 1);
+  blockLatency = addSample<uint32_t>(blockLatency, milliseconds);
+  syncSpeed = addSample<uint64_t>(syncSpeed, std::max<uint64_t>(bytes * 1000 / milliseconds, 1));
+}
+
+void PeerScore::addStrike(uint64_t now) {
+  strikes = getStrikes(now) + 1;
+  lastStrikeTime = now;
+}
+
+uint32_t PeerScore::getStrikes(uint64_t now) const {
+  return now < lastStrikeTime + P2P_PEER_STRIKE_LIFETIME ? strikes : 0;
+}
+
+int64_t PeerScore::getValue(uint64_t now) const {
+  // Each measured metric counts from its P2P_PEER_REFERENCE_* value and an unmeasured one not at all, so a new peer
+  // ranks below peers proven faster than that and above those proven slower. 10 ms of handshake round trip, 100 ms
+  // of block latency and 10 KB/s of sync speed are worth a point each, up to 100 points of speed; a strike costs 100.
+  int64_t value = 0;
+  if (handshakeRtt != 0) {
+    value += (static_cast<int64_t>(P2P_PEER_REFERENCE_HANDSHAKE_RTT) - handshakeRtt) / 10;
+  }
+
+  if (blockLatency != 0) {
+    value += (static_cast<int64_t>(P2P_PEER_REFERENCE_BLOCK_LATENCY) - blockLatency) / 100;
+  }
+
+  if (syncSpeed != 0) {
+    uint64_t speed = std::min<uint64_t>(syncSpeed, P2P_PEER_REFERENCE_SYNC_SPEED + 100 * 10240);
+    value += (static_cast<int64_t>(speed) - static_cast<int64_t>(P2P_PEER_REFERENCE_SYNC_SPEED)) / 10240;
+  }
+
+  value -= 100 * static_cast<int64_t>(getStrikes(now));
+  return value;
+}
+
+void PeerScore::serialize(ISerializer& s) {
+  s(handshakeRtt, "handshake_rtt");
+  s(blockLatency, "block_latency");
+  s(syncSpeed, "sync_speed");
+  s(strikes, "strikes");
+  s(lastStrikeTime, "last_strike_time");
+}
+
+}
@@ -0,0 +1,35 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstdint>
+
+namespace CryptoNote {
+
+class ISerializer;
+
+// How well a peer has served this node: the round trip of its handshake, the delay and speed of its block responses
+// while synchronizing, each a moving average, and the strikes it got for sending invalid data. Kept with the
+// peerlist, so a peer is judged by its past connections as well.
+struct PeerScore {
+  uint32_t handshakeRtt = 0; // milliseconds, 0 if never measured
+  uint32_t blockLatency = 0; // milliseconds from a block request to its response, 0 if never measured
+  uint64_t syncSpeed = 0;    // bytes per second of block responses
+  uint32_t strikes = 0;
+  uint64_t lastStrikeTime = 0;
+
+  void addHandshakeRtt(uint32_t milliseconds);
+  void addBlockDelivery(uint32_t milliseconds, uint64_t bytes);
+  void addStrike(uint64_t now);
+  // Strikes younger than P2P_PEER_STRIKE_LIFETIME.
+  uint32_t getStrikes(uint64_t now) const;
+  // Higher is better; a peer nothing is known about, or one that matches the P2P_PEER_REFERENCE_* values, scores 0.
+  int64_t getValue(uint64_t now) const;
+
+  void serialize(ISerializer& s);
+};
+
+}
@@ -6,16 +6,21 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "Dispatcher.h"
+#include <algorithm>
 #include <cassert>
+#include <memory>
+#include <vector>
 
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
+#include <sys/mman.h>
 #include <sys/timerfd.h>
 #include <fcntl.h>
 #include <string.h>
-#include <ucontext.h>
 #include <unistd.h>
 #include "ErrorMessage.h"
+#include "IoUring.h"
+#include "MachineContext.h"
 
 namespace System {
 
@@ -45,18 +50,35 @@ private:
 
 static_assert(Dispatcher::SIZEOF_PTHREAD_MUTEX_T == sizeof(pthread_mutex_t), "invalid pthread mutex size");
 
-//const size_t STACK_SIZE = 64 * 1024;
 const size_t STACK_SIZE = 512 * 1024;
+const size_t MINIMUM_STACK_SIZE = 16 * 1024;
+const size_t STACK_POOL_LOW_WATERMARK = 32;
+const size_t STACK_POOL_HIGH_WATERMARK = 128;
+const int EPOLL_EVENT_BATCH_SIZE = 256;
+const unsigned IO_URING_ENTRIES = 256;
+const unsigned IO_URING_COMPLETION_ENTRIES = 4096;
+
+size_t pageSize() {
+  static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+size_t roundUpToPageSize(size_t size) {
+  return (size + pageSize() - 1) / pageSize() * pageSize();
+}
 };
 
-Dispatcher::Dispatcher() {
+Dispatcher::Dispatcher() : Dispatcher(false) {
+}
+
+Dispatcher::Dispatcher(bool useIoUring) {
   std::string message;
   epoll = ::epoll_create1(0);
   if (epoll == -1) {
     message = "epoll_create1 failed, " + lastErrorMessage();
   } else {
-    mainContext.ucontext = new ucontext_t;
-    if (getcontext(reinterpret_cast<ucontext_t*>(mainContext.ucontext)) == -1) {
+    mainContext.ucontext = newMachineContext();
+    if (!getMachineContext(static_cast<MachineContext*>(mainContext.ucontext))) {
       message = "getcontext failed, " + lastErrorMessage();
     } else {
       remoteSpawnEvent = eventfd(0, O_NONBLOCK);
@@ -86,7 +108,18 @@ Dispatcher::Dispatcher() {
           currentContext = &mainContext;
           firstResumingContext = nullptr;
           firstReusableContext = nullptr;
+          reusableContextCount = 0;
           runningContextCount = 0;
+          firstStackContext = nullptr;
+          stackCount = 0;
+          stackSize = STACK_SIZE;
+          stackPoolLowWatermark = STACK_POOL_LOW_WATERMARK;
+          stackPoolHighWatermark = STACK_POOL_HIGH_WATERMARK;
+          ioUring = nullptr;
+          if (useIoUring) {
+            initIoUring();
+          }
+
           return;
         }
 
@@ -119,13 +152,14 @@ Dispatcher::~Dispatcher() {
   assert(firstResumingContext == nullptr);
   assert(runningContextCount == 0);
   while (firstReusableContext != nullptr) {
-    auto ucontext = static_cast<ucontext_t*>(firstReusableContext->ucontext);
-    auto stackPtr = static_cast<uint8_t *>(firstReusableContext->stackPtr);
+    NativeContext* context = firstReusableContext;
     firstReusableContext = firstReusableContext->next;
-    delete[] stackPtr;
-    delete ucontext;
+    --reusableContextCount;
+    deleteContextStack(context);
   }
 
+  delete ioUring;
+
   while (!timers.empty()) {
     int result = ::close(timers.top());
     assert(result == 0);
@@ -148,11 +182,10 @@ Dispatcher::~Dispatcher() {
 
 void Dispatcher::clear() {
   while (firstReusableContext != nullptr) {
-    auto ucontext = static_cast<ucontext_t*>(firstReusableContext->ucontext);
-    auto stackPtr = static_cast<uint8_t *>(firstReusableContext->stackPtr);
+    NativeContext* context = firstReusableContext;
     firstReusableContext = firstReusableContext->next;
-    delete[] stackPtr;
-    delete ucontext;
+    --reusableContextCount;
+    deleteContextStack(context);
   }
 
   while (!timers.empty()) {
@@ -174,38 +207,11 @@ void Dispatcher::dispatch() {
       break;
     }
 
-    epoll_event event;
-    int count = epoll_wait(epoll, &event, 1, -1);
-    if (count == 1) {
-      ContextPair *contextPair = static_cast<ContextPair*>(event.data.ptr);
-      if(((event.events & (EPOLLIN | EPOLLOUT)) != 0) && contextPair->readContext == nullptr && contextPair->writeContext == nullptr) {
-        uint64_t buf;
-        auto transferred = read(remoteSpawnEvent, &buf, sizeof buf);
-        if(transferred == -1) {
-            throw std::runtime_error("Dispatcher::dispatch, read(remoteSpawnEvent) failed, " + lastErrorMessage());
-        }
-
-        MutextGuard guard(*reinterpret_cast<pthread_mutex_t*>(this->mutex));
-        while (!remoteSpawningProcedures.empty()) {
-          spawn(std::move(remoteSpawningProcedures.front()));
-          remoteSpawningProcedures.pop();
-        }
-
-        continue;
-      }
-
-      if ((event.events & EPOLLOUT) != 0) {
-        context = contextPair->writeContext->context;
-        contextPair->writeContext->events = event.events;
-      } else if ((event.events & EPOLLIN) != 0) {
-        context = contextPair->readContext->context;
-        contextPair->readContext->events = event.events;
-      } else {
-        continue;
-      }
-
-      assert(context != nullptr);
-      break;
+    epoll_event events[EPOLL_EVENT_BATCH_SIZE];
+    int count = epoll_wait(epoll, events, EPOLL_EVENT_BATCH_SIZE, -1);
+    if (count > 0) {
+      pushReadyContexts(events, count);
+      continue;
     }
 
     if (errno != EINTR) {
@@ -214,9 +220,9 @@ void Dispatcher::dispatch() {
   }
 
   if (context != currentContext) {
-    ucontext_t* oldContext = static_cast<ucontext_t*>(currentContext->ucontext);
+    MachineContext* oldContext = static_cast<MachineContext*>(currentContext->ucontext);
     currentContext = context;
-    if (swapcontext(oldContext, static_cast<ucontext_t *>(context->ucontext)) == -1) {
+    if (!swapMachineContext(oldContext, static_cast<MachineContext*>(context->ucontext))) {
       throw std::runtime_error("Dispatcher::dispatch, swapcontext failed, " + lastErrorMessage());
     }
   }
@@ -296,52 +302,26 @@ void Dispatcher::spawn(std::function<void()>&& procedure) {
   pushContext(context);
 }
 
+void Dispatcher::setStackSize(size_t size) {
+  stackSize = roundUpToPageSize(std::max(size, MINIMUM_STACK_SIZE));
+}
+
+size_t Dispatcher::getStackSize() const {
+  return stackSize;
+}
+
 void Dispatcher::yield() {
   for(;;){
-    epoll_event events[16];
-    int count = epoll_wait(epoll, events, 16, 0);
+    epoll_event events[EPOLL_EVENT_BATCH_SIZE];
+    int count = epoll_wait(epoll, events, EPOLL_EVENT_BATCH_SIZE, 0);
     if (count == 0) {
       break;
     }
 
     if(count > 0) {
-      for(int i = 0; i < count; ++i) {
-        ContextPair *contextPair = static_cast<ContextPair*>(events[i].data.ptr);
-        if(((events[i].events & (EPOLLIN | EPOLLOUT)) != 0) && contextPair->readContext == nullptr && contextPair->writeContext == nullptr) {
-          uint64_t buf;
-          auto transferred = read(remoteSpawnEvent, &buf, sizeof buf);
-          if(transferred == -1) {
-            throw std::runtime_error("Dispatcher::dispatch, read(remoteSpawnEvent) failed, " + lastErrorMessage());
-          }
-
-          MutextGuard guard(*reinterpret_cast<pthread_mutex_t*>(this->mutex));
-          while (!remoteSpawningProcedures.empty()) {
-            spawn(std::move(remoteSpawningProcedures.front()));
-            remoteSpawningProcedures.pop();
-          }
-
-          continue;
-        }
-
-        if ((events[i].events & EPOLLOUT) != 0) {
-            if(contextPair->writeContext != nullptr) {
-            if(contextPair->writeContext->context != nullptr) {
-              contextPair->writeContext->context->interruptProcedure = nullptr;
-            }
-          }
-          pushContext(contextPair->writeContext->context);
-          contextPair->writeContext->events = events[i].events;
-        } else if ((events[i].events & EPOLLIN) != 0) {
-          if(contextPair->readContext != nullptr) {
-           if(contextPair->readContext->context != nullptr) {
-              contextPair->readContext->context->interruptProcedure = nullptr;
-            }
-          }
-          pushContext(contextPair->readContext->context);
-          contextPair->readContext->events = events[i].events;
-        } else {
-          continue;
-        }
+      pushReadyContexts(events, count);
+      if (count < EPOLL_EVENT_BATCH_SIZE) {
+        break;
       }
     } else {
       if (errno != EINTR) {
@@ -356,43 +336,259 @@ void Dispatcher::yield() {
   }
 }
 
+// Queues every context woken by the harvested events. A queued context may not
+// run before some other context interrupts it, so its interrupt procedure is
+// dropped here; otherwise it would disarm the descriptor and queue it again.
+void Dispatcher::pushReadyContexts(const epoll_event* events, int count) {
+  for (int i = 0; i < count; ++i) {
+    ContextPair *contextPair = static_cast<ContextPair*>(events[i].data.ptr);
+    if (contextPair == &ioUringEventContext) {
+      harvestIoUring();
+      continue;
+    }
+
+    if(((events[i].events & (EPOLLIN | EPOLLOUT)) != 0) && contextPair->readContext == nullptr && contextPair->writeContext == nullptr) {
+      uint64_t buf;
+      auto transferred = read(remoteSpawnEvent, &buf, sizeof buf);
+      if(transferred == -1) {
+        throw std::runtime_error("Dispatcher::dispatch, read(remoteSpawnEvent) failed, " + lastErrorMessage());
+      }
+
+      MutextGuard guard(*reinterpret_cast<pthread_mutex_t*>(this->mutex));
+      while (!remoteSpawningProcedures.empty()) {
+        spawn(std::move(remoteSpawningProcedures.front()));
+        remoteSpawningProcedures.pop();
+      }
+
+      continue;
+    }
+
+    OperationContext* operationContext;
+    if ((events[i].events & EPOLLOUT) != 0) {
+      operationContext = contextPair->writeContext;
+    } else if ((events[i].events & EPOLLIN) != 0) {
+      operationContext = contextPair->readContext;
+    } else {
+      continue;
+    }
+
+    assert(operationContext != nullptr && operationContext->context != nullptr);
+    operationContext->context->interruptProcedure = nullptr;
+    operationContext->events = events[i].events;
+    pushContext(operationContext->context);
+  }
+}
+
+// Pooled stacks above the high watermark are released down to the low one, so a
+// burst of short-lived contexts does not pin its stacks for the dispatcher lifetime.
+void Dispatcher::setStackPoolWatermarks(size_t lowWatermark, size_t highWatermark) {
+  assert(lowWatermark <= highWatermark);
+  stackPoolLowWatermark = lowWatermark;
+  stackPoolHighWatermark = highWatermark;
+}
+
+size_t Dispatcher::getLiveStackCount() const {
+  return stackCount - reusableContextCount;
+}
+
+size_t Dispatcher::getPooledStackCount() const {
+  return reusableContextCount;
+}
+
+size_t Dispatcher::getStackResidentSize() const {
+  size_t residentSize = 0;
+  std::vector<unsigned char> residency;
+  for (NativeContext* context = firstStackContext; context != nullptr; context = context->stackNext) {
+    uint8_t* stackBottom = static_cast<uint8_t*>(context->stackPtr) + pageSize();
+    residency.resize(context->stackSize / pageSize());
+    if (mincore(stackBottom, context->stackSize, residency.data()) == -1) {
+      throw std::runtime_error("Dispatcher::getStackResidentSize, mincore failed, " + lastErrorMessage());
+    }
+
+    residentSize += std::count_if(residency.begin(), residency.end(), [](unsigned char page) { return (page & 1) != 0; }) * pageSize();
+  }
+
+  return residentSize;
+}
+
 int Dispatcher::getEpoll() const {
   return epoll;
 }
 
+bool Dispatcher::hasIoUring() const {
+  return ioUring != nullptr;
+}
+
+io_uring_sqe* Dispatcher::getIoUringSqe() {
+  assert(ioUring != nullptr);
+  io_uring_sqe* sqe = ioUring->getSqe();
+  if (sqe == nullptr) {
+    submitIoUring();
+    sqe = ioUring->getSqe();
+    if (sqe == nullptr) {
+      throw std::runtime_error("Dispatcher::getIoUringSqe, submission queue is full");
+    }
+  }
+
+  return sqe;
+}
+
+int32_t Dispatcher::completeIoUring(io_uring_sqe* sqe, bool& interrupted) {
+  assert(ioUring != nullptr);
+  IoUringOperation operation;
+  operation.context = currentContext;
+  operation.result = 0;
+  IoUring::setUserData(sqe, &operation);
+  bool timeout = IoUring::isTimeout(sqe);
+  submitIoUring();
+  interrupted = false;
+  currentContext->interruptProcedure = [&]() {
+    io_uring_sqe* cancelSqe = getIoUringSqe();
+    IoUring::prepareCancel(cancelSqe, timeout, &operation);
+    submitIoUring();
+    interrupted = true;
+  };
+
+  dispatch();
+  currentContext->interruptProcedure = nullptr;
+  assert(operation.context == currentContext);
+  return operation.result;
+}
+
+// Falls back to epoll silently.
+void Dispatcher::initIoUring() {
+  std::unique_ptr<IoUring> ring(new IoUring);
+  if (!ring->init(IO_URING_ENTRIES, IO_URING_COMPLETION_ENTRIES)) {
+    return;
+  }
+
+  ioUringEventContext.readContext = nullptr;
+  ioUringEventContext.writeContext = nullptr;
+  epoll_event ringEvent;
+  ringEvent.events = EPOLLIN;
+  ringEvent.data.ptr = &ioUringEventContext;
+  if (epoll_ctl(epoll, EPOLL_CTL_ADD, ring->getFd(), &ringEvent) == -1) {
+    return;
+  }
+
+  ioUring = ring.release();
+}
+
+void Dispatcher::submitIoUring() {
+  if (ioUring->hasPendingSubmissions() && !ioUring->submit()) {
+    throw std::runtime_error("Dispatcher::submitIoUring, io_uring_enter failed, " + lastErrorMessage());
+  }
+}
+
+void Dispatcher::harvestIoUring() {
+  while (io_uring_cqe* cqe = ioUring->peekCqe()) {
+    IoUringOperation* operation = static_cast<IoUringOperation*>(IoUring::getUserData(cqe));
+    int32_t result = IoUring::getResult(cqe);
+    ioUring->seenCqe();
+    if (operation != nullptr) {
+      operation->result = result;
+      operation->context->interruptProcedure = nullptr;
+      pushContext(operation->context);
+    }
+  }
+}
+
 NativeContext& Dispatcher::getReusableContext() {
   if(firstReusableContext == nullptr) {
-    ucontext_t* newlyCreatedContext = new ucontext_t;
-    if (getcontext(newlyCreatedContext) == -1) { //makecontext precondition
+    MachineContext* newlyCreatedContext = newMachineContext();
+    if (!getMachineContext(newlyCreatedContext)) { //makecontext precondition
       throw std::runtime_error("Dispatcher::getReusableContext, getcontext failed, " + lastErrorMessage());
     }
 
-    auto stackPointer = new uint8_t[STACK_SIZE];
-    newlyCreatedContext->uc_stack.ss_sp = stackPointer;
-    newlyCreatedContext->uc_stack.ss_size = STACK_SIZE;
+    // The stack is reserved but not committed, only touched pages cost memory. Its lowest
+    // page is left inaccessible, so an overflow faults instead of corrupting the heap.
+    size_t newlyCreatedStackSize = stackSize;
+    void* stackPointer = mmap(nullptr, newlyCreatedStackSize + pageSize(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+    if (stackPointer == MAP_FAILED) {
+      std::string message = "Dispatcher::getReusableContext, mmap failed, " + lastErrorMessage();
+      deleteMachineContext(newlyCreatedContext);
+      throw std::runtime_error(message);
+    }
+
+    if (mprotect(stackPointer, pageSize(), PROT_NONE) == -1) {
+      std::string message = "Dispatcher::getReusableContext, mprotect failed, " + lastErrorMessage();
+      munmap(stackPointer, newlyCreatedStackSize + pageSize());
+      deleteMachineContext(newlyCreatedContext);
+      throw std::runtime_error(message);
+    }
 
     ContextMakingData makingContextData {this, newlyCreatedContext};
-    makecontext(newlyCreatedContext, (void(*)())contextProcedureStatic, 1, reinterpret_cast<int*>(&makingContextData));
+    makeMachineContext(newlyCreatedContext, static_cast<uint8_t*>(stackPointer) + pageSize(), newlyCreatedStackSize, contextProcedureStatic, &makingContextData);
 
-    ucontext_t* oldContext = static_cast<ucontext_t*>(currentContext->ucontext);
-    if (swapcontext(oldContext, newlyCreatedContext) == -1) {
+    MachineContext* oldContext = static_cast<MachineContext*>(currentContext->ucontext);
+    if (!swapMachineContext(oldContext, newlyCreatedContext)) {
       throw std::runtime_error("Dispatcher::getReusableContext, swapcontext failed, " + lastErrorMessage());
     }
 
     assert(firstReusableContext != nullptr);
     assert(firstReusableContext->ucontext == newlyCreatedContext);
     firstReusableContext->stackPtr = stackPointer;
+    firstReusableContext->stackSize = newlyCreatedStackSize;
+    firstReusableContext->stackPrev = nullptr;
+    firstReusableContext->stackNext = firstStackContext;
+    if (firstStackContext != nullptr) {
+      firstStackContext->stackPrev = firstReusableContext;
+    }
+
+    firstStackContext = firstReusableContext;
+    ++stackCount;
+    ++reusableContextCount;
   };
 
   NativeContext* context = firstReusableContext;
   firstReusableContext = firstReusableContext-> next;
+  --reusableContextCount;
   return *context;
 }
 
 void Dispatcher::pushReusableContext(NativeContext& context) {
   context.next = firstReusableContext;
   firstReusableContext = &context;
+  ++reusableContextCount;
   --runningContextCount;
+  if (reusableContextCount > stackPoolHighWatermark) {
+    trimReusableContexts(stackPoolLowWatermark);
+  }
+}
+
+// The pushed context is still running on its own stack, so the head of the list is kept.
+void Dispatcher::trimReusableContexts(size_t count) {
+  NativeContext* context = firstReusableContext;
+  while (context != nullptr && context->next != nullptr && reusableContextCount > std::max(count, size_t(1))) {
+    NativeContext* releasedContext = context->next;
+    context->next = releasedContext->next;
+    --reusableContextCount;
+    deleteContextStack(releasedContext);
+  }
+}
+
+// The context lives on the stack it owns, everything needed is copied out before unmapping.
+void Dispatcher::deleteContextStack(NativeContext* context) {
+  if (context->stackPrev != nullptr) {
+    context->stackPrev->stackNext = context->stackNext;
+  } else {
+    firstStackContext = context->stackNext;
+  }
+
+  if (context->stackNext != nullptr) {
+    context->stackNext->stackPrev = context->stackPrev;
+  }
+
+  context->procedure = nullptr;
+  context->interruptProcedure = nullptr;
+  auto ucontext = static_cast<MachineContext*>(context->ucontext);
+  void* stackPtr = context->stackPtr;
+  size_t mappingSize = context->stackSize + pageSize();
+  auto result = munmap(stackPtr, mappingSize);
+  assert(result == 0);
+  std::ignore = result;
+  deleteMachineContext(ucontext);
+  --stackCount;
 }
 
 int Dispatcher::getTimer() {
@@ -425,8 +621,8 @@ void Dispatcher::contextProcedure(void* ucontext) {
   context.interrupted = false;
   context.next = nullptr;
   firstReusableContext = &context;
-  ucontext_t* oldContext = static_cast<ucontext_t*>(context.ucontext);
-  if (swapcontext(oldContext, static_cast<ucontext_t*>(currentContext->ucontext)) == -1) {
+  MachineContext* oldContext = static_cast<MachineContext*>(context.ucontext);
+  if (!swapMachineContext(oldContext, static_cast<MachineContext*>(currentContext->ucontext))) {
     throw std::runtime_error("Dispatcher::contextProcedure, swapcontext failed, " + lastErrorMessage());
   }
 
@@ -12,18 +12,25 @@
 #include <queue>
 #include <stack>
 
+struct epoll_event;
+struct io_uring_sqe;
+
 namespace System {
 
+class IoUring;
 struct NativeContextGroup;
 
 struct NativeContext {
   void* ucontext;
   void* stackPtr;
+  size_t stackSize;
   bool interrupted;
   NativeContext* next;
   NativeContextGroup* group;
   NativeContext* groupPrev;
   NativeContext* groupNext;
+  NativeContext* stackPrev;
+  NativeContext* stackNext;
   std::function<void()> procedure;
   std::function<void()> interruptProcedure;
 };
@@ -41,6 +48,11 @@ struct OperationContext {
   uint32_t events;
 };
 
+struct IoUringOperation {
+  NativeContext* context;
+  int32_t result;
+};
+
 struct ContextPair {
   OperationContext *readContext;
   OperationContext *writeContext;
@@ -48,7 +60,11 @@ struct ContextPair {
 
 class Dispatcher {
 public:
+  // Uses readiness notification through epoll.
   Dispatcher();
+  // Completion-based I/O is used when useIoUring is set and the kernel supports it, readiness
+  // notification through epoll otherwise.
+  explicit Dispatcher(bool useIoUring);
   Dispatcher(const Dispatcher&) = delete;
   ~Dispatcher();
   Dispatcher& operator=(const Dispatcher&) = delete;
@@ -61,9 +77,20 @@ public:
   void pushContext(NativeContext* context);
   void remoteSpawn(std::function<void()>&& procedure);
   void yield();
+  void setStackSize(size_t size);
+  size_t getStackSize() const;
 
   // system-dependent
+  void setStackPoolWatermarks(size_t lowWatermark, size_t highWatermark);
+  size_t getLiveStackCount() const;
+  size_t getPooledStackCount() const;
+  size_t getStackResidentSize() const;
   int getEpoll() const;
+  bool hasIoUring() const;
+  io_uring_sqe* getIoUringSqe();
+  // Runs other contexts until the entry completes. Interruption cancels the operation and sets
+  // interrupted; the completion result is returned either way.
+  int32_t completeIoUring(io_uring_sqe* sqe, bool& interrupted);
   NativeContext& getReusableContext();
   void pushReusableContext(NativeContext&);
   int getTimer();
@@ -81,12 +108,20 @@ public:
 
 private:
   void spawn(std::function<void()>&& procedure);
+  void pushReadyContexts(const epoll_event* events, int count);
+  void trimReusableContexts(size_t count);
+  void deleteContextStack(NativeContext* context);
+  void initIoUring();
+  void submitIoUring();
+  void harvestIoUring();
   int epoll;
   alignas(void*) uint8_t mutex[SIZEOF_PTHREAD_MUTEX_T];
   int remoteSpawnEvent;
   ContextPair remoteSpawnEventContext;
   std::queue<std::function<void()>> remoteSpawningProcedures;
   std::stack<int> timers;
+  IoUring* ioUring;
+  ContextPair ioUringEventContext;
 
   NativeContext mainContext;
   NativeContextGroup contextGroup;
@@ -94,7 +129,13 @@ private:
   NativeContext* firstResumingContext;
   NativeContext* lastResumingContext;
   NativeContext* firstReusableContext;
+  size_t reusableContextCount;
   size_t runningContextCount;
+  NativeContext* firstStackContext;
+  size_t stackCount;
+  size_t stackSize;
+  size_t stackPoolLowWatermark;
+  size_t stackPoolHighWatermark;
 
   void contextProcedure(void* ucontext);
   static void contextProcedureStatic(void* context);
@@ -0,0 +1,285 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "IoUring.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if !defined(DISPATCHER_USE_EPOLL) && defined(__NR_io_uring_setup) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define SYSTEM_HAS_IO_URING
+#else
+struct io_uring_sqe {};
+struct io_uring_cqe {};
+#endif
+
+namespace System {
+
+IoUring::IoUring() : ringFd(-1), sqRing(MAP_FAILED), cqRing(MAP_FAILED), sqes(nullptr) {
+}
+
+IoUring::~IoUring() {
+  release();
+}
+
+#ifdef SYSTEM_HAS_IO_URING
+
+namespace {
+
+static_assert(sizeof(IoUringTimespec) == sizeof(__kernel_timespec), "invalid kernel timespec size");
+
+template<class T> T* ringField(void* ring, uint32_t offset) {
+  return reinterpret_cast<T*>(static_cast<uint8_t*>(ring) + offset);
+}
+
+}
+
+bool IoUring::init(unsigned entries, unsigned completionEntries) {
+  assert(ringFd == -1);
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  params.flags = IORING_SETUP_CQSIZE;
+  params.cq_entries = completionEntries;
+  ringFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+  if (ringFd == -1) {
+    return false;
+  }
+
+  sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+    sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+  }
+
+  sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+  if (sqRing == MAP_FAILED) {
+    release();
+    return false;
+  }
+
+  if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+    cqRing = sqRing;
+  } else {
+    cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+    if (cqRing == MAP_FAILED) {
+      release();
+      return false;
+    }
+  }
+
+  sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+  void* sqesMapping = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+  if (sqesMapping == MAP_FAILED) {
+    release();
+    return false;
+  }
+
+  sqes = static_cast<io_uring_sqe*>(sqesMapping);
+  sqHead = ringField<unsigned>(sqRing, params.sq_off.head);
+  sqTail = ringField<unsigned>(sqRing, params.sq_off.tail);
+  sqMask = *ringField<unsigned>(sqRing, params.sq_off.ring_mask);
+  sqEntries = *ringField<unsigned>(sqRing, params.sq_off.ring_entries);
+  sqArray = ringField<unsigned>(sqRing, params.sq_off.array);
+  sqeTail = submittedTail = *sqTail;
+  cqHead = ringField<unsigned>(cqRing, params.cq_off.head);
+  cqTail = ringField<unsigned>(cqRing, params.cq_off.tail);
+  cqMask = *ringField<unsigned>(cqRing, params.cq_off.ring_mask);
+  cqes = ringField<io_uring_cqe>(cqRing, params.cq_off.cqes);
+  return true;
+}
+
+io_uring_sqe* IoUring::getSqe() {
+  assert(ringFd != -1);
+  if (sqeTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries) {
+    return nullptr;
+  }
+
+  unsigned index = sqeTail & sqMask;
+  io_uring_sqe* sqe = &sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqArray[index] = index;
+  ++sqeTail;
+  return sqe;
+}
+
+bool IoUring::hasPendingSubmissions() const {
+  return sqeTail != submittedTail;
+}
+
+bool IoUring::submit() {
+  __atomic_store_n(sqTail, sqeTail, __ATOMIC_RELEASE);
+  while (submittedTail != sqeTail) {
+    long submitted = syscall(__NR_io_uring_enter, ringFd, sqeTail - submittedTail, 0, 0, nullptr, 0);
+    if (submitted == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      return false;
+    }
+
+    submittedTail += static_cast<unsigned>(submitted);
+  }
+
+  return true;
+}
+
+io_uring_cqe* IoUring::peekCqe() {
+  unsigned head = *cqHead;
+  if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+    return nullptr;
+  }
+
+  return &cqes[head & cqMask];
+}
+
+void IoUring::seenCqe() {
+  __atomic_store_n(cqHead, *cqHead + 1, __ATOMIC_RELEASE);
+}
+
+void IoUring::prepareRecv(io_uring_sqe* sqe, int fd, void* buffer, size_t size) {
+  sqe->opcode = IORING_OP_RECV;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(buffer);
+  sqe->len = static_cast<uint32_t>(std::min<size_t>(size, UINT32_MAX));
+}
+
+void IoUring::prepareSend(io_uring_sqe* sqe, int fd, const void* buffer, size_t size) {
+  sqe->opcode = IORING_OP_SEND;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(buffer);
+  sqe->len = static_cast<uint32_t>(std::min<size_t>(size, UINT32_MAX));
+  sqe->msg_flags = MSG_NOSIGNAL;
+}
+
+void IoUring::prepareAccept(io_uring_sqe* sqe, int fd) {
+  sqe->opcode = IORING_OP_ACCEPT;
+  sqe->fd = fd;
+  sqe->accept_flags = SOCK_NONBLOCK;
+}
+
+void IoUring::prepareTimeout(io_uring_sqe* sqe, const IoUringTimespec* timespec) {
+  sqe->opcode = IORING_OP_TIMEOUT;
+  sqe->fd = -1;
+  sqe->addr = reinterpret_cast<uint64_t>(timespec);
+  sqe->len = 1;
+}
+
+void IoUring::prepareCancel(io_uring_sqe* sqe, bool timeout, void* userData) {
+  sqe->opcode = timeout ? IORING_OP_TIMEOUT_REMOVE : IORING_OP_ASYNC_CANCEL;
+  sqe->fd = -1;
+  sqe->addr = reinterpret_cast<uint64_t>(userData);
+}
+
+bool IoUring::isTimeout(const io_uring_sqe* sqe) {
+  return sqe->opcode == IORING_OP_TIMEOUT;
+}
+
+void IoUring::setUserData(io_uring_sqe* sqe, void* userData) {
+  sqe->user_data = reinterpret_cast<uint64_t>(userData);
+}
+
+void* IoUring::getUserData(const io_uring_cqe* cqe) {
+  return reinterpret_cast<void*>(cqe->user_data);
+}
+
+int32_t IoUring::getResult(const io_uring_cqe* cqe) {
+  return cqe->res;
+}
+
+#else
+
+bool IoUring::init(unsigned entries, unsigned completionEntries) {
+  errno = ENOSYS;
+  return false;
+}
+
+io_uring_sqe* IoUring::getSqe() {
+  return nullptr;
+}
+
+bool IoUring::hasPendingSubmissions() const {
+  return false;
+}
+
+bool IoUring::submit() {
+  errno = ENOSYS;
+  return false;
+}
+
+io_uring_cqe* IoUring::peekCqe() {
+  return nullptr;
+}
+
+void IoUring::seenCqe() {
+}
+
+void IoUring::prepareRecv(io_uring_sqe* sqe, int fd, void* buffer, size_t size) {
+}
+
+void IoUring::prepareSend(io_uring_sqe* sqe, int fd, const void* buffer, size_t size) {
+}
+
+void IoUring::prepareAccept(io_uring_sqe* sqe, int fd) {
+}
+
+void IoUring::prepareTimeout(io_uring_sqe* sqe, const IoUringTimespec* timespec) {
+}
+
+void IoUring::prepareCancel(io_uring_sqe* sqe, bool timeout, void* userData) {
+}
+
+bool IoUring::isTimeout(const io_uring_sqe* sqe) {
+  return false;
+}
+
+void IoUring::setUserData(io_uring_sqe* sqe, void* userData) {
+}
+
+void* IoUring::getUserData(const io_uring_cqe* cqe) {
+  return nullptr;
+}
+
+int32_t IoUring::getResult(const io_uring_cqe* cqe) {
+  return 0;
+}
+
+#endif
+
+int IoUring::getFd() const {
+  return ringFd;
+}
+
+void IoUring::release() {
+  if (sqes != nullptr) {
+    munmap(sqes, sqesSize);
+    sqes = nullptr;
+  }
+
+  if (cqRing != MAP_FAILED && cqRing != sqRing) {
+    munmap(cqRing, cqRingSize);
+  }
+
+  cqRing = MAP_FAILED;
+  if (sqRing != MAP_FAILED) {
+    munmap(sqRing, sqRingSize);
+    sqRing = MAP_FAILED;
+  }
+
+  if (ringFd != -1) {
+    close(ringFd);
+    ringFd = -1;
+  }
+}
+
+}
@@ -0,0 +1,82 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace System {
+
+// Layout of struct __kernel_timespec.
+struct IoUringTimespec {
+  int64_t seconds;
+  int64_t nanoseconds;
+};
+
+// Submission and completion rings of an io_uring instance, driven through the raw system
+// calls so only kernel headers are needed. Builds defining DISPATCHER_USE_EPOLL, or kernels
+// without io_uring, get an instance that never initializes.
+class IoUring {
+public:
+  IoUring();
+  IoUring(const IoUring&) = delete;
+  ~IoUring();
+  IoUring& operator=(const IoUring&) = delete;
+
+  // Returns false and leaves errno set if the ring can't be created.
+  bool init(unsigned entries, unsigned completionEntries);
+  int getFd() const;
+
+  // Returns a zeroed entry, or nullptr if the submission ring is full. Entries are handed to
+  // the kernel by submit().
+  io_uring_sqe* getSqe();
+  bool hasPendingSubmissions() const;
+  // Returns false and leaves errno set on failure.
+  bool submit();
+
+  io_uring_cqe* peekCqe();
+  void seenCqe();
+
+  static void prepareRecv(io_uring_sqe* sqe, int fd, void* buffer, size_t size);
+  static void prepareSend(io_uring_sqe* sqe, int fd, const void* buffer, size_t size);
+  static void prepareAccept(io_uring_sqe* sqe, int fd);
+  static void prepareTimeout(io_uring_sqe* sqe, const IoUringTimespec* timespec);
+  static bool isTimeout(const io_uring_sqe* sqe);
+  // Cancels the operation submitted with userData.
+  static void prepareCancel(io_uring_sqe* sqe, bool timeout, void* userData);
+  static void setUserData(io_uring_sqe* sqe, void* userData);
+  static void* getUserData(const io_uring_cqe* cqe);
+  static int32_t getResult(const io_uring_cqe* cqe);
+
+private:
+  int ringFd;
+  void* sqRing;
+  size_t sqRingSize;
+  void* cqRing;
+  size_t cqRingSize;
+  io_uring_sqe* sqes;
+  size_t sqesSize;
+
+  unsigned* sqHead;
+  unsigned* sqTail;
+  unsigned sqMask;
+  unsigned sqEntries;
+  unsigned* sqArray;
+  unsigned sqeTail;
+  unsigned submittedTail;
+
+  unsigned* cqHead;
+  unsigned* cqTail;
+  unsigned cqMask;
+  io_uring_cqe* cqes;
+
+  void release();
+};
+
+}
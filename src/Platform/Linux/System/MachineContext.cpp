@@ -0,0 +1,134 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "MachineContext.h"
+#include <cstdint>
+
+#if defined(__x86_64__) && !defined(DISPATCHER_USE_UCONTEXT)
+
+extern "C" void systemSwapMachineContext(void** from, void* to);
+extern "C" void systemMachineContextEntry();
+
+// systemSwapMachineContext saves rbp, rbx, r12-r15, MXCSR and the x87 control
+// word on the current stack, stores the stack pointer to *from and restores the
+// same frame from 'to'. A fresh context starts in systemMachineContextEntry,
+// which calls r13 with r12 as the argument; the procedure must never return.
+__asm__(
+  ".pushsection .text\n"
+  ".globl systemSwapMachineContext\n"
+  ".hidden systemSwapMachineContext\n"
+  ".type systemSwapMachineContext, @function\n"
+  "systemSwapMachineContext:\n"
+  "  pushq %rbp\n"
+  "  pushq %rbx\n"
+  "  pushq %r12\n"
+  "  pushq %r13\n"
+  "  pushq %r14\n"
+  "  pushq %r15\n"
+  "  subq $16, %rsp\n"
+  "  stmxcsr 8(%rsp)\n"
+  "  fnstcw (%rsp)\n"
+  "  movq %rsp, (%rdi)\n"
+  "  movq %rsi, %rsp\n"
+  "  ldmxcsr 8(%rsp)\n"
+  "  fldcw (%rsp)\n"
+  "  addq $16, %rsp\n"
+  "  popq %r15\n"
+  "  popq %r14\n"
+  "  popq %r13\n"
+  "  popq %r12\n"
+  "  popq %rbx\n"
+  "  popq %rbp\n"
+  "  ret\n"
+  ".size systemSwapMachineContext, .-systemSwapMachineContext\n"
+  ".globl systemMachineContextEntry\n"
+  ".hidden systemMachineContextEntry\n"
+  ".type systemMachineContextEntry, @function\n"
+  "systemMachineContextEntry:\n"
+  "  .cfi_startproc\n"
+  "  .cfi_undefined rip\n"
+  "  movq %r12, %rdi\n"
+  "  callq *%r13\n"
+  "  ud2\n"
+  "  .cfi_endproc\n"
+  ".size systemMachineContextEntry, .-systemMachineContextEntry\n"
+  ".popsection\n"
+);
+
+namespace System {
+
+struct MachineContext {
+  void* stackPointer;
+};
+
+MachineContext* newMachineContext() {
+  return new MachineContext{ nullptr };
+}
+
+void deleteMachineContext(MachineContext* context) {
+  delete context;
+}
+
+bool getMachineContext(MachineContext* context) {
+  return true;
+}
+
+void makeMachineContext(MachineContext* context, void* stack, size_t stackSize, void (*procedure)(void*), void* argument) {
+  // frame popped by the first switch into this context, see systemSwapMachineContext
+  uint64_t* stackPointer = reinterpret_cast<uint64_t*>((reinterpret_cast<uintptr_t>(stack) + stackSize) & ~static_cast<uintptr_t>(15));
+  *--stackPointer = reinterpret_cast<uint64_t>(&systemMachineContextEntry);
+  *--stackPointer = 0; // rbp
+  *--stackPointer = 0; // rbx
+  *--stackPointer = reinterpret_cast<uint64_t>(argument); // r12
+  *--stackPointer = reinterpret_cast<uint64_t>(procedure); // r13
+  *--stackPointer = 0; // r14
+  *--stackPointer = 0; // r15
+  *--stackPointer = 0x1f80; // MXCSR, default rounding and all exceptions masked
+  *--stackPointer = 0x037f; // x87 control word, default
+  context->stackPointer = stackPointer;
+}
+
+bool swapMachineContext(MachineContext* from, MachineContext* to) {
+  systemSwapMachineContext(&from->stackPointer, to->stackPointer);
+  return true;
+}
+
+}
+
+#else
+
+#include <ucontext.h>
+
+namespace System {
+
+struct MachineContext {
+  ucontext_t ucontext;
+};
+
+MachineContext* newMachineContext() {
+  return new MachineContext;
+}
+
+void deleteMachineContext(MachineContext* context) {
+  delete context;
+}
+
+bool getMachineContext(MachineContext* context) {
+  return getcontext(&context->ucontext) == 0;
+}
+
+void makeMachineContext(MachineContext* context, void* stack, size_t stackSize, void (*procedure)(void*), void* argument) {
+  context->ucontext.uc_stack.ss_sp = stack;
+  context->ucontext.uc_stack.ss_size = stackSize;
+  makecontext(&context->ucontext, (void(*)())procedure, 1, reinterpret_cast<int*>(argument));
+}
+
+bool swapMachineContext(MachineContext* from, MachineContext* to) {
+  return swapcontext(&from->ucontext, &to->ucontext) == 0;
+}
+
+}
+
+#endif
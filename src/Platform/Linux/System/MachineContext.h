@@ -0,0 +1,27 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstddef>
+
+namespace System {
+
+// Execution state of a dispatcher context. On x86-64 a switch pushes only the
+// callee-saved registers and the FPU control words onto the current stack and
+// never enters the kernel. Other architectures, or builds defining
+// DISPATCHER_USE_UCONTEXT, fall back to ucontext, where every swapcontext()
+// also saves and restores the signal mask with a syscall.
+struct MachineContext;
+
+MachineContext* newMachineContext();
+void deleteMachineContext(MachineContext* context);
+
+// Mirror getcontext/makecontext/swapcontext; on failure return false and leave errno set.
+bool getMachineContext(MachineContext* context);
+void makeMachineContext(MachineContext* context, void* stack, size_t stackSize, void (*procedure)(void*), void* argument);
+bool swapMachineContext(MachineContext* from, MachineContext* to);
+
+}
@@ -10,14 +10,41 @@
 #include <arpa/inet.h>
 #include <cassert>
 #include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#include "IoUring.h"
+
 #include <System/ErrorMessage.h>
 #include <System/InterruptedException.h>
 #include <System/Ipv4Address.h>
 
 namespace System {
 
+namespace {
+
+const size_t GATHERED_WRITE_MAX_BUFFERS = 64;
+
+size_t ioUringTransferred(Dispatcher& dispatcher, int32_t result, bool interrupted, const std::string& operation) {
+  if (result < 0) {
+    if (interrupted) {
+      throw InterruptedException();
+    }
+
+    throw std::runtime_error(operation + " failed, " + errorMessage(-result));
+  }
+
+  // Completed before the cancellation reached it, the next operation reports the interruption.
+  if (interrupted) {
+    dispatcher.interrupt();
+  }
+
+  return result;
+}
+
+}
+
 TcpConnection::TcpConnection() : dispatcher(nullptr) {
 }
 
@@ -76,6 +103,8 @@ size_t TcpConnection::read(uint8_t* data, size_t size) {
   if (transferred == -1) {
     if (errno != EAGAIN){
       message = "recv failed, " + lastErrorMessage();
+    } else if (dispatcher->hasIoUring()) {
+      return readCompletion(data, size);
     } else {
       epoll_event connectionEvent;
       OperationContext operationContext;
@@ -172,6 +201,8 @@ std::size_t TcpConnection::write(const uint8_t* data, size_t size) {
   if (transferred == -1) {
     if (errno != EAGAIN){
       message = "send failed, " + lastErrorMessage();
+    } else if (dispatcher->hasIoUring()) {
+      return writeCompletion(data, size);
     } else {
       epoll_event connectionEvent;
       OperationContext operationContext;
@@ -248,6 +279,76 @@ std::size_t TcpConnection::write(const uint8_t* data, size_t size) {
   return transferred;
 }
 
+// A would-block sendmsg falls back to write() of the first buffer, which waits for the socket;
+// the caller resumes gathering from what was transferred.
+std::size_t TcpConnection::writeBuffers(const Buffer* buffers, size_t count) {
+  assert(dispatcher != nullptr);
+  assert(contextPair.writeContext == nullptr);
+  if (dispatcher->interrupted()) {
+    throw InterruptedException();
+  }
+
+  iovec iovecs[GATHERED_WRITE_MAX_BUFFERS];
+  size_t iovecCount = 0;
+  for (size_t i = 0; i < count && iovecCount < GATHERED_WRITE_MAX_BUFFERS; ++i) {
+    if (buffers[i].size != 0) {
+      iovecs[iovecCount].iov_base = const_cast<uint8_t*>(buffers[i].data);
+      iovecs[iovecCount].iov_len = buffers[i].size;
+      ++iovecCount;
+    }
+  }
+
+  if (iovecCount == 0) {
+    return 0;
+  }
+
+  msghdr message = {};
+  message.msg_iov = iovecs;
+  message.msg_iovlen = iovecCount;
+  ssize_t transferred = ::sendmsg(connection, &message, MSG_NOSIGNAL);
+  if (transferred == -1) {
+    if (errno != EAGAIN) {
+      throw std::runtime_error("TcpConnection::write, sendmsg failed, " + lastErrorMessage());
+    }
+
+    return write(static_cast<const uint8_t*>(iovecs[0].iov_base), iovecs[0].iov_len);
+  }
+
+  return transferred;
+}
+
+// Reads straight into the caller's buffer.
+size_t TcpConnection::readCompletion(uint8_t* data, size_t size) {
+  io_uring_sqe* sqe = dispatcher->getIoUringSqe();
+  IoUring::prepareRecv(sqe, connection, data, size);
+
+  OperationContext operationContext;
+  operationContext.interrupted = false;
+  operationContext.context = dispatcher->getCurrentContext();
+  contextPair.readContext = &operationContext;
+  bool interrupted;
+  int32_t result = dispatcher->completeIoUring(sqe, interrupted);
+  contextPair.readContext = nullptr;
+  size_t transferred = ioUringTransferred(*dispatcher, result, interrupted, "TcpConnection::read, read");
+  assert(transferred <= size);
+  return transferred;
+}
+
+size_t TcpConnection::writeCompletion(const uint8_t* data, size_t size) {
+  io_uring_sqe* sqe = dispatcher->getIoUringSqe();
+  IoUring::prepareSend(sqe, connection, data, size);
+  OperationContext operationContext;
+  operationContext.interrupted = false;
+  operationContext.context = dispatcher->getCurrentContext();
+  contextPair.writeContext = &operationContext;
+  bool interrupted;
+  int32_t result = dispatcher->completeIoUring(sqe, interrupted);
+  contextPair.writeContext = nullptr;
+  size_t transferred = ioUringTransferred(*dispatcher, result, interrupted, "TcpConnection::write, send");
+  assert(transferred <= size);
+  return transferred;
+}
+
 std::pair<Ipv4Address, uint16_t> TcpConnection::getPeerAddressAndPort() const {
   sockaddr_in addr;
   socklen_t size = sizeof(addr);
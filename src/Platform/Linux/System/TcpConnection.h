@@ -18,6 +18,11 @@ class Ipv4Address;
 
 class TcpConnection {
 public:
+  struct Buffer {
+    const uint8_t* data;
+    std::size_t size;
+  };
+
   TcpConnection();
   TcpConnection(const TcpConnection&) = delete;
   TcpConnection(TcpConnection&& other);
@@ -26,6 +31,9 @@ public:
   TcpConnection& operator=(TcpConnection&& other);
   std::size_t read(uint8_t* data, std::size_t size);
   std::size_t write(const uint8_t* data, std::size_t size);
+  // Writes the buffers in order with a single call where the platform allows it; like write(),
+  // may transfer less than their total. Empty buffers are skipped and never shut the connection down.
+  std::size_t writeBuffers(const Buffer* buffers, std::size_t count);
   std::pair<Ipv4Address, uint16_t> getPeerAddressAndPort() const;
 
 private:
@@ -37,6 +45,8 @@ private:
   ContextPair contextPair;
 
   TcpConnection(Dispatcher& dispatcher, int socket);
+  std::size_t readCompletion(uint8_t* data, std::size_t size);
+  std::size_t writeCompletion(const uint8_t* data, std::size_t size);
 };
 
 }
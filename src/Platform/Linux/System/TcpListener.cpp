@@ -16,6 +16,7 @@
 #include <string.h>
 
 #include "Dispatcher.h"
+#include "IoUring.h"
 #include "TcpConnection.h"
 #include <System/ErrorMessage.h>
 #include <System/InterruptedException.h>
@@ -119,6 +120,10 @@ TcpConnection TcpListener::accept() {
     throw InterruptedException();
   }
 
+  if (dispatcher->hasIoUring()) {
+    return acceptCompletion();
+  }
+
   ContextPair contextPair;
   OperationContext listenerContext;
   listenerContext.interrupted = false;
@@ -193,4 +198,29 @@ TcpConnection TcpListener::accept() {
   throw std::runtime_error("TcpListener::accept, " + message);
 }
 
+TcpConnection TcpListener::acceptCompletion() {
+  io_uring_sqe* sqe = dispatcher->getIoUringSqe();
+  IoUring::prepareAccept(sqe, listener);
+  OperationContext listenerContext;
+  listenerContext.interrupted = false;
+  listenerContext.context = dispatcher->getCurrentContext();
+  context = &listenerContext;
+  bool interrupted;
+  int32_t connection = dispatcher->completeIoUring(sqe, interrupted);
+  context = nullptr;
+  if (connection < 0) {
+    if (interrupted) {
+      throw InterruptedException();
+    }
+
+    throw std::runtime_error("TcpListener::accept, accept failed, " + errorMessage(-connection));
+  }
+
+  if (interrupted) {
+    dispatcher->interrupt();
+  }
+
+  return TcpConnection(*dispatcher, connection);
+}
+
 }
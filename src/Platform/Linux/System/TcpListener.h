@@ -31,6 +31,8 @@ private:
   Dispatcher* dispatcher;
   void* context;
   int listener;
+
+  TcpConnection acceptCompletion();
 };
 
 }
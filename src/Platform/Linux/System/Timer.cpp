@@ -7,6 +7,7 @@
 
 #include "Timer.h"
 #include <cassert>
+#include <cerrno>
 #include <stdexcept>
 
 #include <sys/timerfd.h>
@@ -14,6 +15,7 @@
 #include <unistd.h>
 
 #include "Dispatcher.h"
+#include "IoUring.h"
 #include <System/ErrorMessage.h>
 #include <System/InterruptedException.h>
 
@@ -61,6 +63,25 @@ void Timer::sleep(std::chrono::nanoseconds duration) {
 
   if(duration.count() == 0 ) {
     dispatcher->yield();
+  } else if (dispatcher->hasIoUring()) {
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(duration);
+    IoUringTimespec expires;
+    expires.seconds = seconds.count();
+    expires.nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration - seconds).count();
+    io_uring_sqe* sqe = dispatcher->getIoUringSqe();
+    IoUring::prepareTimeout(sqe, &expires);
+
+    OperationContext timerContext;
+    timerContext.interrupted = false;
+    timerContext.context = dispatcher->getCurrentContext();
+    context = &timerContext;
+    bool interrupted;
+    dispatcher->completeIoUring(sqe, interrupted);
+    context = nullptr;
+    // The timer may expire with -ETIME before the cancellation reaches it; the interruption still stands.
+    if (interrupted) {
+      throw InterruptedException();
+    }
   } else {
     timer = dispatcher->getTimer();
 
@@ -46,6 +46,7 @@ private:
 };
 
 const size_t STACK_SIZE = 64 * 1024;
+const size_t MINIMUM_STACK_SIZE = 16 * 1024;
 
 }
 
@@ -83,6 +84,7 @@ Dispatcher::Dispatcher() : lastCreatedTimer(0) {
           firstResumingContext = nullptr;
           firstReusableContext = nullptr;
           runningContextCount = 0;
+          stackSize = STACK_SIZE;
           return;
         }
       }
@@ -321,6 +323,14 @@ void Dispatcher::yield() {
   }
 }
 
+void Dispatcher::setStackSize(size_t size) {
+  stackSize = size < MINIMUM_STACK_SIZE ? MINIMUM_STACK_SIZE : size;
+}
+
+size_t Dispatcher::getStackSize() const {
+  return stackSize;
+}
+
 int Dispatcher::getKqueue() const {
   return kqueue;
 }
@@ -328,9 +338,9 @@ int Dispatcher::getKqueue() const {
 NativeContext& Dispatcher::getReusableContext() {
   if(firstReusableContext == nullptr) {
    uctx* newlyCreatedContext = new uctx;
-   uint8_t* stackPointer = new uint8_t[STACK_SIZE];
+   uint8_t* stackPointer = new uint8_t[stackSize];
    static_cast<uctx*>(newlyCreatedContext)->uc_stack.ss_sp = stackPointer;
-   static_cast<uctx*>(newlyCreatedContext)->uc_stack.ss_size = STACK_SIZE;
+   static_cast<uctx*>(newlyCreatedContext)->uc_stack.ss_size = stackSize;
    
    ContextMakingData makingData{ newlyCreatedContext, this};
    makecontext(static_cast<uctx*>(newlyCreatedContext), reinterpret_cast<void(*)()>(contextProcedureStatic), reinterpret_cast<intptr_t>(&makingData));
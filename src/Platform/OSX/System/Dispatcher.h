@@ -56,6 +56,8 @@ public:
   void pushContext(NativeContext* context);
   void remoteSpawn(std::function<void()>&& procedure);
   void yield();
+  void setStackSize(size_t size);
+  size_t getStackSize() const;
 
   int getKqueue() const;
   NativeContext& getReusableContext();
@@ -86,6 +88,7 @@ private:
   NativeContext* lastResumingContext;
   NativeContext* firstReusableContext;
   size_t runningContextCount;
+  size_t stackSize;
 
   void contextProcedure(void* uctx);
   static void contextProcedureStatic(intptr_t context);
@@ -208,6 +208,17 @@ size_t TcpConnection::write(const uint8_t* data, size_t size) {
   return transferred;
 }
 
+// Gathered writes are not implemented here, the first non-empty buffer is written alone.
+size_t TcpConnection::writeBuffers(const Buffer* buffers, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    if (buffers[i].size != 0) {
+      return write(buffers[i].data, buffers[i].size);
+    }
+  }
+
+  return 0;
+}
+
 std::pair<Ipv4Address, uint16_t> TcpConnection::getPeerAddressAndPort() const {
   sockaddr_in addr;
   socklen_t size = sizeof(addr);
@@ -28,6 +28,7 @@ struct DispatcherContext : public OVERLAPPED {
 
 const size_t STACK_SIZE = 16384;
 const size_t RESERVE_STACK_SIZE = 2097152;
+const size_t MINIMUM_STACK_SIZE = 16384;
 }
 
 Dispatcher::Dispatcher() {
@@ -64,6 +65,7 @@ Dispatcher::Dispatcher() {
         firstResumingContext = nullptr;
         firstReusableContext = nullptr;
         runningContextCount = 0;
+        stackSize = RESERVE_STACK_SIZE;
         return;
       }
 
@@ -321,13 +323,21 @@ void Dispatcher::addTimer(uint64_t time, NativeContext* context) {
   timers.insert(std::make_pair(time, context));
 }
 
+void Dispatcher::setStackSize(size_t size) {
+  stackSize = size < MINIMUM_STACK_SIZE ? MINIMUM_STACK_SIZE : size;
+}
+
+size_t Dispatcher::getStackSize() const {
+  return stackSize;
+}
+
 void* Dispatcher::getCompletionPort() const {
   return completionPort;
 }
 
 NativeContext& Dispatcher::getReusableContext() {
   if (firstReusableContext == nullptr) {
-    void* fiber = CreateFiberEx(STACK_SIZE, RESERVE_STACK_SIZE, 0, contextProcedureStatic, this);
+    void* fiber = CreateFiberEx(STACK_SIZE, stackSize, 0, contextProcedureStatic, this);
     if (fiber == NULL) {
       throw std::runtime_error("Dispatcher::getReusableContext, CreateFiberEx failed, " + lastErrorMessage());
     }
@@ -49,6 +49,8 @@ public:
   void pushContext(NativeContext* context);
   void remoteSpawn(std::function<void()>&& procedure);
   void yield();
+  void setStackSize(size_t size);
+  size_t getStackSize() const;
 
   // Platform-specific
   void addTimer(uint64_t time, NativeContext* context);
@@ -74,6 +76,7 @@ private:
   NativeContext* lastResumingContext;
   NativeContext* firstReusableContext;
   size_t runningContextCount;
+  size_t stackSize;
 
   void contextProcedure();
   static void __stdcall contextProcedureStatic(void* context);
@@ -270,6 +270,8 @@ struct COMMAND_RPC_GET_INFO {
     uint32_t last_known_block_index;
     uint64_t full_deposit_amount;
     uint64_t full_deposit_interest;
+    uint64_t response_cache_hits;
+    uint64_t response_cache_misses;
 
     void serialize(ISerializer &s) {
       KV_MEMBER(status)
@@ -285,6 +287,8 @@ struct COMMAND_RPC_GET_INFO {
       KV_MEMBER(last_known_block_index)
       KV_MEMBER(full_deposit_amount)
       KV_MEMBER(full_deposit_interest)
+      KV_MEMBER(response_cache_hits)
+      KV_MEMBER(response_cache_misses)
     }
   };
 };
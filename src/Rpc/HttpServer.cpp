@@ -13,9 +13,22 @@
 #include <System/TcpStream.h>
 #include <System/Ipv4Address.h>
 
+#include "Common/Metrics.h"
+
 using namespace Logging;
 
 namespace {
+
+Common::MetricCounter& requestsCounter(const char* status) {
+  return Common::Metrics::counter("ultranote_http_requests_total", "HTTP requests served, by status", Common::Metrics::label("status", status));
+}
+
+// indexed by HttpResponse::HTTP_STATUS
+Common::MetricCounter& requestsServed(CryptoNote::HttpResponse::HTTP_STATUS status) {
+  static Common::MetricCounter* const counters[] = { &requestsCounter("200"), &requestsCounter("401"), &requestsCounter("404"), &requestsCounter("500") };
+  return *counters[status];
+}
+
 std::string base64Encode(const std::string& data) {
   static const char* encodingTable = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
   const size_t resultSize = 4 * ((data.size() + 2) / 3);
@@ -90,9 +103,12 @@ void HttpServer::acceptLoop() {
       }
     }
 
+    static Common::MetricGauge& openConnections = Common::Metrics::gauge("ultranote_http_connections", "Open HTTP connections");
     m_connections.insert(&connection);
+    openConnections.add(1);
     BOOST_SCOPE_EXIT_ALL(this, &connection) { 
-      m_connections.erase(&connection); };
+      m_connections.erase(&connection);
+      openConnections.add(-1); };
 
     auto addr = connection.getPeerAddressAndPort();
 
@@ -119,6 +135,7 @@ void HttpServer::acceptLoop() {
 
       stream << resp;
       stream.flush();
+      requestsServed(resp.getStatus()).inc();
 
       if (stream.peek() == std::iostream::traits_type::eof()) {
         break;
@@ -59,16 +59,22 @@ public:
   JsonRpcRequest() : psReq(Common::JsonValue::OBJECT) {}
 
   bool parseRequest(const std::string& requestBody) {
+    Common::JsonValue request;
     try {
-      psReq = Common::JsonValue::fromString(requestBody);
+      request = Common::JsonValue::fromString(requestBody);
     } catch (std::exception&) {
       throw JsonRpcError(errParseError);
     }
 
-    if (!psReq.contains("method")) {
+    return parseRequest(request);
+  }
+
+  bool parseRequest(const Common::JsonValue& request) {
+    if (!request.isObject() || !request.contains("method") || !request("method").isString()) {
       throw JsonRpcError(errInvalidRequest);
     }
 
+    psReq = request;
     method = psReq("method").getString();
 
     if (psReq.contains("id")) {
@@ -128,6 +134,8 @@ public:
     } catch (std::exception&) {
       throw JsonRpcError(errParseError);
     }
+
+    resultBody.clear();
   }
 
   void setId(const OptionalId& id) {
@@ -151,17 +159,31 @@ public:
 
   std::string getBody() {
     psResp.set("jsonrpc", std::string("2.0"));
-    return psResp.toString();
+    std::string body = psResp.toString();
+    if (!resultBody.empty()) {
+      // psResp is a non-empty object here, append the result before its closing brace
+      body.pop_back();
+      body += ",\"result\":";
+      body += resultBody;
+      body += '}';
+    }
+
+    return body;
   }
 
   template <typename T>
   bool setResult(const T& v) {
-    psResp.set("result", storeToJsonValue(v));
+    resultBody = storeToJson(v);
     return true;
   }
 
   template <typename T>
   bool getResult(T& v) const {
+    if (!resultBody.empty()) {
+      loadFromJsonValue(v, Common::JsonValue::fromString(resultBody));
+      return true;
+    }
+
     if (!psResp.contains("result")) {
       return false;
     }
@@ -172,6 +194,7 @@ public:
 
 private:
   Common::JsonValue psResp;
+  std::string resultBody; // result serialized straight to JSON, spliced into the body
 };
 
 
@@ -0,0 +1,112 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2014-2017 XDN developers
+// Copyright (c) 2016-2017 BXC developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "crypto/hash.h"
+
+namespace CryptoNote {
+
+// Size-bounded LRU cache of responses built from immutable chain data (blocks
+// and transactions keyed by hash). Entries are dropped when the block they were
+// built from is popped. Values fetched before an invalidation are rejected by
+// put() through the generation counter, so a reorg racing with a handler can't
+// leave a stale entry behind.
+template <typename Value>
+class RpcResponseCache {
+public:
+  explicit RpcResponseCache(size_t maxEntries) : m_maxEntries(maxEntries), m_generation(0), m_hits(0), m_misses(0) {
+  }
+
+  uint64_t generation() const {
+    return m_generation.load();
+  }
+
+  bool get(const Crypto::Hash& key, Value& value) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(key);
+    if (it == m_index.end()) {
+      ++m_misses;
+      return false;
+    }
+
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    value = it->second->second;
+    ++m_hits;
+    return true;
+  }
+
+  void put(const Crypto::Hash& key, const Value& value, uint64_t generation) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_maxEntries == 0 || generation != m_generation.load()) {
+      return;
+    }
+
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+      it->second->second = value;
+      m_entries.splice(m_entries.begin(), m_entries, it->second);
+      return;
+    }
+
+    m_entries.emplace_front(key, value);
+    m_index.emplace(key, m_entries.begin());
+
+    if (m_entries.size() > m_maxEntries) {
+      m_index.erase(m_entries.back().first);
+      m_entries.pop_back();
+    }
+  }
+
+  void remove(const Crypto::Hash& key) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_generation;
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+      m_entries.erase(it->second);
+      m_index.erase(it);
+    }
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_generation;
+    m_index.clear();
+    m_entries.clear();
+  }
+
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+  }
+
+  uint64_t hits() const {
+    return m_hits.load();
+  }
+
+  uint64_t misses() const {
+    return m_misses.load();
+  }
+
+private:
+  typedef std::list<std::pair<Crypto::Hash, Value>> EntryList;
+
+  mutable std::mutex m_mutex;
+  EntryList m_entries;
+  std::unordered_map<Crypto::Hash, typename EntryList::iterator> m_index;
+  const size_t m_maxEntries;
+  std::atomic<uint64_t> m_generation;
+  std::atomic<uint64_t> m_hits;
+  std::atomic<uint64_t> m_misses;
+};
+
+}
@@ -8,9 +8,11 @@
 #include "RpcServer.h"
 
 #include <future>
+#include <sstream>
 #include <unordered_map>
 
 // CryptoNote
+#include "Common/Metrics.h"
 #include "Common/StringTools.h"
 #include "CryptoNoteCore/CryptoNoteTools.h"
 #include "CryptoNoteCore/Core.h"
@@ -35,6 +37,16 @@ namespace CryptoNote {
 
 namespace {
 
+// A JSON-RPC 2.0 request without an id; it is run, but gets no response.
+bool isNotification(const Common::JsonValue& call) {
+  return call.isObject() && call.contains("method") && !call.contains("id");
+}
+
+Common::MetricHistogram& requestTime(const std::string& labels) {
+  return Common::Metrics::histogram("ultranote_rpc_request_seconds", "Time to handle an RPC request, by endpoint or JSON-RPC method",
+    Common::Metrics::latencyBuckets(), labels);
+}
+
 template <typename Command>
 RpcServer::HandlerFunction binMethod(bool (RpcServer::*handler)(typename Command::request const&, typename Command::response&)) {
   return [handler](RpcServer* obj, const HttpRequest& request, HttpResponse& response) {
@@ -92,11 +104,32 @@ std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction
   { "/stop_daemon", { jsonMethod<COMMAND_RPC_STOP_DAEMON>(&RpcServer::on_stop_daemon), true } },
 
   // json rpc
-  { "/json_rpc", { std::bind(&RpcServer::processJsonRpcRequest, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3), true } }
+  { "/json_rpc", { std::bind(&RpcServer::processJsonRpcRequest, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3), true } },
+
+  // prometheus
+  { "/metrics", { std::bind(&RpcServer::on_get_metrics, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3), true } }
 };
 
 RpcServer::RpcServer(System::Dispatcher& dispatcher, Logging::ILogger& log, core& c, NodeServer& p2p, const ICryptoNoteProtocolQuery& protocolQuery) :
-  HttpServer(dispatcher, log), logger(log, "RpcServer"), m_core(c), m_p2p(p2p), m_protocolQuery(protocolQuery) {
+  HttpServer(dispatcher, log), logger(log, "RpcServer"), m_core(c), m_p2p(p2p), m_protocolQuery(protocolQuery),
+  m_rawBlockCache(RPC_RESPONSE_CACHE_MAX_ENTRIES),
+  m_blockHeaderCache(RPC_RESPONSE_CACHE_MAX_ENTRIES),
+  m_blockDetailsCache(RPC_RESPONSE_CACHE_MAX_ENTRIES),
+  m_transactionCache(RPC_RESPONSE_CACHE_MAX_ENTRIES),
+  m_transactionDetailsCache(RPC_RESPONSE_CACHE_MAX_ENTRIES) {
+  for (auto& handler : s_handlers) {
+    handler.second.requestTime = &requestTime(Common::Metrics::label("endpoint", handler.first));
+  }
+
+  for (auto& handler : s_jsonRpcHandlers) {
+    handler.second.requestTime = &requestTime(Common::Metrics::label("endpoint", "/json_rpc") + "," + Common::Metrics::label("method", handler.first));
+  }
+
+  m_core.addObserver(this);
+}
+
+RpcServer::~RpcServer() {
+  m_core.removeObserver(this);
 }
 
 void RpcServer::processRequest(const HttpRequest& request, HttpResponse& response) {
@@ -114,42 +147,67 @@ void RpcServer::processRequest(const HttpRequest& request, HttpResponse& respons
     return;
   }
 
+  Common::MetricTimer timer(*it->second.requestTime);
   it->second.handler(this, request, response);
 }
 
+std::unordered_map<std::string, RpcServer::RpcHandler<JsonRpc::JsonMemberMethod>> RpcServer::s_jsonRpcHandlers = {
+  { "f_blocks_list_json", { JsonRpc::makeMemberMethod(&RpcServer::f_on_blocks_list_json), false, true } },
+  { "f_block_json", { JsonRpc::makeMemberMethod(&RpcServer::f_on_block_json), false, true } },
+  { "f_transaction_json", { JsonRpc::makeMemberMethod(&RpcServer::f_on_transaction_json), false, true } },
+  { "f_on_transactions_pool_json", { JsonRpc::makeMemberMethod(&RpcServer::f_on_transactions_pool_json), false, true } },
+  { "k_transactions_by_payment_id", { JsonRpc::makeMemberMethod(&RpcServer::k_on_transactions_by_payment_id), false, true } },
+ // { "f_get_blockchain_settings", { JsonRpc::makeMemberMethod(&RpcServer::f_on_get_blockchain_settings), true, true } },
+  { "getblockcount", { JsonRpc::makeMemberMethod(&RpcServer::on_getblockcount), true, true } },
+  { "on_getblockhash", { JsonRpc::makeMemberMethod(&RpcServer::on_getblockhash), false, true } },
+  { "getblocktemplate", { JsonRpc::makeMemberMethod(&RpcServer::on_getblocktemplate), false, false } },
+  { "getcurrencyid", { JsonRpc::makeMemberMethod(&RpcServer::on_get_currency_id), true, true } },
+  { "submitblock", { JsonRpc::makeMemberMethod(&RpcServer::on_submitblock), false, false } },
+  { "getlastblockheader", { JsonRpc::makeMemberMethod(&RpcServer::on_get_last_block_header), false, true } },
+  { "getblockheaderbyhash", { JsonRpc::makeMemberMethod(&RpcServer::on_get_block_header_by_hash), false, true } },
+  { "getblockheaderbyheight", { JsonRpc::makeMemberMethod(&RpcServer::on_get_block_header_by_height), false, true } }
+};
+
 bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse& response) {
 
   using namespace JsonRpc;
 
   response.addHeader("Content-Type", "application/json");
+  logger(TRACE) << "JSON-RPC request: " << request.getBody();
+
+  Common::JsonValue requestValue;
+  std::string responseBody;
+
+  try {
+    requestValue = Common::JsonValue::fromString(request.getBody());
+  } catch (std::exception&) {
+    JsonRpcResponse jsonResponse;
+    jsonResponse.setError(JsonRpcError(JsonRpc::errParseError));
+    responseBody = jsonResponse.getBody();
+  }
+
+  if (responseBody.empty()) {
+    responseBody = requestValue.isArray() ? processJsonRpcBatch(requestValue) : processJsonRpcCall(requestValue);
+  }
+
+  response.setBody(responseBody);
+  logger(TRACE) << "JSON-RPC response: " << responseBody;
+  return true;
+}
+
+std::string RpcServer::processJsonRpcCall(const Common::JsonValue& call) {
+
+  using namespace JsonRpc;
 
   JsonRpcRequest jsonRequest;
   JsonRpcResponse jsonResponse;
 
   try {
-    logger(TRACE) << "JSON-RPC request: " << request.getBody();
-    jsonRequest.parseRequest(request.getBody());
+    jsonRequest.parseRequest(call);
     jsonResponse.setId(jsonRequest.getId()); // copy id
 
-    static std::unordered_map<std::string, RpcServer::RpcHandler<JsonMemberMethod>> jsonRpcHandlers = {
-      { "f_blocks_list_json", { makeMemberMethod(&RpcServer::f_on_blocks_list_json), false } },
-      { "f_block_json", { makeMemberMethod(&RpcServer::f_on_block_json), false } },
-      { "f_transaction_json", { makeMemberMethod(&RpcServer::f_on_transaction_json), false } },
-      { "f_on_transactions_pool_json", { makeMemberMethod(&RpcServer::f_on_transactions_pool_json), false } },
-      { "k_transactions_by_payment_id", { makeMemberMethod(&RpcServer::k_on_transactions_by_payment_id), false } },
-     // { "f_get_blockchain_settings", { makeMemberMethod(&RpcServer::f_on_get_blockchain_settings), true } },
-      { "getblockcount", { makeMemberMethod(&RpcServer::on_getblockcount), true } },
-      { "on_getblockhash", { makeMemberMethod(&RpcServer::on_getblockhash), false } },
-      { "getblocktemplate", { makeMemberMethod(&RpcServer::on_getblocktemplate), false } },
-      { "getcurrencyid", { makeMemberMethod(&RpcServer::on_get_currency_id), true } },
-      { "submitblock", { makeMemberMethod(&RpcServer::on_submitblock), false } },
-      { "getlastblockheader", { makeMemberMethod(&RpcServer::on_get_last_block_header), false } },
-      { "getblockheaderbyhash", { makeMemberMethod(&RpcServer::on_get_block_header_by_hash), false } },
-      { "getblockheaderbyheight", { makeMemberMethod(&RpcServer::on_get_block_header_by_height), false } }
-    };
-
-    auto it = jsonRpcHandlers.find(jsonRequest.getMethod());
-    if (it == jsonRpcHandlers.end()) {
+    auto it = s_jsonRpcHandlers.find(jsonRequest.getMethod());
+    if (it == s_jsonRpcHandlers.end()) {
       throw JsonRpcError(JsonRpc::errMethodNotFound);
     }
 
@@ -157,6 +215,7 @@ bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse&
       throw JsonRpcError(CORE_RPC_ERROR_CODE_CORE_BUSY, "Core is busy");
     }
 
+    Common::MetricTimer timer(*it->second.requestTime);
     it->second.handler(this, jsonRequest, jsonResponse);
 
   } catch (const JsonRpcError& err) {
@@ -165,15 +224,82 @@ bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse&
     jsonResponse.setError(JsonRpcError(JsonRpc::errInternalError, e.what()));
   }
 
-  response.setBody(jsonResponse.getBody());
-  logger(TRACE) << "JSON-RPC response: " << jsonResponse.getBody();
-  return true;
+  return jsonResponse.getBody();
+}
+
+std::string RpcServer::processJsonRpcBatch(const Common::JsonValue& batch) {
+  if (batch.size() == 0) {
+    JsonRpc::JsonRpcResponse jsonResponse;
+    jsonResponse.setError(JsonRpc::JsonRpcError(JsonRpc::errInvalidRequest));
+    return jsonResponse.getBody();
+  }
+
+  std::vector<std::string> responses(batch.size());
+  size_t index = 0;
+  while (index < batch.size()) {
+    if (!isReadOnlyJsonRpcCall(batch[index])) {
+      responses[index] = processJsonRpcCall(batch[index]);
+      ++index;
+      continue;
+    }
+
+    // run the whole span of consecutive read-only calls under a single core lock
+    size_t spanEnd = index + 1;
+    while (spanEnd < batch.size() && isReadOnlyJsonRpcCall(batch[spanEnd])) {
+      ++spanEnd;
+    }
+
+    m_core.executeLocked([&]() -> std::error_code {
+      for (; index < spanEnd; ++index) {
+        responses[index] = processJsonRpcCall(batch[index]);
+      }
+
+      return std::error_code();
+    });
+  }
+
+  // a batch of notifications only is answered with nothing at all
+  std::string body;
+  for (size_t i = 0; i < responses.size(); ++i) {
+    if (isNotification(batch[i])) {
+      continue;
+    }
+
+    body += body.empty() ? '[' : ',';
+    body += responses[i];
+  }
+
+  if (!body.empty()) {
+    body += ']';
+  }
+
+  return body;
+}
+
+bool RpcServer::isReadOnlyJsonRpcCall(const Common::JsonValue& call) const {
+  if (!call.isObject() || !call.contains("method") || !call("method").isString()) {
+    return false;
+  }
+
+  auto it = s_jsonRpcHandlers.find(call("method").getString());
+  return it != s_jsonRpcHandlers.end() && it->second.readOnly;
 }
 
 bool RpcServer::isCoreReady() {
   return m_core.currency().isTestnet() || m_p2p.get_payload_object().isSynchronized();
 }
 
+void RpcServer::blockPopped(const Crypto::Hash& blockHash, const std::vector<Crypto::Hash>& transactionHashes) {
+  m_rawBlockCache.remove(blockHash);
+  m_blockHeaderCache.remove(blockHash);
+  m_blockDetailsCache.remove(blockHash);
+
+  for (const auto& transactionHash : transactionHashes) {
+    m_transactionCache.remove(transactionHash);
+    m_transactionDetailsCache.remove(transactionHash);
+  }
+}
+
 //
 // Binary handlers
 //
@@ -198,17 +324,21 @@ bool RpcServer::on_get_blocks(const COMMAND_RPC_GET_BLOCKS_FAST::request& req, C
   res.start_height = startBlockIndex;
 
   for (const auto& blockId : supplement) {
-    assert(m_core.have_block(blockId));
-    auto completeBlock = m_core.getBlock(blockId);
-    assert(completeBlock != nullptr);
-
     res.blocks.resize(res.blocks.size() + 1);
-    res.blocks.back().block = asString(toBinaryArray(completeBlock->getBlock()));
 
-    res.blocks.back().txs.reserve(completeBlock->getTransactionCount());
-    for (size_t i = 0; i < completeBlock->getTransactionCount(); ++i) {
-      res.blocks.back().txs.push_back(asString(toBinaryArray(completeBlock->getTransaction(i))));
+    uint64_t cacheGeneration = m_rawBlockCache.generation();
+    if (m_rawBlockCache.get(blockId, res.blocks.back())) {
+      continue;
+    }
+
+    assert(m_core.have_block(blockId));
+    if (!m_core.getRawBlock(blockId, res.blocks.back())) {
+      res.blocks.pop_back();
+      res.status = "Failed";
+      return false;
     }
+
+    m_rawBlockCache.put(blockId, res.blocks.back(), cacheGeneration);
   }
 
   res.status = CORE_RPC_STATUS_OK;
@@ -340,6 +470,10 @@ bool RpcServer::on_get_info(const COMMAND_RPC_GET_INFO::request& req, COMMAND_RP
   }
   res.full_deposit_amount = totalCoinsOnDeposits;
   res.full_deposit_interest = m_core.fullDepositInterest();
+  res.response_cache_hits = m_rawBlockCache.hits() + m_blockHeaderCache.hits() + m_blockDetailsCache.hits() +
+    m_transactionCache.hits() + m_transactionDetailsCache.hits();
+  res.response_cache_misses = m_rawBlockCache.misses() + m_blockHeaderCache.misses() + m_blockDetailsCache.misses() +
+    m_transactionCache.misses() + m_transactionDetailsCache.misses();
   res.status = CORE_RPC_STATUS_OK;
   return true;
 }
@@ -365,16 +499,34 @@ bool RpcServer::on_get_transactions(const COMMAND_RPC_GET_TRANSACTIONS::request&
     }
     vh.push_back(*reinterpret_cast<const Hash*>(b.data()));
   }
+
+  uint64_t cacheGeneration = m_transactionCache.generation();
+  std::vector<std::string> cachedTxs(vh.size());
+  std::vector<Hash> uncachedTxIds;
+  for (size_t i = 0; i < vh.size(); ++i) {
+    if (!m_transactionCache.get(vh[i], cachedTxs[i])) {
+      uncachedTxIds.push_back(vh[i]);
+    }
+  }
+
   std::list<Hash> missed_txs;
   std::list<Transaction> txs;
-  m_core.getTransactions(vh, txs, missed_txs);
-
-  for (auto& tx : txs) {
-    res.txs_as_hex.push_back(toHex(toBinaryArray(tx)));
+  if (!uncachedTxIds.empty()) {
+    m_core.getTransactions(uncachedTxIds, txs, missed_txs);
   }
 
-  for (const auto& miss_tx : missed_txs) {
-    res.missed_tx.push_back(Common::podToHex(miss_tx));
+  // found transactions and misses both keep the order of the requested ids
+  auto txIt = txs.begin();
+  auto missedIt = missed_txs.begin();
+  for (size_t i = 0; i < vh.size(); ++i) {
+    if (!cachedTxs[i].empty()) {
+      res.txs_as_hex.push_back(std::move(cachedTxs[i]));
+    } else if (missedIt != missed_txs.end() && *missedIt == vh[i]) {
+      res.missed_tx.push_back(Common::podToHex(*missedIt++));
+    } else if (txIt != txs.end()) {
+      res.txs_as_hex.push_back(toHex(toBinaryArray(*txIt++)));
+      m_transactionCache.put(vh[i], res.txs_as_hex.back(), cacheGeneration);
+    }
   }
 
   res.status = CORE_RPC_STATUS_OK;
@@ -457,6 +609,25 @@ bool RpcServer::on_stop_daemon(const COMMAND_RPC_STOP_DAEMON::request& req, COMM
   return true;
 }
 
+bool RpcServer::on_get_metrics(const HttpRequest& request, HttpResponse& response) {
+  // values the node keeps anyway are read at scrape time instead of being tracked on every change
+  uint64_t connections = m_p2p.get_connections_count();
+  uint64_t outgoingConnections = m_p2p.get_outgoing_connections_count();
+  Common::Metrics::gauge("ultranote_blockchain_height", "Height of the main chain").set(m_core.get_current_blockchain_height());
+  Common::Metrics::gauge("ultranote_next_block_difficulty", "Difficulty of the next block").set(m_core.getNextBlockDifficulty());
+  Common::Metrics::gauge("ultranote_alternative_blocks", "Blocks kept on alternative chains").set(m_core.get_alternative_blocks_count());
+  Common::Metrics::gauge("ultranote_p2p_connections", "Open P2P connections", Common::Metrics::label("direction", "in")).set(connections - outgoingConnections);
+  Common::Metrics::gauge("ultranote_p2p_connections", "Open P2P connections", Common::Metrics::label("direction", "out")).set(outgoingConnections);
+  Common::Metrics::gauge("ultranote_p2p_peerlist_size", "Known peers", Common::Metrics::label("list", "white")).set(m_p2p.getPeerlistManager().get_white_peers_count());
+  Common::Metrics::gauge("ultranote_p2p_peerlist_size", "Known peers", Common::Metrics::label("list", "gray")).set(m_p2p.getPeerlistManager().get_gray_peers_count());
+
+  std::ostringstream body;
+  Common::Metrics::writePrometheus(body);
+  response.addHeader("Content-Type", "text/plain; version=0.0.4");
+  response.setBody(body.str());
+  return true;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------
 // JSON RPC methods
 //------------------------------------------------------------------------------------------------------------------------------
@@ -512,6 +683,13 @@ bool RpcServer::f_on_block_json(const F_COMMAND_RPC_GET_BLOCK_DETAILS::request&
       "Failed to parse hex representation of block hash. Hex = " + req.hash + '.' };
   }
 
+  uint64_t cacheGeneration = m_blockDetailsCache.generation();
+  if (m_blockDetailsCache.get(hash, res.block)) {
+    res.block.depth = m_core.get_current_blockchain_height() - res.block.height - 1;
+    res.status = CORE_RPC_STATUS_OK;
+    return true;
+  }
+
   Block blk;
   if (!m_core.getBlockByHash(hash, blk)) {
     throw JsonRpc::JsonRpcError{
@@ -641,6 +819,10 @@ bool RpcServer::f_on_block_json(const F_COMMAND_RPC_GET_BLOCK_DETAILS::request&
     res.block.totalFeeAmount += transaction_short.fee;
   }
 
+  if (m_core.getBlockIdByHeight(static_cast<uint32_t>(res.block.height)) == hash) {
+    m_blockDetailsCache.put(hash, res.block, cacheGeneration);
+  }
+
   res.status = CORE_RPC_STATUS_OK;
   return true;
 }
@@ -654,6 +836,11 @@ bool RpcServer::f_on_transaction_json(const F_COMMAND_RPC_GET_TRANSACTION_DETAIL
       "Failed to parse hex representation of transaction hash. Hex = " + req.hash + '.' };
   }
 
+  uint64_t cacheGeneration = m_transactionDetailsCache.generation();
+  if (m_transactionDetailsCache.get(hash, res)) {
+    return true;
+  }
+
   std::vector<Crypto::Hash> tx_ids;
   tx_ids.push_back(hash);
 
@@ -669,11 +856,13 @@ bool RpcServer::f_on_transaction_json(const F_COMMAND_RPC_GET_TRANSACTION_DETAIL
       "transaction wasn't found. Hash = " + req.hash + '.' };
   }
 
+  bool inMainChain = false;
   Crypto::Hash blockHash;
   uint32_t blockHeight;
   if (m_core.getBlockContainingTx(hash, blockHash, blockHeight)) {
     Block blk;
     if (m_core.getBlockByHash(blockHash, blk)) {
+      inMainChain = true;
       size_t tx_cumulative_block_size;
       m_core.getBlockSize(blockHash, tx_cumulative_block_size);
       size_t blokBlobSize = getObjectBinarySize(blk);
@@ -720,6 +909,10 @@ bool RpcServer::f_on_transaction_json(const F_COMMAND_RPC_GET_TRANSACTION_DETAIL
   }
 
   res.status = CORE_RPC_STATUS_OK;
+  if (inMainChain) {
+    m_transactionDetailsCache.put(hash, res, cacheGeneration);
+  }
+
   return true;
 }
 
@@ -968,6 +1161,13 @@ bool RpcServer::on_get_block_header_by_hash(const COMMAND_RPC_GET_BLOCK_HEADER_B
       "Failed to parse hex representation of block hash. Hex = " + req.hash + '.' };
   }
 
+  uint64_t cacheGeneration = m_blockHeaderCache.generation();
+  if (m_blockHeaderCache.get(block_hash, res.block_header)) {
+    res.block_header.depth = m_core.get_current_blockchain_height() - res.block_header.height - 1;
+    res.status = CORE_RPC_STATUS_OK;
+    return true;
+  }
+
   Block blk;
   if (!m_core.getBlockByHash(block_hash, blk)) {
     throw JsonRpc::JsonRpcError{
@@ -983,6 +1183,10 @@ bool RpcServer::on_get_block_header_by_hash(const COMMAND_RPC_GET_BLOCK_HEADER_B
 
   uint64_t block_height = boost::get<BaseInput>(blk.baseTransaction.inputs.front()).blockIndex;
   fill_block_header_response(blk, false, block_height, block_hash, res.block_header);
+  if (m_core.getBlockIdByHeight(static_cast<uint32_t>(block_height)) == block_hash) {
+    m_blockHeaderCache.put(block_hash, res.block_header, cacheGeneration);
+  }
+
   res.status = CORE_RPC_STATUS_OK;
   return true;
 }
@@ -993,7 +1197,14 @@ bool RpcServer::on_get_block_header_by_height(const COMMAND_RPC_GET_BLOCK_HEADER
       std::string("To big height: ") + std::to_string(req.height) + ", current blockchain height = " + std::to_string(m_core.get_current_blockchain_height()) };
   }
 
+  uint64_t cacheGeneration = m_blockHeaderCache.generation();
   Hash block_hash = m_core.getBlockIdByHeight(static_cast<uint32_t>(req.height));
+  if (m_blockHeaderCache.get(block_hash, res.block_header)) {
+    res.block_header.depth = m_core.get_current_blockchain_height() - res.block_header.height - 1;
+    res.status = CORE_RPC_STATUS_OK;
+    return true;
+  }
+
   Block blk;
   if (!m_core.getBlockByHash(block_hash, blk)) {
     throw JsonRpc::JsonRpcError{ CORE_RPC_ERROR_CODE_INTERNAL_ERROR,
@@ -1001,6 +1212,7 @@ bool RpcServer::on_get_block_header_by_height(const COMMAND_RPC_GET_BLOCK_HEADER
   }
 
   fill_block_header_response(blk, false, req.height, block_hash, res.block_header);
+  m_blockHeaderCache.put(block_hash, res.block_header, cacheGeneration);
   res.status = CORE_RPC_STATUS_OK;
   return true;
 }
@@ -12,7 +12,14 @@
 
 #include <Logging/LoggerRef.h>
 #include "Common/Math.h"
+#include "CryptoNoteCore/ICoreObserver.h"
 #include "CoreRpcServerCommandsDefinitions.h"
+#include "JsonRpc.h"
+#include "RpcResponseCache.h"
+
+namespace Common {
+class MetricHistogram;
+}
 
 namespace CryptoNote {
 
@@ -20,9 +27,10 @@ class core;
 class NodeServer;
 class ICryptoNoteProtocolQuery;
 
-class RpcServer : public HttpServer {
+class RpcServer : public HttpServer, private ICoreObserver {
 public:
   RpcServer(System::Dispatcher& dispatcher, Logging::ILogger& log, core& c, NodeServer& p2p, const ICryptoNoteProtocolQuery& protocolQuery);
+  virtual ~RpcServer();
 
   typedef std::function<bool(RpcServer*, const HttpRequest& request, HttpResponse& response)> HandlerFunction;
 
@@ -32,15 +40,24 @@ private:
   struct RpcHandler {
     const Handler handler;
     const bool allowBusyCore;
+    const bool readOnly; // only reads core state, batch members with it share one core lock
+    Common::MetricHistogram* requestTime; // set by the constructor, so requests don't look it up
   };
 
   typedef void (RpcServer::*HandlerPtr)(const HttpRequest& request, HttpResponse& response);
   static std::unordered_map<std::string, RpcHandler<HandlerFunction>> s_handlers;
+  static std::unordered_map<std::string, RpcHandler<JsonRpc::JsonMemberMethod>> s_jsonRpcHandlers;
 
   virtual void processRequest(const HttpRequest& request, HttpResponse& response) override;
   bool processJsonRpcRequest(const HttpRequest& request, HttpResponse& response);
+  std::string processJsonRpcCall(const Common::JsonValue& call);
+  std::string processJsonRpcBatch(const Common::JsonValue& batch);
+  bool isReadOnlyJsonRpcCall(const Common::JsonValue& call) const;
   bool isCoreReady();
 
+  // ICoreObserver
+  virtual void blockPopped(const Crypto::Hash& blockHash, const std::vector<Crypto::Hash>& transactionHashes) override;
+
   // binary handlers
   bool on_get_blocks(const COMMAND_RPC_GET_BLOCKS_FAST::request& req, COMMAND_RPC_GET_BLOCKS_FAST::response& res);
   bool on_query_blocks(const COMMAND_RPC_QUERY_BLOCKS::request& req, COMMAND_RPC_QUERY_BLOCKS::response& res);
@@ -59,6 +76,9 @@ private:
   bool on_stop_mining(const COMMAND_RPC_STOP_MINING::request& req, COMMAND_RPC_STOP_MINING::response& res);
   bool on_stop_daemon(const COMMAND_RPC_STOP_DAEMON::request& req, COMMAND_RPC_STOP_DAEMON::response& res);
 
+  // prometheus
+  bool on_get_metrics(const HttpRequest& request, HttpResponse& response);
+
   // json rpc
   bool on_getblockcount(const COMMAND_RPC_GETBLOCKCOUNT::request& req, COMMAND_RPC_GETBLOCKCOUNT::response& res);
   bool on_getblockhash(const COMMAND_RPC_GETBLOCKHASH::request& req, COMMAND_RPC_GETBLOCKHASH::response& res);
@@ -83,6 +103,12 @@ private:
   core& m_core;
   NodeServer& m_p2p;
   const ICryptoNoteProtocolQuery& m_protocolQuery;
+
+  RpcResponseCache<block_complete_entry> m_rawBlockCache;
+  RpcResponseCache<block_header_response> m_blockHeaderCache;
+  RpcResponseCache<f_block_details_response> m_blockDetailsCache;
+  RpcResponseCache<std::string> m_transactionCache;
+  RpcResponseCache<F_COMMAND_RPC_GET_TRANSACTION_DETAILS::response> m_transactionDetailsCache;
 };
 
 }
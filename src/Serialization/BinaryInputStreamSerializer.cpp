@@ -97,11 +97,8 @@ bool BinaryInputStreamSerializer::operator()(std::string& value, Common::StringV
   if (size > 100 * 1024 * 1024) {
     throw std::runtime_error("string size is too big");
   } else if (size > 0) {
-    std::vector<char> temp;
-    temp.resize(size);
-    checkedRead(&temp[0], size);
-    value.reserve(size);
-    value.assign(&temp[0], size);
+    value.resize(size);
+    checkedRead(&value[0], size);
   } else {
     value.clear();
   }
@@ -118,6 +115,24 @@ bool BinaryInputStreamSerializer::binary(std::string& value, Common::StringView
   return (*this)(value, name);
 }
 
+bool BinaryInputStreamSerializer::binaryArray(size_t itemSize, const std::function<void*(size_t)>& allocate, Common::StringView name) {
+  uint64_t size;
+  readVarint(stream, size);
+
+  if (size > 100 * 1024 * 1024) {
+    throw std::runtime_error("string size is too big");
+  } else if (size % itemSize != 0) {
+    throw std::runtime_error("Binary block size mismatch");
+  }
+
+  void* items = allocate(static_cast<size_t>(size / itemSize));
+  if (size > 0) {
+    checkedRead(static_cast<char*>(items), static_cast<size_t>(size));
+  }
+
+  return true;
+}
+
 bool BinaryInputStreamSerializer::operator()(double& value, Common::StringView name) {
   assert(false); //the method is not supported for this type of serialization
   throw std::runtime_error("double serialization is not supported in BinaryInputStreamSerializer");
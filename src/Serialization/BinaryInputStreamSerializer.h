@@ -38,6 +38,7 @@ public:
   virtual bool operator()(std::string& value, Common::StringView name) override;
   virtual bool binary(void* value, size_t size, Common::StringView name) override;
   virtual bool binary(std::string& value, Common::StringView name) override;
+  virtual bool binaryArray(size_t itemSize, const std::function<void*(size_t)>& allocate, Common::StringView name) override;
 
   template<typename T>
   bool operator()(T& value, Common::StringView name) {
@@ -7,8 +7,12 @@
 
 #pragma once
 
-#include <string>
+#include <cassert>
 #include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
 
 #include <Common/StringView.h>
 
@@ -46,10 +50,33 @@ public:
   virtual bool binary(void* value, size_t size, Common::StringView name) = 0;
   virtual bool binary(std::string& value, Common::StringView name) = 0;
 
+  // Input only: reads a binary block of count items of itemSize bytes into the storage allocate(count) returns,
+  // so arrays of POD don't have to go through a temporary string (see serializeAsBinary).
+  virtual bool binaryArray(size_t itemSize, const std::function<void*(size_t)>& allocate, Common::StringView name);
+
   template<typename T>
   bool operator()(T& value, Common::StringView name);
 };
 
+inline bool ISerializer::binaryArray(size_t itemSize, const std::function<void*(size_t)>& allocate, Common::StringView name) {
+  assert(type() == INPUT);
+  std::string blob;
+  if (!binary(blob, name)) {
+    return false;
+  }
+
+  if (blob.size() % itemSize != 0) {
+    throw std::runtime_error("Binary block size mismatch");
+  }
+
+  void* items = allocate(blob.size() / itemSize);
+  if (!blob.empty()) {
+    memcpy(items, blob.data(), blob.size());
+  }
+
+  return true;
+}
+
 template<typename T>
 bool ISerializer::operator()(T& value, Common::StringView name) {
   return serialize(value, name, *this);
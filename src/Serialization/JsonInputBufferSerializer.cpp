@@ -0,0 +1,352 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "JsonInputBufferSerializer.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include "Common/StringTools.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+const size_t JSON_MAX_DEPTH = 256;
+
+bool isWhitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+}
+
+JsonInputBufferSerializer::JsonInputBufferSerializer(Common::StringView json) : data(json.getData()), size(json.getSize()), position(0) {
+  if (peekNonWs() != '{') {
+    throw std::runtime_error("Serializer doesn't support this type of serialization: Object expected.");
+  }
+
+  parseValue(0);
+  chain.push_back({ 0, 0 });
+}
+
+JsonInputBufferSerializer::~JsonInputBufferSerializer() {
+}
+
+ISerializer::SerializerType JsonInputBufferSerializer::type() const {
+  return ISerializer::INPUT;
+}
+
+bool JsonInputBufferSerializer::beginObject(Common::StringView name) {
+  size_t index;
+  if (!findValue(name, index)) {
+    return false;
+  }
+
+  expectToken(index, TOKEN_OBJECT);
+  chain.push_back({ index, 0 });
+  return true;
+}
+
+void JsonInputBufferSerializer::endObject() {
+  assert(!chain.empty());
+  chain.pop_back();
+}
+
+bool JsonInputBufferSerializer::beginArray(size_t& size, Common::StringView name) {
+  size_t index;
+  if (!findValue(name, index)) {
+    size = 0;
+    return false;
+  }
+
+  size = expectToken(index, TOKEN_ARRAY).count;
+  chain.push_back({ index, index + 1 });
+  return true;
+}
+
+void JsonInputBufferSerializer::endArray() {
+  assert(!chain.empty());
+  chain.pop_back();
+}
+
+bool JsonInputBufferSerializer::operator()(uint16_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool JsonInputBufferSerializer::operator()(int16_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool JsonInputBufferSerializer::operator()(uint32_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool JsonInputBufferSerializer::operator()(int32_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool JsonInputBufferSerializer::operator()(int64_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool JsonInputBufferSerializer::operator()(uint64_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool JsonInputBufferSerializer::operator()(double& value, Common::StringView name) {
+  size_t index;
+  if (!findValue(name, index)) {
+    return false;
+  }
+
+  const Token& token = expectToken(index, TOKEN_NUMBER);
+  char text[64];
+  if (token.size >= sizeof(text)) {
+    throw std::runtime_error("Unable to parse");
+  }
+
+  memcpy(text, data + token.offset, token.size);
+  text[token.size] = '\0';
+  value = strtod(text, nullptr);
+  return true;
+}
+
+bool JsonInputBufferSerializer::operator()(uint8_t& value, Common::StringView name) {
+  return getNumber(name, value);
+}
+
+bool JsonInputBufferSerializer::operator()(std::string& value, Common::StringView name) {
+  size_t index;
+  if (!findValue(name, index)) {
+    return false;
+  }
+
+  const Token& token = expectToken(index, TOKEN_STRING);
+  value.assign(data + token.offset, token.size);
+  return true;
+}
+
+bool JsonInputBufferSerializer::operator()(bool& value, Common::StringView name) {
+  size_t index;
+  if (!findValue(name, index)) {
+    return false;
+  }
+
+  if (tokens[index].type != TOKEN_TRUE && tokens[index].type != TOKEN_FALSE) {
+    throw std::runtime_error("JsonValue type is not BOOL");
+  }
+
+  value = tokens[index].type == TOKEN_TRUE;
+  return true;
+}
+
+bool JsonInputBufferSerializer::binary(void* value, size_t size, Common::StringView name) {
+  size_t index;
+  if (!findValue(name, index)) {
+    return false;
+  }
+
+  const Token& token = expectToken(index, TOKEN_STRING);
+  if ((token.size >> 1) > size) {
+    throw std::runtime_error("fromHex: invalid buffer size");
+  }
+
+  readHex(token, value);
+  return true;
+}
+
+bool JsonInputBufferSerializer::binary(std::string& value, Common::StringView name) {
+  size_t index;
+  if (!findValue(name, index)) {
+    return false;
+  }
+
+  const Token& token = expectToken(index, TOKEN_STRING);
+  value.resize(token.size >> 1);
+  readHex(token, &value[0]);
+  return true;
+}
+
+void JsonInputBufferSerializer::parseValue(size_t depth) {
+  if (depth > JSON_MAX_DEPTH) {
+    throw std::runtime_error("Unable to parse: nesting is too deep");
+  }
+
+  char c = peekNonWs();
+  if (c == '{' || c == '[') {
+    size_t index = tokens.size();
+    tokens.push_back({ c == '{' ? TOKEN_OBJECT : TOKEN_ARRAY, position, 0, 0, 0 });
+    char close = c == '{' ? '}' : ']';
+    ++position;
+
+    if (peekNonWs() == close) {
+      ++position;
+    } else {
+      for (;;) {
+        if (c == '{') {
+          if (peekNonWs() != '"') {
+            throw std::runtime_error("Unable to parse");
+          }
+
+          parseString();
+          if (peekNonWs() != ':') {
+            throw std::runtime_error("Unable to parse");
+          }
+
+          ++position;
+        }
+
+        parseValue(depth + 1);
+        ++tokens[index].count;
+
+        char next = peekNonWs();
+        ++position;
+        if (next == close) {
+          break;
+        }
+
+        if (next != ',') {
+          throw std::runtime_error("Unable to parse");
+        }
+      }
+    }
+
+    tokens[index].size = position - tokens[index].offset;
+    tokens[index].end = tokens.size();
+  } else if (c == '"') {
+    parseString();
+  } else if (c == '-' || (c >= '0' && c <= '9')) {
+    parseNumber();
+  } else if (c == 't') {
+    parseLiteral("true", TOKEN_TRUE);
+  } else if (c == 'f') {
+    parseLiteral("false", TOKEN_FALSE);
+  } else if (c == 'n') {
+    parseLiteral("null", TOKEN_NULL);
+  } else {
+    throw std::runtime_error("Unable to parse");
+  }
+}
+
+void JsonInputBufferSerializer::parseString() {
+  // escape sequences are kept as is, same as Common::JsonValue does
+  size_t begin = ++position;
+  while (position < size && data[position] != '"') {
+    position += data[position] == '\\' ? 2 : 1;
+  }
+
+  if (position >= size) {
+    throw std::runtime_error("Unable to parse");
+  }
+
+  tokens.push_back({ TOKEN_STRING, begin, position - begin, 0, tokens.size() + 1 });
+  ++position;
+}
+
+void JsonInputBufferSerializer::parseNumber() {
+  size_t begin = position++;
+  while (position < size) {
+    char c = data[position];
+    if ((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') {
+      ++position;
+    } else {
+      break;
+    }
+  }
+
+  tokens.push_back({ TOKEN_NUMBER, begin, position - begin, 0, tokens.size() + 1 });
+}
+
+void JsonInputBufferSerializer::parseLiteral(const char* literal, TokenType type) {
+  size_t length = strlen(literal);
+  if (size - position < length || memcmp(data + position, literal, length) != 0) {
+    throw std::runtime_error("Unable to parse");
+  }
+
+  tokens.push_back({ type, position, length, 0, tokens.size() + 1 });
+  position += length;
+}
+
+char JsonInputBufferSerializer::peekNonWs() {
+  while (position < size && isWhitespace(data[position])) {
+    ++position;
+  }
+
+  if (position >= size) {
+    throw std::runtime_error("Unable to parse");
+  }
+
+  return data[position];
+}
+
+bool JsonInputBufferSerializer::findValue(Common::StringView name, size_t& index) {
+  assert(!chain.empty());
+  Scope& scope = chain.back();
+  const Token& parent = tokens[scope.token];
+
+  if (parent.type == TOKEN_ARRAY) {
+    if (scope.cursor >= parent.end) {
+      throw std::runtime_error("Unable to parse: array index is out of range");
+    }
+
+    index = scope.cursor;
+    scope.cursor = tokens[index].end;
+    return true;
+  }
+
+  for (size_t key = scope.token + 1; key < parent.end; key = tokens[key + 1].end) {
+    if (tokens[key].size == name.getSize() && memcmp(data + tokens[key].offset, name.getData(), name.getSize()) == 0) {
+      index = key + 1;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+const JsonInputBufferSerializer::Token& JsonInputBufferSerializer::expectToken(size_t index, TokenType type) const {
+  static const char* typeNames[] = { "OBJECT", "ARRAY", "STRING", "INTEGER", "BOOL", "BOOL", "NIL" };
+
+  if (tokens[index].type != type) {
+    throw std::runtime_error(std::string("JsonValue type is not ") + typeNames[type]);
+  }
+
+  return tokens[index];
+}
+
+int64_t JsonInputBufferSerializer::readInteger(size_t index) const {
+  const Token& token = expectToken(index, TOKEN_NUMBER);
+  const char* text = data + token.offset;
+  bool negative = text[0] == '-';
+  size_t i = negative ? 1 : 0;
+  if (i == token.size) {
+    throw std::runtime_error("Unable to parse");
+  }
+
+  uint64_t value = 0;
+  for (; i < token.size; ++i) {
+    if (text[i] < '0' || text[i] > '9') {
+      throw std::runtime_error("JsonValue type is not INTEGER");
+    }
+
+    value = value * 10 + static_cast<uint64_t>(text[i] - '0');
+  }
+
+  return negative ? static_cast<int64_t>(0 - value) : static_cast<int64_t>(value);
+}
+
+void JsonInputBufferSerializer::readHex(const Token& token, void* value) const {
+  if ((token.size & 1) != 0) {
+    throw std::runtime_error("fromHex: invalid string size");
+  }
+
+  const char* text = data + token.offset;
+  uint8_t* bytes = static_cast<uint8_t*>(value);
+  for (size_t i = 0; i < token.size >> 1; ++i) {
+    bytes[i] = Common::fromHex(text[i << 1]) << 4 | Common::fromHex(text[(i << 1) + 1]);
+  }
+}
@@ -0,0 +1,102 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <vector>
+#include "ISerializer.h"
+
+namespace CryptoNote {
+
+// Reads JSON in place from a contiguous buffer that must outlive the serializer.
+// The constructor makes a single pass that records a flat index of value spans;
+// strings, numbers and hex blobs are decoded straight from the buffer when the
+// serialize() functions ask for them, no Common::JsonValue tree is built.
+// Accepts the same documents as JsonInputValueSerializer.
+class JsonInputBufferSerializer : public ISerializer {
+public:
+  JsonInputBufferSerializer(Common::StringView json);
+  virtual ~JsonInputBufferSerializer();
+
+  SerializerType type() const override;
+
+  virtual bool beginObject(Common::StringView name) override;
+  virtual void endObject() override;
+
+  virtual bool beginArray(size_t& size, Common::StringView name) override;
+  virtual void endArray() override;
+
+  virtual bool operator()(uint8_t& value, Common::StringView name) override;
+  virtual bool operator()(int16_t& value, Common::StringView name) override;
+  virtual bool operator()(uint16_t& value, Common::StringView name) override;
+  virtual bool operator()(int32_t& value, Common::StringView name) override;
+  virtual bool operator()(uint32_t& value, Common::StringView name) override;
+  virtual bool operator()(int64_t& value, Common::StringView name) override;
+  virtual bool operator()(uint64_t& value, Common::StringView name) override;
+  virtual bool operator()(double& value, Common::StringView name) override;
+  virtual bool operator()(bool& value, Common::StringView name) override;
+  virtual bool operator()(std::string& value, Common::StringView name) override;
+  virtual bool binary(void* value, size_t size, Common::StringView name) override;
+  virtual bool binary(std::string& value, Common::StringView name) override;
+
+  template<typename T>
+  bool operator()(T& value, Common::StringView name) {
+    return ISerializer::operator()(value, name);
+  }
+
+private:
+  enum TokenType : uint8_t {
+    TOKEN_OBJECT,
+    TOKEN_ARRAY,
+    TOKEN_STRING,
+    TOKEN_NUMBER,
+    TOKEN_TRUE,
+    TOKEN_FALSE,
+    TOKEN_NULL
+  };
+
+  struct Token {
+    TokenType type;
+    size_t offset; // span in the buffer, strings without quotes
+    size_t size;
+    size_t count; // members or elements of a container
+    size_t end; // index of the token following this value and its children
+  };
+
+  struct Scope {
+    size_t token;
+    size_t cursor; // next element of an array
+  };
+
+  const char* data;
+  size_t size;
+  size_t position;
+  std::vector<Token> tokens;
+  std::vector<Scope> chain;
+
+  void parseValue(size_t depth);
+  void parseString();
+  void parseNumber();
+  void parseLiteral(const char* literal, TokenType type);
+  char peekNonWs();
+
+  bool findValue(Common::StringView name, size_t& index);
+  const Token& expectToken(size_t index, TokenType type) const;
+  int64_t readInteger(size_t index) const;
+  void readHex(const Token& token, void* value) const;
+
+  template <typename T>
+  bool getNumber(Common::StringView name, T& v) {
+    size_t index;
+    if (!findValue(name, index)) {
+      return false;
+    }
+
+    v = static_cast<T>(readInteger(index));
+    return true;
+  }
+};
+
+}
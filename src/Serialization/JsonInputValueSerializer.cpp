@@ -47,9 +47,9 @@ bool JsonInputValueSerializer::beginObject(Common::StringView name) {
     return true;
   }
 
-  if (parent->contains(std::string(name))) {
-    const JsonValue& v = (*parent)(std::string(name));
-    chain.push_back(&v);
+  const JsonValue* v = findMember(*parent, name);
+  if (v != nullptr) {
+    chain.push_back(v);
     return true;
   }
 
@@ -62,13 +62,10 @@ void JsonInputValueSerializer::endObject() {
 }
 
 bool JsonInputValueSerializer::beginArray(size_t& size, Common::StringView name) {
-  const JsonValue* parent = chain.back();
-  std::string strName(name);
-
-  if (parent->contains(strName)) {
-    const JsonValue& arr = (*parent)(strName);
-    size = arr.size();
-    chain.push_back(&arr);
+  const JsonValue* arr = findMember(*chain.back(), name);
+  if (arr != nullptr) {
+    size = arr->size();
+    chain.push_back(arr);
     idxs.push_back(0);
     return true;
   }
@@ -163,6 +160,13 @@ const JsonValue* JsonInputValueSerializer::getValue(Common::StringView name) {
     return &val[idxs.back()++];
   }
 
-  std::string strName(name);
-  return val.contains(strName) ? &val(strName) : nullptr;
+  return findMember(val, name);
+}
+
+const JsonValue* JsonInputValueSerializer::findMember(const JsonValue& object, Common::StringView name) {
+  // the key buffer keeps its capacity, so lookups don't allocate once it has seen the longest name
+  keyBuffer.assign(name.getData(), name.getSize());
+  const JsonValue::Object& members = object.getObject();
+  auto it = members.find(keyBuffer);
+  return it != members.end() ? &it->second : nullptr;
 }
@@ -45,12 +45,16 @@ public:
     return ISerializer::operator()(value, name);
   }
 
+protected:
+  const Common::JsonValue* getValue(Common::StringView name);
+
 private:
   Common::JsonValue value;
   std::vector<const Common::JsonValue*> chain;
   std::vector<size_t> idxs;
+  std::string keyBuffer;
 
-  const Common::JsonValue* getValue(Common::StringView name);
+  const Common::JsonValue* findMember(const Common::JsonValue& object, Common::StringView name);
 
   template <typename T>
   bool getNumber(Common::StringView name, T& v) {
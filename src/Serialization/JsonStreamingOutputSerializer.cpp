@@ -0,0 +1,192 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "JsonStreamingOutputSerializer.h"
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <sstream>
+#include "Common/StreamTools.h"
+
+using namespace CryptoNote;
+
+JsonStreamingOutputSerializer::JsonStreamingOutputSerializer(Common::IOutputStream& target) : target(target) {
+  chain.push_back({ false, true });
+  write('{');
+}
+
+JsonStreamingOutputSerializer::~JsonStreamingOutputSerializer() {
+}
+
+void JsonStreamingOutputSerializer::close() {
+  assert(chain.size() == 1);
+  chain.pop_back();
+  write('}');
+}
+
+ISerializer::SerializerType JsonStreamingOutputSerializer::type() const {
+  return ISerializer::OUTPUT;
+}
+
+bool JsonStreamingOutputSerializer::beginObject(Common::StringView name) {
+  beginValue(name);
+  write('{');
+  chain.push_back({ false, true });
+  return true;
+}
+
+void JsonStreamingOutputSerializer::endObject() {
+  assert(chain.size() > 1 && !chain.back().isArray);
+  chain.pop_back();
+  write('}');
+}
+
+bool JsonStreamingOutputSerializer::beginArray(size_t& size, Common::StringView name) {
+  beginValue(name);
+  write('[');
+  chain.push_back({ true, true });
+  return true;
+}
+
+void JsonStreamingOutputSerializer::endArray() {
+  assert(chain.size() > 1 && chain.back().isArray);
+  chain.pop_back();
+  write(']');
+}
+
+bool JsonStreamingOutputSerializer::operator()(uint64_t& value, Common::StringView name) {
+  int64_t v = static_cast<int64_t>(value);
+  return operator()(v, name);
+}
+
+bool JsonStreamingOutputSerializer::operator()(uint16_t& value, Common::StringView name) {
+  uint64_t v = static_cast<uint64_t>(value);
+  return operator()(v, name);
+}
+
+bool JsonStreamingOutputSerializer::operator()(int16_t& value, Common::StringView name) {
+  int64_t v = static_cast<int64_t>(value);
+  return operator()(v, name);
+}
+
+bool JsonStreamingOutputSerializer::operator()(uint32_t& value, Common::StringView name) {
+  uint64_t v = static_cast<uint64_t>(value);
+  return operator()(v, name);
+}
+
+bool JsonStreamingOutputSerializer::operator()(int32_t& value, Common::StringView name) {
+  int64_t v = static_cast<int64_t>(value);
+  return operator()(v, name);
+}
+
+bool JsonStreamingOutputSerializer::operator()(int64_t& value, Common::StringView name) {
+  beginValue(name);
+
+  char buffer[24];
+  char* end = buffer + sizeof(buffer);
+  char* begin = end;
+  uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+  do {
+    *--begin = static_cast<char>('0' + magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude != 0);
+
+  if (value < 0) {
+    *--begin = '-';
+  }
+
+  write(begin, end - begin);
+  return true;
+}
+
+bool JsonStreamingOutputSerializer::operator()(double& value, Common::StringView name) {
+  beginValue(name);
+
+  // same formatting as Common::JsonValue
+  std::ostringstream stream;
+  stream << std::fixed << std::setprecision(11) << value;
+  std::string text = stream.str();
+  while (text.size() > 1 && text[text.size() - 2] != '.' && text[text.size() - 1] == '0') {
+    text.resize(text.size() - 1);
+  }
+
+  write(text.data(), text.size());
+  return true;
+}
+
+bool JsonStreamingOutputSerializer::operator()(std::string& value, Common::StringView name) {
+  beginValue(name);
+  write('"');
+  write(value.data(), value.size());
+  write('"');
+  return true;
+}
+
+bool JsonStreamingOutputSerializer::operator()(uint8_t& value, Common::StringView name) {
+  int64_t v = static_cast<int64_t>(value);
+  return operator()(v, name);
+}
+
+bool JsonStreamingOutputSerializer::operator()(bool& value, Common::StringView name) {
+  beginValue(name);
+  if (value) {
+    write("true", 4);
+  } else {
+    write("false", 5);
+  }
+
+  return true;
+}
+
+bool JsonStreamingOutputSerializer::binary(void* value, size_t size, Common::StringView name) {
+  static const char hexDigits[] = "0123456789abcdef";
+
+  beginValue(name);
+  write('"');
+
+  const uint8_t* data = static_cast<const uint8_t*>(value);
+  char buffer[256];
+  while (size > 0) {
+    size_t chunkSize = std::min(size, sizeof(buffer) / 2);
+    for (size_t i = 0; i < chunkSize; ++i) {
+      buffer[i * 2] = hexDigits[data[i] >> 4];
+      buffer[i * 2 + 1] = hexDigits[data[i] & 15];
+    }
+
+    write(buffer, chunkSize * 2);
+    data += chunkSize;
+    size -= chunkSize;
+  }
+
+  write('"');
+  return true;
+}
+
+bool JsonStreamingOutputSerializer::binary(std::string& value, Common::StringView name) {
+  return binary(const_cast<char*>(value.data()), value.size(), name);
+}
+
+void JsonStreamingOutputSerializer::beginValue(Common::StringView name) {
+  assert(!chain.empty());
+  Scope& scope = chain.back();
+  if (!scope.isEmpty) {
+    write(',');
+  }
+
+  scope.isEmpty = false;
+  if (!scope.isArray) {
+    write('"');
+    write(name.getData(), name.getSize());
+    write("\":", 2);
+  }
+}
+
+void JsonStreamingOutputSerializer::write(const char* data, size_t size) {
+  Common::write(target, data, size);
+}
+
+void JsonStreamingOutputSerializer::write(char c) {
+  Common::write(target, &c, 1);
+}
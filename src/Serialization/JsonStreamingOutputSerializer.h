@@ -0,0 +1,66 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <vector>
+#include <Common/IOutputStream.h>
+#include "ISerializer.h"
+
+namespace CryptoNote {
+
+// Writes JSON straight into the target stream as values are serialized, without
+// building a Common::JsonValue tree first. The output matches
+// JsonOutputStreamSerializer::getValue().toString(), except that object members
+// keep their serialization order instead of being sorted by name.
+class JsonStreamingOutputSerializer : public ISerializer {
+public:
+  JsonStreamingOutputSerializer(Common::IOutputStream& target);
+  virtual ~JsonStreamingOutputSerializer();
+
+  // Closes the root object, must be called once serialization is complete.
+  void close();
+
+  SerializerType type() const override;
+
+  virtual bool beginObject(Common::StringView name) override;
+  virtual void endObject() override;
+
+  virtual bool beginArray(size_t& size, Common::StringView name) override;
+  virtual void endArray() override;
+
+  virtual bool operator()(uint8_t& value, Common::StringView name) override;
+  virtual bool operator()(int16_t& value, Common::StringView name) override;
+  virtual bool operator()(uint16_t& value, Common::StringView name) override;
+  virtual bool operator()(int32_t& value, Common::StringView name) override;
+  virtual bool operator()(uint32_t& value, Common::StringView name) override;
+  virtual bool operator()(int64_t& value, Common::StringView name) override;
+  virtual bool operator()(uint64_t& value, Common::StringView name) override;
+  virtual bool operator()(double& value, Common::StringView name) override;
+  virtual bool operator()(bool& value, Common::StringView name) override;
+  virtual bool operator()(std::string& value, Common::StringView name) override;
+  virtual bool binary(void* value, size_t size, Common::StringView name) override;
+  virtual bool binary(std::string& value, Common::StringView name) override;
+
+  template<typename T>
+  bool operator()(T& value, Common::StringView name) {
+    return ISerializer::operator()(value, name);
+  }
+
+private:
+  struct Scope {
+    bool isArray;
+    bool isEmpty;
+  };
+
+  void beginValue(Common::StringView name);
+  void write(const char* data, size_t size);
+  void write(char c);
+
+  Common::IOutputStream& target;
+  std::vector<Scope> chain;
+};
+
+}
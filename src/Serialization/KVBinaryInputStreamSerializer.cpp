@@ -19,6 +19,8 @@ using namespace CryptoNote;
 
 namespace {
 
+const size_t MAX_ARRAY_RESERVE = 16 * 1024;
+
 template <typename T>
 T readPod(Common::IInputStream& s) {
   T v;
@@ -39,34 +41,21 @@ JsonValue readIntegerJson(Common::IInputStream& s) {
 }
 
 size_t readVarint(Common::IInputStream& s) {
-  uint8_t b = read<uint8_t>(s);
-  uint8_t size_mask = b & PORTABLE_RAW_SIZE_MARK_MASK;
-  size_t bytesLeft = 0;
+  uint8_t bytes[8] = {};
+  read(s, bytes, 1);
 
-  switch (size_mask){
-  case PORTABLE_RAW_SIZE_MARK_BYTE:
-    bytesLeft = 0;
-    break;
-  case PORTABLE_RAW_SIZE_MARK_WORD:
-    bytesLeft = 1;
-    break;
-  case PORTABLE_RAW_SIZE_MARK_DWORD:
-    bytesLeft = 3;
-    break;
-  case PORTABLE_RAW_SIZE_MARK_INT64:
-    bytesLeft = 7;
-    break;
+  // the size mark in the low two bits gives the length of the little endian value: 1, 2, 4 or 8 bytes
+  size_t size = size_t(1) << (bytes[0] & PORTABLE_RAW_SIZE_MARK_MASK);
+  if (size > 1) {
+    read(s, bytes + 1, size - 1);
   }
 
-  size_t value = b;
-
-  for (size_t i = 1; i <= bytesLeft; ++i) {
-    size_t n = read<uint8_t>(s);
-    value |= n << (i * 8);
+  uint64_t value = 0;
+  for (size_t i = 0; i < sizeof(bytes); ++i) {
+    value |= static_cast<uint64_t>(bytes[i]) << (i * 8);
   }
 
-  value >>= 2;
-  return value;
+  return static_cast<size_t>(value >> 2);
 }
 
 std::string readString(Common::IInputStream& s) {
@@ -149,6 +138,8 @@ JsonValue loadEntry(Common::IInputStream& stream) {
 JsonValue loadArray(Common::IInputStream& stream, uint8_t itemType) {
   JsonValue arr(JsonValue::ARRAY);
   size_t count = readVarint(stream);
+  // the count comes from the peer, so only trust it that far before the items are actually there
+  arr.getArray().reserve(std::min<size_t>(count, MAX_ARRAY_RESERVE));
 
   while (count--) {
     arr.pushBack(loadValue(stream, itemType));
@@ -180,12 +171,12 @@ KVBinaryInputStreamSerializer::KVBinaryInputStreamSerializer(Common::IInputStrea
 }
 
 bool KVBinaryInputStreamSerializer::binary(void* value, size_t size, Common::StringView name) {
-  std::string str;
-
-  if (!(*this)(str, name)) {
+  const JsonValue* ptr = getValue(name);
+  if (ptr == nullptr) {
     return false;
   }
 
+  const std::string& str = ptr->getString();
   if (str.size() != size) {
     throw std::runtime_error("Binary block size mismatch");
   }
@@ -198,3 +189,21 @@ bool KVBinaryInputStreamSerializer::binary(std::string& value, Common::StringVie
   return (*this)(value, name); // load as string
 }
 
+bool KVBinaryInputStreamSerializer::binaryArray(size_t itemSize, const std::function<void*(size_t)>& allocate, Common::StringView name) {
+  const JsonValue* ptr = getValue(name);
+  if (ptr == nullptr) {
+    return false;
+  }
+
+  const std::string& str = ptr->getString();
+  if (str.size() % itemSize != 0) {
+    throw std::runtime_error("Binary block size mismatch");
+  }
+
+  void* items = allocate(str.size() / itemSize);
+  if (!str.empty()) {
+    memcpy(items, str.data(), str.size());
+  }
+
+  return true;
+}
@@ -19,6 +19,7 @@ public:
 
   virtual bool binary(void* value, size_t size, Common::StringView name) override;
   virtual bool binary(std::string& value, Common::StringView name) override;
+  virtual bool binaryArray(size_t itemSize, const std::function<void*(size_t)>& allocate, Common::StringView name) override;
 };
 
 }
@@ -26,14 +26,15 @@ namespace CryptoNote {
 template<typename T>
 typename std::enable_if<std::is_pod<T>::value>::type
 serializeAsBinary(std::vector<T>& value, Common::StringView name, CryptoNote::ISerializer& serializer) {
-  std::string blob;
   if (serializer.type() == ISerializer::INPUT) {
-    serializer.binary(blob, name);
-    value.resize(blob.size() / sizeof(T));
-    if (blob.size()) {
-      memcpy(&value[0], blob.data(), blob.size());
+    if (!serializer.binaryArray(sizeof(T), [&value](size_t count) -> void* {
+      value.resize(count);
+      return value.data();
+    }, name)) {
+      value.clear();
     }
   } else {
+    std::string blob;
     if (!value.empty()) {
       blob.assign(reinterpret_cast<const char*>(&value[0]), value.size() * sizeof(T));
     }
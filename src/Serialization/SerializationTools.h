@@ -11,8 +11,10 @@
 #include <vector>
 #include <Common/MemoryInputStream.h>
 #include <Common/StringOutputStream.h>
+#include "JsonInputBufferSerializer.h"
 #include "JsonInputStreamSerializer.h"
 #include "JsonOutputStreamSerializer.h"
+#include "JsonStreamingOutputSerializer.h"
 #include "KVBinaryInputStreamSerializer.h"
 #include "KVBinaryOutputStreamSerializer.h"
 
@@ -84,11 +86,38 @@ void loadFromJsonValue(std::list<T>& v, const Common::JsonValue& js) {
 
 template <typename T>
 std::string storeToJson(const T& v) {
-  return storeToJsonValue(v).toString();
+  std::string json;
+  Common::StringOutputStream stream(json);
+  JsonStreamingOutputSerializer s(stream);
+  serialize(const_cast<T&>(v), s);
+  s.close();
+  return json;
 }
 
+template <typename T>
+std::string storeToJson(const std::vector<T>& v) { return storeToJsonValue(v).toString(); }
+
+template <typename T>
+std::string storeToJson(const std::list<T>& v) { return storeToJsonValue(v).toString(); }
+
+inline std::string storeToJson(const std::string& v) { return storeToJsonValue(v).toString(); }
+
 template <typename T>
 bool loadFromJson(T& v, const std::string& buf) {
+  try {
+    if (buf.empty()) {
+      return true;
+    }
+    JsonInputBufferSerializer s(buf);
+    serialize(v, s);
+  } catch (std::exception&) {
+    return false;
+  }
+  return true;
+}
+
+template <typename T>
+bool loadFromJsonViaValue(T& v, const std::string& buf) {
   try {
     if (buf.empty()) {
       return true;
@@ -101,6 +130,12 @@ bool loadFromJson(T& v, const std::string& buf) {
   return true;
 }
 
+template <typename T>
+bool loadFromJson(std::vector<T>& v, const std::string& buf) { return loadFromJsonViaValue(v, buf); }
+
+template <typename T>
+bool loadFromJson(std::list<T>& v, const std::string& buf) { return loadFromJsonViaValue(v, buf); }
+
 template <typename T>
 std::string storeToBinaryKeyValue(const T& v) {
   KVBinaryOutputStreamSerializer s;
@@ -0,0 +1,83 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2014-2017 XDN developers
+// Copyright (c) 2016-2017 BXC developers
+// Copyright (c) 2017 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "DispatcherPool.h"
+#include <cassert>
+#include <stdexcept>
+
+namespace System {
+
+DispatcherPool::DispatcherPool(size_t size) : nextWorker(0) {
+  if (size == 0) {
+    throw std::invalid_argument("DispatcherPool::DispatcherPool, pool size must be positive");
+  }
+
+  try {
+    for (size_t i = 0; i < size; ++i) {
+      std::unique_ptr<Worker> worker(new Worker{std::thread(), nullptr, nullptr});
+      std::promise<void> started;
+      std::future<void> startedFuture = started.get_future();
+      Worker& workerRef = *worker;
+      worker->thread = std::thread([this, &workerRef, &started] { workerProcedure(workerRef, started); });
+      workers.push_back(std::move(worker));
+      startedFuture.get();
+    }
+  } catch (std::exception&) {
+    stop();
+    throw;
+  }
+}
+
+DispatcherPool::~DispatcherPool() {
+  stop();
+}
+
+size_t DispatcherPool::size() const {
+  return workers.size();
+}
+
+Dispatcher& DispatcherPool::getDispatcher(size_t index) {
+  assert(index < workers.size());
+  return *workers[index]->dispatcher;
+}
+
+Dispatcher& DispatcherPool::nextDispatcher() {
+  return getDispatcher(nextWorker++ % workers.size());
+}
+
+// Dispatcher is created and destroyed on its own thread, as the platform implementations require.
+void DispatcherPool::workerProcedure(Worker& worker, std::promise<void>& started) {
+  try {
+    Dispatcher dispatcher;
+    Event stopEvent(dispatcher);
+    worker.dispatcher = &dispatcher;
+    worker.stopEvent = &stopEvent;
+    started.set_value();
+    stopEvent.wait();
+  } catch (std::exception&) {
+    if (worker.dispatcher == nullptr) {
+      started.set_exception(std::current_exception());
+    }
+  }
+}
+
+void DispatcherPool::stop() {
+  for (auto& worker : workers) {
+    if (worker->dispatcher != nullptr) {
+      Event* stopEvent = worker->stopEvent;
+      worker->dispatcher->remoteSpawn([stopEvent] { stopEvent->set(); });
+    }
+
+    if (worker->thread.joinable()) {
+      worker->thread.join();
+    }
+  }
+
+  workers.clear();
+}
+
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2014-2017 XDN developers
+// Copyright (c) 2016-2017 BXC developers
+// Copyright (c) 2017 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <System/Dispatcher.h>
+#include <System/Event.h>
+#include <System/InterruptedException.h>
+
+namespace System {
+
+// Owns a set of dispatchers, each running on a thread of its own until the pool is destroyed. Work is handed to them
+// with invoke; the caller's own contexts, such as network connections, stay on the caller's dispatcher.
+class DispatcherPool {
+public:
+  explicit DispatcherPool(size_t size);
+  DispatcherPool(const DispatcherPool&) = delete;
+  ~DispatcherPool();
+  DispatcherPool& operator=(const DispatcherPool&) = delete;
+
+  size_t size() const;
+  Dispatcher& getDispatcher(size_t index);
+
+  // Picks dispatchers round-robin, may be called from any thread.
+  Dispatcher& nextDispatcher();
+
+  // Run operation on target dispatcher, run other tasks on caller dispatcher until it completes, then return
+  // operation's result, or rethrow exception. Interruption is deferred until the operation completes.
+  template<class T> static T invoke(Dispatcher& caller, Dispatcher& target, std::function<T()>&& operation);
+
+private:
+  struct Worker {
+    std::thread thread;
+    Dispatcher* dispatcher;
+    Event* stopEvent;
+  };
+
+  void workerProcedure(Worker& worker, std::promise<void>& started);
+  void stop();
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::atomic<size_t> nextWorker;
+};
+
+template<class T> T DispatcherPool::invoke(Dispatcher& caller, Dispatcher& target, std::function<T()>&& operation) {
+  Event completed(caller);
+  std::packaged_task<T()> task(std::move(operation));
+  std::future<T> result = task.get_future();
+  Event* completedEvent = &completed;
+  target.remoteSpawn([&task, &caller, completedEvent] {
+    task();
+    caller.remoteSpawn([completedEvent] { completedEvent->set(); });
+  });
+
+  bool interrupted = false;
+  while (!completed.get()) {
+    try {
+      completed.wait();
+    } catch (InterruptedException&) {
+      interrupted = true;
+    }
+  }
+
+  if (interrupted) {
+    caller.interrupt();
+  }
+
+  return result.get();
+}
+
+}
@@ -6,6 +6,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "TcpStream.h"
+#include <algorithm>
 #include <System/TcpConnection.h>
 
 namespace System {
@@ -39,6 +40,34 @@ int TcpStreambuf::sync() {
   return dumpBuffer(true) ? 0 : -1;
 }
 
+// Writes at least a buffer long skip the copy and go out together with whatever is pending.
+std::streamsize TcpStreambuf::xsputn(const char* s, std::streamsize n) {
+  if (static_cast<size_t>(n) < writeBuf.max_size()) {
+    return std::streambuf::xsputn(s, n);
+  }
+
+  try {
+    TcpConnection::Buffer buffers[2] = {
+      { &writeBuf.front(), static_cast<size_t>(pptr() - pbase()) },
+      { reinterpret_cast<const uint8_t*>(s), static_cast<size_t>(n) }
+    };
+
+    while (buffers[0].size + buffers[1].size != 0) {
+      size_t transferred = connection.writeBuffers(buffers, 2);
+      size_t pending = std::min(transferred, buffers[0].size);
+      buffers[0].data += pending;
+      buffers[0].size -= pending;
+      buffers[1].data += transferred - pending;
+      buffers[1].size -= transferred - pending;
+    }
+  } catch (std::exception&) {
+    return 0;
+  }
+
+  setp(reinterpret_cast<char*>(&writeBuf.front()), reinterpret_cast<char *>(&writeBuf.front() + writeBuf.max_size()));
+  return n;
+}
+
 std::streambuf::int_type TcpStreambuf::underflow() {
   if (gptr() < egptr()) {
     return traits_type::to_int_type(*gptr());
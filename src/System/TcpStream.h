@@ -29,6 +29,7 @@ private:
 
   std::streambuf::int_type overflow(std::streambuf::int_type ch) override;
   int sync() override;
+  std::streamsize xsputn(const char* s, std::streamsize n) override;
   std::streambuf::int_type underflow() override;
   bool dumpBuffer(bool finalize);
 };
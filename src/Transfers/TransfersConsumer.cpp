@@ -12,7 +12,7 @@
 
 #include "CommonTypes.h"
 #include "Common/StringTools.h"
-#include "Common/BlockingQueue.h"
+#include "Common/MpmcQueue.h"
 #include "CryptoNoteCore/CryptoNoteFormatUtils.h"
 #include "CryptoNoteCore/TransactionApi.h"
 #include "CryptoNoteCore/TransactionExtra.h"
@@ -215,7 +215,7 @@ bool TransfersConsumer::onNewBlocks(const CompleteBlock* blocks, uint32_t startH
     workers = 2;
   }
 
-  BlockingQueue<Tx> inputQueue(workers * 2);
+  MpmcQueue<Tx> inputQueue(workers * 2);
 
   std::atomic<bool> stopProcessing(false);
 
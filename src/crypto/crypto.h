@@ -109,20 +109,22 @@ struct EllipticCurveScalar {
   public:
     typedef T result_type;
 
-#ifdef __clang__
-    constexpr static T min() {
+    // std::uniform_int_distribution needs these as constant expressions; only compilers without constexpr, such as
+    // MSVC before 2015, get plain functions. The parentheses keep the windows.h min and max macros out.
+#if defined(_MSC_VER) && _MSC_VER < 1900
+    static T(min)() {
       return (std::numeric_limits<T>::min)();
     }
 
-    constexpr static T max() {
+    static T(max)() {
       return (std::numeric_limits<T>::max)();
     }
 #else
-    static T(min)() {
+    constexpr static T(min)() {
       return (std::numeric_limits<T>::min)();
     }
 
-    static T(max)() {
+    constexpr static T(max)() {
       return (std::numeric_limits<T>::max)();
     }
 #endif
@@ -0,0 +1,15 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstddef>
+
+namespace AllocationTests {
+
+// Number of calls to the global operator new so far, by any thread of this binary.
+size_t heapAllocations();
+
+}
@@ -0,0 +1,30 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+#include "Common/MonotonicArena.h"
+
+#include "HeapAllocations.h"
+
+using namespace Common;
+
+TEST(MonotonicArena, warmArenaDoesNotTouchTheHeap) {
+  MonotonicArena arena(64);
+  for (size_t pass = 0; pass < 2; ++pass) {
+    size_t before = AllocationTests::heapAllocations();
+    {
+      MonotonicArena::Scope scope(arena);
+      for (size_t i = 0; i < 100; ++i) {
+        ArenaVector<uint64_t> values{ ArenaAllocator<uint64_t>(arena) };
+        values.push_back(i);
+        values.push_back(i);
+      }
+    }
+
+    if (pass != 0) {
+      ASSERT_EQ(before, AllocationTests::heapAllocations());
+    }
+  }
+}
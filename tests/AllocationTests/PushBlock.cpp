@@ -0,0 +1,149 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <list>
+
+#include <boost/filesystem.hpp>
+
+#include "CryptoNoteCore/Account.h"
+#include "CryptoNoteCore/Blockchain.h"
+#include "CryptoNoteCore/CryptoNoteFormatUtils.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/ITimeProvider.h"
+#include "CryptoNoteCore/TransactionExtra.h"
+#include "CryptoNoteCore/TransactionPool.h"
+#include "Logging/LoggerGroup.h"
+#include "TestGenerator/TestGenerator.h"
+
+#include "HeapAllocations.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+const uint64_t START_TIMESTAMP = 1338224400;
+const size_t MEASURED_BLOCKS = 8;
+// Coinbase transactions spent by each measured block.
+const size_t SPENT_COINBASES = 8;
+
+class PushBlockAllocations : public testing::Test {
+public:
+  PushBlockAllocations() :
+    currency(CurrencyBuilder(logger).currency()),
+    generator(currency),
+    pool(currency, blockchain, timeProvider, logger),
+    blockchain(currency, pool, logger),
+    dataFolder(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()) {
+    miner.generate();
+  }
+
+  void SetUp() override {
+    boost::filesystem::create_directories(dataFolder);
+    ASSERT_TRUE(pool.init(dataFolder.string()));
+    // The currency's own genesis block doesn't pass the reward check in this tree, so the chain is started from a
+    // generated one; init has opened the storage by the time it rejects the built-in genesis.
+    blockchain.init(dataFolder.string(), false);
+
+    Block genesis;
+    ASSERT_TRUE(generator.constructBlock(genesis, miner, START_TIMESTAMP));
+    ASSERT_TRUE(blockchain.resetAndSetGenesisBlock(genesis));
+    blocks.push_back(genesis);
+  }
+
+  void TearDown() override {
+    pool.deinit();
+    blockchain.deinit();
+    boost::filesystem::remove_all(dataFolder);
+  }
+
+  // Returns the heap allocations made by pushing the block.
+  size_t pushBlock(const std::list<Transaction>& transactions) {
+    for (const Transaction& transaction : transactions) {
+      tx_verification_context tvc = boost::value_initialized<tx_verification_context>();
+      EXPECT_TRUE(pool.add_tx(transaction, tvc, false, blockchain.getCurrentBlockchainHeight()));
+    }
+
+    generator.defaultMajorVersion = blocks.size() > currency.upgradeHeight(BLOCK_MAJOR_VERSION_2) ? BLOCK_MAJOR_VERSION_2 : BLOCK_MAJOR_VERSION_1;
+    Block block;
+    EXPECT_TRUE(generator.constructBlock(block, blocks.back(), miner, transactions));
+
+    block_verification_context bvc = boost::value_initialized<block_verification_context>();
+    size_t before = AllocationTests::heapAllocations();
+    blockchain.addNewBlock(block, bvc);
+    size_t allocations = AllocationTests::heapAllocations() - before;
+    EXPECT_TRUE(bvc.m_added_to_main_chain);
+    blocks.push_back(block);
+    return allocations;
+  }
+
+  // Sends every output of the coinbase transactions of the given blocks back to the miner, without mixins.
+  Transaction spendCoinbases(size_t firstBlock, size_t blockCount, size_t& inputCount) {
+    std::vector<TransactionSourceEntry> sources;
+    uint64_t amount = 0;
+    for (size_t i = firstBlock; i < firstBlock + blockCount; ++i) {
+      const Transaction& coinbase = blocks[i].baseTransaction;
+      std::vector<uint32_t> globalIndexes;
+      EXPECT_TRUE(blockchain.getTransactionOutputGlobalIndexes(getObjectHash(coinbase), globalIndexes));
+      for (size_t output = 0; output < coinbase.outputs.size(); ++output) {
+        TransactionSourceEntry source;
+        source.outputs.push_back(std::make_pair(globalIndexes[output], boost::get<KeyOutput>(coinbase.outputs[output].target).key));
+        source.realOutput = 0;
+        source.realTransactionPublicKey = getTransactionPublicKeyFromExtra(coinbase.extra);
+        source.realOutputIndexInTransaction = output;
+        source.amount = coinbase.outputs[output].amount;
+        sources.push_back(source);
+        amount += source.amount;
+      }
+    }
+
+    std::vector<TransactionDestinationEntry> destinations;
+    destinations.push_back(TransactionDestinationEntry(amount - currency.minimumFee(), miner.getAccountKeys().address));
+
+    Transaction transaction;
+    EXPECT_TRUE(constructTransaction(miner.getAccountKeys(), sources, destinations, std::vector<uint8_t>(), transaction, 0, logger));
+    inputCount += sources.size();
+    return transaction;
+  }
+
+  Logging::LoggerGroup logger;
+  Currency currency;
+  test_generator generator;
+  RealTimeProvider timeProvider;
+  tx_memory_pool pool;
+  Blockchain blockchain;
+  boost::filesystem::path dataFolder;
+  AccountBase miner;
+  std::vector<Block> blocks;
+};
+
+}
+
+// Reports what a block costs on the heap in pushBlock, compared with an empty block of the same chain so the cost
+// of checking and storing its inputs stands out.
+TEST_F(PushBlockAllocations, perBlockAndPerInput) {
+  while (blocks.size() < currency.minedMoneyUnlockWindow() + MEASURED_BLOCKS * SPENT_COINBASES) {
+    pushBlock(std::list<Transaction>());
+  }
+
+  size_t emptyAllocations = 0;
+  size_t spendingAllocations = 0;
+  size_t inputCount = 0;
+  for (size_t i = 0; i < MEASURED_BLOCKS; ++i) {
+    emptyAllocations += pushBlock(std::list<Transaction>());
+    std::list<Transaction> transactions;
+    transactions.push_back(spendCoinbases(1 + i * SPENT_COINBASES, SPENT_COINBASES, inputCount));
+    spendingAllocations += pushBlock(transactions);
+  }
+
+  size_t perEmptyBlock = emptyAllocations / MEASURED_BLOCKS;
+  size_t perSpendingBlock = spendingAllocations / MEASURED_BLOCKS;
+  double perInput = static_cast<double>(spendingAllocations - emptyAllocations) / inputCount;
+  std::cout << "heap allocations in pushBlock: " << perEmptyBlock << " per block with the coinbase only, " <<
+    perSpendingBlock << " per block spending " << inputCount / MEASURED_BLOCKS << " inputs, " << perInput << " per input" << std::endl;
+}
@@ -0,0 +1,88 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Common/JsonValue.h"
+#include "Serialization/JsonInputBufferSerializer.h"
+#include "Serialization/JsonInputValueSerializer.h"
+#include "Serialization/SerializationOverloads.h"
+#include "Serialization/SerializationTools.h"
+
+// Loading a sendTransaction-like request (many transfers plus a large hex blob)
+// through Common::JsonValue::fromString and JsonInputValueSerializer, or in place
+// through JsonInputBufferSerializer.
+template<size_t transfer_count, bool in_situ>
+class test_json_input
+{
+public:
+  static const size_t loop_count = 1000;
+
+  struct transfer
+  {
+    std::string address;
+    uint64_t amount;
+
+    void serialize(CryptoNote::ISerializer& s)
+    {
+      KV_MEMBER(address)
+      KV_MEMBER(amount)
+    }
+  };
+
+  struct request
+  {
+    std::vector<transfer> transfers;
+    uint64_t fee;
+    uint64_t unlock_time;
+    std::string extra;
+
+    void serialize(CryptoNote::ISerializer& s)
+    {
+      KV_MEMBER(transfers)
+      KV_MEMBER(fee)
+      KV_MEMBER(unlock_time)
+      s.binary(extra, "extra");
+    }
+  };
+
+  bool init()
+  {
+    request req;
+    for (size_t i = 0; i < transfer_count; ++i)
+    {
+      req.transfers.push_back({ std::string(98, 'X') + std::to_string(i), 1000000 + i });
+    }
+
+    req.fee = 100000;
+    req.unlock_time = 0;
+    req.extra.assign(8192, '\x5a');
+    m_body = CryptoNote::storeToJson(req);
+    return true;
+  }
+
+  bool test()
+  {
+    request req;
+    if (in_situ)
+    {
+      CryptoNote::JsonInputBufferSerializer s(m_body);
+      serialize(req, s);
+    }
+    else
+    {
+      CryptoNote::JsonInputValueSerializer s(Common::JsonValue::fromString(m_body));
+      serialize(req, s);
+    }
+
+    return req.transfers.size() == transfer_count;
+  }
+
+private:
+  std::string m_body;
+};
@@ -0,0 +1,105 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <System/Dispatcher.h>
+
+#include "CryptoNoteCore/Core.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteProtocol/CryptoNoteProtocolHandler.h"
+#include "Logging/LoggerGroup.h"
+#include "P2p/NetNode.h"
+#include "Rpc/HttpClient.h"
+#include "Rpc/RpcServer.h"
+
+// call_count getblockcount calls sent to a real RpcServer over loopback HTTP, either one request at a time or
+// as a single JSON-RPC batch, so both the round trips and the shared core lock of a batch are measured.
+template<size_t call_count, bool batched>
+class test_json_rpc_batch
+{
+public:
+  static const size_t loop_count = 1000;
+  static const uint16_t rpc_port = 38081;
+
+  ~test_json_rpc_batch()
+  {
+    if (m_rpc_server)
+    {
+      m_client.reset();
+      m_rpc_server->stop();
+    }
+  }
+
+  bool init()
+  {
+    m_currency.reset(new CryptoNote::Currency(CryptoNote::CurrencyBuilder(m_logger).currency()));
+    m_core.reset(new CryptoNote::core(*m_currency, nullptr, m_logger));
+    m_protocol.reset(new CryptoNote::CryptoNoteProtocolHandler(*m_currency, m_dispatcher, *m_core, nullptr, m_logger));
+    m_p2p.reset(new CryptoNote::NodeServer(m_dispatcher, *m_protocol, m_logger));
+    m_rpc_server.reset(new CryptoNote::RpcServer(m_dispatcher, m_logger, *m_core, *m_p2p, *m_protocol));
+    m_rpc_server->start("127.0.0.1", rpc_port);
+    m_client.reset(new CryptoNote::HttpClient(m_dispatcher, "127.0.0.1", rpc_port));
+
+    for (size_t i = 0; i < call_count; ++i)
+    {
+      m_bodies.push_back("{\"jsonrpc\":\"2.0\",\"id\":" + std::to_string(i) + ",\"method\":\"getblockcount\",\"params\":[]}");
+    }
+
+    m_batch_body = "[";
+    for (size_t i = 0; i < m_bodies.size(); ++i)
+    {
+      m_batch_body += (i == 0 ? "" : ",") + m_bodies[i];
+    }
+
+    m_batch_body += "]";
+    return true;
+  }
+
+  bool test()
+  {
+    size_t response_size = 0;
+
+    if (batched)
+    {
+      response_size = post(m_batch_body);
+    }
+    else
+    {
+      for (const auto& request_body : m_bodies)
+      {
+        response_size += post(request_body);
+      }
+    }
+
+    return response_size != 0;
+  }
+
+private:
+  size_t post(const std::string& body)
+  {
+    CryptoNote::HttpRequest request;
+    CryptoNote::HttpResponse response;
+    request.setUrl("/json_rpc");
+    request.setBody(body);
+    m_client->request(request, response);
+    return response.getStatus() == CryptoNote::HttpResponse::STATUS_200 ? response.getBody().size() : 0;
+  }
+
+  Logging::LoggerGroup m_logger;
+  System::Dispatcher m_dispatcher;
+  std::unique_ptr<CryptoNote::Currency> m_currency;
+  std::unique_ptr<CryptoNote::core> m_core;
+  std::unique_ptr<CryptoNote::CryptoNoteProtocolHandler> m_protocol;
+  std::unique_ptr<CryptoNote::NodeServer> m_p2p;
+  std::unique_ptr<CryptoNote::RpcServer> m_rpc_server;
+  std::unique_ptr<CryptoNote::HttpClient> m_client;
+  std::vector<std::string> m_bodies;
+  std::string m_batch_body;
+};
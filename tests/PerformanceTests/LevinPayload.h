@@ -0,0 +1,71 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <string>
+
+#include "CryptoNoteProtocol/CryptoNoteProtocolDefinitions.h"
+#include "Serialization/SerializationTools.h"
+
+// Loading the KV binary payloads that dominate synchronization: a NOTIFY_RESPONSE_CHAIN_ENTRY with
+// hash_count block ids, or a NOTIFY_RESPONSE_GET_OBJECTS with hash_count blocks of four transactions.
+template<size_t hash_count, bool objects>
+class test_levin_payload
+{
+public:
+  static const size_t loop_count = 100;
+
+  bool init()
+  {
+    if (objects)
+    {
+      CryptoNote::NOTIFY_RESPONSE_GET_OBJECTS::request response;
+      for (size_t i = 0; i < hash_count; ++i)
+      {
+        CryptoNote::block_complete_entry entry;
+        entry.block.assign(400, static_cast<char>(i));
+        entry.txs.assign(4, std::string(2000, static_cast<char>(i)));
+        response.blocks.push_back(std::move(entry));
+      }
+
+      response.missed_ids.resize(10);
+      response.current_blockchain_height = 100000;
+      m_payload = CryptoNote::storeToBinaryKeyValue(response);
+    }
+    else
+    {
+      CryptoNote::NOTIFY_RESPONSE_CHAIN_ENTRY::request response;
+      response.start_height = 100000;
+      response.total_height = 100000 + hash_count;
+      response.m_block_ids.resize(hash_count);
+      for (size_t i = 0; i < hash_count; ++i)
+      {
+        response.m_block_ids[i].data[0] = static_cast<uint8_t>(i);
+      }
+
+      m_payload = CryptoNote::storeToBinaryKeyValue(response);
+    }
+
+    return true;
+  }
+
+  bool test()
+  {
+    if (objects)
+    {
+      CryptoNote::NOTIFY_RESPONSE_GET_OBJECTS::request response;
+      return CryptoNote::loadFromBinaryKeyValue(response, m_payload) && response.blocks.size() == hash_count;
+    }
+    else
+    {
+      CryptoNote::NOTIFY_RESPONSE_CHAIN_ENTRY::request response;
+      return CryptoNote::loadFromBinaryKeyValue(response, m_payload) && response.m_block_ids.size() == hash_count;
+    }
+  }
+
+private:
+  std::string m_payload;
+};
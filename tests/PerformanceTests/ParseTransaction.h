@@ -0,0 +1,70 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include "Common/MemoryInputStream.h"
+#include "CryptoNoteConfig.h"
+#include "CryptoNoteCore/BinaryCodec.h"
+#include "CryptoNoteCore/CryptoNoteSerialization.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "Serialization/BinaryInputStreamSerializer.h"
+
+// Parsing a synthetic transaction blob (ring size 4, two outputs per input) through
+// the BinaryDecoder codec, or through BinaryInputStreamSerializer as before it.
+template<size_t input_count, bool codec>
+class test_parse_transaction
+{
+public:
+  static const size_t loop_count = 10000;
+
+  bool init()
+  {
+    CryptoNote::Transaction tx;
+    tx.version = CryptoNote::TRANSACTION_VERSION_1;
+    tx.unlockTime = 0;
+    for (size_t i = 0; i < input_count; ++i)
+    {
+      CryptoNote::KeyInput input;
+      input.amount = 1000000 + i;
+      input.outputIndexes = { 100000 + static_cast<uint32_t>(i), 5000, 300, 20 };
+      input.keyImage.data[0] = static_cast<uint8_t>(i);
+      tx.inputs.push_back(input);
+      tx.signatures.emplace_back(input.outputIndexes.size());
+
+      for (size_t j = 0; j < 2; ++j)
+      {
+        CryptoNote::KeyOutput target;
+        target.key.data[0] = static_cast<uint8_t>(j);
+        tx.outputs.push_back({ 500000 + j, target });
+      }
+    }
+
+    tx.extra.assign(33, 0x01);
+    m_blob = CryptoNote::toBinaryArray(tx);
+    return !m_blob.empty();
+  }
+
+  bool test()
+  {
+    CryptoNote::Transaction tx;
+    if (codec)
+    {
+      CryptoNote::BinaryDecoder decoder(m_blob.data(), m_blob.size());
+      CryptoNote::decode(decoder, tx);
+    }
+    else
+    {
+      Common::MemoryInputStream stream(m_blob.data(), m_blob.size());
+      CryptoNote::BinaryInputStreamSerializer serializer(stream);
+      CryptoNote::serialize(tx, serializer);
+    }
+
+    return tx.inputs.size() == input_count;
+  }
+
+private:
+  CryptoNote::BinaryArray m_blob;
+};
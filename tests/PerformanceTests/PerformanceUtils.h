@@ -6,6 +6,7 @@
 #pragma once
 
 #include <iostream>
+#include <thread>
 
 #include <boost/config.hpp>
 
@@ -35,6 +36,21 @@ void set_process_affinity(int core)
 #endif
 }
 
+// Lets a thread spawned by a multi-threaded test run on any core again despite set_process_affinity()
+void clear_thread_affinity()
+{
+#if defined(BOOST_HAS_PTHREADS) && !defined(__APPLE__) && !defined(BOOST_WINDOWS)
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  for (unsigned core = 0; core < std::thread::hardware_concurrency() && core < CPU_SETSIZE; ++core)
+  {
+    CPU_SET(core, &cpuset);
+  }
+
+  ::pthread_setaffinity_np(::pthread_self(), sizeof(cpuset), &cpuset);
+#endif
+}
+
 void set_thread_high_priority()
 {
 #if defined(__APPLE__)
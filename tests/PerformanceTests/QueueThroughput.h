@@ -0,0 +1,83 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "Common/BlockingQueue.h"
+#include "Common/MpmcQueue.h"
+
+#include "PerformanceUtils.h"
+
+// Moves item_count items through a queue of 64 slots with thread_count producers and as many
+// consumers; items/sec is item_count divided by the reported time per call.
+template<size_t thread_count, bool lock_free>
+class test_queue_throughput
+{
+public:
+  static const size_t loop_count = 20;
+  static const size_t item_count = 100000;
+
+  bool init()
+  {
+    return true;
+  }
+
+  bool test()
+  {
+    return lock_free ? run<Common::MpmcQueue<size_t>>() : run<BlockingQueue<size_t>>();
+  }
+
+private:
+  template<typename Queue>
+  bool run()
+  {
+    Queue queue(64);
+    std::atomic<size_t> produced(0);
+    std::atomic<size_t> consumed(0);
+    std::atomic<size_t> producers_left(thread_count);
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < thread_count; ++i)
+    {
+      threads.emplace_back([&]
+      {
+        clear_thread_affinity();
+        while (produced.fetch_add(1) < item_count)
+        {
+          queue.push(size_t(1));
+        }
+
+        if (--producers_left == 0)
+        {
+          queue.close();
+        }
+      });
+
+      threads.emplace_back([&]
+      {
+        clear_thread_affinity();
+        size_t value;
+        size_t count = 0;
+        while (queue.pop(value))
+        {
+          count += value;
+        }
+
+        consumed += count;
+      });
+    }
+
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+
+    return consumed.load() == item_count;
+  }
+};
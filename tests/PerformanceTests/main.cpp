@@ -16,6 +16,11 @@
 #include "GenerateKeyImage.h"
 #include "GenerateKeyImageHelper.h"
 #include "IsOutToAccount.h"
+#include "JsonInput.h"
+#include "JsonRpcBatch.h"
+#include "LevinPayload.h"
+#include "ParseTransaction.h"
+#include "QueueThroughput.h"
 
 int main(int argc, char** argv)
 {
@@ -60,6 +65,33 @@ int main(int argc, char** argv)
 
   TEST_PERFORMANCE0(test_cn_slow_hash);
 
+  TEST_PERFORMANCE2(test_json_input, 10, false);
+  TEST_PERFORMANCE2(test_json_input, 10, true);
+  TEST_PERFORMANCE2(test_json_input, 100, false);
+  TEST_PERFORMANCE2(test_json_input, 100, true);
+
+  TEST_PERFORMANCE2(test_json_rpc_batch, 10, false);
+  TEST_PERFORMANCE2(test_json_rpc_batch, 10, true);
+  TEST_PERFORMANCE2(test_json_rpc_batch, 100, false);
+  TEST_PERFORMANCE2(test_json_rpc_batch, 100, true);
+
+  TEST_PERFORMANCE2(test_levin_payload, 10000, false);
+  TEST_PERFORMANCE2(test_levin_payload, 200, true);
+
+  TEST_PERFORMANCE2(test_parse_transaction, 1, false);
+  TEST_PERFORMANCE2(test_parse_transaction, 1, true);
+  TEST_PERFORMANCE2(test_parse_transaction, 10, false);
+  TEST_PERFORMANCE2(test_parse_transaction, 10, true);
+  TEST_PERFORMANCE2(test_parse_transaction, 100, false);
+  TEST_PERFORMANCE2(test_parse_transaction, 100, true);
+
+  TEST_PERFORMANCE2(test_queue_throughput, 1, false);
+  TEST_PERFORMANCE2(test_queue_throughput, 1, true);
+  TEST_PERFORMANCE2(test_queue_throughput, 4, false);
+  TEST_PERFORMANCE2(test_queue_throughput, 4, true);
+  TEST_PERFORMANCE2(test_queue_throughput, 16, false);
+  TEST_PERFORMANCE2(test_queue_throughput, 16, true);
+
   std::cout << "Tests finished. Elapsed time: " << timer.elapsed_ms() / 1000 << " sec" << std::endl;
 
   return 0;
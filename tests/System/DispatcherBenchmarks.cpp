@@ -0,0 +1,177 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include <System/ContextGroup.h>
+#include <System/Dispatcher.h>
+#include <System/Event.h>
+#include <System/Ipv4Address.h>
+#include <System/TcpConnection.h>
+#include <System/TcpConnector.h>
+#include <System/TcpListener.h>
+#include <System/Timer.h>
+#include <gtest/gtest.h>
+
+using namespace System;
+
+namespace {
+
+const Ipv4Address LISTEN_ADDRESS("127.0.0.1");
+const uint16_t LISTEN_PORT = 6667;
+const size_t ECHO_PAIR_COUNT = 128;
+const size_t ECHO_ROUND_TRIPS = 500;
+const size_t ECHO_MESSAGE_SIZE = 64;
+const size_t PING_PONG_ROUNDS = 1000000;
+const size_t SLEEPER_COUNT = 256;
+const size_t SLEEPS_PER_CONTEXT = 200;
+
+void readFully(TcpConnection& connection, uint8_t* data, size_t size) {
+  while (size > 0) {
+    size_t transferred = connection.read(data, size);
+    if (transferred == 0) {
+      throw std::runtime_error("readFully: connection closed");
+    }
+
+    data += transferred;
+    size -= transferred;
+  }
+}
+
+void writeFully(TcpConnection& connection, const uint8_t* data, size_t size) {
+  while (size > 0) {
+    size_t transferred = connection.write(data, size);
+    data += transferred;
+    size -= transferred;
+  }
+}
+
+uint64_t measureEchoThroughput(Dispatcher& dispatcher) {
+  TcpListener listener(dispatcher, LISTEN_ADDRESS, LISTEN_PORT);
+  std::vector<TcpConnection> clients(ECHO_PAIR_COUNT);
+  std::vector<TcpConnection> servers(ECHO_PAIR_COUNT);
+  for (size_t i = 0; i < ECHO_PAIR_COUNT; ++i) {
+    clients[i] = TcpConnector(dispatcher).connect(LISTEN_ADDRESS, LISTEN_PORT);
+    servers[i] = listener.accept();
+  }
+
+  size_t completed = 0;
+  auto start = std::chrono::steady_clock::now();
+  {
+    ContextGroup contextGroup(dispatcher);
+    for (size_t i = 0; i < ECHO_PAIR_COUNT; ++i) {
+      contextGroup.spawn([&, i] {
+        uint8_t data[ECHO_MESSAGE_SIZE];
+        for (size_t j = 0; j < ECHO_ROUND_TRIPS; ++j) {
+          readFully(servers[i], data, sizeof(data));
+          writeFully(servers[i], data, sizeof(data));
+        }
+      });
+
+      contextGroup.spawn([&, i] {
+        uint8_t data[ECHO_MESSAGE_SIZE] = { static_cast<uint8_t>(i) };
+        uint8_t echo[ECHO_MESSAGE_SIZE];
+        for (size_t j = 0; j < ECHO_ROUND_TRIPS; ++j) {
+          writeFully(clients[i], data, sizeof(data));
+          readFully(clients[i], echo, sizeof(echo));
+          EXPECT_EQ(data[0], echo[0]);
+          ++completed;
+        }
+      });
+    }
+
+    contextGroup.wait();
+  }
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_EQ(ECHO_PAIR_COUNT * ECHO_ROUND_TRIPS, completed);
+  return static_cast<uint64_t>(completed / elapsed.count());
+}
+
+uint64_t measureSleepRate(Dispatcher& dispatcher) {
+  size_t completed = 0;
+  auto start = std::chrono::steady_clock::now();
+  {
+    ContextGroup contextGroup(dispatcher);
+    for (size_t i = 0; i < SLEEPER_COUNT; ++i) {
+      contextGroup.spawn([&] {
+        Timer timer(dispatcher);
+        for (size_t j = 0; j < SLEEPS_PER_CONTEXT; ++j) {
+          timer.sleep(std::chrono::microseconds(50));
+          ++completed;
+        }
+      });
+    }
+
+    contextGroup.wait();
+  }
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_EQ(SLEEPER_COUNT * SLEEPS_PER_CONTEXT, completed);
+  return static_cast<uint64_t>(completed / elapsed.count());
+}
+
+}
+
+// Many concurrent echo pairs keep lots of sockets ready at once, which is where
+// harvesting several epoll events per wait pays off.
+TEST(DispatcherBenchmarks, tcpEchoThroughput) {
+  Dispatcher dispatcher;
+  uint64_t rate = measureEchoThroughput(dispatcher);
+  std::cout << ECHO_PAIR_COUNT << " echo pairs: " << rate << " round trips/s" << std::endl;
+}
+
+#ifdef __linux__
+// Same workloads on both Linux backends. With io_uring a blocked read or sleep is one
+// submission completed in place, instead of epoll_ctl plus the retried syscall or timerfd.
+TEST(DispatcherBenchmarks, ioUringVersusEpoll) {
+  Dispatcher epollDispatcher(false);
+  Dispatcher ioUringDispatcher(true);
+  if (!ioUringDispatcher.hasIoUring()) {
+    std::cout << "io_uring is not available, skipping" << std::endl;
+    return;
+  }
+
+  std::cout << "epoll:    " << measureEchoThroughput(epollDispatcher) << " round trips/s, " << measureSleepRate(epollDispatcher) << " sleeps/s" << std::endl;
+  std::cout << "io_uring: " << measureEchoThroughput(ioUringDispatcher) << " round trips/s, " << measureSleepRate(ioUringDispatcher) << " sleeps/s" << std::endl;
+}
+#endif
+
+// Two contexts handing control to each other through events; no syscalls are
+// involved, so this measures the cost of the context switch itself.
+TEST(DispatcherBenchmarks, contextSwitchRate) {
+  Dispatcher dispatcher;
+  Event ping(dispatcher);
+  Event pong(dispatcher);
+  size_t rounds = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  {
+    ContextGroup contextGroup(dispatcher);
+    contextGroup.spawn([&] {
+      for (size_t i = 0; i < PING_PONG_ROUNDS; ++i) {
+        ping.set();
+        pong.wait();
+        pong.clear();
+        ++rounds;
+      }
+    });
+
+    contextGroup.spawn([&] {
+      for (size_t i = 0; i < PING_PONG_ROUNDS; ++i) {
+        ping.wait();
+        ping.clear();
+        pong.set();
+      }
+    });
+
+    contextGroup.wait();
+  }
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  ASSERT_EQ(PING_PONG_ROUNDS, rounds);
+  std::cout << static_cast<uint64_t>(2 * rounds / elapsed.count()) << " context switches/s" << std::endl;
+}
@@ -0,0 +1,86 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Copyright (c) 2014-2016 SDN developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <System/DispatcherPool.h>
+#include <System/Context.h>
+#include <System/Dispatcher.h>
+#include <System/Event.h>
+#include <System/Timer.h>
+#include <gtest/gtest.h>
+
+using namespace System;
+
+class DispatcherPoolTests : public testing::Test {
+public:
+  Dispatcher dispatcher;
+};
+
+TEST_F(DispatcherPoolTests, invokeRunsOnTargetThread) {
+  DispatcherPool pool(2);
+  std::thread::id callerThread = std::this_thread::get_id();
+  std::thread::id targetThread = DispatcherPool::invoke<std::thread::id>(dispatcher, pool.getDispatcher(1), [] {
+    return std::this_thread::get_id();
+  });
+
+  ASSERT_NE(callerThread, targetThread);
+}
+
+TEST_F(DispatcherPoolTests, invokeRethrowsException) {
+  DispatcherPool pool(1);
+  ASSERT_THROW(DispatcherPool::invoke<void>(dispatcher, pool.getDispatcher(0), [] {
+    throw std::runtime_error("failed");
+  }), std::runtime_error);
+}
+
+TEST_F(DispatcherPoolTests, invokeDoesNotBlockCallerDispatcher) {
+  DispatcherPool pool(1);
+  bool otherContextDone = false;
+  Context<> otherContext(dispatcher, [&] {
+    otherContextDone = true;
+  });
+
+  bool otherContextDoneBeforeResult = DispatcherPool::invoke<bool>(dispatcher, pool.getDispatcher(0), [] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return true;
+  }) && otherContextDone;
+
+  ASSERT_TRUE(otherContextDoneBeforeResult);
+}
+
+TEST_F(DispatcherPoolTests, invokeDefersInterruptUntilCompletion) {
+  DispatcherPool pool(1);
+  bool operationDone = false;
+  bool interrupted = false;
+  Context<> context(dispatcher, [&] {
+    DispatcherPool::invoke<void>(dispatcher, pool.getDispatcher(0), [&] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      operationDone = true;
+    });
+
+    interrupted = dispatcher.interrupted();
+  });
+
+  context.interrupt();
+  context.wait();
+  ASSERT_TRUE(operationDone);
+  ASSERT_TRUE(interrupted);
+}
+
+TEST_F(DispatcherPoolTests, nextDispatcherIsRoundRobin) {
+  DispatcherPool pool(3);
+  ASSERT_EQ(&pool.getDispatcher(0), &pool.nextDispatcher());
+  ASSERT_EQ(&pool.getDispatcher(1), &pool.nextDispatcher());
+  ASSERT_EQ(&pool.getDispatcher(2), &pool.nextDispatcher());
+  ASSERT_EQ(&pool.getDispatcher(0), &pool.nextDispatcher());
+}
+
+TEST_F(DispatcherPoolTests, workersRunTimers) {
+  DispatcherPool pool(2);
+  DispatcherPool::invoke<void>(dispatcher, pool.getDispatcher(0), [&] {
+    Timer(pool.getDispatcher(0)).sleep(std::chrono::milliseconds(1));
+  });
+
+  SUCCEED();
+}
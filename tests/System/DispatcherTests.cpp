@@ -4,6 +4,8 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <future>
+#include <memory>
+#include <vector>
 #include <System/Context.h>
 #include <System/Dispatcher.h>
 #include <System/Event.h>
@@ -374,3 +376,68 @@ TEST_F(DispatcherTests, yieldExecutesIoOnItsFront) {
   dispatcher.yield();
   ASSERT_TRUE(spawnDone);
 }
+
+TEST_F(DispatcherTests, setStackSizeAppliesToNewContexts) {
+  dispatcher.setStackSize(256 * 1024);
+  ASSERT_GE(dispatcher.getStackSize(), 256 * 1024);
+  bool spawnDone = false;
+  Context<> context(dispatcher, [&]() {
+    volatile uint8_t buffer[128 * 1024];
+    buffer[0] = 1;
+    buffer[sizeof(buffer) - 1] = 1;
+    spawnDone = buffer[0] == buffer[sizeof(buffer) - 1];
+  });
+
+  context.get();
+  ASSERT_TRUE(spawnDone);
+}
+
+#ifdef __linux__
+TEST_F(DispatcherTests, stackPoolIsTrimmedAboveHighWatermark) {
+  dispatcher.setStackPoolWatermarks(2, 4);
+  Event event(dispatcher);
+  std::vector<std::unique_ptr<Context<>>> contexts;
+  for (size_t i = 0; i < 10; ++i) {
+    contexts.emplace_back(new Context<>(dispatcher, [&]() {
+      event.wait();
+    }));
+  }
+
+  dispatcher.yield();
+  ASSERT_EQ(10, dispatcher.getLiveStackCount());
+  ASSERT_EQ(0, dispatcher.getPooledStackCount());
+
+  event.set();
+  contexts.clear();
+  ASSERT_EQ(0, dispatcher.getLiveStackCount());
+  ASSERT_LE(dispatcher.getPooledStackCount(), 4);
+  ASSERT_GE(dispatcher.getPooledStackCount(), 2);
+}
+
+TEST_F(DispatcherTests, stackResidentSizeCountsOnlyTouchedPages) {
+  dispatcher.setStackSize(1024 * 1024);
+  Context<> context(dispatcher, [&]() {
+    volatile uint8_t buffer[16 * 1024];
+    buffer[0] = 1;
+  });
+
+  context.get();
+  size_t residentSize = dispatcher.getStackResidentSize();
+  ASSERT_GT(residentSize, 0);
+  ASSERT_LT(residentSize, 1024 * 1024);
+}
+
+TEST_F(DispatcherTests, stackOverflowHitsGuardPage) {
+  ASSERT_DEATH({
+    dispatcher.setStackSize(64 * 1024);
+    Context<> context(dispatcher, [&]() {
+      volatile uint8_t buffer[128 * 1024];
+      for (size_t i = sizeof(buffer); i > 0; --i) {
+        buffer[i - 1] = 1;
+      }
+    });
+
+    context.get();
+  }, "");
+}
+#endif
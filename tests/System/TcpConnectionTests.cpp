@@ -263,6 +263,52 @@ TEST_F(TcpConnectionTests, sendBigChunk) {
   ASSERT_EQ(buf, incoming);
 }
 
+TEST_F(TcpConnectionTests, sendBigChunkGathered) {
+  connect();
+
+  const size_t bufsize = 15 * 1024 * 1024; // 15MB
+  std::vector<uint8_t> buf;
+  buf.resize(bufsize);
+  fillRandomBuf(buf);
+
+  std::vector<uint8_t> incoming;
+  Event readComplete(dispatcher);
+
+  contextGroup.spawn([&]{
+    uint8_t readBuf[1024];
+    size_t readSize;
+    while ((readSize = connection2.read(readBuf, sizeof(readBuf))) > 0) {
+      incoming.insert(incoming.end(), readBuf, readBuf + readSize);
+    }
+
+    readComplete.set();
+  });
+
+  contextGroup.spawn([&]{
+    const uint8_t* bufPtr = &buf[0];
+    size_t left = bufsize;
+    while (left > 0) {
+      // an empty buffer in the middle must be skipped
+      TcpConnection::Buffer buffers[3] = {
+        { bufPtr, std::min(left, size_t(24)) },
+        { bufPtr, 0 },
+        { bufPtr + std::min(left, size_t(24)), left - std::min(left, size_t(24)) }
+      };
+
+      auto transferred = connection1.writeBuffers(buffers, 3);
+      left -= transferred;
+      bufPtr += transferred;
+    }
+
+    connection1 = TcpConnection(); // close connection
+  });
+
+  readComplete.wait();
+
+  ASSERT_EQ(bufsize, incoming.size());
+  ASSERT_EQ(buf, incoming);
+}
+
 TEST_F(TcpConnectionTests, writeWhenReadWaiting) {
   connect();
 
@@ -266,3 +266,23 @@ TEST_F(TimerTests, timerWithZeroTimeIsYielding) {
   Timer(dispatcher).sleep(std::chrono::milliseconds(0));
   ASSERT_TRUE(done);
 }
+
+TEST(TimerIoUringTests, interruptAfterExpiryIsNotDropped) {
+  Dispatcher dispatcher(true);
+  if (!dispatcher.hasIoUring()) {
+    return;
+  }
+
+  ContextGroup contextGroup(dispatcher);
+  contextGroup.spawn([&] {
+    Timer t(dispatcher);
+    ASSERT_THROW(t.sleep(std::chrono::milliseconds(1)), InterruptedException);
+  });
+
+  contextGroup.spawn([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    contextGroup.interrupt();
+  });
+
+  contextGroup.wait();
+}
@@ -0,0 +1,123 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+#include "Logging/AsyncLogger.h"
+#include "Logging/LoggerRef.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace Logging;
+
+namespace {
+
+class RecordingLogger : public ILogger {
+public:
+  RecordingLogger() : blocked(false) {}
+
+  virtual void operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) override {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (blocked) {
+      unblocked.wait(lock);
+    }
+
+    bodies.push_back(body);
+  }
+
+  void block(bool value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    blocked = value;
+    unblocked.notify_all();
+  }
+
+  std::vector<std::string> getBodies() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return bodies;
+  }
+
+private:
+  std::mutex mutex;
+  std::condition_variable unblocked;
+  bool blocked;
+  std::vector<std::string> bodies;
+};
+
+}
+
+TEST(AsyncLogger, writesMessagesInOrderFromOneThread) {
+  RecordingLogger target;
+  AsyncLogger logger(target, 4);
+  LoggerRef ref(logger, "test");
+  for (int i = 0; i < 100; ++i) {
+    ref(INFO) << i;
+  }
+
+  logger.flush();
+
+  auto bodies = target.getBodies();
+  ASSERT_EQ(100, bodies.size());
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(DEFAULT + std::to_string(i) + "\n", bodies[i]);
+  }
+}
+
+TEST(AsyncLogger, destructorWritesQueuedMessages) {
+  RecordingLogger target;
+  {
+    AsyncLogger logger(target, 64);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([&logger] {
+        LoggerRef ref(logger, "test");
+        for (int i = 0; i < 250; ++i) {
+          ref(INFO) << "message";
+        }
+      });
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  ASSERT_EQ(1000, target.getBodies().size());
+}
+
+TEST(AsyncLogger, dropPolicyCountsAndReportsDroppedMessages) {
+  RecordingLogger target;
+  target.block(true);
+  AsyncLogger logger(target, 2, AsyncLogger::OverflowPolicy::DROP);
+  LoggerRef ref(logger, "test");
+  for (int i = 0; i < 20; ++i) {
+    ref(INFO) << i;
+  }
+
+  uint64_t dropped = logger.getDroppedCount();
+  // the writer holds one message and the queue two more
+  ASSERT_GE(dropped, 17);
+
+  target.block(false);
+  logger.flush();
+
+  auto bodies = target.getBodies();
+  ASSERT_EQ(20 - dropped + 1, bodies.size());
+  ASSERT_NE(std::string::npos, bodies.back().find(std::to_string(dropped) + " log messages were dropped"));
+}
+
+TEST(AsyncLogger, levelsAboveCompiledMaximumAreDiscarded) {
+  RecordingLogger target;
+  LoggerRef ref(target, "test");
+  ref(COMPILED_MAX_LEVEL) << "kept";
+  if (COMPILED_MAX_LEVEL < TRACE) {
+    ref(TRACE) << "discarded";
+  }
+
+  auto bodies = target.getBodies();
+  ASSERT_EQ(1, bodies.size());
+  ASSERT_EQ(DEFAULT + "kept\n", bodies[0]);
+}
@@ -0,0 +1,177 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include "Common/VectorOutputStream.h"
+#include "CryptoNoteConfig.h"
+#include "CryptoNoteCore/BinaryCodec.h"
+#include "CryptoNoteCore/CryptoNoteFormatUtils.h"
+#include "CryptoNoteCore/CryptoNoteSerialization.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "Serialization/BinaryOutputStreamSerializer.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+template<typename T>
+BinaryArray serializeWithSerializer(T& value) {
+  BinaryArray result;
+  Common::VectorOutputStream stream(result);
+  BinaryOutputStreamSerializer serializer(stream);
+  serialize(value, serializer);
+  return result;
+}
+
+template<typename T>
+BinaryArray encodeWithCodec(const T& value) {
+  BinaryArray result;
+  BinaryEncoder encoder(result);
+  encode(encoder, value);
+  return result;
+}
+
+Transaction createTransaction() {
+  Transaction tx;
+  tx.version = TRANSACTION_VERSION_2;
+  tx.unlockTime = 1234567890123;
+
+  KeyInput key;
+  key.amount = 300;
+  key.outputIndexes = { 1, 200, 70000 };
+  key.keyImage.data[5] = 0x5a;
+  tx.inputs.push_back(key);
+
+  MultisignatureInput multisignature;
+  multisignature.amount = 1ull << 40;
+  multisignature.signatureCount = 2;
+  multisignature.outputIndex = 129;
+  multisignature.term = 77;
+  tx.inputs.push_back(multisignature);
+
+  KeyOutput keyOutput;
+  keyOutput.key.data[31] = 0xee;
+  tx.outputs.push_back({ 150, keyOutput });
+
+  MultisignatureOutput multisignatureOutput;
+  multisignatureOutput.keys.resize(3);
+  multisignatureOutput.keys[1].data[0] = 0x11;
+  multisignatureOutput.requiredSignatureCount = 2;
+  multisignatureOutput.term = 1000;
+  tx.outputs.push_back({ 127, multisignatureOutput });
+
+  tx.extra = { 0x01, 0x02, 0x80, 0xff };
+
+  tx.signatures.resize(2);
+  tx.signatures[0].resize(3);
+  tx.signatures[0][2].data[63] = 0x42;
+  tx.signatures[1].resize(2);
+  tx.signatures[1][0].data[0] = 0x24;
+  return tx;
+}
+
+Block createBlock() {
+  Block block;
+  block.majorVersion = BLOCK_MAJOR_VERSION_2;
+  block.minorVersion = 0;
+  block.timestamp = 1500000000;
+  block.previousBlockHash.data[0] = 0x99;
+  block.nonce = 0xdeadbeef;
+
+  block.baseTransaction.version = TRANSACTION_VERSION_1;
+  block.baseTransaction.unlockTime = 1010;
+  block.baseTransaction.inputs.push_back(BaseInput{ 1000 });
+  KeyOutput output;
+  output.key.data[7] = 7;
+  block.baseTransaction.outputs.push_back({ 5000000000, output });
+
+  block.transactionHashes.resize(2);
+  block.transactionHashes[1].data[31] = 0x31;
+  return block;
+}
+
+}
+
+TEST(BinaryCodec, transactionEncodingMatchesSerializer) {
+  Transaction tx = createTransaction();
+  BinaryArray expected = serializeWithSerializer(tx);
+  ASSERT_EQ(expected, encodeWithCodec(tx));
+  ASSERT_EQ(expected, toBinaryArray(tx));
+
+  TransactionPrefix& prefix = tx;
+  ASSERT_EQ(serializeWithSerializer(prefix), encodeWithCodec(prefix));
+}
+
+TEST(BinaryCodec, blockEncodingMatchesSerializer) {
+  Block block = createBlock();
+  BinaryArray expected = serializeWithSerializer(block);
+  ASSERT_EQ(expected, encodeWithCodec(block));
+  ASSERT_EQ(expected, toBinaryArray(block));
+  ASSERT_EQ(Crypto::cn_fast_hash(expected.data(), expected.size()), getObjectHash(block));
+}
+
+TEST(BinaryCodec, transactionRoundTrips) {
+  Transaction tx = createTransaction();
+  BinaryArray blob = toBinaryArray(tx);
+
+  Transaction decoded;
+  ASSERT_TRUE(fromBinaryArray(decoded, blob));
+  ASSERT_EQ(blob, serializeWithSerializer(decoded));
+  ASSERT_EQ(getObjectHash(tx), getObjectHash(decoded));
+
+  Transaction parsed;
+  Crypto::Hash hash;
+  Crypto::Hash prefixHash;
+  ASSERT_TRUE(parseAndValidateTransactionFromBinaryArray(blob, parsed, hash, prefixHash));
+  ASSERT_EQ(getObjectHash(tx), hash);
+  ASSERT_EQ(getObjectHash(static_cast<const TransactionPrefix&>(tx)), prefixHash);
+}
+
+TEST(BinaryCodec, blockRoundTrips) {
+  Block block = createBlock();
+  BinaryArray blob = toBinaryArray(block);
+
+  Block decoded;
+  ASSERT_TRUE(fromBinaryArray(decoded, blob));
+  ASSERT_EQ(blob, toBinaryArray(decoded));
+  ASSERT_EQ(block.nonce, decoded.nonce);
+  ASSERT_EQ(block.transactionHashes, decoded.transactionHashes);
+}
+
+TEST(BinaryCodec, rejectsTruncatedAndTrailingData) {
+  BinaryArray blob = toBinaryArray(createTransaction());
+  Transaction tx;
+  for (size_t size = 0; size < blob.size(); ++size) {
+    ASSERT_FALSE(fromBinaryArray(tx, BinaryArray(blob.begin(), blob.begin() + size))) << size;
+  }
+
+  blob.push_back(0);
+  ASSERT_FALSE(fromBinaryArray(tx, blob));
+}
+
+TEST(BinaryCodec, rejectsNonCanonicalVarints) {
+  BinaryArray overlong = { 0x80, 0x00 };
+  BinaryDecoder overlongDecoder(overlong.data(), overlong.size());
+  ASSERT_THROW(overlongDecoder.readVarint<uint64_t>(), std::runtime_error);
+
+  BinaryArray overflow = { 0x80, 0x80, 0x80, 0x80, 0x10 };
+  BinaryDecoder overflowDecoder(overflow.data(), overflow.size());
+  ASSERT_THROW(overflowDecoder.readVarint<uint32_t>(), std::runtime_error);
+
+  BinaryArray maximum = { 0xff, 0xff, 0xff, 0xff, 0x0f };
+  BinaryDecoder maximumDecoder(maximum.data(), maximum.size());
+  ASSERT_EQ(0xffffffff, maximumDecoder.readVarint<uint32_t>());
+}
+
+TEST(BinaryCodec, rejectsUnknownVariantTags) {
+  BinaryArray blob = toBinaryArray(createTransaction());
+  // version, unlock time (6 bytes), input count, then the first input's tag
+  ASSERT_EQ(0x2, blob[8]);
+
+  Transaction tx;
+  blob[8] = 0x7;
+  ASSERT_FALSE(fromBinaryArray(tx, blob));
+}
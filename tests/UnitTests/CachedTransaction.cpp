@@ -0,0 +1,104 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include "CryptoNoteConfig.h"
+#include "CryptoNoteCore/CachedTransaction.h"
+#include "CryptoNoteCore/CryptoNoteBasicImpl.h"
+#include "CryptoNoteCore/CryptoNoteFormatUtils.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/TransactionUtils.h"
+#include "CryptoNoteCore/TransactionView.h"
+#include "Serialization/BinarySerializationTools.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+Transaction createTransaction() {
+  Transaction tx;
+  tx.version = TRANSACTION_VERSION_1;
+  tx.unlockTime = 3;
+
+  KeyInput key;
+  key.amount = 1000;
+  key.outputIndexes = { 1, 20, 300 };
+  Crypto::PublicKey image = generateKeyPair().publicKey;
+  memcpy(&key.keyImage, &image, sizeof(key.keyImage));
+  tx.inputs.push_back(key);
+
+  tx.outputs.push_back({ 900, KeyOutput{ generateKeyPair().publicKey } });
+  tx.extra = { 0x02, 0x01, 0x00 };
+
+  tx.signatures.resize(1);
+  tx.signatures[0].resize(key.outputIndexes.size());
+  for (auto& signature : tx.signatures[0]) {
+    signature.data[0] = 0x5a;
+  }
+
+  return tx;
+}
+
+void expectCached(const Transaction& tx, const CachedTransaction& cached) {
+  EXPECT_EQ(tx, cached.getTransaction());
+  EXPECT_EQ(getObjectHash(tx), cached.getTransactionHash());
+  EXPECT_EQ(getObjectHash(static_cast<const TransactionPrefix&>(tx)), cached.getTransactionPrefixHash());
+  EXPECT_EQ(getObjectBinarySize(tx), cached.getTransactionBinarySize());
+}
+
+}
+
+TEST(CachedTransaction, keepsHashesAndBlobOfSerializedTransaction) {
+  Transaction tx = createTransaction();
+  CachedTransaction cached(tx);
+
+  expectCached(tx, cached);
+  ASSERT_TRUE(cached.hasTransactionBinaryArray());
+  EXPECT_EQ(toBinaryArray(tx), cached.getTransactionBinaryArray());
+}
+
+TEST(CachedTransaction, takesHashesAndBlobFromView) {
+  Transaction tx = createTransaction();
+  BinaryArray blob = toBinaryArray(tx);
+  TransactionView view;
+  ASSERT_TRUE(view.parse(blob));
+
+  CachedTransaction cached(view);
+  expectCached(tx, cached);
+  ASSERT_TRUE(cached.hasTransactionBinaryArray());
+  EXPECT_EQ(blob, cached.getTransactionBinaryArray());
+}
+
+TEST(CachedTransaction, decodeHashesBytesReadWithoutKeepingThem) {
+  Transaction tx = createTransaction();
+  BinaryArray blob = toBinaryArray(tx);
+  blob.push_back(0x7f);
+
+  CachedTransaction cached;
+  BinaryDecoder decoder(blob.data(), blob.size());
+  decode(decoder, cached);
+  EXPECT_EQ(1, decoder.remaining());
+
+  expectCached(tx, cached);
+  EXPECT_FALSE(cached.hasTransactionBinaryArray());
+
+  BinaryArray encoded;
+  BinaryEncoder encoder(encoded);
+  encode(encoder, cached);
+  EXPECT_EQ(toBinaryArray(tx), encoded);
+}
+
+TEST(CachedTransaction, serializesAsTransaction) {
+  Transaction tx = createTransaction();
+  CachedTransaction cached(tx);
+
+  BinaryArray stored = storeToBinary(cached);
+  EXPECT_EQ(toBinaryArray(tx), stored);
+
+  CachedTransaction loaded;
+  loadFromBinary(loaded, stored);
+  expectCached(tx, loaded);
+}
@@ -101,6 +101,43 @@ std::vector<CryptoNote::Transaction> ICoreStub::getPoolTransactions() {
   return std::vector<CryptoNote::Transaction>();
 }
 
+std::vector<Crypto::Hash> ICoreStub::getMissingPoolTransactions(const std::vector<Crypto::Hash>& txIds) {
+  std::vector<Crypto::Hash> missingTxIds;
+  for (const Crypto::Hash& txId : txIds) {
+    if (transactionPool.count(txId) == 0) {
+      missingTxIds.push_back(txId);
+    }
+  }
+
+  return missingTxIds;
+}
+
+std::vector<Crypto::Hash> ICoreStub::getUnknownTransactions(const std::vector<Crypto::Hash>& txIds) {
+  std::vector<Crypto::Hash> unknownTxIds;
+  for (const Crypto::Hash& txId : txIds) {
+    if (transactionPool.count(txId) == 0 && transactions.count(txId) == 0) {
+      unknownTxIds.push_back(txId);
+    }
+  }
+
+  return unknownTxIds;
+}
+
+bool ICoreStub::isTransactionRejected(const Crypto::Hash& txId) {
+  return false;
+}
+
+void ICoreStub::getPoolTransactionBlobs(const std::vector<Crypto::Hash>& txIds, std::vector<CryptoNote::BinaryArray>& txs, std::vector<Crypto::Hash>& missedTxIds) {
+  for (const Crypto::Hash& txId : txIds) {
+    auto it = transactionPool.find(txId);
+    if (it == transactionPool.end()) {
+      missedTxIds.push_back(txId);
+    } else {
+      txs.push_back(CryptoNote::toBinaryArray(it->second));
+    }
+  }
+}
+
 bool ICoreStub::getPoolChanges(const Crypto::Hash& tailBlockId, const std::vector<Crypto::Hash>& knownTxsIds,
                                std::vector<CryptoNote::Transaction>& addedTxs, std::vector<Crypto::Hash>& deletedTxsIds) {
   std::unordered_set<Crypto::Hash> knownSet;
@@ -34,6 +34,10 @@ public:
   virtual CryptoNote::i_cryptonote_protocol* get_protocol() override;
   virtual bool handle_incoming_tx(CryptoNote::BinaryArray const& tx_blob, CryptoNote::tx_verification_context& tvc, bool keeped_by_block) override;
   virtual std::vector<CryptoNote::Transaction> getPoolTransactions() override;
+  virtual std::vector<Crypto::Hash> getMissingPoolTransactions(const std::vector<Crypto::Hash>& txIds) override;
+  virtual std::vector<Crypto::Hash> getUnknownTransactions(const std::vector<Crypto::Hash>& txIds) override;
+  virtual bool isTransactionRejected(const Crypto::Hash& txId) override;
+  virtual void getPoolTransactionBlobs(const std::vector<Crypto::Hash>& txIds, std::vector<CryptoNote::BinaryArray>& txs, std::vector<Crypto::Hash>& missedTxIds) override;
   virtual bool getPoolChanges(const Crypto::Hash& tailBlockId, const std::vector<Crypto::Hash>& knownTxsIds,
                               std::vector<CryptoNote::Transaction>& addedTxs, std::vector<Crypto::Hash>& deletedTxsIds) override;
   virtual bool getPoolChangesLite(const Crypto::Hash& tailBlockId, const std::vector<Crypto::Hash>& knownTxsIds,
@@ -54,6 +58,7 @@ public:
   virtual void update_block_template_and_resume_mining() override {}
   virtual bool handle_incoming_block_blob(const CryptoNote::BinaryArray& block_blob, CryptoNote::block_verification_context& bvc, bool control_miner, bool relay_block) override { return false; }
   virtual bool handle_get_objects(CryptoNote::NOTIFY_REQUEST_GET_OBJECTS::request& arg, CryptoNote::NOTIFY_RESPONSE_GET_OBJECTS::request& rsp) override { return false; }
+  virtual bool handle_get_blocks_by_range(const CryptoNote::NOTIFY_REQUEST_BLOCKS_BY_RANGE::request& arg, CryptoNote::NOTIFY_RESPONSE_BLOCKS_BY_RANGE::request& rsp) override { return false; }
   virtual void on_synchronized() override {}
   virtual bool getOutByMSigGIndex(uint64_t amount, uint64_t gindex, CryptoNote::MultisignatureOutput& out) override { return true; }
   virtual size_t addChain(const std::vector<const CryptoNote::IBlock*>& chain) override;
@@ -78,6 +83,7 @@ public:
   virtual bool getPoolTransactionsByTimestamp(uint64_t timestampBegin, uint64_t timestampEnd, uint32_t transactionsNumberLimit, std::vector<CryptoNote::Transaction>& transactions, uint64_t& transactionsNumberWithinTimestamps) override;
   virtual bool getTransactionsByPaymentId(const Crypto::Hash& paymentId, std::vector<CryptoNote::Transaction>& transactions) override;
   virtual std::unique_ptr<CryptoNote::IBlock> getBlock(const Crypto::Hash& blockId) override;
+  virtual bool getRawBlock(const Crypto::Hash& blockId, CryptoNote::block_complete_entry& entry) override { return false; }
   virtual bool handleIncomingTransaction(const CryptoNote::Transaction& tx, const Crypto::Hash& txHash, size_t blobSize, CryptoNote::tx_verification_context& tvc, bool keptByBlock, uint32_t height) override;
   virtual std::error_code executeLocked(const std::function<std::error_code()>& func) override;
 
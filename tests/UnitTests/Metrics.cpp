@@ -0,0 +1,109 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+#include "Common/Metrics.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace Common;
+
+namespace {
+
+std::string exposition() {
+  std::ostringstream stream;
+  Metrics::writePrometheus(stream);
+  return stream.str();
+}
+
+bool contains(const std::string& text, const std::string& line) {
+  return text.find(line + "\n") != std::string::npos;
+}
+
+}
+
+TEST(Metrics, sameNameAndLabelsReturnTheSameMetric) {
+  MetricCounter& counter = Metrics::counter("test_lookup_total", "Lookups", Metrics::label("kind", "a"));
+  ASSERT_EQ(&counter, &Metrics::counter("test_lookup_total", "Lookups", Metrics::label("kind", "a")));
+  ASSERT_NE(&counter, &Metrics::counter("test_lookup_total", "Lookups", Metrics::label("kind", "b")));
+}
+
+TEST(Metrics, registeringANameWithAnotherTypeThrows) {
+  Metrics::counter("test_typed_total", "Typed");
+  ASSERT_THROW(Metrics::gauge("test_typed_total", "Typed"), std::invalid_argument);
+}
+
+TEST(Metrics, countersAreExactUnderConcurrentUpdates) {
+  MetricCounter& counter = Metrics::counter("test_concurrent_total", "Concurrent increments");
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&counter] {
+      for (int i = 0; i < 10000; ++i) {
+        counter.inc();
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(40000, counter.get());
+  ASSERT_TRUE(contains(exposition(), "test_concurrent_total 40000"));
+}
+
+TEST(Metrics, writesCountersAndGaugesInTextFormat) {
+  Metrics::counter("test_bytes_total", "Bytes \"moved\"\nso far", Metrics::label("command", "10\"01")).inc(33);
+  Metrics::gauge("test_depth", "Queue depth").set(-2);
+
+  std::string text = exposition();
+  ASSERT_TRUE(contains(text, "# HELP test_bytes_total Bytes \"moved\"\\nso far"));
+  ASSERT_TRUE(contains(text, "# TYPE test_bytes_total counter"));
+  ASSERT_TRUE(contains(text, "test_bytes_total{command=\"10\\\"01\"} 33"));
+  ASSERT_TRUE(contains(text, "# TYPE test_depth gauge"));
+  ASSERT_TRUE(contains(text, "test_depth -2"));
+}
+
+TEST(Metrics, histogramBucketsAreCumulativeWithInclusiveBounds) {
+  MetricHistogram& histogram = Metrics::histogram("test_latency_seconds", "Latency", { 0.5, 1, 2 }, Metrics::label("endpoint", "/x"));
+  histogram.observe(0.25);
+  histogram.observe(1);
+  histogram.observe(1.5);
+  histogram.observe(7);
+
+  ASSERT_EQ(1, histogram.getBucketCount(0));
+  ASSERT_EQ(1, histogram.getBucketCount(1));
+  ASSERT_EQ(1, histogram.getBucketCount(2));
+  ASSERT_EQ(1, histogram.getBucketCount(3));
+  ASSERT_EQ(4, histogram.getCount());
+  ASSERT_DOUBLE_EQ(9.75, histogram.getSum());
+
+  std::string text = exposition();
+  ASSERT_TRUE(contains(text, "# TYPE test_latency_seconds histogram"));
+  ASSERT_TRUE(contains(text, "test_latency_seconds_bucket{endpoint=\"/x\",le=\"0.5\"} 1"));
+  ASSERT_TRUE(contains(text, "test_latency_seconds_bucket{endpoint=\"/x\",le=\"1\"} 2"));
+  ASSERT_TRUE(contains(text, "test_latency_seconds_bucket{endpoint=\"/x\",le=\"2\"} 3"));
+  ASSERT_TRUE(contains(text, "test_latency_seconds_bucket{endpoint=\"/x\",le=\"+Inf\"} 4"));
+  ASSERT_TRUE(contains(text, "test_latency_seconds_sum{endpoint=\"/x\"} 9.75"));
+  ASSERT_TRUE(contains(text, "test_latency_seconds_count{endpoint=\"/x\"} 4"));
+}
+
+TEST(Metrics, timerObservesOnceUnlessCancelled) {
+  MetricHistogram& histogram = Metrics::histogram("test_timer_seconds", "Timer", Metrics::latencyBuckets());
+  {
+    MetricTimer timer(histogram);
+    timer.finish();
+  }
+
+  {
+    MetricTimer timer(histogram);
+    timer.cancel();
+  }
+
+  ASSERT_EQ(1, histogram.getCount());
+}
@@ -0,0 +1,62 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+#include "Common/MonotonicArena.h"
+
+using namespace Common;
+
+TEST(MonotonicArena, alignsAndRewinds) {
+  MonotonicArena arena(64);
+  char* first = static_cast<char*>(arena.allocate(1, 1));
+  uint64_t* aligned = static_cast<uint64_t*>(arena.allocate(sizeof(uint64_t), alignof(uint64_t)));
+  ASSERT_EQ(0, reinterpret_cast<uintptr_t>(aligned) % alignof(uint64_t));
+  ASSERT_NE(first, reinterpret_cast<char*>(aligned));
+
+  MonotonicArena::Marker marker = arena.getMarker();
+  void* scoped = arena.allocate(16, 1);
+  arena.rewind(marker);
+  ASSERT_EQ(scoped, arena.allocate(16, 1));
+}
+
+TEST(MonotonicArena, scopesNest) {
+  MonotonicArena arena(256);
+  void* outer;
+  {
+    MonotonicArena::Scope outerScope(arena);
+    outer = arena.allocate(32, 8);
+    void* inner;
+    {
+      MonotonicArena::Scope innerScope(arena);
+      inner = arena.allocate(32, 8);
+    }
+
+    ASSERT_EQ(inner, arena.allocate(32, 8));
+  }
+
+  ASSERT_EQ(outer, arena.allocate(32, 8));
+}
+
+TEST(MonotonicArena, growsPastItsChunkAndKeepsTheMemory) {
+  MonotonicArena arena(64);
+  {
+    MonotonicArena::Scope scope(arena);
+    for (size_t i = 0; i < 100; ++i) {
+      arena.allocate(48, 8);
+    }
+  }
+
+  size_t capacity = arena.getCapacity();
+  ASSERT_GE(capacity, 100 * 48);
+
+  {
+    MonotonicArena::Scope scope(arena);
+    for (size_t i = 0; i < 100; ++i) {
+      arena.allocate(48, 8);
+    }
+  }
+
+  ASSERT_EQ(capacity, arena.getCapacity());
+}
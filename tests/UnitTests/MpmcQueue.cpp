@@ -0,0 +1,147 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+#include "Common/MpmcQueue.h"
+
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Common;
+
+namespace {
+
+// every producer pushes its own range of values, the consumers' sums must add up to all of them
+void testQueueMPMC(unsigned iterations, unsigned producers, unsigned consumers, unsigned queueSize) {
+  MpmcQueue<unsigned> queue(queueSize);
+  std::atomic<uint64_t> popped(0);
+  std::atomic<unsigned> producersLeft(producers);
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < consumers; ++i) {
+    threads.emplace_back([&] {
+      unsigned value;
+      uint64_t sum = 0;
+      while (queue.pop(value)) {
+        sum += value;
+      }
+
+      popped += sum;
+    });
+  }
+
+  for (unsigned i = 0; i < producers; ++i) {
+    threads.emplace_back([&, i] {
+      for (unsigned value = i * iterations; value < (i + 1) * iterations; ++value) {
+        ASSERT_TRUE(queue.push(value));
+      }
+
+      if (--producersLeft == 0) {
+        queue.close();
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  uint64_t total = static_cast<uint64_t>(producers) * iterations;
+  ASSERT_EQ(total * (total - 1) / 2, popped.load());
+  ASSERT_EQ(0, queue.size());
+}
+
+}
+
+TEST(MpmcQueue, MPMC) {
+  testQueueMPMC(10000, 1, 1, 1);
+  testQueueMPMC(10000, 4, 4, 2);
+  testQueueMPMC(10000, 4, 1, 16);
+  testQueueMPMC(10000, 1, 4, 16);
+  testQueueMPMC(10000, 16, 16, 100);
+}
+
+TEST(MpmcQueue, popReturnsFalseOnlyWhenClosedAndEmpty) {
+  MpmcQueue<int> queue(4);
+  ASSERT_TRUE(queue.push(1));
+  ASSERT_TRUE(queue.push(2));
+  queue.close();
+
+  ASSERT_FALSE(queue.push(3));
+
+  int value;
+  ASSERT_TRUE(queue.pop(value));
+  ASSERT_EQ(1, value);
+  ASSERT_TRUE(queue.pop(value));
+  ASSERT_EQ(2, value);
+  ASSERT_FALSE(queue.pop(value));
+}
+
+TEST(MpmcQueue, closeUnblocksProducersAndConsumers) {
+  MpmcQueue<int> full(2);
+  ASSERT_TRUE(full.push(1));
+  ASSERT_TRUE(full.push(2));
+  MpmcQueue<int> empty(2);
+
+  auto producer = std::async(std::launch::async, [&] { return full.push(3); });
+  auto consumer = std::async(std::launch::async, [&] { int value; return empty.pop(value); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  full.close();
+  empty.close();
+  ASSERT_FALSE(producer.get());
+  ASSERT_FALSE(consumer.get());
+}
+
+TEST(MpmcQueue, closeAndWaitReturnsWhenDrained) {
+  MpmcQueue<int> queue(100);
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_TRUE(queue.push(i));
+  }
+
+  std::atomic<size_t> itemsPopped(0);
+  std::thread consumer([&] {
+    int value;
+    while (queue.pop(value)) {
+      ++itemsPopped;
+    }
+  });
+
+  queue.close(true);
+  ASSERT_EQ(100, itemsPopped.load());
+  consumer.join();
+}
+
+TEST(MpmcQueue, allowsMoveOnly) {
+  MpmcQueue<std::unique_ptr<int>> queue(1);
+
+  std::unique_ptr<int> value(new int(100));
+  ASSERT_TRUE(queue.push(std::move(value)));
+
+  std::unique_ptr<int> popped;
+  ASSERT_TRUE(queue.pop(popped));
+  ASSERT_EQ(100, *popped);
+}
+
+TEST(MpmcQueue, pushCopiesLvalues) {
+  MpmcQueue<std::string> queue(2);
+  std::string value = "value";
+  ASSERT_TRUE(queue.push(value));
+  ASSERT_EQ("value", value);
+}
+
+TEST(MpmcQueue, destructorReleasesQueuedItems) {
+  auto item = std::make_shared<int>(1);
+  {
+    MpmcQueue<std::shared_ptr<int>> queue(4);
+    ASSERT_TRUE(queue.push(item));
+    ASSERT_TRUE(queue.push(item));
+    ASSERT_EQ(3, item.use_count());
+  }
+
+  ASSERT_EQ(1, item.use_count());
+}
@@ -0,0 +1,77 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+#include "Common/RollingBloomFilter.h"
+
+#include "crypto/hash.h"
+
+using namespace Common;
+
+namespace {
+
+Crypto::Hash makeKey(uint64_t i) {
+  return Crypto::cn_fast_hash(&i, sizeof(i));
+}
+
+}
+
+TEST(RollingBloomFilter, emptyFilterContainsNothing) {
+  RollingBloomFilter filter(100, 0.001);
+  EXPECT_FALSE(filter.contains(makeKey(0)));
+}
+
+TEST(RollingBloomFilter, remembersLastCapacityKeys) {
+  const size_t capacity = 1000;
+  RollingBloomFilter filter(capacity, 0.001);
+  for (uint64_t i = 0; i < 10 * capacity; ++i) {
+    filter.insert(makeKey(i));
+    ASSERT_TRUE(filter.contains(makeKey(i)));
+  }
+
+  for (uint64_t i = 9 * capacity; i < 10 * capacity; ++i) {
+    ASSERT_TRUE(filter.contains(makeKey(i))) << i;
+  }
+}
+
+TEST(RollingBloomFilter, forgetsOldKeys) {
+  const size_t capacity = 1000;
+  RollingBloomFilter filter(capacity, 0.001);
+  for (uint64_t i = 0; i < 3 * capacity; ++i) {
+    filter.insert(makeKey(i));
+  }
+
+  size_t remembered = 0;
+  for (uint64_t i = 0; i < capacity; ++i) {
+    remembered += filter.contains(makeKey(i)) ? 1 : 0;
+  }
+
+  EXPECT_LT(remembered, capacity / 100);
+}
+
+TEST(RollingBloomFilter, falsePositiveRateIsClose) {
+  const size_t capacity = 10000;
+  RollingBloomFilter filter(capacity, 0.01);
+  for (uint64_t i = 0; i < 2 * capacity; ++i) {
+    filter.insert(makeKey(i));
+  }
+
+  size_t falsePositives = 0;
+  for (uint64_t i = 2 * capacity; i < 12 * capacity; ++i) {
+    falsePositives += filter.contains(makeKey(i)) ? 1 : 0;
+  }
+
+  EXPECT_LT(falsePositives, 10 * capacity * 2 / 100);
+}
+
+TEST(RollingBloomFilter, clearForgetsEverything) {
+  RollingBloomFilter filter(100, 0.001);
+  filter.insert(makeKey(1));
+  filter.clear();
+  EXPECT_FALSE(filter.contains(makeKey(1)));
+
+  filter.insert(makeKey(2));
+  EXPECT_TRUE(filter.contains(makeKey(2)));
+}
@@ -0,0 +1,74 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+#include "Rpc/RpcResponseCache.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+Crypto::Hash makeHash(uint8_t seed) {
+  Crypto::Hash hash = Crypto::Hash();
+  hash.data[0] = seed;
+  return hash;
+}
+
+}
+
+TEST(RpcResponseCache, returnsStoredValue) {
+  RpcResponseCache<std::string> cache(4);
+  cache.put(makeHash(1), "one", cache.generation());
+
+  std::string value;
+  ASSERT_TRUE(cache.get(makeHash(1), value));
+  ASSERT_EQ("one", value);
+  ASSERT_FALSE(cache.get(makeHash(2), value));
+  ASSERT_EQ(1, cache.hits());
+  ASSERT_EQ(1, cache.misses());
+}
+
+TEST(RpcResponseCache, evictsLeastRecentlyUsed) {
+  RpcResponseCache<std::string> cache(2);
+  cache.put(makeHash(1), "one", cache.generation());
+  cache.put(makeHash(2), "two", cache.generation());
+
+  std::string value;
+  ASSERT_TRUE(cache.get(makeHash(1), value));
+  cache.put(makeHash(3), "three", cache.generation());
+
+  ASSERT_EQ(2, cache.size());
+  ASSERT_TRUE(cache.get(makeHash(1), value));
+  ASSERT_FALSE(cache.get(makeHash(2), value));
+  ASSERT_TRUE(cache.get(makeHash(3), value));
+}
+
+TEST(RpcResponseCache, removeDropsEntry) {
+  RpcResponseCache<std::string> cache(4);
+  cache.put(makeHash(1), "one", cache.generation());
+  cache.remove(makeHash(1));
+
+  std::string value;
+  ASSERT_FALSE(cache.get(makeHash(1), value));
+  ASSERT_EQ(0, cache.size());
+}
+
+TEST(RpcResponseCache, rejectsValueBuiltBeforeInvalidation) {
+  RpcResponseCache<std::string> cache(4);
+  uint64_t generation = cache.generation();
+  cache.remove(makeHash(2));
+  cache.put(makeHash(1), "stale", generation);
+
+  std::string value;
+  ASSERT_FALSE(cache.get(makeHash(1), value));
+}
+
+TEST(RpcResponseCache, zeroCapacityDisablesCache) {
+  RpcResponseCache<std::string> cache(0);
+  cache.put(makeHash(1), "one", cache.generation());
+
+  std::string value;
+  ASSERT_FALSE(cache.get(makeHash(1), value));
+}
@@ -0,0 +1,185 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <array>
+
+#include "Serialization/JsonInputBufferSerializer.h"
+#include "Serialization/JsonStreamingOutputSerializer.h"
+#include "Serialization/SerializationOverloads.h"
+#include "Serialization/SerializationTools.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+struct JsonTestElement {
+  std::string name;
+  int32_t delta;
+  std::array<uint8_t, 8> blob;
+  std::vector<uint32_t> values;
+
+  bool operator==(const JsonTestElement& other) const {
+    return name == other.name && delta == other.delta && blob == other.blob && values == other.values;
+  }
+
+  void serialize(ISerializer& s) {
+    s(name, "name");
+    s(delta, "delta");
+    s.binary(blob.data(), blob.size(), "blob");
+    s(values, "values");
+  }
+};
+
+struct JsonTestStruct {
+  uint64_t amount;
+  bool flag;
+  double ratio;
+  std::vector<JsonTestElement> elements;
+  std::vector<JsonTestElement> empty;
+  JsonTestElement root;
+
+  bool operator==(const JsonTestStruct& other) const {
+    return amount == other.amount && flag == other.flag && ratio == other.ratio && elements == other.elements &&
+      empty == other.empty && root == other.root;
+  }
+
+  void serialize(ISerializer& s) {
+    s(root, "root");
+    s(elements, "elements");
+    s(empty, "empty");
+    s(amount, "amount");
+    s(flag, "flag");
+    s(ratio, "ratio");
+  }
+};
+
+JsonTestElement makeElement(const std::string& name, int32_t delta) {
+  JsonTestElement element;
+  element.name = name;
+  element.delta = delta;
+  for (size_t i = 0; i < element.blob.size(); ++i) {
+    element.blob[i] = static_cast<uint8_t>(delta * 31 + i * 17);
+  }
+
+  element.values = { 1, 2, static_cast<uint32_t>(delta) };
+  return element;
+}
+
+JsonTestStruct makeStruct() {
+  JsonTestStruct value;
+  value.amount = 1234567890123ULL;
+  value.flag = true;
+  value.ratio = 0.25;
+  value.root = makeElement("root", -7);
+  value.elements.push_back(makeElement("first", 1));
+  value.elements.push_back(makeElement("second", 250));
+  return value;
+}
+
+}
+
+TEST(JsonStreamingOutputSerializer, matchesJsonValueOutput) {
+  JsonTestStruct value = makeStruct();
+
+  std::string streamed = storeToJson(value);
+  ASSERT_EQ(storeToJsonValue(value).toString(), Common::JsonValue::fromString(streamed).toString());
+}
+
+TEST(JsonStreamingOutputSerializer, roundTrip) {
+  JsonTestElement value = makeElement("element", -3);
+
+  JsonTestElement loaded;
+  ASSERT_TRUE(loadFromJson(loaded, storeToJson(value)));
+  ASSERT_EQ(value, loaded);
+}
+
+TEST(JsonStreamingOutputSerializer, emptyObject) {
+  std::string json;
+  Common::StringOutputStream stream(json);
+  JsonStreamingOutputSerializer s(stream);
+  s.close();
+
+  ASSERT_EQ("{}", json);
+}
+
+TEST(JsonInputBufferSerializer, readsStreamedOutput) {
+  JsonTestElement value = makeElement("element", -3);
+  std::string json = storeToJson(value);
+
+  JsonTestElement loaded;
+  JsonInputBufferSerializer s(json);
+  serialize(loaded, s);
+  ASSERT_EQ(value, loaded);
+}
+
+TEST(JsonInputBufferSerializer, matchesJsonValueInput) {
+  JsonTestStruct value = makeStruct();
+  std::string json = " { \"unknown\" : [ { \"a\" : null }, true, -1.5e3 ] ,\n" + storeToJson(value).substr(1);
+
+  JsonTestStruct fromValue;
+  loadFromJsonValue(fromValue.root, Common::JsonValue::fromString(json)("root"));
+
+  JsonTestStruct fromBuffer;
+  JsonInputBufferSerializer s(json);
+  ASSERT_TRUE(s.beginObject("root"));
+  serialize(fromBuffer.root, s);
+  s.endObject();
+
+  size_t size;
+  ASSERT_TRUE(s.beginArray(size, "elements"));
+  ASSERT_EQ(2, size);
+  s.endArray();
+  ASSERT_FALSE(s.beginArray(size, "missing"));
+  ASSERT_EQ(0, size);
+
+  ASSERT_EQ(fromValue.root, fromBuffer.root);
+  ASSERT_EQ(value.root, fromBuffer.root);
+
+  uint64_t amount;
+  ASSERT_TRUE(s(amount, "amount"));
+  ASSERT_EQ(value.amount, amount);
+
+  double ratio;
+  ASSERT_TRUE(s(ratio, "ratio"));
+  ASSERT_EQ(value.ratio, ratio);
+}
+
+TEST(JsonInputBufferSerializer, keepsStringEscapes) {
+  std::string json = "{\"text\":\"a\\\"b\\\\\"}";
+
+  std::string text;
+  JsonInputBufferSerializer s(json);
+  ASSERT_TRUE(s(text, "text"));
+  ASSERT_EQ(Common::JsonValue::fromString(json)("text").getString(), text);
+}
+
+TEST(JsonInputBufferSerializer, decodesHexBlob) {
+  std::string json = "{\"blob\":\"00ff10\",\"odd\":\"abc\",\"bad\":\"zz\"}";
+  JsonInputBufferSerializer s(json);
+
+  std::string blob;
+  ASSERT_TRUE(s.binary(blob, "blob"));
+  ASSERT_EQ(std::string("\x00\xff\x10", 3), blob);
+  ASSERT_ANY_THROW(s.binary(blob, "odd"));
+  ASSERT_ANY_THROW(s.binary(blob, "bad"));
+
+  uint8_t small[2];
+  ASSERT_ANY_THROW(s.binary(small, sizeof(small), "blob"));
+}
+
+TEST(JsonInputBufferSerializer, rejectsMalformedInput) {
+  ASSERT_ANY_THROW(JsonInputBufferSerializer("[1,2]"));
+  ASSERT_ANY_THROW(JsonInputBufferSerializer("{\"a\":1"));
+  ASSERT_ANY_THROW(JsonInputBufferSerializer("{\"a\" 1}"));
+  ASSERT_ANY_THROW(JsonInputBufferSerializer("{\"a\":tru}"));
+  ASSERT_ANY_THROW(JsonInputBufferSerializer("{\"a\":" + std::string(1000, '[')));
+
+  JsonInputBufferSerializer s("{\"a\":1.5,\"b\":\"1\"}");
+  uint64_t value;
+  ASSERT_ANY_THROW(s(value, "a"));
+  ASSERT_ANY_THROW(s(value, "b"));
+}
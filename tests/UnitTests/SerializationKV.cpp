@@ -7,6 +7,7 @@
 
 #include <boost/lexical_cast.hpp>
 
+#include "crypto/hash.h"
 #include "Serialization/KVBinaryInputStreamSerializer.h"
 #include "Serialization/KVBinaryOutputStreamSerializer.h"
 #include "Serialization/SerializationOverloads.h"
@@ -122,3 +123,55 @@ TEST(KVSerialize, BigCollection) {
   ASSERT_TRUE(CryptoNote::loadFromBinaryKeyValue(ts2, buf));
   EXPECT_EQ(ts1, ts2);
 }
+
+namespace {
+
+struct HashList {
+  std::vector<Crypto::Hash> hashes;
+
+  void serialize(ISerializer& s) {
+    serializeAsBinary(hashes, "hashes", s);
+  }
+};
+
+struct BlobEntry {
+  std::string hashes;
+
+  void serialize(ISerializer& s) {
+    s.binary(hashes, "hashes");
+  }
+};
+
+}
+
+TEST(KVSerialize, PodArrayOfEverySizeMark) {
+  // blob lengths of 32, 2048 and 320000 bytes take one, two and four byte size marks
+  for (size_t count : { 1, 64, 10000 }) {
+    HashList list1;
+    list1.hashes.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+      list1.hashes[i].data[0] = static_cast<uint8_t>(i);
+      list1.hashes[i].data[31] = static_cast<uint8_t>(i >> 8);
+    }
+
+    HashList list2;
+    ASSERT_TRUE(CryptoNote::loadFromBinaryKeyValue(list2, CryptoNote::storeToBinaryKeyValue(list1)));
+    EXPECT_EQ(list1.hashes, list2.hashes);
+  }
+}
+
+TEST(KVSerialize, PodArrayMissingFieldIsEmpty) {
+  HashList list;
+  list.hashes.resize(3);
+
+  ASSERT_TRUE(CryptoNote::loadFromBinaryKeyValue(list, CryptoNote::storeToBinaryKeyValue(TestElement())));
+  EXPECT_TRUE(list.hashes.empty());
+}
+
+TEST(KVSerialize, PodArrayOfPartialItemIsRejected) {
+  BlobEntry entry;
+  entry.hashes.assign(sizeof(Crypto::Hash) + 1, 'x');
+
+  HashList list;
+  EXPECT_FALSE(CryptoNote::loadFromBinaryKeyValue(list, CryptoNote::storeToBinaryKeyValue(entry)));
+}
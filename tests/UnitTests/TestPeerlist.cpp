@@ -6,14 +6,42 @@
 #include "gtest/gtest.h"
 
 #include "Common/Util.h"
+#include "Serialization/BinarySerializationTools.h"
 
 #include "P2p/PeerListManager.h"
 #include "P2p/PeerListManager.cpp"
+#include "P2p/PeerScore.cpp"
 
 using namespace CryptoNote;
 
 #define MAKE_IP( a1, a2, a3, a4 )	(a1|(a2<<8)|(a3<<16)|(a4<<24))
 
+namespace {
+
+// p2pstate.bin peer lists as written before peer scores were stored
+struct PeerlistStateV1 {
+  std::vector<PeerlistEntry> white;
+  std::vector<PeerlistEntry> gray;
+
+  void serialize(ISerializer& s) {
+    uint8_t version = 1;
+    s(version, "version");
+    s(white, "whitelist");
+    s(gray, "graylist");
+  }
+};
+
+PeerlistEntry makePeerlistEntry(uint32_t ip, uint32_t port, PeerIdType id, uint64_t lastSeen) {
+  PeerlistEntry entry;
+  entry.adr.ip = ip;
+  entry.adr.port = port;
+  entry.id = id;
+  entry.last_seen = lastSeen;
+  return entry;
+}
+
+}
+
 
 TEST(peer_list, peer_list_general)
 {
@@ -62,3 +90,119 @@ TEST(peer_list, merge_peer_lists)
 
 
 }
+
+TEST(peer_list, peer_score_prefers_fast_peers)
+{
+  PeerScore fast;
+  fast.addHandshakeRtt(50);
+  fast.addBlockDelivery(200, 1024 * 1024);
+
+  PeerScore slow;
+  slow.addHandshakeRtt(900);
+  slow.addBlockDelivery(8000, 1024 * 1024);
+
+  ASSERT_EQ(0, PeerScore().getValue(1000));
+  ASSERT_GT(fast.getValue(1000), 0);
+  ASSERT_LT(slow.getValue(1000), 0);
+
+  // a single slow sample doesn't outweigh the history
+  fast.addBlockDelivery(8000, 1024 * 1024);
+  ASSERT_GT(fast.getValue(1000), slow.getValue(1000));
+}
+
+TEST(peer_list, peer_score_ranks_unknown_peers_between_fast_and_slow)
+{
+  PeerScore unknown;
+
+  // responsive, but never synchronized from
+  PeerScore responsive;
+  responsive.addHandshakeRtt(40);
+
+  PeerScore fast;
+  fast.addHandshakeRtt(60);
+  fast.addBlockDelivery(300, 512 * 1024);
+
+  PeerScore slow;
+  slow.addHandshakeRtt(600);
+
+  ASSERT_GT(responsive.getValue(1000), unknown.getValue(1000));
+  ASSERT_GT(fast.getValue(1000), unknown.getValue(1000));
+  ASSERT_LT(slow.getValue(1000), unknown.getValue(1000));
+}
+
+TEST(peer_list, peer_score_strikes_expire)
+{
+  PeerScore score;
+  score.addStrike(1000);
+  score.addStrike(2000);
+
+  ASSERT_EQ(2, score.getStrikes(2000));
+  ASSERT_EQ(-200, score.getValue(2000));
+  ASSERT_EQ(0, score.getStrikes(2000 + CryptoNote::P2P_PEER_STRIKE_LIFETIME));
+  ASSERT_EQ(0, score.getValue(2000 + CryptoNote::P2P_PEER_STRIKE_LIFETIME));
+
+  score.addStrike(2000 + CryptoNote::P2P_PEER_STRIKE_LIFETIME);
+  ASSERT_EQ(1, score.getStrikes(2000 + CryptoNote::P2P_PEER_STRIKE_LIFETIME));
+}
+
+TEST(peer_list, peer_scores_are_serialized)
+{
+  PeerlistManager plm;
+  plm.init(false);
+  ADD_WHITE_NODE(MAKE_IP(123,43,12,1), 8080, 121241, 34345);
+
+  NetworkAddress addr;
+  addr.ip = MAKE_IP(123,43,12,1);
+  addr.port = 8080;
+
+  PeerScore score;
+  score.addHandshakeRtt(120);
+  score.addBlockDelivery(300, 500000);
+  score.addStrike(5000);
+  plm.set_peer_score(addr, score);
+
+  PeerlistManager loaded;
+  loaded.init(false);
+  loadFromBinary(loaded, storeToBinary(plm));
+  ASSERT_EQ(1, loaded.get_white_peers_count());
+
+  PeerScore loadedScore;
+  ASSERT_TRUE(loaded.get_peer_score(addr, loadedScore));
+  ASSERT_EQ(score.handshakeRtt, loadedScore.handshakeRtt);
+  ASSERT_EQ(score.blockLatency, loadedScore.blockLatency);
+  ASSERT_EQ(score.syncSpeed, loadedScore.syncSpeed);
+  ASSERT_EQ(score.strikes, loadedScore.strikes);
+  ASSERT_EQ(score.lastStrikeTime, loadedScore.lastStrikeTime);
+
+  addr.port = 8081;
+  ASSERT_FALSE(loaded.get_peer_score(addr, loadedScore));
+}
+
+TEST(peer_list, version_1_state_loads_without_scores)
+{
+  PeerlistStateV1 state;
+  state.white.push_back(makePeerlistEntry(MAKE_IP(123,43,12,1), 8080, 121241, 34345));
+  state.white.push_back(makePeerlistEntry(MAKE_IP(123,43,12,2), 8080, 121242, 34346));
+  state.gray.push_back(makePeerlistEntry(MAKE_IP(123,43,12,3), 8080, 121243, 34347));
+
+  PeerlistManager loaded;
+  loaded.init(false);
+  loadFromBinary(loaded, storeToBinary(state));
+  ASSERT_EQ(2, loaded.get_white_peers_count());
+  ASSERT_EQ(1, loaded.get_gray_peers_count());
+
+  std::list<PeerlistEntry> gray;
+  std::list<PeerlistEntry> white;
+  ASSERT_TRUE(loaded.get_peerlist_full(gray, white));
+  ASSERT_EQ(MAKE_IP(123,43,12,3), gray.front().adr.ip);
+  ASSERT_EQ(121243, gray.front().id);
+  ASSERT_EQ(34347, gray.front().last_seen);
+
+  PeerScore score;
+  for (const PeerlistEntry& entry : white) {
+    ASSERT_TRUE(entry.adr.ip == MAKE_IP(123,43,12,1) || entry.adr.ip == MAKE_IP(123,43,12,2));
+    ASSERT_FALSE(loaded.get_peer_score(entry.adr, score));
+  }
+
+  ASSERT_FALSE(loaded.get_peer_score(gray.front().adr, score));
+}
@@ -7,6 +7,7 @@
 
 #include "gtest/gtest.h"
 #include "CryptoNoteProtocol/CryptoNoteProtocolDefinitions.h"
+#include "P2p/P2pProtocolDefinitions.h"
 #include "Serialization/SerializationTools.h"
 
 TEST(protocol_pack, protocol_pack_command) 
@@ -26,3 +27,99 @@ TEST(protocol_pack, protocol_pack_command)
     ASSERT_TRUE(r.total_height == 3);
   }
 }
+
+TEST(protocol_pack, blocks_by_range_response)
+{
+  std::vector<CryptoNote::block_complete_entry> blocks(3);
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    blocks[i].block.assign(80 + i, static_cast<char>(i));
+    blocks[i].txs.assign(i, std::string(200, static_cast<char>(i)));
+  }
+
+  CryptoNote::BinaryArray packed;
+  CryptoNote::BinaryEncoder encoder(packed);
+  encode(encoder, blocks);
+
+  CryptoNote::NOTIFY_RESPONSE_BLOCKS_BY_RANGE::request r;
+  r.start_height = 10;
+  r.current_blockchain_height = 20;
+  r.anchor_found = true;
+  r.blocks.assign(packed.begin(), packed.end());
+
+  CryptoNote::NOTIFY_RESPONSE_BLOCKS_BY_RANGE::request r2;
+  ASSERT_TRUE(CryptoNote::loadFromBinaryKeyValue(r2, CryptoNote::storeToBinaryKeyValue(r)));
+  EXPECT_EQ(10, r2.start_height);
+  EXPECT_EQ(20, r2.current_blockchain_height);
+  EXPECT_TRUE(r2.anchor_found);
+
+  std::vector<CryptoNote::block_complete_entry> blocks2;
+  CryptoNote::BinaryDecoder decoder(reinterpret_cast<const uint8_t*>(r2.blocks.data()), r2.blocks.size());
+  decode(decoder, blocks2);
+  EXPECT_EQ(0, decoder.remaining());
+  ASSERT_EQ(blocks.size(), blocks2.size());
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    EXPECT_EQ(blocks[i].block, blocks2[i].block);
+    EXPECT_EQ(blocks[i].txs, blocks2[i].txs);
+  }
+}
+
+TEST(protocol_pack, core_sync_data_without_capabilities)
+{
+  struct LegacySyncData {
+    uint32_t current_height;
+    Crypto::Hash top_id;
+
+    void serialize(CryptoNote::ISerializer& s) {
+      KV_MEMBER(current_height)
+      KV_MEMBER(top_id)
+    }
+  } legacy = { 5, CryptoNote::NULL_HASH };
+
+  CryptoNote::CORE_SYNC_DATA data;
+  data.capabilities = CryptoNote::P2P_CAPABILITY_BLOCKS_BY_RANGE;
+  ASSERT_TRUE(CryptoNote::loadFromBinaryKeyValue(data, CryptoNote::storeToBinaryKeyValue(legacy)));
+  EXPECT_EQ(5, data.current_height);
+  EXPECT_EQ(0, data.capabilities);
+
+  data.capabilities = CryptoNote::P2P_CAPABILITY_BLOCKS_BY_RANGE;
+  CryptoNote::CORE_SYNC_DATA data2;
+  ASSERT_TRUE(CryptoNote::loadFromBinaryKeyValue(data2, CryptoNote::storeToBinaryKeyValue(data)));
+  EXPECT_EQ(CryptoNote::P2P_CAPABILITY_BLOCKS_BY_RANGE, data2.capabilities);
+}
+
+TEST(protocol_pack, block_txs_request_and_response)
+{
+  CryptoNote::NOTIFY_REQUEST_BLOCK_TXS::request r;
+  r.block_id.data[0] = 1;
+  r.txs.resize(3);
+  for (size_t i = 0; i < r.txs.size(); ++i) {
+    r.txs[i].data[31] = static_cast<uint8_t>(i + 1);
+  }
+
+  CryptoNote::NOTIFY_REQUEST_BLOCK_TXS::request r2;
+  ASSERT_TRUE(CryptoNote::loadFromBinaryKeyValue(r2, CryptoNote::storeToBinaryKeyValue(r)));
+  EXPECT_EQ(r.block_id, r2.block_id);
+  EXPECT_EQ(r.txs, r2.txs);
+
+  CryptoNote::NOTIFY_RESPONSE_BLOCK_TXS::request rsp;
+  rsp.block_id = r.block_id;
+  rsp.txs.assign(3, std::string(300, 'x'));
+
+  CryptoNote::NOTIFY_RESPONSE_BLOCK_TXS::request rsp2;
+  ASSERT_TRUE(CryptoNote::loadFromBinaryKeyValue(rsp2, CryptoNote::storeToBinaryKeyValue(rsp)));
+  EXPECT_EQ(rsp.block_id, rsp2.block_id);
+  EXPECT_EQ(rsp.txs, rsp2.txs);
+}
+
+TEST(protocol_pack, tx_inventory)
+{
+  CryptoNote::NOTIFY_TX_INVENTORY::request r;
+  r.txs.resize(100);
+  for (size_t i = 0; i < r.txs.size(); ++i) {
+    r.txs[i].data[0] = static_cast<uint8_t>(i);
+  }
+
+  CryptoNote::NOTIFY_TX_INVENTORY::request r2;
+  ASSERT_TRUE(CryptoNote::loadFromBinaryKeyValue(r2, CryptoNote::storeToBinaryKeyValue(r)));
+  EXPECT_EQ(r.txs, r2.txs);
+}
@@ -0,0 +1,102 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+#include "CryptoNoteCore/TraceLog.h"
+
+#include <sstream>
+#include <thread>
+
+#include "Common/JsonValue.h"
+#include "Common/StringTools.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+Crypto::Hash makeHash(uint8_t seed) {
+  Crypto::Hash hash = Crypto::Hash();
+  hash.data[0] = seed;
+  return hash;
+}
+
+Common::JsonValue dump() {
+  std::stringstream stream;
+  TraceLog::dumpChromeTrace(stream);
+  return Common::JsonValue::fromString(stream.str());
+}
+
+class TraceLogTest : public testing::Test {
+public:
+  void SetUp() override {
+    TraceLog::clear();
+    TraceLog::setEnabled(true);
+  }
+
+  void TearDown() override {
+    TraceLog::setEnabled(false);
+    TraceLog::clear();
+  }
+};
+
+}
+
+TEST_F(TraceLogTest, dumpsSpansAndInstantsAsChromeTrace) {
+  {
+    TraceSpan span(TraceEvent::BLOCK_PARSED);
+    span.setId(makeHash(1));
+  }
+
+  TraceLog::instant(TraceEvent::BLOCK_RELAYED, makeHash(1));
+
+  Common::JsonValue trace = dump();
+  const Common::JsonValue& events = trace("traceEvents");
+  ASSERT_EQ(2, events.size());
+
+  ASSERT_EQ("block.parsed", events[0]("name").getString());
+  ASSERT_EQ("X", events[0]("ph").getString());
+  ASSERT_TRUE(events[0].contains("dur"));
+  ASSERT_EQ(Common::podToHex(makeHash(1)), events[0]("args")("id").getString());
+
+  ASSERT_EQ("block.relayed", events[1]("name").getString());
+  ASSERT_EQ("i", events[1]("ph").getString());
+}
+
+TEST_F(TraceLogTest, recordsNothingWhenDisabled) {
+  TraceLog::setEnabled(false);
+  {
+    TraceSpan span(TraceEvent::TX_PARSED, makeHash(2));
+    ASSERT_FALSE(span.isActive());
+  }
+
+  TraceLog::instant(TraceEvent::TX_RELAYED, makeHash(2));
+  ASSERT_EQ(0, dump()("traceEvents").size());
+}
+
+TEST_F(TraceLogTest, mergesThreadsInTimeOrder) {
+  std::thread other([] { TraceLog::instant(TraceEvent::TX_RECEIVED, makeHash(3)); });
+  other.join();
+  TraceLog::instant(TraceEvent::TX_RELAYED, makeHash(3));
+
+  Common::JsonValue trace = dump();
+  const Common::JsonValue& events = trace("traceEvents");
+  ASSERT_EQ(2, events.size());
+  ASSERT_EQ("tx.received", events[0]("name").getString());
+  ASSERT_EQ("tx.relayed", events[1]("name").getString());
+  ASSERT_NE(events[0]("tid").getInteger(), events[1]("tid").getInteger());
+}
+
+TEST_F(TraceLogTest, keepsOnlyTheNewestEventsOfAThread) {
+  for (int i = 0; i < 100000; ++i) {
+    TraceLog::instant(TraceEvent::TX_RECEIVED, makeHash(4));
+  }
+
+  TraceLog::instant(TraceEvent::TX_RELAYED, makeHash(4));
+
+  Common::JsonValue trace = dump();
+  const Common::JsonValue& events = trace("traceEvents");
+  ASSERT_LT(events.size(), 100000);
+  ASSERT_EQ("tx.relayed", events[events.size() - 1]("name").getString());
+}
@@ -0,0 +1,66 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include "CryptoNoteCore/TransactionHashCache.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+Crypto::Hash makeHash(uint8_t i) {
+  Crypto::Hash hash = {};
+  hash.data[0] = i;
+  return hash;
+}
+
+}
+
+TEST(TransactionHashCache, containsAddedHashes) {
+  TransactionHashCache cache(10, 60);
+  cache.add(makeHash(1), 1000);
+
+  EXPECT_TRUE(cache.contains(makeHash(1), 1000));
+  EXPECT_FALSE(cache.contains(makeHash(2), 1000));
+}
+
+TEST(TransactionHashCache, forgetsHashesAfterLifetime) {
+  TransactionHashCache cache(10, 60);
+  cache.add(makeHash(1), 1000);
+  cache.add(makeHash(2), 1030);
+
+  EXPECT_TRUE(cache.contains(makeHash(1), 1059));
+  EXPECT_FALSE(cache.contains(makeHash(1), 1060));
+  EXPECT_TRUE(cache.contains(makeHash(2), 1060));
+
+  cache.add(makeHash(3), 1060);
+  EXPECT_EQ(2, cache.size());
+}
+
+TEST(TransactionHashCache, forgetsOldestHashesBeyondCapacity) {
+  TransactionHashCache cache(3, 60);
+  for (uint8_t i = 0; i < 5; ++i) {
+    cache.add(makeHash(i), 1000 + i);
+  }
+
+  EXPECT_EQ(3, cache.size());
+  EXPECT_FALSE(cache.contains(makeHash(0), 1005));
+  EXPECT_FALSE(cache.contains(makeHash(1), 1005));
+  for (uint8_t i = 2; i < 5; ++i) {
+    EXPECT_TRUE(cache.contains(makeHash(i), 1005));
+  }
+}
+
+TEST(TransactionHashCache, addingHashAgainKeepsFirstTime) {
+  TransactionHashCache cache(10, 60);
+  cache.add(makeHash(1), 1000);
+  cache.add(makeHash(1), 1050);
+  EXPECT_FALSE(cache.contains(makeHash(1), 1060));
+
+  cache.add(makeHash(1), 1060);
+  EXPECT_TRUE(cache.contains(makeHash(1), 1119));
+  EXPECT_EQ(1, cache.size());
+}
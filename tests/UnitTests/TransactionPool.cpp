@@ -25,11 +25,11 @@ using namespace CryptoNote;
 using namespace CryptoNote;
 
 class TransactionValidator : public CryptoNote::ITransactionValidator {
-  virtual bool checkTransactionInputs(const CryptoNote::Transaction& tx, BlockInfo& maxUsedBlock) override {
+  virtual bool checkTransactionInputs(const CryptoNote::CachedTransaction& tx, BlockInfo& maxUsedBlock) override {
     return true;
   }
 
-  virtual bool checkTransactionInputs(const CryptoNote::Transaction& tx, BlockInfo& maxUsedBlock, BlockInfo& lastFailed) override {
+  virtual bool checkTransactionInputs(const CryptoNote::CachedTransaction& tx, BlockInfo& maxUsedBlock, BlockInfo& lastFailed) override {
     return true;
   }
 
@@ -230,13 +230,15 @@ TEST_F(tx_pool, take_tx)
   ASSERT_TRUE(test.pool.add_tx(tx, tvc, false, 0)); 
   ASSERT_FALSE(tvc.m_verifivation_failed);
 
-  Transaction txOut;
-  size_t blobSize;
+  CachedTransaction txOut;
   uint64_t fee = 0;
 
-  ASSERT_TRUE(test.pool.take_tx(txhash, txOut, blobSize, fee));
+  ASSERT_TRUE(test.pool.take_tx(txhash, txOut, fee));
   ASSERT_EQ(fee, test.m_currency.minimumFee());
-  ASSERT_EQ(tx, txOut);
+  ASSERT_EQ(tx, txOut.getTransaction());
+  ASSERT_EQ(txhash, txOut.getTransactionHash());
+  ASSERT_EQ(getObjectBinarySize(tx), txOut.getTransactionBinarySize());
+  ASSERT_EQ(toBinaryArray(tx), txOut.getTransactionBinaryArray());
 };
 
 
@@ -0,0 +1,180 @@
+// Copyright (c) 2011-2017 The Cryptonote developers
+// Copyright (c) 2017-2020 UltraNote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include "CryptoNoteConfig.h"
+#include "CryptoNoteCore/CryptoNoteFormatUtils.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/TransactionUtils.h"
+#include "CryptoNoteCore/TransactionView.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+Crypto::PublicKey randomKey() {
+  return generateKeyPair().publicKey;
+}
+
+Transaction createTransaction() {
+  Transaction tx;
+  tx.version = TRANSACTION_VERSION_2;
+  tx.unlockTime = 10;
+
+  for (uint8_t i = 0; i < 2; ++i) {
+    KeyInput key;
+    key.amount = 1000 + i;
+    key.outputIndexes = { 5u + i, 300, 70000 };
+    Crypto::PublicKey image = randomKey();
+    memcpy(&key.keyImage, &image, sizeof(key.keyImage));
+    tx.inputs.push_back(key);
+  }
+
+  tx.inputs.push_back(MultisignatureInput{ 500, 2, 7, 0 });
+
+  tx.outputs.push_back({ 900, KeyOutput{ randomKey() } });
+  MultisignatureOutput multisignature;
+  multisignature.keys = { randomKey(), randomKey() };
+  multisignature.requiredSignatureCount = 2;
+  multisignature.term = 0;
+  tx.outputs.push_back({ 600, multisignature });
+
+  tx.extra = { 0x02, 0x01, 0x00 };
+
+  tx.signatures.resize(tx.inputs.size());
+  for (size_t i = 0; i < tx.inputs.size(); ++i) {
+    tx.signatures[i].resize(getRequiredSignaturesCount(tx.inputs[i]));
+    for (auto& signature : tx.signatures[i]) {
+      signature.data[0] = static_cast<uint8_t>(i);
+    }
+  }
+
+  return tx;
+}
+
+void expectSameChecks(const Transaction& tx) {
+  BinaryArray blob = toBinaryArray(tx);
+  TransactionView view;
+  ASSERT_TRUE(view.parse(blob));
+
+  EXPECT_EQ(check_inputs_types_supported(tx), check_inputs_types_supported(view));
+  std::string error;
+  EXPECT_EQ(check_outs_valid(tx, &error), check_outs_valid(view, &error));
+  EXPECT_EQ(check_money_overflow(tx), check_money_overflow(view));
+  EXPECT_EQ(checkMultisignatureInputsDiff(tx), checkMultisignatureInputsDiff(view));
+  EXPECT_EQ(checkInputsKeyimagesDiff(tx), checkInputsKeyimagesDiff(view));
+  EXPECT_EQ(get_outs_money_amount(tx), get_outs_money_amount(view));
+}
+
+}
+
+TEST(TransactionView, parsesInPlace) {
+  Transaction tx = createTransaction();
+  BinaryArray blob = toBinaryArray(tx);
+
+  TransactionView view;
+  ASSERT_TRUE(view.parse(blob));
+  ASSERT_EQ(tx.version, view.getVersion());
+  ASSERT_EQ(tx.unlockTime, view.getUnlockTime());
+  ASSERT_EQ(3, view.getInputs().size());
+  ASSERT_EQ(2, view.getOutputs().size());
+  ASSERT_EQ(blob.size(), view.getBlobSize());
+
+  const TransactionView::Input& key = view.getInputs()[1];
+  ASSERT_EQ(TransactionTypes::InputType::Key, key.type);
+  ASSERT_EQ(1001, key.amount);
+  ASSERT_EQ(3, key.outputIndexes.getSize());
+  ASSERT_EQ(6, key.outputIndexes[0]);
+  ASSERT_EQ(70000, key.outputIndexes[2]);
+  ASSERT_EQ(boost::get<KeyInput>(tx.inputs[1]).keyImage, *key.keyImage);
+  ASSERT_EQ(3, key.signatures.getSize());
+
+  const TransactionView::Input& multisignature = view.getInputs()[2];
+  ASSERT_EQ(TransactionTypes::InputType::Multisignature, multisignature.type);
+  ASSERT_EQ(2, multisignature.signatures.getSize());
+
+  // spans point into the blob
+  ASSERT_EQ(blob.data() + blob.size() - 2 * sizeof(Crypto::Signature), reinterpret_cast<const uint8_t*>(multisignature.signatures.getData()));
+  ASSERT_EQ(tx.extra.size(), view.getExtra().getSize());
+
+  ASSERT_EQ(getObjectHash(tx), view.getHash());
+  ASSERT_EQ(getObjectHash(static_cast<const TransactionPrefix&>(tx)), view.getPrefixHash());
+}
+
+TEST(TransactionView, toTransactionRoundTrips) {
+  Transaction tx = createTransaction();
+  BinaryArray blob = toBinaryArray(tx);
+
+  TransactionView view;
+  ASSERT_TRUE(view.parse(blob));
+  Transaction materialized;
+  view.toTransaction(materialized);
+  ASSERT_EQ(blob, toBinaryArray(materialized));
+}
+
+TEST(TransactionView, reparsingReplacesThePreviousTransaction) {
+  Transaction big = createTransaction();
+  Transaction small = createTransaction();
+  small.inputs.resize(1);
+  small.signatures.resize(1);
+  small.outputs.resize(1);
+  BinaryArray bigBlob = toBinaryArray(big);
+  BinaryArray smallBlob = toBinaryArray(small);
+
+  TransactionView view;
+  ASSERT_TRUE(view.parse(bigBlob));
+  ASSERT_TRUE(view.parse(smallBlob));
+  ASSERT_EQ(1, view.getInputs().size());
+  ASSERT_EQ(getObjectHash(small), view.getHash());
+
+  Transaction materialized;
+  view.toTransaction(materialized);
+  ASSERT_EQ(smallBlob, toBinaryArray(materialized));
+}
+
+TEST(TransactionView, rejectsWhatTheCodecRejects) {
+  BinaryArray blob = toBinaryArray(createTransaction());
+  TransactionView view;
+  Transaction tx;
+  for (size_t size = 0; size < blob.size(); ++size) {
+    BinaryArray truncated(blob.begin(), blob.begin() + size);
+    ASSERT_EQ(fromBinaryArray(tx, truncated), view.parse(truncated)) << size;
+  }
+
+  blob.push_back(0);
+  ASSERT_FALSE(view.parse(blob));
+  ASSERT_TRUE(view.getInputs().empty());
+}
+
+TEST(TransactionView, checksMatchTheTransactionChecks) {
+  Transaction tx = createTransaction();
+  expectSameChecks(tx);
+
+  Transaction duplicateKeyImage = createTransaction();
+  boost::get<KeyInput>(duplicateKeyImage.inputs[1]).keyImage = boost::get<KeyInput>(duplicateKeyImage.inputs[0]).keyImage;
+  expectSameChecks(duplicateKeyImage);
+
+  Transaction duplicateOutputKey = createTransaction();
+  boost::get<MultisignatureOutput>(duplicateOutputKey.outputs[1].target).keys[1] = boost::get<KeyOutput>(duplicateOutputKey.outputs[0].target).key;
+  expectSameChecks(duplicateOutputKey);
+
+  Transaction zeroAmount = createTransaction();
+  zeroAmount.outputs[0].amount = 0;
+  expectSameChecks(zeroAmount);
+
+  Transaction duplicateMultisignature = createTransaction();
+  duplicateMultisignature.inputs.push_back(duplicateMultisignature.inputs[2]);
+  duplicateMultisignature.signatures.push_back(duplicateMultisignature.signatures[2]);
+  expectSameChecks(duplicateMultisignature);
+
+  Transaction overflow = createTransaction();
+  overflow.outputs[0].amount = std::numeric_limits<uint64_t>::max();
+  expectSameChecks(overflow);
+
+  Transaction multisignatureInVersion1 = createTransaction();
+  multisignatureInVersion1.version = TRANSACTION_VERSION_1;
+  expectSameChecks(multisignatureInVersion1);
+}